@@ -63,6 +63,14 @@ struct BlockShortEntry {
   std::vector<TransactionShortInfo> txsShortInfo;
 };
 
+struct BlockFilterEntry {
+  Crypto::Hash blockHash;
+  bool hasBlock;
+  CryptoNote::Block block;
+  std::vector<TransactionFilterInfo> txFilters;
+  std::string spendFilter;
+};
+
 class INode {
 public:
   typedef std::function<void(std::error_code)> Callback;
@@ -84,6 +92,7 @@ public:
   virtual void getRandomOutsByAmounts(std::vector<uint64_t>&& amounts, uint64_t outsCount, std::vector<CryptoNote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount>& result, const Callback& callback) = 0;
   virtual void getNewBlocks(std::vector<Crypto::Hash>&& knownBlockIds, std::vector<CryptoNote::block_complete_entry>& newBlocks, uint32_t& startHeight, const Callback& callback) = 0;
   virtual void getTransactionOutsGlobalIndices(const Crypto::Hash& transactionHash, std::vector<uint32_t>& outsGlobalIndices, const Callback& callback) = 0;
+  virtual void getTransactionsOutsGlobalIndices(const std::vector<Crypto::Hash>& transactionHashes, std::vector<std::vector<uint32_t>>& outsGlobalIndices, const Callback& callback) = 0;
   virtual void queryBlocks(std::vector<Crypto::Hash>&& knownBlockIds, uint64_t timestamp, std::vector<BlockShortEntry>& newBlocks, uint32_t& startHeight, const Callback& callback) = 0;
   virtual void getPoolSymmetricDifference(std::vector<Crypto::Hash>&& knownPoolTxIds, Crypto::Hash knownBlockId, bool& isBcActual, std::vector<std::unique_ptr<ITransactionReader>>& newTxs, std::vector<Crypto::Hash>& deletedTxIds, const Callback& callback) = 0;
   virtual void getMultisignatureOutputByGlobalIndex(uint64_t amount, uint32_t gindex, MultisignatureOutput& out, const Callback& callback) = 0;
@@ -95,6 +104,15 @@ public:
   virtual void getTransactionsByPaymentId(const Crypto::Hash& paymentId, std::vector<TransactionDetails>& transactions, const Callback& callback) = 0;
   virtual void getPoolTransactions(uint64_t timestampBegin, uint64_t timestampEnd, uint32_t transactionsNumberLimit, std::vector<TransactionDetails>& transactions, uint64_t& transactionsNumberWithinTimestamps, const Callback& callback) = 0;
   virtual void isSynchronized(bool& syncStatus, const Callback& callback) = 0;
+
+  // Compact block filters are optional, a node that doesn't serve them reports std::errc::function_not_supported
+  virtual void queryBlockFilters(std::vector<Crypto::Hash>&& knownBlockIds, uint64_t timestamp, std::vector<BlockFilterEntry>& newBlocks, uint32_t& startHeight, const Callback& callback) {
+    callback(std::make_error_code(std::errc::function_not_supported));
+  }
+
+  virtual void getBlocksTransactions(const std::vector<Crypto::Hash>& blockHashes, std::vector<std::vector<TransactionShortInfo>>& transactions, const Callback& callback) {
+    callback(std::make_error_code(std::errc::function_not_supported));
+  }
 };
 
 }
@@ -126,6 +126,8 @@ public:
 
   // signing
   virtual void signInputKey(size_t input, const TransactionTypes::InputKeyInfo& info, const KeyPair& ephKeys) = 0;
+  // signs key inputs 0..infos.size()-1 in parallel, same result as calling signInputKey for each of them
+  virtual void signInputKeys(const std::vector<TransactionTypes::InputKeyInfo>& infos, const std::vector<KeyPair>& ephKeys) = 0;
   virtual void signInputMultisignature(size_t input, const Crypto::PublicKey& sourceTransactionKey, size_t outputIndex, const AccountKeys& accountKeys) = 0;
   virtual void signInputMultisignature(size_t input, const KeyPair& ephemeralKeys) = 0;
 };
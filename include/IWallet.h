@@ -235,6 +235,9 @@ public:
 
   virtual std::vector<TransactionsInBlockInfo> getTransactions(const Crypto::Hash &blockHash, size_t count) const = 0;
   virtual std::vector<TransactionsInBlockInfo> getTransactions(uint32_t blockIndex, size_t count) const = 0;
+  // Blocks of the range that hold wallet transactions, each listing only the transactions with the given payment id
+  virtual std::vector<TransactionsInBlockInfo> getTransactionsByPaymentId(const Crypto::Hash &paymentId, const Crypto::Hash &blockHash, size_t count) const = 0;
+  virtual std::vector<TransactionsInBlockInfo> getTransactionsByPaymentId(const Crypto::Hash &paymentId, uint32_t blockIndex, size_t count) const = 0;
 
 
 
@@ -244,6 +247,9 @@ public:
   virtual std::vector<size_t> getDelayedTransactionIds() const = 0;
 
   virtual size_t transfer(const TransactionParameters &sendingTransaction, Crypto::SecretKey &transactionSK) = 0;
+  // Builds every transaction before any of them is relayed: either all are created or none. Returns
+  // one transaction id per entry; a transaction the node refused to relay is left in FAILED state
+  virtual std::vector<size_t> transfer(const std::vector<TransactionParameters> &sendingTransactions, std::vector<Crypto::SecretKey> &transactionSKs) = 0;
 
   virtual size_t makeTransaction(const TransactionParameters &sendingTransaction) = 0;
   virtual void commitTransaction(size_t transactionId) = 0;
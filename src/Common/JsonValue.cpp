@@ -18,6 +18,7 @@
 // along with Fuego. If not, see <https://www.gnu.org/licenses/>
 
 #include "JsonValue.h"
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
@@ -574,28 +575,241 @@ size_t JsonValue::erase(const Key& key) {
   return getObject().erase(key);
 }
 
-JsonValue JsonValue::fromString(const std::string& source) {
-  JsonValue jsonValue;
-  std::istringstream stream(source);
-  stream >> jsonValue;
-  if (stream.fail()) {
-    throw std::runtime_error("Unable to parse JsonValue");
+namespace {
+
+// Reads the dialect of operator>> straight from a buffer: escapes in strings are kept as they are,
+// exponents need a fraction, and whatever follows the value is ignored.
+class JsonParser {
+public:
+  JsonParser(const char* data, size_t size) : m_current(data), m_end(data + size), m_depth(0) {
   }
 
-  return jsonValue;
-}
+  void readValue(JsonValue& value) {
+    char c = readNonWsChar();
+
+    if (c == '[') {
+      readArray(value);
+    } else if (c == 't') {
+      readWord("rue", 3);
+      value = JsonValue(true);
+    } else if (c == 'f') {
+      readWord("alse", 4);
+      value = JsonValue(false);
+    } else if ((c == '-') || (c >= '0' && c <= '9')) {
+      readNumber(value, c);
+    } else if (c == 'n') {
+      readWord("ull", 3);
+      value = nullptr;
+    } else if (c == '{') {
+      readObject(value);
+    } else if (c == '"') {
+      JsonValue::String string;
+      readStringToken(string);
+      value = std::move(string);
+    } else {
+      fail();
+    }
+  }
 
-JsonValue JsonValue::fromStringWithWhiteSpaces(const std::string& source) {
-  JsonValue jsonValue;
-  std::istringstream stream(source);
-  stream >> std::noskipws >> jsonValue;
-  if (stream.fail()) {
-    throw std::runtime_error("Unable to parse JsonValue");
+private:
+  // nesting deeper than this is no legitimate request, and recursing on it would exhaust the stack
+  static const size_t MAX_DEPTH = 512;
+
+  [[noreturn]] static void fail() {
+    throw std::runtime_error("Unable to parse");
+  }
+
+  char readChar() {
+    if (m_current == m_end) {
+      throw std::runtime_error("Unable to parse: unexpected end of stream");
+    }
+
+    return *m_current++;
   }
 
+  char readNonWsChar() {
+    char c;
+    do {
+      c = readChar();
+    } while (c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f');
+
+    return c;
+  }
+
+  void readWord(const char* rest, size_t size) {
+    if (static_cast<size_t>(m_end - m_current) < size || memcmp(m_current, rest, size) != 0) {
+      fail();
+    }
+
+    m_current += size;
+  }
+
+  void readStringToken(std::string& value) {
+    for (;;) {
+      const char* quote = static_cast<const char*>(memchr(m_current, '"', m_end - m_current));
+      if (quote == nullptr) {
+        throw std::runtime_error("Unable to parse: unexpected end of stream");
+      }
+
+      const char* backslash = static_cast<const char*>(memchr(m_current, '\\', quote - m_current));
+      if (backslash == nullptr) {
+        value.append(m_current, quote);
+        m_current = quote + 1;
+        return;
+      }
+
+      // the escaped character goes with its backslash and doesn't end the string
+      value.append(m_current, backslash + 2);
+      m_current = backslash + 2;
+    }
+  }
+
+  void readArray(JsonValue& value) {
+    enter();
+    JsonValue::Array array;
+    char c = readNonWsChar();
+
+    if (c != ']') {
+      --m_current;
+      for (;;) {
+        array.emplace_back();
+        readValue(array.back());
+        c = readNonWsChar();
+
+        if (c == ']') {
+          break;
+        }
+
+        if (c != ',') {
+          fail();
+        }
+      }
+    }
+
+    value = std::move(array);
+    --m_depth;
+  }
+
+  void readObject(JsonValue& value) {
+    enter();
+    JsonValue::Object object;
+    char c = readNonWsChar();
+
+    if (c != '}') {
+      std::string name;
+
+      for (;;) {
+        if (c != '"') {
+          fail();
+        }
+
+        name.clear();
+        readStringToken(name);
+        if (readNonWsChar() != ':') {
+          fail();
+        }
+
+        readValue(object[name]);
+        c = readNonWsChar();
+
+        if (c == '}') {
+          break;
+        }
+
+        if (c != ',') {
+          fail();
+        }
+
+        c = readNonWsChar();
+      }
+    }
+
+    value = std::move(object);
+    --m_depth;
+  }
+
+  void readNumber(JsonValue& value, char first) {
+    const char* begin = m_current - 1;
+    size_t dots = 0;
+    while (m_current != m_end && ((*m_current >= '0' && *m_current <= '9') || *m_current == '.')) {
+      if (*m_current == '.') {
+        ++dots;
+      }
+
+      ++m_current;
+    }
+
+    if (dots > 0) {
+      if (dots > 1) {
+        fail();
+      }
+
+      if (m_current != m_end && *m_current == 'e') {
+        ++m_current;
+        if (m_current != m_end && (*m_current == '+' || *m_current == '-')) {
+          ++m_current;
+        }
+
+        if (m_current == m_end || *m_current < '0' || *m_current > '9') {
+          fail();
+        }
+
+        do {
+          ++m_current;
+        } while (m_current != m_end && *m_current >= '0' && *m_current <= '9');
+      }
+
+      // rare enough in requests to take the stream, which reads reals independently of the C locale
+      JsonValue::Real real;
+      std::istringstream(std::string(begin, m_current)) >> real;
+      value = real;
+      return;
+    }
+
+    const char* digits = first == '-' ? begin + 1 : begin;
+    if (digits == m_current || (m_current - begin > 1 && *digits == '0')) {
+      fail();
+    }
+
+    // out of range values saturate, as reading them from a stream does
+    const uint64_t limit = first == '-' ? static_cast<uint64_t>(INT64_MAX) + 1 : INT64_MAX;
+    uint64_t magnitude = 0;
+    for (const char* digit = digits; digit != m_current; ++digit) {
+      uint64_t next = magnitude * 10 + (*digit - '0');
+      if (magnitude > limit / 10 || next > limit) {
+        magnitude = limit;
+        break;
+      }
+
+      magnitude = next;
+    }
+
+    value = first == '-' ? static_cast<JsonValue::Integer>(0 - magnitude) : static_cast<JsonValue::Integer>(magnitude);
+  }
+
+  void enter() {
+    if (++m_depth > MAX_DEPTH) {
+      fail();
+    }
+  }
+
+  const char* m_current;
+  const char* m_end;
+  size_t m_depth;
+};
+
+}
+
+JsonValue JsonValue::fromString(const std::string& source) {
+  JsonValue jsonValue;
+  JsonParser(source.data(), source.size()).readValue(jsonValue);
   return jsonValue;
 }
 
+JsonValue JsonValue::fromStringWithWhiteSpaces(const std::string& source) {
+  return fromString(source);
+}
+
 std::string JsonValue::toString() const {
   std::ostringstream stream;
   stream << *this;
@@ -0,0 +1,116 @@
+// Copyright (c) 2017-2022 Fuego Developers
+//
+// This file is part of Fuego.
+//
+// Fuego is free & open source software distributed in the hope
+// it will be useful, but WITHOUT ANY WARRANTY; without even an
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+// PURPOSE. You may redistribute it and/or modify it under the terms
+// of the GNU General Public License v3 or later versions as published
+// by the Free Software Foundation. Fuego includes elements written
+// by third parties. See file labeled LICENSE for more details.
+// You should have received a copy of the GNU General Public License
+// along with Fuego. If not, see <https://www.gnu.org/licenses/>.
+
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <system_error>
+
+namespace Tools {
+
+WorkerPool::WorkerPool(size_t workerCount) :
+  m_stopped(false), m_jobNumber(0), m_busyThreads(0), m_task(nullptr), m_count(0), m_nextIndex(0) {
+  if (workerCount == 0) {
+    workerCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  }
+
+  for (size_t i = 1; i < workerCount; ++i) {
+    try {
+      m_threads.emplace_back(&WorkerPool::workerProcedure, this);
+    } catch (const std::system_error&) {
+      // work with the threads we have
+      break;
+    }
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_stopped = true;
+  }
+
+  m_haveJob.notify_all();
+  for (auto& thread : m_threads) {
+    thread.join();
+  }
+}
+
+size_t WorkerPool::workerCount() const {
+  return m_threads.size() + 1;
+}
+
+void WorkerPool::run(size_t count, const std::function<void(size_t)>& task) {
+  if (count == 0) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> runLock(m_runMutex);
+
+  // a single index is not worth waking anybody up
+  if (count == 1 || m_threads.empty()) {
+    for (size_t i = 0; i < count; ++i) {
+      task(i);
+    }
+
+    return;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_task = &task;
+    m_count = count;
+    m_nextIndex = 0;
+    m_busyThreads = m_threads.size();
+    ++m_jobNumber;
+  }
+
+  m_haveJob.notify_all();
+  runTasks();
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_jobDone.wait(lock, [this] { return m_busyThreads == 0; });
+  m_task = nullptr;
+}
+
+void WorkerPool::workerProcedure() {
+  uint64_t lastJob = 0;
+
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_haveJob.wait(lock, [&] { return m_stopped || m_jobNumber != lastJob; });
+      if (m_stopped) {
+        return;
+      }
+
+      lastJob = m_jobNumber;
+    }
+
+    runTasks();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (--m_busyThreads == 0) {
+      m_jobDone.notify_one();
+    }
+  }
+}
+
+void WorkerPool::runTasks() {
+  for (size_t i = m_nextIndex++; i < m_count; i = m_nextIndex++) {
+    (*m_task)(i);
+  }
+}
+
+}
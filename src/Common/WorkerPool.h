@@ -0,0 +1,63 @@
+// Copyright (c) 2017-2022 Fuego Developers
+//
+// This file is part of Fuego.
+//
+// Fuego is free & open source software distributed in the hope
+// it will be useful, but WITHOUT ANY WARRANTY; without even an
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+// PURPOSE. You may redistribute it and/or modify it under the terms
+// of the GNU General Public License v3 or later versions as published
+// by the Free Software Foundation. Fuego includes elements written
+// by third parties. See file labeled LICENSE for more details.
+// You should have received a copy of the GNU General Public License
+// along with Fuego. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Tools {
+
+// Threads that are started once and then run one indexed job after another.
+// The calling thread takes part in every job, so a pool of N workers has N - 1 threads.
+class WorkerPool {
+public:
+  // 0 means one worker per hardware thread
+  explicit WorkerPool(size_t workerCount = 0);
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  size_t workerCount() const;
+
+  // Calls task(index) for every index in [0, count) and returns once all calls are done.
+  // Indices are handed out one at a time in ascending order; the task must not throw.
+  // Jobs from several callers run one after another.
+  void run(size_t count, const std::function<void(size_t)>& task);
+
+private:
+  void workerProcedure();
+  void runTasks();
+
+  std::vector<std::thread> m_threads;
+
+  std::mutex m_runMutex;
+  std::mutex m_mutex;
+  std::condition_variable m_haveJob;
+  std::condition_variable m_jobDone;
+  bool m_stopped;
+  uint64_t m_jobNumber;
+  size_t m_busyThreads;
+
+  const std::function<void(size_t)>* m_task;
+  size_t m_count;
+  std::atomic<size_t> m_nextIndex;
+};
+
+}
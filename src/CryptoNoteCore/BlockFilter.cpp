@@ -0,0 +1,265 @@
+// Copyright (c) 2017-2022 Fuego Developers
+//
+// This file is part of Fuego.
+//
+// Fuego is free & open source software distributed in the hope
+// it will be useful, but WITHOUT ANY WARRANTY; without even an
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+// PURPOSE. You may redistribute it and/or modify it under the terms
+// of the GNU General Public License v3 or later versions as published
+// by the Free Software Foundation. Fuego includes elements written
+// by third parties. See file labeled LICENSE for more details.
+// You should have received a copy of the GNU General Public License
+// along with Fuego. If not, see <https://www.gnu.org/licenses/>.
+
+#include "BlockFilter.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Common/int-util.h"
+#include "Common/Varint.h"
+#include "crypto/hash.h"
+#include "CryptoNoteCore/TransactionExtra.h"
+
+namespace CryptoNote {
+
+namespace {
+
+class BitWriter {
+public:
+  explicit BitWriter(std::string& out) : m_out(out), m_bitCount(0) {
+  }
+
+  void writeBit(bool bit) {
+    if (m_bitCount % 8 == 0) {
+      m_out.push_back(0);
+    }
+
+    if (bit) {
+      m_out.back() = static_cast<char>(static_cast<uint8_t>(m_out.back()) | (0x80 >> (m_bitCount % 8)));
+    }
+
+    ++m_bitCount;
+  }
+
+  void write(uint64_t value, uint8_t bits) {
+    while (bits > 0) {
+      --bits;
+      writeBit(((value >> bits) & 1) != 0);
+    }
+  }
+
+private:
+  std::string& m_out;
+  size_t m_bitCount;
+};
+
+class BitReader {
+public:
+  BitReader(const uint8_t* data, size_t size) : m_data(data), m_bitCount(size * 8), m_position(0) {
+  }
+
+  bool readBit(bool& bit) {
+    if (m_position >= m_bitCount) {
+      return false;
+    }
+
+    bit = ((m_data[m_position / 8] >> (7 - m_position % 8)) & 1) != 0;
+    ++m_position;
+    return true;
+  }
+
+  bool read(uint8_t bits, uint64_t& value) {
+    value = 0;
+    while (bits > 0) {
+      bool bit;
+      if (!readBit(bit)) {
+        return false;
+      }
+
+      value = (value << 1) | (bit ? 1 : 0);
+      --bits;
+    }
+
+    return true;
+  }
+
+private:
+  const uint8_t* m_data;
+  size_t m_bitCount;
+  size_t m_position;
+};
+
+// maps a tag uniformly onto [0, range)
+uint64_t hashToRange(const Crypto::Hash& blockHash, const Crypto::Hash& tag, uint64_t range) {
+  uint8_t data[sizeof(Crypto::Hash) * 2];
+  memcpy(data, &blockHash, sizeof(blockHash));
+  memcpy(data + sizeof(blockHash), &tag, sizeof(tag));
+
+  Crypto::Hash hash = Crypto::cn_fast_hash(data, sizeof(data));
+  uint64_t value;
+  memcpy(&value, &hash, sizeof(value));
+
+  uint64_t high;
+  mul128(SWAP64LE(value), range, &high);
+  return high;
+}
+
+std::vector<uint64_t> hashSortedSet(const Crypto::Hash& blockHash, const std::vector<Crypto::Hash>& tags, uint64_t range) {
+  std::vector<uint64_t> values;
+  values.reserve(tags.size());
+  for (const auto& tag : tags) {
+    values.push_back(hashToRange(blockHash, tag, range));
+  }
+
+  std::sort(values.begin(), values.end());
+  values.erase(std::unique(values.begin(), values.end()), values.end());
+  return values;
+}
+
+}
+
+Crypto::Hash getSpendTag(const Crypto::KeyImage& keyImage) {
+  Crypto::Hash tag;
+  static_assert(sizeof(tag) == sizeof(keyImage), "Key image doesn't fit spend tag");
+  memcpy(&tag, &keyImage, sizeof(tag));
+  return tag;
+}
+
+Crypto::Hash getSpendTag(uint64_t amount, uint32_t globalOutputIndex) {
+  uint8_t data[sizeof(amount) + sizeof(globalOutputIndex)];
+  amount = SWAP64LE(amount);
+  globalOutputIndex = SWAP32LE(globalOutputIndex);
+  memcpy(data, &amount, sizeof(amount));
+  memcpy(data + sizeof(amount), &globalOutputIndex, sizeof(globalOutputIndex));
+  return Crypto::cn_fast_hash(data, sizeof(data));
+}
+
+void getTransactionSpendTags(const TransactionPrefix& tx, std::vector<Crypto::Hash>& tags) {
+  for (const auto& input : tx.inputs) {
+    if (input.type() == typeid(KeyInput)) {
+      tags.push_back(getSpendTag(boost::get<KeyInput>(input).keyImage));
+    } else if (input.type() == typeid(MultisignatureInput)) {
+      const auto& multisignatureInput = boost::get<MultisignatureInput>(input);
+      tags.push_back(getSpendTag(multisignatureInput.amount, multisignatureInput.outputIndex));
+    }
+  }
+}
+
+std::string buildSpendFilter(const Crypto::Hash& blockHash, const std::vector<Crypto::Hash>& tags) {
+  std::vector<Crypto::Hash> uniqueTags(tags);
+  std::sort(uniqueTags.begin(), uniqueTags.end(), [](const Crypto::Hash& a, const Crypto::Hash& b) {
+    return memcmp(&a, &b, sizeof(a)) < 0;
+  });
+  uniqueTags.erase(std::unique(uniqueTags.begin(), uniqueTags.end()), uniqueTags.end());
+
+  uint64_t count = uniqueTags.size();
+  std::string filter = Tools::get_varint_data(count);
+  if (count == 0) {
+    return filter;
+  }
+
+  std::vector<uint64_t> values = hashSortedSet(blockHash, uniqueTags, count * BLOCK_FILTER_M);
+
+  BitWriter writer(filter);
+  uint64_t previous = 0;
+  for (uint64_t value : values) {
+    uint64_t delta = value - previous;
+    previous = value;
+
+    for (uint64_t quotient = delta >> BLOCK_FILTER_P; quotient > 0; --quotient) {
+      writer.writeBit(true);
+    }
+
+    writer.writeBit(false);
+    writer.write(delta, BLOCK_FILTER_P);
+  }
+
+  return filter;
+}
+
+bool spendFilterMatchesAny(const std::string& filter, const Crypto::Hash& blockHash, const std::vector<Crypto::Hash>& tags) {
+  if (tags.empty()) {
+    return false;
+  }
+
+  uint64_t count;
+  int read = Tools::read_varint(filter.begin(), filter.end(), count);
+  if (read <= 0) {
+    return true;
+  }
+
+  if (count == 0) {
+    return false;
+  }
+
+  // every item takes at least BLOCK_FILTER_P + 1 bits
+  size_t dataSize = filter.size() - read;
+  if (count > dataSize * 8 / (BLOCK_FILTER_P + 1)) {
+    return true;
+  }
+
+  std::vector<uint64_t> queries = hashSortedSet(blockHash, tags, count * BLOCK_FILTER_M);
+
+  BitReader reader(reinterpret_cast<const uint8_t*>(filter.data()) + read, dataSize);
+  uint64_t value = 0;
+  size_t query = 0;
+  for (uint64_t i = 0; i < count; ++i) {
+    uint64_t quotient = 0;
+    bool bit;
+    for (;;) {
+      if (!reader.readBit(bit)) {
+        return true;
+      }
+
+      if (!bit) {
+        break;
+      }
+
+      ++quotient;
+    }
+
+    uint64_t remainder;
+    if (!reader.read(BLOCK_FILTER_P, remainder)) {
+      return true;
+    }
+
+    value += (quotient << BLOCK_FILTER_P) | remainder;
+
+    while (queries[query] < value) {
+      if (++query == queries.size()) {
+        return false;
+      }
+    }
+
+    if (queries[query] == value) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+TransactionFilterInfo getTransactionFilterInfo(const TransactionPrefix& tx) {
+  TransactionFilterInfo info;
+  info.txPublicKey = getTransactionPublicKeyFromExtra(tx.extra);
+
+  for (size_t i = 0; i < tx.outputs.size(); ++i) {
+    const auto& target = tx.outputs[i].target;
+    if (target.type() == typeid(KeyOutput)) {
+      info.outputKeys.push_back(boost::get<KeyOutput>(target).key);
+      info.outputIndexes.push_back(static_cast<uint32_t>(i));
+    } else if (target.type() == typeid(MultisignatureOutput)) {
+      for (const auto& key : boost::get<MultisignatureOutput>(target).keys) {
+        info.multisignatureKeys.push_back(static_cast<uint32_t>(info.outputKeys.size()));
+        info.outputKeys.push_back(key);
+        info.outputIndexes.push_back(static_cast<uint32_t>(i));
+      }
+    }
+  }
+
+  return info;
+}
+
+}
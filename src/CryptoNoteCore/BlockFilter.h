@@ -0,0 +1,43 @@
+// Copyright (c) 2017-2022 Fuego Developers
+//
+// This file is part of Fuego.
+//
+// Fuego is free & open source software distributed in the hope
+// it will be useful, but WITHOUT ANY WARRANTY; without even an
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+// PURPOSE. You may redistribute it and/or modify it under the terms
+// of the GNU General Public License v3 or later versions as published
+// by the Free Software Foundation. Fuego includes elements written
+// by third parties. See file labeled LICENSE for more details.
+// You should have received a copy of the GNU General Public License
+// along with Fuego. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "CryptoNoteCore/CryptoNoteBasic.h"
+#include "CryptoNoteProtocol/CryptoNoteProtocolDefinitions.h"
+
+namespace CryptoNote {
+
+// Golomb-Rice parameters of the spend filter, the same as BIP 158 uses:
+// one false positive per BLOCK_FILTER_M queries, BLOCK_FILTER_P bits of remainder per item
+const uint8_t BLOCK_FILTER_P = 19;
+const uint64_t BLOCK_FILTER_M = 784931;
+
+// A spend is recognized by the key image of a key input,
+// or by the amount and global output index of a multisignature input
+Crypto::Hash getSpendTag(const Crypto::KeyImage& keyImage);
+Crypto::Hash getSpendTag(uint64_t amount, uint32_t globalOutputIndex);
+void getTransactionSpendTags(const TransactionPrefix& tx, std::vector<Crypto::Hash>& tags);
+
+// Items are keyed with the block hash, so a collision in one block says nothing about another
+std::string buildSpendFilter(const Crypto::Hash& blockHash, const std::vector<Crypto::Hash>& tags);
+// A malformed filter matches everything, the block is then fetched in full
+bool spendFilterMatchesAny(const std::string& filter, const Crypto::Hash& blockHash, const std::vector<Crypto::Hash>& tags);
+
+TransactionFilterInfo getTransactionFilterInfo(const TransactionPrefix& tx);
+
+}
@@ -0,0 +1,77 @@
+// Copyright (c) 2017-2022 Fuego Developers
+//
+// This file is part of Fuego.
+//
+// Fuego is free & open source software distributed in the hope
+// it will be useful, but WITHOUT ANY WARRANTY; without even an
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+// PURPOSE. You may redistribute it and/or modify it under the terms
+// of the GNU General Public License v3 or later versions as published
+// by the Free Software Foundation. Fuego includes elements written
+// by third parties. See file labeled LICENSE for more details.
+// You should have received a copy of the GNU General Public License
+// along with Fuego. If not, see <https://www.gnu.org/licenses/>.
+
+#include "BlockShortInfoCache.h"
+
+#include "CryptoNoteCore/CryptoNoteTools.h"
+
+namespace CryptoNote {
+
+BlockShortInfoCache::BlockShortInfoCache(size_t maxSize) : m_maxSize(maxSize), m_size(0) {
+}
+
+bool BlockShortInfoCache::get(uint32_t height, uint64_t timestamp, BlockShortInfo& info) const {
+  auto it = m_entries.find(height);
+  if (it == m_entries.end()) {
+    return false;
+  }
+
+  const Entry& entry = it->second;
+  if (entry.timestamp < timestamp) {
+    info.blockId = entry.info.blockId;
+    return true;
+  }
+
+  info = entry.info;
+  return true;
+}
+
+void BlockShortInfoCache::put(uint32_t height, uint64_t blockTimestamp, const BlockShortInfo& info) {
+  if (m_maxSize == 0) {
+    return;
+  }
+
+  Entry entry;
+  entry.timestamp = blockTimestamp;
+  entry.info = info;
+  entry.size = sizeof(Entry) + info.block.size();
+  for (const TransactionPrefixInfo& prefixInfo : info.txPrefixes) {
+    entry.size += sizeof(TransactionPrefixInfo) + getObjectBinarySize(prefixInfo.txPrefix);
+  }
+
+  erase(height);
+  m_size += entry.size;
+  m_entries.emplace(height, std::move(entry));
+
+  while (m_size > m_maxSize) {
+    auto oldest = m_entries.begin();
+    m_size -= oldest->second.size;
+    m_entries.erase(oldest);
+  }
+}
+
+void BlockShortInfoCache::erase(uint32_t height) {
+  auto it = m_entries.find(height);
+  if (it != m_entries.end()) {
+    m_size -= it->second.size;
+    m_entries.erase(it);
+  }
+}
+
+void BlockShortInfoCache::clear() {
+  m_entries.clear();
+  m_size = 0;
+}
+
+}
@@ -0,0 +1,53 @@
+// Copyright (c) 2017-2022 Fuego Developers
+//
+// This file is part of Fuego.
+//
+// Fuego is free & open source software distributed in the hope
+// it will be useful, but WITHOUT ANY WARRANTY; without even an
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+// PURPOSE. You may redistribute it and/or modify it under the terms
+// of the GNU General Public License v3 or later versions as published
+// by the Free Software Foundation. Fuego includes elements written
+// by third parties. See file labeled LICENSE for more details.
+// You should have received a copy of the GNU General Public License
+// along with Fuego. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <map>
+
+#include "CryptoNote.h"
+#include "CryptoNoteProtocol/CryptoNoteProtocolDefinitions.h"
+
+namespace CryptoNote {
+
+// Lite sync entries of blocks keyed by height, kept parsed so a hit is a plain copy. The cache is bounded by the
+// serialized size of its entries; the lowest heights go first since wallets mostly ask for the tip.
+// Not thread safe, the blockchain guards it with its lock.
+class BlockShortInfoCache {
+public:
+  explicit BlockShortInfoCache(size_t maxSize);
+
+  // false if the height isn't cached, only the block id if the block is older than timestamp
+  bool get(uint32_t height, uint64_t timestamp, BlockShortInfo& info) const;
+  void put(uint32_t height, uint64_t blockTimestamp, const BlockShortInfo& info);
+  void erase(uint32_t height);
+  void clear();
+
+  // serialized size of the entries
+  size_t getSize() const { return m_size; }
+  size_t getCount() const { return m_entries.size(); }
+
+private:
+  struct Entry {
+    uint64_t timestamp;
+    BlockShortInfo info;
+    size_t size;
+  };
+
+  const size_t m_maxSize;
+  size_t m_size;
+  std::map<uint32_t, Entry> m_entries;
+};
+
+}
@@ -40,6 +40,19 @@ using namespace Common;
 
 namespace {
 
+// Bound for the set of key images that already passed the subgroup check (mostly transactions waiting in the pool)
+const size_t MAX_CHECKED_KEY_IMAGES = 100000;
+// Bound for the set of pool transactions whose inputs were fully checked on admission
+const size_t MAX_VERIFIED_TRANSACTIONS = 10000;
+// Bound in bytes for the cached lite sync entries
+const size_t MAX_BLOCK_SHORT_INFO_CACHE_SIZE = 64 * 1024 * 1024;
+
+bool hasMultisignatureInputs(const CryptoNote::Transaction& tx) {
+  return std::any_of(tx.inputs.begin(), tx.inputs.end(), [](const CryptoNote::TransactionInput& in) {
+    return in.type() == typeid(CryptoNote::MultisignatureInput);
+  });
+}
+
 std::string appendPath(const std::string& path, const std::string& fileName) {
   std::string result = path;
   if (!result.empty()) {
@@ -366,7 +379,8 @@ private:
 			 m_upgradeDetectorV7(currency, m_blocks, BLOCK_MAJOR_VERSION_7, logger),
 			 m_upgradeDetectorV8(currency, m_blocks, BLOCK_MAJOR_VERSION_8, logger),
                      m_upgradeDetectorV9(currency, m_blocks, BLOCK_MAJOR_VERSION_9, logger),
-                     m_upgradeDetectorV10(currency, m_blocks, BLOCK_MAJOR_VERSION_10, logger) {
+                     m_upgradeDetectorV10(currency, m_blocks, BLOCK_MAJOR_VERSION_10, logger),
+                     m_blockShortInfoCache(MAX_BLOCK_SHORT_INFO_CACHE_SIZE) {
 }
 
 bool Blockchain::addObserver(IBlockchainStorageObserver* observer) {
@@ -646,7 +660,7 @@ if (!m_upgradeDetectorV2.init() || !m_upgradeDetectorV3.init() || !m_upgradeDete
       for (uint16_t t = 0; t < block.transactions.size(); ++t)
       {
         const TransactionEntry &transaction = block.transactions[t];
-        Crypto::Hash transactionHash = getObjectHash(transaction.tx);
+        const Crypto::Hash& transactionHash = transaction.hash();
         TransactionIndex transactionIndex = {b, t};
         m_transactionMap.insert(std::make_pair(transactionHash, transactionIndex));
 
@@ -710,8 +724,10 @@ bool Blockchain::resetAndSetGenesisBlock(const Block& b) {
   m_blocks.clear();
   m_blockIndex.clear();
   m_transactionMap.clear();
+  m_blockShortInfoCache.clear();
 
   m_spent_keys.clear();
+  m_verifiedTransactions.clear();
   m_alternative_chains.clear();
   m_outputs.clear();
 
@@ -786,6 +802,37 @@ Crypto::Hash Blockchain::getBlockIdByHeight(uint32_t height) {
   return m_blockIndex.getBlockId(height);
 }
 
+bool Blockchain::getBlockShortInfo(uint32_t height, uint64_t timestamp, BlockShortInfo& info) {
+  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+
+  if (m_blockShortInfoCache.get(height, timestamp, info)) {
+    return true;
+  }
+
+  if (height >= m_blocks.size()) {
+    return false;
+  }
+
+  const BlockEntry& block = m_blocks[height];
+  info.blockId = m_blockIndex.getBlockId(height);
+  if (block.bl.timestamp < timestamp) {
+    return true;
+  }
+
+  info.block = asString(toBinaryArray(block.bl));
+  info.txPrefixes.clear();
+  info.txPrefixes.reserve(block.transactions.size() - 1);
+  for (size_t i = 1; i < block.transactions.size(); ++i) {
+    TransactionPrefixInfo prefixInfo;
+    prefixInfo.txPrefix = block.transactions[i].tx;
+    prefixInfo.txHash = block.transactions[i].hash();
+    info.txPrefixes.push_back(std::move(prefixInfo));
+  }
+
+  m_blockShortInfoCache.put(height, block.bl.timestamp, info);
+  return true;
+}
+
 bool Blockchain::getBlockByHash(const Crypto::Hash& blockHash, Block& b) {
   std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
 
@@ -1659,7 +1706,7 @@ void Blockchain::print_blockchain_outs(const std::string& file) {
     if (!vals.empty()) {
       ss << "amount: " << v.first << ENDL;
       for (size_t i = 0; i != vals.size(); i++) {
-        ss << "\t" << getObjectHash(transactionByIndex(vals[i].first).tx) << ": " << vals[i].second << ENDL;
+        ss << "\t" << transactionByIndex(vals[i].first).hash() << ": " << vals[i].second << ENDL;
       }
     }
   }
@@ -1749,13 +1796,49 @@ bool Blockchain::checkTransactionInputs(const Transaction& tx, uint32_t& max_use
   if (tail)
     tail->id = getTailId(tail->height);
 
-  bool res = checkTransactionInputs(tx, &max_used_block_height);
+  Crypto::Hash transactionHash = getObjectHash(tx);
+  bool res = checkTransactionInputs(tx, transactionHash, &max_used_block_height);
   if (!res) return false;
   if (!(max_used_block_height < m_blocks.size())) { logger(ERROR, BRIGHT_RED) << "internal error: max used block index=" << max_used_block_height << " is not less then blockchain size = " << m_blocks.size(); return false; }
   get_block_hash(m_blocks[max_used_block_height].bl, max_used_block_id);
+
+  // remember the result so the block containing this transaction only has to check for double spends;
+  // multisignature inputs are not covered by max used block and are always checked again.
+  // The cache is dropped whenever a block is popped, so a hit is only ever used at a height
+  // not lower than the one the transaction was verified at
+  if (!hasMultisignatureInputs(tx)) {
+    if (m_verifiedTransactions.size() >= MAX_VERIFIED_TRANSACTIONS) {
+      m_verifiedTransactions.clear();
+    }
+
+    BlockInfo& maxUsedBlock = m_verifiedTransactions[transactionHash];
+    maxUsedBlock.height = max_used_block_height;
+    maxUsedBlock.id = max_used_block_id;
+  }
+
   return true;
 }
 
+bool Blockchain::checkBlockTransactionInputs(const Transaction& tx, const Crypto::Hash& transactionHash) {
+  auto it = m_verifiedTransactions.find(transactionHash);
+  if (it != m_verifiedTransactions.end()) {
+    BlockInfo maxUsedBlock = it->second;
+    m_verifiedTransactions.erase(it);
+
+    // ring members are unchanged as long as the block with the highest of them is still in the main chain
+    if (maxUsedBlock.height < m_blocks.size() && getBlockIdByHeight(maxUsedBlock.height) == maxUsedBlock.id) {
+      if (haveTransactionKeyImagesAsSpent(tx)) {
+        logger(DEBUGGING) << "Key image already spent in blockchain, transaction " << transactionHash;
+        return false;
+      }
+
+      return true;
+    }
+  }
+
+  return checkTransactionInputs(tx, transactionHash);
+}
+
 bool Blockchain::haveTransactionKeyImagesAsSpent(const Transaction &tx) {
   for (const auto& in : tx.inputs) {
     if (in.type() == typeid(KeyInput)) {
@@ -1768,24 +1851,44 @@ bool Blockchain::haveTransactionKeyImagesAsSpent(const Transaction &tx) {
   return false;
 }
 
-bool Blockchain::checkTransactionInputs(const Transaction& tx, uint32_t* pmax_used_block_height) {
+bool Blockchain::checkKeyImageDomain(const Crypto::KeyImage& keyImage) {
+  {
+    std::lock_guard<std::mutex> lk(m_checkedKeyImagesLock);
+    if (m_checkedKeyImages.count(keyImage) != 0) {
+      return true;
+    }
+  }
+
+  // additional key_image check, fix discovered by Monero Lab and suggested by "fluffypony" (bitcointalk.org)
+  if (!Crypto::check_key_image(keyImage)) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lk(m_checkedKeyImagesLock);
+  if (m_checkedKeyImages.size() >= MAX_CHECKED_KEY_IMAGES) {
+    m_checkedKeyImages.clear();
+  }
+  m_checkedKeyImages.insert(keyImage);
+  return true;
+}
+
+bool Blockchain::checkTransactionInputs(const Transaction& tx, const Crypto::Hash& transactionHash, uint32_t* pmax_used_block_height) {
   Crypto::Hash tx_prefix_hash = getObjectHash(*static_cast<const TransactionPrefix*>(&tx));
-  return checkTransactionInputs(tx, tx_prefix_hash, pmax_used_block_height);
+  return checkTransactionInputs(tx, transactionHash, tx_prefix_hash, pmax_used_block_height);
 }
 
-bool Blockchain::checkTransactionInputs(const Transaction& tx, const Crypto::Hash& tx_prefix_hash, uint32_t* pmax_used_block_height) {
+bool Blockchain::checkTransactionInputs(const Transaction& tx, const Crypto::Hash& transactionHash, const Crypto::Hash& tx_prefix_hash, uint32_t* pmax_used_block_height) {
   size_t inputIndex = 0;
   if (pmax_used_block_height) {
     *pmax_used_block_height = 0;
   }
 
-  Crypto::Hash transactionHash = getObjectHash(tx);
   for (const auto& txin : tx.inputs) {
     assert(inputIndex < tx.signatures.size());
     if (txin.type() == typeid(KeyInput)) {
 
       const KeyInput& in_to_key = boost::get<KeyInput>(txin);
-      if (!(!in_to_key.outputIndexes.empty())) { logger(ERROR, BRIGHT_RED) << "empty in_to_key.outputIndexes in transaction with id " << getObjectHash(tx); return false; }
+      if (!(!in_to_key.outputIndexes.empty())) { logger(ERROR, BRIGHT_RED) << "empty in_to_key.outputIndexes in transaction with id " << transactionHash; return false; }
 
       if (have_tx_keyimg_as_spent(in_to_key.keyImage)) {
         logger(DEBUGGING) <<
@@ -1799,15 +1902,6 @@ bool Blockchain::checkTransactionInputs(const Transaction& tx, const Crypto::Has
         return false;
       }
 
-        if (!isInCheckpointZone(getCurrentBlockchainHeight()))
-        {
-          if (!check_tx_input(in_to_key, tx_prefix_hash, tx.signatures[inputIndex], pmax_used_block_height))
-          {
-            logger(INFO, BRIGHT_WHITE) << "Failed to check input in transaction " << transactionHash;
-            return false;
-          }
-        }
-
         ++inputIndex;
       }
       else if (txin.type() == typeid(MultisignatureInput))
@@ -1880,10 +1974,7 @@ bool Blockchain::check_tx_input(const KeyInput& txin, const Crypto::Hash& tx_pre
     }
   };
 
-  // additional key_image check, fix discovered by Monero Lab and suggested by "fluffypony" (bitcointalk.org)
-  static const Crypto::KeyImage I = { { 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } };
-  static const Crypto::KeyImage L = { { 0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10 } };
-  if (!(scalarmultKey(txin.keyImage, L) == I)) {
+  if (!checkKeyImageDomain(txin.keyImage)) {
 	 logger(ERROR) << "Transaction uses key image not in the valid domain";
 	 return false;
   }
@@ -2222,17 +2313,19 @@ bool Blockchain::pushBlock(const Block &blockData, const std::vector<Transaction
     return false;
   }
 
-  Crypto::Hash minerTransactionHash = getObjectHash(blockData.baseTransaction);
+  Crypto::Hash minerTransactionHash;
+  size_t coinbase_blob_size;
+  getObjectHash(blockData.baseTransaction, minerTransactionHash, coinbase_blob_size);
 
   BlockEntry block;
   block.bl = blockData;
   block.height = static_cast<uint32_t>(m_blocks.size());
   block.transactions.resize(1);
   block.transactions[0].tx = blockData.baseTransaction;
+  block.transactions[0].setHash(minerTransactionHash, coinbase_blob_size);
   TransactionIndex transactionIndex = { block.height, static_cast<uint16_t>(0) };
   pushTransaction(block, minerTransactionHash, transactionIndex);
 
-  size_t coinbase_blob_size = getObjectBinarySize(blockData.baseTransaction);
   size_t cumulative_block_size = coinbase_blob_size;
   uint64_t fee_summary = 0;
     uint64_t interestSummary = 0;
@@ -2242,7 +2335,8 @@ bool Blockchain::pushBlock(const Block &blockData, const std::vector<Transaction
       const Crypto::Hash &tx_id = blockData.transactionHashes[i];
       block.transactions.resize(block.transactions.size() + 1);
       block.transactions.back().tx = transactions[i];
-      size_t blob_size = toBinaryArray(transactions[i]).size();
+      size_t blob_size = getObjectBinarySize(transactions[i]);
+      block.transactions.back().setHash(tx_id, blob_size);
 
     uint64_t in_amount = m_currency.getTransactionAllInputsAmount(transactions[i], block.height);
 	  uint64_t out_amount = getOutputAmount(transactions[i]);
@@ -2254,7 +2348,7 @@ bool Blockchain::pushBlock(const Block &blockData, const std::vector<Transaction
       logger(INFO, BRIGHT_WHITE) << "Block " << blockHash << " can't contain transaction " << tx_id << " because it has invalid version " << transactions[i].version;
     }
 
-    if (!checkTransactionInputs(transactions[i])) {
+    if (!checkBlockTransactionInputs(transactions[i], tx_id)) {
       isTransactionValid = false;
       logger(INFO, BRIGHT_WHITE) << "Block " << blockHash << " has at least one transaction with wrong inputs: " << tx_id;
     }
@@ -2410,12 +2504,13 @@ void Blockchain::popBlock(const Crypto::Hash& blockHash) {
   uint32_t height = m_blocks.size(); //height of popped block should be same as number of blocks
   saveTransactions(transactions, height);
 
-  popTransactions(m_blocks.back(), getObjectHash(m_blocks.back().bl.baseTransaction));
+  popTransactions(m_blocks.back(), m_blocks.back().transactions[0].hash());
 
   m_timestampIndex.remove(m_blocks.back().bl.timestamp, blockHash);
   m_generatedTransactionsIndex.remove(m_blocks.back().bl);
 
   m_depositIndex.popBlock();
+  m_blockShortInfoCache.erase(static_cast<uint32_t>(m_blocks.size() - 1));
   m_blocks.pop_back();
   m_blockIndex.pop();
 
@@ -2473,6 +2568,16 @@ bool Blockchain::pushTransaction(BlockEntry& block, const Crypto::Hash& transact
     }
   }
 
+  {
+    // spent key images are rejected by m_spent_keys from now on, no need to remember their domain check
+    std::lock_guard<std::mutex> lk(m_checkedKeyImagesLock);
+    for (const auto& in : transaction.tx.inputs) {
+      if (in.type() == typeid(KeyInput)) {
+        m_checkedKeyImages.erase(::boost::get<KeyInput>(in).keyImage);
+      }
+    }
+  }
+
   for (const auto& inv : transaction.tx.inputs) {
     if (inv.type() == typeid(MultisignatureInput)) {
       const MultisignatureInput& in = ::boost::get<MultisignatureInput>(inv);
@@ -2696,12 +2801,15 @@ bool Blockchain::validateInput(const MultisignatureInput& input, const Crypto::H
   }
 
   logger(DEBUGGING) << "Removing last block with height " << m_blocks.back().height;
-  popTransactions(m_blocks.back(), getObjectHash(m_blocks.back().bl.baseTransaction));
+  popTransactions(m_blocks.back(), m_blocks.back().transactions[0].hash());
 
   Crypto::Hash blockHash = getBlockIdByHeight(m_blocks.back().height);
   m_timestampIndex.remove(m_blocks.back().bl.timestamp, blockHash);
   m_generatedTransactionsIndex.remove(m_blocks.back().bl);
 
+  m_blockShortInfoCache.erase(m_blocks.back().height);
+  // unlock time and the other height dependent checks of verified pool transactions may not hold any more
+  m_verifiedTransactions.clear();
   m_blocks.pop_back();
   m_blockIndex.pop();
 
@@ -2808,8 +2916,8 @@ bool Blockchain::getMultisigOutputReference(const MultisignatureInput& txInMulti
     return false;
   }
   const MultisignatureOutputUsage& outputIndex = amountIter->second[txInMultisig.outputIndex];
-  const Transaction& outputTransaction = m_blocks[outputIndex.transactionIndex.block].transactions[outputIndex.transactionIndex.transaction].tx;
-  outputReference.first = getObjectHash(outputTransaction);
+  const TransactionEntry& outputTransaction = m_blocks[outputIndex.transactionIndex.block].transactions[outputIndex.transactionIndex.transaction];
+  outputReference.first = outputTransaction.hash();
   outputReference.second = outputIndex.outputIndex;
   return true;
 }
@@ -19,6 +19,9 @@
 #pragma once
 
 #include <atomic>
+#include <map>
+#include <mutex>
+#include <unordered_set>
 
 #include "google/sparse_hash_set"
 #include "google/sparse_hash_map"
@@ -27,6 +30,7 @@
 #include "Common/ObserverManager.h"
 #include "Common/Util.h"
 #include "CryptoNoteCore/BlockIndex.h"
+#include "CryptoNoteCore/BlockShortInfoCache.h"
 #include "CryptoNoteCore/Checkpoints.h"
 #include "CryptoNoteCore/Currency.h"
 #include "CryptoNoteCore/DepositIndex.h"
@@ -35,12 +39,14 @@
 #include "CryptoNoteCore/SwappedVector.h"
 #include "CryptoNoteCore/UpgradeDetector.h"
 #include "CryptoNoteCore/CryptoNoteFormatUtils.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
 #include "CryptoNoteCore/TransactionPool.h"
 #include "CryptoNoteCore/BlockchainIndices.h"
 
 #include "CryptoNoteCore/MessageQueue.h"
 #include "CryptoNoteCore/BlockchainMessages.h"
 #include "CryptoNoteCore/IntrusiveLinkedList.h"
+#include "CryptoNoteProtocol/CryptoNoteProtocolDefinitions.h"
 
 #include <Logging/LoggerRef.h>
 
@@ -83,6 +89,8 @@ namespace CryptoNote {
     uint32_t getAlternativeBlocksCount();
     Crypto::Hash getBlockIdByHeight(uint32_t height);
     bool getBlockByHash(const Crypto::Hash &h, Block &blk);
+    // Lite sync entry of the block at the given height, only the id for blocks older than timestamp
+    bool getBlockShortInfo(uint32_t height, uint64_t timestamp, BlockShortInfo& info);
     bool getBlockHeight(const Crypto::Hash& blockId, uint32_t& blockHeight);
 
     template <class archive_t>
@@ -90,6 +98,7 @@ namespace CryptoNote {
 
     bool haveTransaction(const Crypto::Hash &id);
     bool haveTransactionKeyImagesAsSpent(const Transaction &tx);
+    bool checkKeyImageDomain(const Crypto::KeyImage &keyImage);
 
     uint32_t getCurrentBlockchainHeight(); //TODO rename to getCurrentBlockchainSize
     Crypto::Hash getTailId();
@@ -222,10 +231,36 @@ namespace CryptoNote {
       Transaction tx;
       std::vector<uint32_t> m_global_output_indexes;
 
+      // Hash and blob size are not serialized: pushBlock fills them in, entries loaded from disk compute them on first use
+      const Crypto::Hash& hash() const {
+        if (m_blobSize == 0) {
+          getObjectHash(tx, m_hash, m_blobSize);
+        }
+
+        return m_hash;
+      }
+
+      size_t blobSize() const {
+        hash();
+        return m_blobSize;
+      }
+
+      void setHash(const Crypto::Hash& hash, size_t blobSize) {
+        m_hash = hash;
+        m_blobSize = blobSize;
+      }
+
       void serialize(ISerializer& s) {
         s(tx, "tx");
         s(m_global_output_indexes, "indexes");
+        if (s.type() == ISerializer::INPUT) {
+          m_blobSize = 0;
+        }
       }
+
+    private:
+      mutable Crypto::Hash m_hash = NULL_HASH;
+      mutable size_t m_blobSize = 0;
     };
 
     struct BlockEntry {
@@ -258,6 +293,9 @@ namespace CryptoNote {
     Tools::ObserverManager<IBlockchainStorageObserver> m_observerManager;
 
     key_images_container m_spent_keys;
+    parallel_flat_hash_map<Crypto::Hash, BlockInfo> m_verifiedTransactions; // pool transactions with checked inputs -> max used block
+    std::mutex m_checkedKeyImagesLock;
+    std::unordered_set<Crypto::KeyImage> m_checkedKeyImages; // key images already known to be in the prime-order subgroup
     size_t m_current_block_cumul_sz_limit;
     blocks_ext_by_hash m_alternative_chains; // Crypto::Hash -> block_extended_info
     outputs_container m_outputs;
@@ -297,6 +335,9 @@ namespace CryptoNote {
     GeneratedTransactionsIndex m_generatedTransactionsIndex;
     OrphanBlocksIndex m_orthanBlocksIndex;
 
+    // lite sync entries keyed by height, guarded by m_blockchain_lock and trimmed in popBlock
+    BlockShortInfoCache m_blockShortInfoCache;
+
     IntrusiveLinkedList<MessageQueue<BlockchainMessage>> m_messageQueueList;
 
     Logging::LoggerRef logger;
@@ -324,8 +365,9 @@ namespace CryptoNote {
     bool getBlockCumulativeSize(const Block& block, size_t& cumulativeSize);
     bool update_next_comulative_size_limit();
     bool check_tx_input(const KeyInput& txin, const Crypto::Hash& tx_prefix_hash, const std::vector<Crypto::Signature>& sig, uint32_t* pmax_related_block_height = NULL);
-    bool checkTransactionInputs(const Transaction& tx, const Crypto::Hash& tx_prefix_hash, uint32_t* pmax_used_block_height = NULL);
-    bool checkTransactionInputs(const Transaction& tx, uint32_t* pmax_used_block_height = NULL);
+    bool checkTransactionInputs(const Transaction& tx, const Crypto::Hash& transactionHash, const Crypto::Hash& tx_prefix_hash, uint32_t* pmax_used_block_height = NULL);
+    bool checkTransactionInputs(const Transaction& tx, const Crypto::Hash& transactionHash, uint32_t* pmax_used_block_height = NULL);
+    bool checkBlockTransactionInputs(const Transaction& tx, const Crypto::Hash& transactionHash);
     bool check_tx_outputs(const Transaction& tx, uint32_t height) const;
     const TransactionEntry& transactionByIndex(TransactionIndex index);
     bool pushBlock(const Block &blockData, const Crypto::Hash &id, block_verification_context &bvc, uint32_t height);
@@ -35,6 +35,7 @@
 #include "Miner.h"
 #include "TransactionExtra.h"
 #include "IBlock.h"
+#include "BlockFilter.h"
 
 #undef ERROR
 
@@ -46,6 +47,13 @@ using namespace  Common;
 
 namespace CryptoNote {
 
+namespace {
+
+// about two months of blocks at the target block time
+const size_t BLOCK_FILTERS_CACHE_SIZE = 10000;
+
+}
+
 class BlockWithTransactions : public IBlock {
 public:
   virtual const Block& getBlock() const override {
@@ -376,11 +384,6 @@ bool core::check_tx_semantic(const Transaction& tx, bool keeped_by_block, uint32
 
 bool core::check_tx_inputs_keyimages_diff(const Transaction& tx) {
 
-  // parameters used for the additional key_image check
- // static const Crypto::KeyImage Z = { { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } };
-  static const Crypto::KeyImage I = { { 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } };
-  static const Crypto::KeyImage L = { { 0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10 } };
-
   std::unordered_set<Crypto::KeyImage> ki;
   std::set<std::pair<uint64_t, uint32_t>> outputsUsage;
   for (const auto& input : tx.inputs) {
@@ -398,7 +401,7 @@ bool core::check_tx_inputs_keyimages_diff(const Transaction& tx) {
 
 	  // additional key_image check
 	  // Fix discovered by Monero Lab and suggested by "fluffypony" (bitcointalk.org)
-	  if (!(scalarmultKey(in.keyImage, L) == I)) {
+	  if (!m_blockchain.checkKeyImageDomain(in.keyImage)) {
 		  logger(ERROR) << "Transaction uses key image not in the valid domain";
 		  return false;
 	  }
@@ -987,28 +990,92 @@ bool core::queryBlocksLite(const std::vector<Crypto::Hash>& knownBlockIds, uint6
     return true;
   }
 
+  // entries of recent blocks are shared by all syncing wallets, so most of them come serialized from the cache
+  for (uint32_t height = resFullOffset; height < resFullOffset + blocksLeft; ++height) {
+    BlockShortInfo item;
+    if (!lbs->getBlockShortInfo(height, timestamp, item)) {
+      break;
+    }
+
+    entries.push_back(std::move(item));
+  }
+
+  return true;
+}
+
+bool core::getBlockFilters(const std::vector<Crypto::Hash>& knownBlockIds, uint64_t timestamp, uint32_t& resStartHeight,
+  uint32_t& resCurrentHeight, uint32_t& resFullOffset, std::vector<BlockFilterInfo>& entries) {
+  LockedBlockchainStorage lbs(m_blockchain);
+
+  resCurrentHeight = lbs->getCurrentBlockchainHeight();
+  resStartHeight = 0;
+  resFullOffset = 0;
+
+  if (!findStartAndFullOffsets(knownBlockIds, timestamp, resStartHeight, resFullOffset)) {
+    return false;
+  }
+
+  std::vector<Crypto::Hash> blockIds = findIdsForShortBlocks(resStartHeight, resFullOffset);
+  entries.reserve(blockIds.size());
+
+  for (const auto& id : blockIds) {
+    entries.push_back(BlockFilterInfo());
+    entries.back().blockId = id;
+  }
+
+  uint32_t blocksLeft = static_cast<uint32_t>(std::min(BLOCKS_IDS_SYNCHRONIZING_DEFAULT_COUNT - entries.size(), size_t(BLOCKS_SYNCHRONIZING_DEFAULT_COUNT)));
+
+  if (blocksLeft == 0) {
+    return true;
+  }
+
   std::list<Block> blocks;
   lbs->getBlocks(resFullOffset, blocksLeft, blocks);
 
   for (auto& b : blocks) {
-    BlockShortInfo item;
+    BlockFilterInfo item;
 
     item.blockId = get_block_hash(b);
 
     if (b.timestamp >= timestamp) {
-      std::list<Transaction> txs;
-      std::list<Crypto::Hash> missedTxs;
-      lbs->getTransactions(b.transactionHashes, txs, missedTxs);
-
       item.block = asString(toBinaryArray(b));
+      getBlockFilter(b, item.blockId, item);
+    }
 
-      for (const auto& tx: txs) {
-        TransactionPrefixInfo info;
-        info.txPrefix = tx;
-        info.txHash = getObjectHash(tx);
+    entries.push_back(std::move(item));
+  }
 
-        item.txPrefixes.push_back(std::move(info));
-      }
+  return true;
+}
+
+bool core::getBlockTransactionPrefixes(const std::vector<Crypto::Hash>& blockIds, std::vector<BlockShortInfo>& entries) {
+  LockedBlockchainStorage lbs(m_blockchain);
+
+  entries.reserve(blockIds.size());
+  for (const auto& id : blockIds) {
+    BlockShortInfo item;
+    item.blockId = id;
+
+    Block b;
+    if (!lbs->getBlockByHash(id, b)) {
+      return false;
+    }
+
+    std::list<Transaction> txs;
+    std::list<Crypto::Hash> missedTxs;
+    lbs->getTransactions(b.transactionHashes, txs, missedTxs);
+    if (!missedTxs.empty()) {
+      return false;
+    }
+
+    // the caller already has the block itself from its filter
+    auto txHash = b.transactionHashes.begin();
+    for (const auto& tx : txs) {
+      TransactionPrefixInfo info;
+      info.txPrefix = tx;
+      info.txHash = *txHash++;
+
+      item.txPrefixes.push_back(std::move(info));
     }
 
     entries.push_back(std::move(item));
@@ -1017,6 +1084,44 @@ bool core::queryBlocksLite(const std::vector<Crypto::Hash>& knownBlockIds, uint6
   return true;
 }
 
+/// \pre the blockchain storage is locked
+void core::getBlockFilter(const Block& block, const Crypto::Hash& blockHash, BlockFilterInfo& filter) {
+  {
+    std::lock_guard<std::mutex> lk(m_blockFiltersMutex);
+    auto it = m_blockFilters.find(blockHash);
+    if (it != m_blockFilters.end()) {
+      filter.txFilters = it->second.txFilters;
+      filter.spendFilter = it->second.spendFilter;
+      return;
+    }
+  }
+
+  std::list<Transaction> txs;
+  std::list<Crypto::Hash> missedTxs;
+  m_blockchain.getTransactions(block.transactionHashes, txs, missedTxs);
+
+  std::vector<Crypto::Hash> spendTags;
+  CachedBlockFilter cached;
+  cached.txFilters.reserve(txs.size());
+  for (const auto& tx : txs) {
+    cached.txFilters.push_back(getTransactionFilterInfo(tx));
+    getTransactionSpendTags(tx, spendTags);
+  }
+
+  cached.spendFilter = buildSpendFilter(blockHash, spendTags);
+  filter.txFilters = cached.txFilters;
+  filter.spendFilter = cached.spendFilter;
+
+  std::lock_guard<std::mutex> lk(m_blockFiltersMutex);
+  if (m_blockFilters.emplace(blockHash, std::move(cached)).second) {
+    m_blockFiltersOrder.push_back(blockHash);
+    if (m_blockFiltersOrder.size() > BLOCK_FILTERS_CACHE_SIZE) {
+      m_blockFilters.erase(m_blockFiltersOrder.front());
+      m_blockFiltersOrder.pop_front();
+    }
+  }
+}
+
 bool core::getBackwardBlocksSizes(uint32_t fromHeight, std::vector<size_t>& sizes, size_t count) {
   return m_blockchain.getBackwardBlocksSize(fromHeight, sizes, count);
 }
@@ -1173,6 +1278,12 @@ uint64_t core::fullDepositAmount() const {
   return m_blockchain.fullDepositAmount();
 }
 
+void core::readLocked(const std::function<void()>& reader) {
+  std::lock_guard<decltype(m_mempool)> poolLock(m_mempool);
+  LockedBlockchainStorage blockchainLock(m_blockchain);
+  reader();
+}
+
 uint64_t core::depositAmountAtHeight(size_t height) const {
   return m_blockchain.depositAmountAtHeight(height);
 }
@@ -18,10 +18,15 @@
 #pragma once
 
 #include <ctime>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
 #include <boost/program_options/options_description.hpp>
 #include <boost/program_options/variables_map.hpp>
 
 #include "P2p/NetNodeCommon.h"
+#include "CryptoNoteProtocol/CryptoNoteProtocolDefinitions.h"
 #include "CryptoNoteProtocol/CryptoNoteProtocolHandlerCommon.h"
 #include "Currency.h"
 #include "TransactionPool.h"
@@ -115,6 +120,10 @@ namespace CryptoNote {
        uint32_t& start_height, uint32_t& current_height, uint32_t& full_offset, std::vector<BlockFullInfo>& entries) override;
     virtual bool queryBlocksLite(const std::vector<Crypto::Hash>& knownBlockIds, uint64_t timestamp,
       uint32_t& resStartHeight, uint32_t& resCurrentHeight, uint32_t& resFullOffset, std::vector<BlockShortInfo>& entries) override;
+    // same walk as queryBlocksLite, with per-block filters instead of transaction prefixes
+    bool getBlockFilters(const std::vector<Crypto::Hash>& knownBlockIds, uint64_t timestamp,
+      uint32_t& resStartHeight, uint32_t& resCurrentHeight, uint32_t& resFullOffset, std::vector<BlockFilterInfo>& entries);
+    bool getBlockTransactionPrefixes(const std::vector<Crypto::Hash>& blockIds, std::vector<BlockShortInfo>& entries);
     virtual Crypto::Hash getBlockIdByHeight(uint32_t height) override;
     virtual bool getTransaction(const Crypto::Hash &id, Transaction &tx, bool checkTxPool = false) override;
     void getTransactions(const std::vector<Crypto::Hash> &txs_ids, std::list<Transaction> &txs, std::list<Crypto::Hash> &missed_txs, bool checkTxPool = false) override;
@@ -161,6 +170,9 @@ namespace CryptoNote {
     uint64_t getNextBlockDifficulty();
     uint64_t getTotalGeneratedAmount();
     uint64_t fullDepositAmount() const;
+    // runs reader with the pool and the blockchain locked, in the order block processing takes them,
+    // so several reads see one state of both
+    void readLocked(const std::function<void()>& reader);
     uint64_t depositAmountAtHeight(size_t height) const;
     uint8_t getBlockMajorVersionForHeight(uint32_t height) const;
 
@@ -189,6 +201,12 @@ namespace CryptoNote {
 
     bool findStartAndFullOffsets(const std::vector<Crypto::Hash> &knownBlockIds, uint64_t timestamp, uint32_t &startOffset, uint32_t &startFullOffset);
     std::vector<Crypto::Hash> findIdsForShortBlocks(uint32_t startOffset, uint32_t startFullOffset);
+    void getBlockFilter(const Block& block, const Crypto::Hash& blockHash, BlockFilterInfo& filter);
+
+    struct CachedBlockFilter {
+      std::vector<TransactionFilterInfo> txFilters;
+      std::string spendFilter;
+    };
 
     const Currency &m_currency;
     Logging::LoggerRef logger;
@@ -202,6 +220,10 @@ namespace CryptoNote {
     friend class tx_validate_inputs;
     std::atomic<bool> m_starter_message_showed;
     Tools::ObserverManager<ICoreObserver> m_observerManager;
+    // filters are keyed by block hash, so a reorganization never makes one stale
+    std::mutex m_blockFiltersMutex;
+    std::unordered_map<Crypto::Hash, CachedBlockFilter> m_blockFilters;
+    std::deque<Crypto::Hash> m_blockFiltersOrder;
      time_t start_time;
    };
 }
@@ -50,6 +50,10 @@ namespace CryptoNote {
 
 template <class T>
 std::ostream &print256(std::ostream &o, const T &v) {
+  if (!o) {
+    return o;
+  }
+
   return o << "<" << Common::podToHex(v) << ">";
 }
 
@@ -17,11 +17,13 @@
 
 #include "CryptoNoteFormatUtils.h"
 
+#include <algorithm>
 #include <set>
 #include <Logging/LoggerRef.h>
 #include <Common/BinaryArray.hpp>
 #include <Common/int-util.h>
 #include <Common/Varint.h>
+#include <Common/WorkerPool.h>
 #include "Common/Base58.h"
 
 #include "Serialization/BinaryOutputStreamSerializer.h"
@@ -42,6 +44,14 @@ using namespace Common;
 
 namespace CryptoNote {
 
+namespace {
+
+// a ring signature costs two scalar multiplications per ring member, far more than handing it to a worker,
+// but waking the signing pool is still wasted on small transactions
+const size_t MIN_INPUTS_PER_SIGNING_THREAD = 2;
+
+}
+
 bool parseAndValidateTransactionFromBinaryArray(const BinaryArray& tx_blob, Transaction& tx, Hash& tx_hash, Hash& tx_prefix_hash) {
   if (!fromBinaryArray(tx, tx_blob)) {
     return false;
@@ -232,24 +242,51 @@ bool constructTransaction(
   Hash tx_prefix_hash;
   getObjectHash(*static_cast<TransactionPrefix*>(&tx), tx_prefix_hash);
 
-  size_t i = 0;
-  for (const TransactionSourceEntry& src_entr : sources) {
-    std::vector<const PublicKey*> keys_ptrs;
-    for (const TransactionSourceEntry::OutputEntry& o : src_entr.outputs) {
-      keys_ptrs.push_back(&o.second);
+  std::vector<RingSignatureInput> signatureInputs(sources.size());
+  for (size_t i = 0; i < sources.size(); ++i) {
+    RingSignatureInput& signatureInput = signatureInputs[i];
+    for (const TransactionSourceEntry::OutputEntry& o : sources[i].outputs) {
+      signatureInput.keys.push_back(&o.second);
     }
 
-    tx.signatures.push_back(std::vector<Signature>());
-    std::vector<Signature>& sigs = tx.signatures.back();
-    sigs.resize(src_entr.outputs.size());
-    generate_ring_signature(tx_prefix_hash, boost::get<KeyInput>(tx.inputs[i]).keyImage, keys_ptrs,
-      in_contexts[i].in_ephemeral.secretKey, src_entr.realOutput, sigs.data());
-    i++;
+    signatureInput.keyImage = boost::get<KeyInput>(tx.inputs[i]).keyImage;
+    signatureInput.secretKey = in_contexts[i].in_ephemeral.secretKey;
+    signatureInput.realOutput = sources[i].realOutput;
   }
 
+  generateRingSignatures(tx_prefix_hash, signatureInputs, tx.signatures);
+
   return true;
 }
 
+void generateRingSignatures(const Hash& prefixHash, const std::vector<RingSignatureInput>& inputs, std::vector<std::vector<Signature>>& signatures) {
+  signatures.resize(inputs.size());
+  std::vector<EllipticCurveScalar> commitments(inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    signatures[i].resize(inputs[i].keys.size());
+    // random_lock is only taken here, the signing below runs without it
+    generate_ring_signature_scalars(inputs[i].keys.size(), inputs[i].realOutput, commitments[i], signatures[i].data());
+  }
+
+  auto sign = [&](size_t i) {
+    const RingSignatureInput& input = inputs[i];
+    generate_ring_signature(prefixHash, input.keyImage, input.keys.data(), input.keys.size(), input.secretKey, input.realOutput,
+      commitments[i], signatures[i].data());
+  };
+
+  if (inputs.size() < 2 * MIN_INPUTS_PER_SIGNING_THREAD) {
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      sign(i);
+    }
+
+    return;
+  }
+
+  // shared by every wallet in the process, so concurrent transfers queue up instead of starting threads of their own
+  static Tools::WorkerPool signingPool;
+  signingPool.run(inputs.size(), sign);
+}
+
 bool generateDeterministicTransactionKeys(const Crypto::Hash &inputsHash, const Crypto::SecretKey &viewSecretKey, KeyPair &generatedKeys)
 {
   BinaryArray ba;
@@ -567,6 +604,7 @@ Hash get_tx_tree_hash(const std::vector<Hash>& tx_hashes) {
 
 Hash get_tx_tree_hash(const Block& b) {
   std::vector<Hash> txs_ids;
+  txs_ids.reserve(b.transactionHashes.size() + 1);
   Hash h = NULL_HASH;
   getObjectHash(b.baseTransaction, h);
   txs_ids.push_back(h);
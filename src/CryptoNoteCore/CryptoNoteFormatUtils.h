@@ -58,6 +58,17 @@ struct tx_message_entry
   AccountPublicAddress addr;
 };
 
+struct RingSignatureInput {
+  Crypto::KeyImage keyImage;
+  std::vector<const Crypto::PublicKey*> keys; //ring members
+  Crypto::SecretKey secretKey;                //ephemeral secret key of the real output
+  size_t realOutput;                          //index of the real output in keys
+};
+
+// Signs all inputs of one transaction on a signing pool shared by the whole process.
+// signatures[i] always holds the ring signature of inputs[i], whatever the thread scheduling
+void generateRingSignatures(const Crypto::Hash& prefixHash, const std::vector<RingSignatureInput>& inputs, std::vector<std::vector<Crypto::Signature>>& signatures);
+
 bool generateDeterministicTransactionKeys(const Crypto::Hash &inputsHash, const Crypto::SecretKey &viewSecretKey, KeyPair &generatedKeys);
 bool generateDeterministicTransactionKeys(const Transaction &tx, const Crypto::SecretKey &viewSecretKey, KeyPair &generatedKeys);
 
@@ -20,6 +20,7 @@
 #include "TransactionUtils.h"
 
 #include "Account.h"
+#include "CryptoNoteCore/CryptoNoteFormatUtils.h"
 #include "CryptoNoteCore/CryptoNoteTools.h"
 #include "CryptoNoteConfig.h"
 
@@ -110,6 +111,7 @@ namespace CryptoNote {
     virtual size_t addOutput(uint64_t amount, const MultisignatureOutput& out) override;
 
     virtual void signInputKey(size_t input, const TransactionTypes::InputKeyInfo& info, const KeyPair& ephKeys) override;
+    virtual void signInputKeys(const std::vector<TransactionTypes::InputKeyInfo>& infos, const std::vector<KeyPair>& ephKeys) override;
     virtual void signInputMultisignature(size_t input, const PublicKey& sourceTransactionKey, size_t outputIndex, const AccountKeys& accountKeys) override;
     virtual void signInputMultisignature(size_t input, const KeyPair& ephemeralKeys) override;
 
@@ -361,6 +363,35 @@ namespace CryptoNote {
     invalidateHash();
   }
 
+  void TransactionImpl::signInputKeys(const std::vector<TransactionTypes::InputKeyInfo>& infos, const std::vector<KeyPair>& ephKeys) {
+    if (infos.size() != ephKeys.size()) {
+      throw std::runtime_error("Input key info and ephemeral keys count mismatch");
+    }
+
+    Hash prefixHash = getTransactionPrefixHash();
+
+    std::vector<RingSignatureInput> inputs(infos.size());
+    for (size_t i = 0; i < infos.size(); ++i) {
+      const auto& input = boost::get<KeyInput>(getInputChecked(transaction, i, TransactionTypes::InputType::Key));
+      for (const auto& o : infos[i].outputs) {
+        inputs[i].keys.push_back(reinterpret_cast<const PublicKey*>(&o.targetKey));
+      }
+
+      inputs[i].keyImage = input.keyImage;
+      inputs[i].secretKey = ephKeys[i].secretKey;
+      inputs[i].realOutput = infos[i].realOutput.transactionIndex;
+    }
+
+    std::vector<std::vector<Signature>> signatures;
+    generateRingSignatures(prefixHash, inputs, signatures);
+
+    for (size_t i = 0; i < signatures.size(); ++i) {
+      getSignatures(i) = std::move(signatures[i]);
+    }
+
+    invalidateHash();
+  }
+
   void TransactionImpl::signInputMultisignature(size_t index, const PublicKey& sourceTransactionKey, size_t outputIndex, const AccountKeys& accountKeys) {
     KeyDerivation derivation;
     PublicKey ephemeralPublicKey;
@@ -69,6 +69,38 @@ namespace CryptoNote
     }
   };
 
+  // Output keys of one transaction in the order a wallet scans them: the key of every key output
+  // and every key of every multisignature output, in output order
+  struct TransactionFilterInfo {
+    Crypto::PublicKey txPublicKey;
+    std::vector<Crypto::PublicKey> outputKeys;
+    std::vector<uint32_t> outputIndexes;      // output of each entry in outputKeys
+    std::vector<uint32_t> multisignatureKeys; // positions in outputKeys that belong to multisignature outputs
+
+    void serialize(ISerializer& s) {
+      KV_MEMBER(txPublicKey);
+      serializeAsBinary(outputKeys, "outputKeys", s);
+      serializeAsBinary(outputIndexes, "outputIndexes", s);
+      serializeAsBinary(multisignatureKeys, "multisignatureKeys", s);
+    }
+  };
+
+  // What a wallet needs to tell whether a block concerns it without its transaction prefixes:
+  // the output keys of every non-coinbase transaction and a Golomb-coded set of the outputs it spends
+  struct BlockFilterInfo {
+    Crypto::Hash blockId;
+    std::string block;
+    std::vector<TransactionFilterInfo> txFilters;
+    std::string spendFilter;
+
+    void serialize(ISerializer& s) {
+      KV_MEMBER(blockId);
+      KV_MEMBER(block);
+      KV_MEMBER(txFilters);
+      KV_MEMBER(spendFilter);
+    }
+  };
+
   /************************************************************************/
   /*                                                                      */
   /************************************************************************/
@@ -82,6 +82,10 @@ namespace
   const command_line::arg_descriptor<bool>        arg_restricted_rpc = {"restricted-rpc", "Restrict RPC to view only commands to prevent abuse"};
   const command_line::arg_descriptor<std::string> arg_enable_cors = { "enable-cors", "Adds header 'Access-Control-Allow-Origin' to the daemon's RPC responses. Uses the value as domain. Use * for all", "" };
   const command_line::arg_descriptor<int>         arg_log_level   = {"log-level", "", 2}; // info level
+  const command_line::arg_descriptor<bool>        arg_log_async   = {"log-async", "Write the log file from a background thread"};
+  const command_line::arg_descriptor<uint32_t>    arg_log_flush_interval = {"log-flush-interval", "Milliseconds between flushes of the asynchronous log file", 1000};
+  const command_line::arg_descriptor<std::string> arg_log_overflow = {"log-overflow", "What the asynchronous log does when its buffer is full: block or drop", "block"};
+  const command_line::arg_descriptor<uint32_t>    arg_log_max_size = {"log-max-size", "Rotate the asynchronous log file after this many megabytes, 0 to never rotate", 0};
   const command_line::arg_descriptor<bool>        arg_console     = {"no-console", "Disable daemon console commands"};
   const command_line::arg_descriptor<bool>        arg_testnet_on  = {"testnet", "Used to deploy test nets. Checkpoints and hardcoded seeds are ignored, "
     "network id is changed. Use it with --data-dir flag. The wallet must be launched with --testnet flag.", false};
@@ -192,14 +196,22 @@ void print_genesis_tx_hex() {
   return;
 }
 
-JsonValue buildLoggerConfiguration(Level level, const std::string& logfile) {
+JsonValue buildLoggerConfiguration(Level level, const std::string& logfile, const po::variables_map& vm) {
   JsonValue loggerConfiguration(JsonValue::OBJECT);
   loggerConfiguration.insert("globalLevel", static_cast<int64_t>(level));
 
   JsonValue& cfgLoggers = loggerConfiguration.insert("loggers", JsonValue::ARRAY);
 
   JsonValue& fileLogger = cfgLoggers.pushBack(JsonValue::OBJECT);
-  fileLogger.insert("type", "file");
+  if (command_line::get_arg(vm, arg_log_async)) {
+    fileLogger.insert("type", "async_file");
+    fileLogger.insert("flushInterval", static_cast<int64_t>(command_line::get_arg(vm, arg_log_flush_interval)));
+    fileLogger.insert("overflow", command_line::get_arg(vm, arg_log_overflow));
+    fileLogger.insert("maxFileSize", static_cast<int64_t>(command_line::get_arg(vm, arg_log_max_size)) * 1024 * 1024);
+  } else {
+    fileLogger.insert("type", "file");
+  }
+
   fileLogger.insert("filename", logfile);
   fileLogger.insert("level", static_cast<int64_t>(TRACE));
 
@@ -262,6 +274,10 @@ int main(int argc, char* argv[])
    command_line::add_arg(desc_cmd_sett, arg_set_fee_address);
    command_line::add_arg(desc_cmd_sett, arg_log_file);
    command_line::add_arg(desc_cmd_sett, arg_log_level);
+   command_line::add_arg(desc_cmd_sett, arg_log_async);
+   command_line::add_arg(desc_cmd_sett, arg_log_flush_interval);
+   command_line::add_arg(desc_cmd_sett, arg_log_overflow);
+   command_line::add_arg(desc_cmd_sett, arg_log_max_size);
    command_line::add_arg(desc_cmd_sett, arg_console);
    command_line::add_arg(desc_cmd_sett, arg_set_view_key);
    
@@ -341,7 +357,7 @@ int main(int argc, char* argv[])
     Level cfgLogLevel = static_cast<Level>(static_cast<int>(Logging::ERROR) + command_line::get_arg(vm, arg_log_level));
 
     // configure logging
-	    logManager.configure(buildLoggerConfiguration(cfgLogLevel, cfgLogFile));
+	    logManager.configure(buildLoggerConfiguration(cfgLogLevel, cfgLogFile, vm));
 		logger(INFO, BRIGHT_MAGENTA) <<
 #ifdef _WIN32
 " \n"		
@@ -470,6 +486,8 @@ int main(int argc, char* argv[])
       }
     }
  
+    rpcServer.startWorkers(rpcConfig.workerThreads, rpcConfig.endpointLimits);
+    rpcServer.setResponseCacheSize(rpcConfig.responseCacheSize);
     rpcServer.start(rpcConfig.bindIp, rpcConfig.bindPort);
     rpcServer.restrictRPC(command_line::get_arg(vm, arg_restricted_rpc));
     rpcServer.enableCors(command_line::get_arg(vm, arg_enable_cors));
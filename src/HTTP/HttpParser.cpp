@@ -18,11 +18,63 @@
 #include "HttpParser.h"
 
 #include <algorithm>
+#include <cstring>
 
 #include "HttpParserErrorCodes.h"
 
 namespace {
 
+// requests with a longer head are rejected instead of buffered without end
+const size_t MAX_HEADER_SIZE = 64 * 1024;
+
+[[noreturn]] void throwUnexpectedSymbol() {
+  throw std::system_error(make_error_code(CryptoNote::error::HttpParserErrorCodes::UNEXPECTED_SYMBOL));
+}
+
+const char* findCrlf(const char* begin, const char* end) {
+  for (const char* p = begin; p + 1 < end; ++p) {
+    p = static_cast<const char*>(memchr(p, '\r', end - p - 1));
+    if (p == nullptr) {
+      return end;
+    }
+
+    if (p[1] == '\n') {
+      return p;
+    }
+  }
+
+  return end;
+}
+
+// returns nullptr while the empty line after the headers isn't there
+const char* findHeadEnd(const char* begin, const char* end) {
+  const char* line = begin;
+  for (;;) {
+    const char* crlf = findCrlf(line, end);
+    if (crlf == end) {
+      return nullptr;
+    }
+
+    if (crlf == line && line != begin) {
+      return crlf + 2;
+    }
+
+    line = crlf + 2;
+  }
+}
+
+std::string trim(const char* begin, const char* end) {
+  while (begin < end && (*begin == ' ' || *begin == '\t')) {
+    ++begin;
+  }
+
+  while (end > begin && (end[-1] == ' ' || end[-1] == '\t')) {
+    --end;
+  }
+
+  return std::string(begin, end);
+}
+
 void throwIfNotGood(std::istream& stream) {
   if (!stream.good()) {
     if (stream.eof()) {
@@ -53,8 +105,7 @@ void HttpParser::receiveRequest(std::istream& stream, HttpRequest& request) {
   readWord(stream, request.method);
   readWord(stream, request.url);
 
-  std::string httpVersion;
-  readWord(stream, httpVersion);
+  readWord(stream, request.version);
 
   readHeaders(stream, request.headers);
 
@@ -66,6 +117,72 @@ void HttpParser::receiveRequest(std::istream& stream, HttpRequest& request) {
 }
 
 
+size_t HttpParser::parseRequest(const char* data, size_t size, HttpRequest& request) {
+  // clients may put empty lines after a body, they aren't part of the next request but count toward its head
+  size_t skipped = 0;
+  while (size - skipped >= 2 && data[skipped] == '\r' && data[skipped + 1] == '\n') {
+    skipped += 2;
+    if (skipped > MAX_HEADER_SIZE) {
+      throw std::system_error(make_error_code(CryptoNote::error::HttpParserErrorCodes::HEADER_TOO_LARGE));
+    }
+  }
+
+  data += skipped;
+  size -= skipped;
+
+  const char* end = data + size;
+  const char* headEnd = findHeadEnd(data, end);
+  if (headEnd == nullptr) {
+    if (skipped + size > MAX_HEADER_SIZE) {
+      throw std::system_error(make_error_code(CryptoNote::error::HttpParserErrorCodes::HEADER_TOO_LARGE));
+    }
+
+    return 0;
+  }
+
+  // request line: method, url and version separated by single spaces
+  const char* lineEnd = findCrlf(data, headEnd);
+  const char* methodEnd = std::find(data, lineEnd, ' ');
+  const char* urlEnd = std::find(methodEnd == lineEnd ? lineEnd : methodEnd + 1, lineEnd, ' ');
+  if (methodEnd == lineEnd || urlEnd == lineEnd || methodEnd == data || urlEnd == methodEnd + 1) {
+    throwUnexpectedSymbol();
+  }
+
+  HttpRequest::Headers headers;
+  for (const char* line = lineEnd + 2; line < headEnd - 2; line = lineEnd + 2) {
+    lineEnd = findCrlf(line, headEnd);
+    const char* colon = std::find(line, lineEnd, ':');
+    if (colon == lineEnd) {
+      throwUnexpectedSymbol();
+    }
+
+    if (colon == line) {
+      throw std::system_error(make_error_code(CryptoNote::error::HttpParserErrorCodes::EMPTY_HEADER));
+    }
+
+    std::string name(line, colon);
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    headers[name] = trim(colon + 1, lineEnd);
+  }
+
+  size_t bodyLen = getBodyLen(headers);
+  size_t headSize = static_cast<size_t>(headEnd - data);
+  if (skipped + headSize > MAX_HEADER_SIZE) {
+    throw std::system_error(make_error_code(CryptoNote::error::HttpParserErrorCodes::HEADER_TOO_LARGE));
+  }
+
+  if (size - headSize < bodyLen) {
+    return 0;
+  }
+
+  request.method.assign(data, methodEnd);
+  request.url.assign(methodEnd + 1, urlEnd);
+  request.version.assign(urlEnd + 1, findCrlf(data, headEnd));
+  request.headers = std::move(headers);
+  request.body.assign(headEnd, bodyLen);
+  return skipped + headSize + bodyLen;
+}
+
 void HttpParser::receiveResponse(std::istream& stream, HttpResponse& response) {
   std::string httpVersion;
   readWord(stream, httpVersion);
@@ -108,7 +225,10 @@ void HttpParser::receiveResponse(std::istream& stream, HttpResponse& response) {
   }
   
   std::string body;
-  if (length) {
+  it = headers.find("transfer-encoding");
+  if (it != headers.end() && it->second.find("chunked") != std::string::npos) {
+    readChunkedBody(stream, body);
+  } else if (length) {
     readBody(stream, body, length);
   }
 
@@ -211,6 +331,51 @@ size_t HttpParser::getBodyLen(const HttpRequest::Headers& headers) {
   return 0;
 }
 
+void HttpParser::readChunkedBody(std::istream& stream, std::string& body) {
+  std::string line;
+  for (;;) {
+    readLine(stream, line);
+    size_t chunkSize;
+    try {
+      chunkSize = std::stoul(line, nullptr, 16);
+    } catch (std::exception&) {
+      throwUnexpectedSymbol();
+    }
+
+    if (chunkSize == 0) {
+      break;
+    }
+
+    readBody(stream, body, chunkSize);
+    readLine(stream, line);
+    if (!line.empty()) {
+      throwUnexpectedSymbol();
+    }
+  }
+
+  // trailer headers end with an empty line
+  do {
+    readLine(stream, line);
+  } while (!line.empty());
+}
+
+void HttpParser::readLine(std::istream& stream, std::string& line) {
+  line.clear();
+  char c;
+  stream.get(c);
+  while (stream.good() && c != '\r') {
+    line += c;
+    stream.get(c);
+  }
+
+  throwIfNotGood(stream);
+
+  stream.get(c);
+  if (c != '\n') {
+    throwUnexpectedSymbol();
+  }
+}
+
 void HttpParser::readBody(std::istream& stream, std::string& body, const size_t bodyLen) {
   size_t read = 0;
 
@@ -32,6 +32,8 @@ public:
   HttpParser() {};
 
   void receiveRequest(std::istream& stream, HttpRequest& request);
+  // Parses the request at the front of data and returns its size in bytes, or 0 while it isn't complete yet
+  size_t parseRequest(const char* data, size_t size, HttpRequest& request);
   void receiveResponse(std::istream& stream, HttpResponse& response);
   static HttpResponse::HTTP_STATUS parseResponseStatusFromString(const std::string& status);
 private:
@@ -40,6 +42,8 @@ private:
   bool readHeader(std::istream& stream, std::string& name, std::string& value);
   size_t getBodyLen(const HttpRequest::Headers& headers);
   void readBody(std::istream& stream, std::string& body, const size_t bodyLen);
+  void readChunkedBody(std::istream& stream, std::string& body);
+  void readLine(std::istream& stream, std::string& line);
 };
 
 } //namespace CryptoNote
@@ -17,6 +17,8 @@
 
 #include "HttpRequest.h"
 
+#include <algorithm>
+
 namespace CryptoNote {
 
   const std::string& HttpRequest::getMethod() const {
@@ -35,6 +37,25 @@ namespace CryptoNote {
     return body;
   }
 
+  const std::string& HttpRequest::getVersion() const {
+    return version;
+  }
+
+  bool HttpRequest::isKeepAlive() const {
+    std::string connection;
+    auto it = headers.find("connection");
+    if (it != headers.end()) {
+      connection = it->second;
+      std::transform(connection.begin(), connection.end(), connection.begin(), ::tolower);
+    }
+
+    if (version == "HTTP/1.0") {
+      return connection == "keep-alive";
+    }
+
+    return connection != "close";
+  }
+
   void HttpRequest::addHeader(const std::string& name, const std::string& value) {
     headers[name] = value;
   }
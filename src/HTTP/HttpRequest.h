@@ -30,6 +30,9 @@ namespace CryptoNote {
     const std::string& getUrl() const;
     const Headers& getHeaders() const;
     const std::string& getBody() const;
+    const std::string& getVersion() const;
+    // HTTP/1.1 connections stay open unless asked otherwise, HTTP/1.0 ones only when asked to
+    bool isKeepAlive() const;
 
     void addHeader(const std::string& name, const std::string& value);
     void setBody(const std::string& b);
@@ -40,6 +43,7 @@ namespace CryptoNote {
 
     std::string method;
     std::string url;
+    std::string version;
     Headers headers;
     std::string body;
 
@@ -17,7 +17,12 @@
 
 #include "HttpResponse.h"
 
+#include <cstdio>
 #include <stdexcept>
+#include <utility>
+
+#include <Common/StreamTools.h>
+#include <Common/StringOutputStream.h>
 
 namespace {
 
@@ -53,11 +58,58 @@ const char* getErrorBody(CryptoNote::HttpResponse::HTTP_STATUS status) {
   return ""; //unaccessible
 }
 
+// Frames whatever is written to it as HTTP chunks, small writes are gathered into one chunk
+class ChunkedOutputStream : public Common::IOutputStream {
+public:
+  explicit ChunkedOutputStream(Common::IOutputStream& out) : out(out) {
+  }
+
+  virtual size_t writeSome(const void* data, size_t size) override {
+    if (buffer.size() + size > CHUNK_SIZE) {
+      flushChunk();
+    }
+
+    if (size >= CHUNK_SIZE) {
+      writeChunk(data, size);
+    } else {
+      buffer.append(static_cast<const char*>(data), size);
+    }
+
+    return size;
+  }
+
+  void finish() {
+    flushChunk();
+    Common::write(out, "0\r\n\r\n", 5);
+  }
+
+private:
+  static const size_t CHUNK_SIZE = 16 * 1024;
+
+  void flushChunk() {
+    if (!buffer.empty()) {
+      writeChunk(buffer.data(), buffer.size());
+      buffer.clear();
+    }
+  }
+
+  void writeChunk(const void* data, size_t size) {
+    char sizeLine[24];
+    int length = snprintf(sizeLine, sizeof(sizeLine), "%zx\r\n", size);
+    Common::write(out, sizeLine, static_cast<size_t>(length));
+    Common::write(out, data, size);
+    Common::write(out, "\r\n", 2);
+  }
+
+  Common::IOutputStream& out;
+  std::string buffer;
+};
+
 } //namespace
 
 namespace CryptoNote {
 
-HttpResponse::HttpResponse() {
+HttpResponse::HttpResponse() : bodyWriterSize(0) {
   status = STATUS_200;
   headers["Server"] = "Fuego (CryptoNote-based) HTTP server";
 }
@@ -74,8 +126,10 @@ void HttpResponse::addHeader(const std::string& name, const std::string& value)
   headers[name] = value;
 }
 
-void HttpResponse::setBody(const std::string& b) {
-  body = b;
+void HttpResponse::setBody(std::string b) {
+  body = std::move(b);
+  bodyWriter = nullptr;
+  headers.erase("Transfer-Encoding");
   if (!body.empty()) {
     headers["Content-Length"] = std::to_string(body.size());
   } else {
@@ -83,19 +137,58 @@ void HttpResponse::setBody(const std::string& b) {
   }
 }
 
-std::ostream& HttpResponse::printHttpResponse(std::ostream& os) const {
-  os << "HTTP/1.1 " << getStatusString(status) << "\r\n";
+void HttpResponse::setBodyWriter(const BodyWriter& writer, size_t size) {
+  body.clear();
+  bodyWriter = writer;
+  bodyWriterSize = size;
+  if (size == UNKNOWN_BODY_SIZE) {
+    headers.erase("Content-Length");
+    headers["Transfer-Encoding"] = "chunked";
+  } else {
+    headers.erase("Transfer-Encoding");
+    headers["Content-Length"] = std::to_string(size);
+  }
+}
+
+void HttpResponse::bufferBody() {
+  if (bodyWriter) {
+    std::string buffered;
+    Common::StringOutputStream stream(buffered);
+    bodyWriter(stream);
+    setBody(buffered);
+  }
+}
 
-  for (auto pair: headers) {
-    os << pair.first << ": " << pair.second << "\r\n";
+void HttpResponse::write(Common::IOutputStream& out) const {
+  std::string head = "HTTP/1.1 ";
+  head += getStatusString(status);
+  head += "\r\n";
+  for (const auto& pair : headers) {
+    head += pair.first;
+    head += ": ";
+    head += pair.second;
+    head += "\r\n";
   }
-  os << "\r\n";
 
-  if (!body.empty()) {
-    os << body;
+  head += "\r\n";
+  Common::write(out, head.data(), head.size());
+
+  if (!bodyWriter) {
+    Common::write(out, body.data(), body.size());
+  } else if (bodyWriterSize != UNKNOWN_BODY_SIZE) {
+    bodyWriter(out);
+  } else {
+    ChunkedOutputStream chunked(out);
+    bodyWriter(chunked);
+    chunked.finish();
   }
+}
 
-  return os;
+std::ostream& HttpResponse::printHttpResponse(std::ostream& os) const {
+  std::string message;
+  Common::StringOutputStream stream(message);
+  write(stream);
+  return os << message;
 }
 
 } //namespace CryptoNote
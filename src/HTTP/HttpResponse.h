@@ -16,10 +16,13 @@
 // along with Fuego. If not, see <https://www.gnu.org/licenses/>.
 #pragma once
 
+#include <functional>
 #include <ostream>
 #include <string>
 #include <map>
 
+#include <Common/IOutputStream.h>
+
 namespace CryptoNote {
 
   class HttpResponse {
@@ -31,11 +34,21 @@ namespace CryptoNote {
       STATUS_500
     };
 
+    typedef std::function<void(Common::IOutputStream&)> BodyWriter;
+    static const size_t UNKNOWN_BODY_SIZE = static_cast<size_t>(-1);
+
     HttpResponse();
 
     void setStatus(HTTP_STATUS s);
     void addHeader(const std::string& name, const std::string& value);
-    void setBody(const std::string& b);
+    void setBody(std::string b);
+    // The writer produces the body straight into the connection when the response is sent.
+    // size is the exact number of bytes it writes, a body of unknown size goes out chunked.
+    void setBodyWriter(const BodyWriter& writer, size_t size = UNKNOWN_BODY_SIZE);
+    // runs the body writer into the body, for clients that don't take chunked bodies
+    void bufferBody();
+    bool hasChunkedBody() const { return bodyWriter && bodyWriterSize == UNKNOWN_BODY_SIZE; }
+    void write(Common::IOutputStream& out) const;
 
     const std::map<std::string, std::string>& getHeaders() const { return headers; }
     HTTP_STATUS getStatus() const { return status; }
@@ -48,6 +61,8 @@ namespace CryptoNote {
     HTTP_STATUS status;
     std::map<std::string, std::string> headers;
     std::string body;
+    BodyWriter bodyWriter;
+    size_t bodyWriterSize;
   };
 
   inline std::ostream& operator<<(std::ostream& os, const HttpResponse& resp) {
@@ -231,6 +231,59 @@ std::error_code InProcessNode::doGetTransactionOutsGlobalIndices(const Crypto::H
   return std::error_code();
 }
 
+void InProcessNode::getTransactionsOutsGlobalIndices(const std::vector<Crypto::Hash>& transactionHashes, std::vector<std::vector<uint32_t>>& outsGlobalIndices,
+    const Callback& callback)
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  if (state != INITIALIZED) {
+    lock.unlock();
+    callback(make_error_code(CryptoNote::error::NOT_INITIALIZED));
+    return;
+  }
+
+  boost::asio::post(ioService,
+    std::bind(&InProcessNode::getTransactionsOutsGlobalIndicesAsync,
+      this,
+      std::cref(transactionHashes),
+      std::ref(outsGlobalIndices),
+      callback
+    )
+  );
+}
+
+void InProcessNode::getTransactionsOutsGlobalIndicesAsync(const std::vector<Crypto::Hash>& transactionHashes, std::vector<std::vector<uint32_t>>& outsGlobalIndices,
+    const Callback& callback)
+{
+  std::error_code ec = doGetTransactionsOutsGlobalIndices(transactionHashes, outsGlobalIndices);
+  callback(ec);
+}
+
+//it's always protected with mutex
+std::error_code InProcessNode::doGetTransactionsOutsGlobalIndices(const std::vector<Crypto::Hash>& transactionHashes, std::vector<std::vector<uint32_t>>& outsGlobalIndices) {
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (state != INITIALIZED) {
+      return make_error_code(CryptoNote::error::NOT_INITIALIZED);
+    }
+  }
+
+  try {
+    outsGlobalIndices.clear();
+    outsGlobalIndices.resize(transactionHashes.size());
+    for (size_t i = 0; i < transactionHashes.size(); ++i) {
+      if (!core.get_tx_outputs_gindexs(transactionHashes[i], outsGlobalIndices[i])) {
+        return make_error_code(CryptoNote::error::REQUEST_ERROR);
+      }
+    }
+  } catch (std::system_error& e) {
+    return e.code();
+  } catch (std::exception&) {
+    return make_error_code(CryptoNote::error::INTERNAL_NODE_ERROR);
+  }
+
+  return std::error_code();
+}
+
 void InProcessNode::getRandomOutsByAmounts(std::vector<uint64_t>&& amounts, uint64_t outsCount,
     std::vector<CryptoNote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount>& result, const Callback& callback)
 {
@@ -21,7 +21,6 @@
 #include <future>
 #include <system_error>
 #include <memory>
-#include <sstream>
 #include "HTTP/HttpParserErrorCodes.h"
 
 #include <System/TcpConnection.h>
@@ -56,12 +55,11 @@ void JsonRpcServer::processRequest(const CryptoNote::HttpRequest& req, CryptoNot
     logger(Logging::TRACE) << "HTTP request came: \n" << req;
 
     if (req.getUrl() == "/json_rpc") {
-      std::istringstream jsonInputStream(req.getBody());
       Common::JsonValue jsonRpcRequest;
       Common::JsonValue jsonRpcResponse(Common::JsonValue::OBJECT);
 
       try {
-        jsonInputStream >> jsonRpcRequest;
+        jsonRpcRequest = Common::JsonValue::fromString(req.getBody());
       } catch (std::runtime_error&) {
         logger(Logging::DEBUGGING) << "Couldn't parse request: \"" << req.getBody() << "\"";
         makeJsonParsingErrorResponse(jsonRpcResponse);
@@ -70,13 +68,17 @@ void JsonRpcServer::processRequest(const CryptoNote::HttpRequest& req, CryptoNot
         return;
       }
 
-      processJsonRpcRequest(jsonRpcRequest, jsonRpcResponse);
-
-      std::ostringstream jsonOutputStream;
-      jsonOutputStream << jsonRpcResponse;
+      if (jsonRpcRequest.isArray()) {
+        processJsonRpcBatch(jsonRpcRequest, jsonRpcResponse);
+      } else {
+        processJsonRpcRequest(jsonRpcRequest, jsonRpcResponse);
+      }
 
       resp.setStatus(CryptoNote::HttpResponse::STATUS_200);
-      resp.setBody(jsonOutputStream.str());
+      // a batch of notifications only gets an empty body
+      if (!jsonRpcResponse.isArray() || jsonRpcResponse.size() != 0) {
+        resp.setBody(jsonRpcResponse.toString());
+      }
 
     } else {
       logger(Logging::WARNING) << "Requested url \"" << req.getUrl() << "\" is not found";
@@ -89,6 +91,29 @@ void JsonRpcServer::processRequest(const CryptoNote::HttpRequest& req, CryptoNot
   }
 }
 
+void JsonRpcServer::processJsonRpcBatch(const Common::JsonValue& req, Common::JsonValue& resp) {
+  using Common::JsonValue;
+
+  if (req.size() == 0) {
+    resp.insert("jsonrpc", "2.0");
+    resp.insert("id", nullptr);
+    makeGenericErrorReponse(resp, "Invalid Request", -32600);
+    return;
+  }
+
+  resp = JsonValue(JsonValue::ARRAY);
+  for (size_t i = 0; i < req.size(); ++i) {
+    JsonValue itemResp(JsonValue::OBJECT);
+    processJsonRpcRequest(req[i], itemResp);
+
+    // notifications are run but get no response
+    bool notification = req[i].isObject() && req[i].contains("method") && !req[i].contains("id");
+    if (!notification) {
+      resp.pushBack(std::move(itemResp));
+    }
+  }
+}
+
 void JsonRpcServer::prepareJsonResponse(const Common::JsonValue& req, Common::JsonValue& resp) {
   using Common::JsonValue;
 
@@ -61,6 +61,8 @@ protected:
 private:
   // HttpServer
   virtual void processRequest(const CryptoNote::HttpRequest& request, CryptoNote::HttpResponse& response) override;
+  // answers every element of a JSON-RPC 2.0 batch array but notifications, in order, with one array
+  void processJsonRpcBatch(const Common::JsonValue& req, Common::JsonValue& resp);
 
   System::Dispatcher& system;
   System::Event& stopEvent;
@@ -0,0 +1,269 @@
+// Copyright (c) 2017-2022 Fuego Developers
+//
+// This file is part of Fuego.
+//
+// Fuego is free & open source software distributed in the hope
+// it will be useful, but WITHOUT ANY WARRANTY; without even an
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+// PURPOSE. You may redistribute it and/or modify it under the terms
+// of the GNU General Public License v3 or later versions as published
+// by the Free Software Foundation. Fuego includes elements written
+// by third parties. See file labeled LICENSE for more details.
+// You should have received a copy of the GNU General Public License
+// along with Fuego. If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "AsyncFileLogger.h"
+#include <cstdint>
+#include <cstdio>
+
+namespace Logging {
+
+namespace {
+
+const size_t MAX_BATCH_SIZE = 1 << 20;
+
+void appendWithoutColors(std::string& batch, const std::string& message) {
+  bool readingText = true;
+  for (char c : message) {
+    if (c == ILogger::COLOR_DELIMETER) {
+      readingText = !readingText;
+    } else if (readingText) {
+      batch += c;
+    }
+  }
+}
+
+}
+
+AsyncFileLogger::AsyncFileLogger(Level level) : CommonLogger(level), mask(0), pushPosition(0), popPosition(0), droppedCount(0),
+  fileSize(0), maxFileSize(0), flushInterval(0), overflow(BLOCK), writerSleeping(false), blockedProducers(0), stopped(false) {
+}
+
+AsyncFileLogger::~AsyncFileLogger() {
+  stop();
+}
+
+void AsyncFileLogger::init(const std::string& fileName, size_t bufferSize, std::chrono::milliseconds flushInterval,
+  OverflowPolicy overflow, uint64_t maxFileSize) {
+  stop();
+
+  size_t capacity = 2;
+  while (capacity < bufferSize) {
+    capacity <<= 1;
+  }
+
+  cells.reset(new Cell[capacity]);
+  for (size_t i = 0; i < capacity; ++i) {
+    cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  mask = capacity - 1;
+  pushPosition = 0;
+  popPosition = 0;
+  droppedCount = 0;
+
+  this->fileName = fileName;
+  this->flushInterval = flushInterval;
+  this->overflow = overflow;
+  this->maxFileSize = maxFileSize;
+
+  std::ifstream existing(fileName, std::ios::binary | std::ios::ate);
+  fileSize = existing ? static_cast<uint64_t>(existing.tellg()) : 0;
+  fileStream.open(fileName, std::ios::app | std::ios::binary);
+
+  stopped = false;
+  writer = std::thread(&AsyncFileLogger::writerProcedure, this);
+}
+
+void AsyncFileLogger::doLogString(const std::string& message) {
+  if (!cells) {
+    return;
+  }
+
+  if (tryPush(message)) {
+    wakeWriter();
+    return;
+  }
+
+  if (overflow == DROP) {
+    droppedCount.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  // the writer takes the mutex before it signals, so room freed after the failed push can't be missed
+  std::unique_lock<std::mutex> lock(mutex);
+  ++blockedProducers;
+  while (!tryPush(message)) {
+    if (stopped) {
+      droppedCount.fetch_add(1, std::memory_order_relaxed);
+      break;
+    }
+
+    wakeUp.notify_one();
+    roomFreed.wait(lock);
+  }
+
+  --blockedProducers;
+}
+
+// Producers only take the mutex when the writer went to sleep on an empty ring. The fences pair with the
+// ones in writerProcedure: either the writer sees the pushed record or the producer sees the writer asleep.
+void AsyncFileLogger::wakeWriter() {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (writerSleeping.load(std::memory_order_relaxed) && writerSleeping.exchange(false, std::memory_order_relaxed)) {
+    std::lock_guard<std::mutex> lock(mutex);
+    wakeUp.notify_one();
+  }
+}
+
+bool AsyncFileLogger::isEmpty() const {
+  return cells[popPosition & mask].sequence.load(std::memory_order_acquire) != popPosition + 1;
+}
+
+// Bounded MPMC ring by Dmitry Vyukov: a cell is free for the producer when its sequence equals the position,
+// and ready for the consumer when it equals the position plus one
+bool AsyncFileLogger::tryPush(const std::string& message) {
+  size_t position = pushPosition.load(std::memory_order_relaxed);
+  Cell* cell;
+  for (;;) {
+    cell = &cells[position & mask];
+    size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+    if (difference == 0) {
+      if (pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (difference < 0) {
+      return false;
+    } else {
+      position = pushPosition.load(std::memory_order_relaxed);
+    }
+  }
+
+  cell->record = message;
+  cell->sequence.store(position + 1, std::memory_order_release);
+  return true;
+}
+
+bool AsyncFileLogger::tryPop(std::string& record) {
+  Cell& cell = cells[popPosition & mask];
+  if (cell.sequence.load(std::memory_order_acquire) != popPosition + 1) {
+    return false;
+  }
+
+  record.swap(cell.record);
+  cell.sequence.store(popPosition + mask + 1, std::memory_order_release);
+  ++popPosition;
+  return true;
+}
+
+void AsyncFileLogger::writerProcedure() {
+  std::string record;
+  std::string batch;
+  bool dirty = false;
+  auto lastFlush = std::chrono::steady_clock::now();
+
+  for (;;) {
+    batch.clear();
+    while (batch.size() < MAX_BATCH_SIZE && tryPop(record)) {
+      appendWithoutColors(batch, record);
+    }
+
+    uint64_t dropped = droppedCount.exchange(0, std::memory_order_relaxed);
+    if (dropped != 0) {
+      batch += std::to_string(dropped) + " log messages dropped, the log buffer was full\n";
+    }
+
+    if (!batch.empty()) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (blockedProducers != 0) {
+          roomFreed.notify_all();
+        }
+      }
+
+      write(batch);
+      dirty = true;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (dirty && now - lastFlush >= flushInterval) {
+      fileStream.flush();
+      dirty = false;
+      lastFlush = now;
+    }
+
+    if (batch.empty()) {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (stopped) {
+        break;
+      }
+
+      writerSleeping.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (isEmpty()) {
+        // sleep until a record comes in, or until the unflushed tail is due
+        if (dirty) {
+          wakeUp.wait_until(lock, lastFlush + flushInterval);
+        } else {
+          wakeUp.wait(lock);
+        }
+      }
+
+      writerSleeping.store(false, std::memory_order_relaxed);
+    }
+  }
+
+  // whatever came in between the last pass and the stop request
+  batch.clear();
+  while (tryPop(record)) {
+    appendWithoutColors(batch, record);
+  }
+
+  write(batch);
+  fileStream.flush();
+}
+
+void AsyncFileLogger::write(const std::string& batch) {
+  if (!fileStream.good()) {
+    return;
+  }
+
+  fileStream.write(batch.data(), batch.size());
+  fileSize += batch.size();
+  if (maxFileSize != 0 && fileSize >= maxFileSize) {
+    rotate();
+  }
+}
+
+// keeps one previous file next to the current one
+void AsyncFileLogger::rotate() {
+  fileStream.close();
+
+  std::string previousName = fileName + ".1";
+  std::remove(previousName.c_str());
+  std::rename(fileName.c_str(), previousName.c_str());
+
+  fileStream.clear();
+  fileStream.open(fileName, std::ios::trunc | std::ios::binary);
+  fileSize = 0;
+}
+
+void AsyncFileLogger::stop() {
+  if (!writer.joinable()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopped = true;
+  }
+
+  wakeUp.notify_one();
+  roomFreed.notify_all();
+  writer.join();
+  fileStream.close();
+}
+
+}
@@ -0,0 +1,89 @@
+// Copyright (c) 2017-2022 Fuego Developers
+//
+// This file is part of Fuego.
+//
+// Fuego is free & open source software distributed in the hope
+// it will be useful, but WITHOUT ANY WARRANTY; without even an
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+// PURPOSE. You may redistribute it and/or modify it under the terms
+// of the GNU General Public License v3 or later versions as published
+// by the Free Software Foundation. Fuego includes elements written
+// by third parties. See file labeled LICENSE for more details.
+// You should have received a copy of the GNU General Public License
+// along with Fuego. If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "CommonLogger.h"
+
+namespace Logging {
+
+// Hands formatted messages to a background thread through a bounded lock-free ring,
+// so the logging thread never waits for the disk. The writer batches records, flushes
+// at most once per flush interval and rotates the file once it grows past its size limit.
+class AsyncFileLogger : public CommonLogger {
+public:
+  enum OverflowPolicy {
+    DROP,  // a message that finds the ring full is counted and thrown away
+    BLOCK  // the logging thread sleeps until the writer makes room
+  };
+
+  AsyncFileLogger(Level level = DEBUGGING);
+  ~AsyncFileLogger();
+
+  AsyncFileLogger(const AsyncFileLogger&) = delete;
+  AsyncFileLogger& operator=(const AsyncFileLogger&) = delete;
+
+  // bufferSize is rounded up to a power of two, maxFileSize of 0 disables rotation
+  void init(const std::string& fileName, size_t bufferSize = 8192, std::chrono::milliseconds flushInterval = std::chrono::milliseconds(1000),
+    OverflowPolicy overflow = BLOCK, uint64_t maxFileSize = 0);
+
+protected:
+  virtual void doLogString(const std::string& message) override;
+
+private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    std::string record;
+  };
+
+  bool tryPush(const std::string& message);
+  bool tryPop(std::string& record);
+  bool isEmpty() const;
+  void wakeWriter();
+  void writerProcedure();
+  void write(const std::string& batch);
+  void rotate();
+  void stop();
+
+  std::unique_ptr<Cell[]> cells;
+  size_t mask;
+  std::atomic<size_t> pushPosition;
+  size_t popPosition;
+  std::atomic<uint64_t> droppedCount;
+
+  std::string fileName;
+  std::ofstream fileStream;
+  uint64_t fileSize;
+  uint64_t maxFileSize;
+  std::chrono::milliseconds flushInterval;
+  OverflowPolicy overflow;
+
+  std::mutex mutex;
+  std::condition_variable wakeUp;
+  std::condition_variable roomFreed;
+  std::atomic<bool> writerSleeping;
+  size_t blockedProducers;
+  bool stopped;
+  std::thread writer;
+};
+
+}
@@ -90,6 +90,10 @@ void CommonLogger::setMaxLevel(Level level) {
   logLevel = level;
 }
 
+bool CommonLogger::isEnabled(Level level) const {
+  return level <= logLevel.load(std::memory_order_relaxed);
+}
+
 CommonLogger::CommonLogger(Level level) : logLevel(level), pattern("%D %T %L [%C] ") {
 }
 
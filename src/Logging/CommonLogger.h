@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <set>
 #include "ILogger.h"
 
@@ -29,12 +30,13 @@ public:
   virtual void enableCategory(const std::string& category);
   virtual void disableCategory(const std::string& category);
   virtual void setMaxLevel(Level level);
+  virtual bool isEnabled(Level level) const override;
 
   void setPattern(const std::string& pattern);
 
 protected:
   std::set<std::string> disabledCategories;
-  Level logLevel;
+  std::atomic<Level> logLevel;
   std::string pattern;
 
   CommonLogger(Level level);
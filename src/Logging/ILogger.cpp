@@ -46,4 +46,8 @@ const std::array<std::string, 6> ILogger::LEVEL_NAMES = {
   "TRACE"}
 };
 
+bool ILogger::isEnabled(Level level) const {
+  return true;
+}
+
 }
@@ -57,6 +57,8 @@ public:
   const static std::array<std::string, 6> LEVEL_NAMES;
 
   virtual void operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) = 0;
+  // Checked before a message is formatted, a logger that returns false never sees messages of that level
+  virtual bool isEnabled(Level level) const;
 };
 
 #ifndef ENDL
@@ -20,15 +20,17 @@
 
 namespace Logging {
 
-LoggerGroup::LoggerGroup(Level level) : CommonLogger(level) {
+LoggerGroup::LoggerGroup(Level level) : CommonLogger(level), enabledLevel(-1) {
 }
 
 void LoggerGroup::addLogger(ILogger& logger) {
   loggers.push_back(&logger);
+  updateEnabledLevel();
 }
 
 void LoggerGroup::removeLogger(ILogger& logger) {
   loggers.erase(std::remove(loggers.begin(), loggers.end(), &logger), loggers.end());
+  updateEnabledLevel();
 }
 
 void LoggerGroup::operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) {
@@ -39,4 +41,27 @@ void LoggerGroup::operator()(const std::string& category, Level level, boost::po
   }
 }
 
+bool LoggerGroup::isEnabled(Level level) const {
+  return static_cast<int>(level) <= enabledLevel.load(std::memory_order_relaxed);
+}
+
+void LoggerGroup::setMaxLevel(Level level) {
+  CommonLogger::setMaxLevel(level);
+  updateEnabledLevel();
+}
+
+void LoggerGroup::updateEnabledLevel() {
+  int maxLevel = -1;
+  for (ILogger* logger : loggers) {
+    for (int level = logLevel.load(); level > maxLevel; --level) {
+      if (logger->isEnabled(static_cast<Level>(level))) {
+        maxLevel = level;
+        break;
+      }
+    }
+  }
+
+  enabledLevel.store(maxLevel, std::memory_order_relaxed);
+}
+
 }
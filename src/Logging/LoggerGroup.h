@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <vector>
 #include "CommonLogger.h"
 
@@ -29,9 +30,19 @@ public:
   void addLogger(ILogger& logger);
   void removeLogger(ILogger& logger);
   virtual void operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) override;
+  // A message is formatted only when the group level passes it and some attached logger takes it.
+  // Levels of the attached loggers are read when the group changes, see updateEnabledLevel.
+  virtual bool isEnabled(Level level) const override;
+  virtual void setMaxLevel(Level level) override;
 
 protected:
+  void updateEnabledLevel();
+
   std::vector<ILogger*> loggers;
+
+private:
+  // highest level that reaches at least one logger, -1 while none is attached
+  std::atomic<int> enabledLevel;
 };
 
 }
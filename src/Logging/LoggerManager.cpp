@@ -17,6 +17,7 @@
 
 #include "LoggerManager.h"
 #include <thread>
+#include "AsyncFileLogger.h"
 #include "ConsoleLogger.h"
 #include "FileLogger.h"
 
@@ -36,6 +37,7 @@ void LoggerManager::configure(const JsonValue& val) {
   std::unique_lock<std::mutex> lock(reconfigureLock);
   loggers.clear();
   LoggerGroup::loggers.clear();
+  updateEnabledLevel();
   Level globalLevel;
   if (val.contains("globalLevel")) {
     auto levelVal = val("globalLevel");
@@ -89,6 +91,36 @@ void LoggerManager::configure(const JsonValue& val) {
           auto fileLogger = new FileLogger(level);
           fileLogger->init(filename);
           logger.reset(fileLogger);
+        } else if (type == "async_file") {
+          std::string filename = loggerConfiguration("filename").getString();
+          size_t bufferSize = 8192;
+          if (loggerConfiguration.contains("bufferSize")) {
+            bufferSize = static_cast<size_t>(loggerConfiguration("bufferSize").getInteger());
+          }
+
+          std::chrono::milliseconds flushInterval(1000);
+          if (loggerConfiguration.contains("flushInterval")) {
+            flushInterval = std::chrono::milliseconds(loggerConfiguration("flushInterval").getInteger());
+          }
+
+          AsyncFileLogger::OverflowPolicy overflow = AsyncFileLogger::BLOCK;
+          if (loggerConfiguration.contains("overflow")) {
+            std::string policy = loggerConfiguration("overflow").getString();
+            if (policy == "drop") {
+              overflow = AsyncFileLogger::DROP;
+            } else if (policy != "block") {
+              throw std::runtime_error("Unknown logger overflow policy: " + policy);
+            }
+          }
+
+          uint64_t maxFileSize = 0;
+          if (loggerConfiguration.contains("maxFileSize")) {
+            maxFileSize = static_cast<uint64_t>(loggerConfiguration("maxFileSize").getInteger());
+          }
+
+          auto asyncFileLogger = new AsyncFileLogger(level);
+          asyncFileLogger->init(filename, bufferSize, flushInterval, overflow, maxFileSize);
+          logger.reset(asyncFileLogger);
         } else {
           throw std::runtime_error("Unknown logger type: " + type);
         }
@@ -25,9 +25,15 @@ LoggerMessage::LoggerMessage(ILogger& logger, const std::string& category, Level
   , logger(logger)
   , category(category)
   , logLevel(level)
-  , message(color)
-  , timestamp(boost::posix_time::microsec_clock::local_time())
-  , gotText(false) {
+  , gotText(false)
+  , enabled(logger.isEnabled(level)) {
+  if (enabled) {
+    message = color;
+    timestamp = boost::posix_time::microsec_clock::local_time();
+  } else {
+    // a failed stream skips formatting of every argument, so a disabled message costs neither time nor allocations
+    setstate(std::ios_base::badbit);
+  }
 }
 
 LoggerMessage::~LoggerMessage() {
@@ -43,9 +49,10 @@ LoggerMessage::LoggerMessage(LoggerMessage&& other)
   , category(other.category)
   , logLevel(other.logLevel)
   , logger(other.logger)
-  , message(other.message)
-  , timestamp(boost::posix_time::microsec_clock::local_time())
-  , gotText(false) {
+  , message(std::move(other.message))
+  , timestamp(other.timestamp)
+  , gotText(false)
+  , enabled(other.enabled) {
   this->set_rdbuf(this);
 }
 #else
@@ -55,9 +62,10 @@ LoggerMessage::LoggerMessage(LoggerMessage&& other)
   , category(other.category)
   , logLevel(other.logLevel)
   , logger(other.logger)
-  , message(other.message)
-  , timestamp(boost::posix_time::microsec_clock::local_time())
-  , gotText(false) {
+  , message(std::move(other.message))
+  , timestamp(other.timestamp)
+  , gotText(false)
+  , enabled(other.enabled) {
   if (this != &other) {
     _M_tie = nullptr;
     _M_streambuf = nullptr;
@@ -98,6 +106,10 @@ LoggerMessage::LoggerMessage(LoggerMessage&& other)
 #endif
 
 int LoggerMessage::sync() {
+  if (!enabled) {
+    return 0;
+  }
+
   logger(category, logLevel, timestamp, message);
   gotText = false;
   message = DEFAULT;
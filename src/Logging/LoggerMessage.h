@@ -35,11 +35,13 @@ private:
   int overflow(int c) override;
 
   std::string message;
-  const std::string category;
+  // the LoggerRef that made the message outlives it
+  const std::string& category;
   Level logLevel;
   ILogger& logger;
   boost::posix_time::ptime timestamp;
   bool gotText;
+  bool enabled;
 };
 
 }
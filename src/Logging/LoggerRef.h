@@ -26,6 +26,8 @@ class LoggerRef {
 public:
   LoggerRef(ILogger& logger, const std::string& category);
   LoggerMessage operator()(Level level = INFO, const std::string& color = DEFAULT) const;
+  // For messages whose arguments are expensive to build, the stream already skips formatting for disabled levels
+  bool isEnabled(Level level) const;
   ILogger& getLogger() const;
 
 private:
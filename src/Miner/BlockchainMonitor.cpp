@@ -45,9 +45,17 @@ void BlockchainMonitor::waitBlockchainUpdate() {
   m_stopped = false;
 
   Crypto::Hash lastBlockHash = requestLastBlockHash();
+  bool longPoll = true;
 
   while(!m_stopped) {
-    m_sleepingContext.spawn([this] () {
+    m_sleepingContext.spawn([this, &lastBlockHash, &longPoll] () {
+      if (longPoll) {
+        longPoll = waitForNewBlock(lastBlockHash);
+        if (longPoll) {
+          return;
+        }
+      }
+
       System::Timer timer(m_dispatcher);
       timer.sleep(std::chrono::seconds(m_pollingInterval));
     });
@@ -103,3 +111,33 @@ Crypto::Hash BlockchainMonitor::requestLastBlockHash() {
     throw;
   }
 }
+
+bool BlockchainMonitor::waitForNewBlock(const Crypto::Hash& lastBlockHash) {
+  try {
+    CryptoNote::HttpClient client(m_dispatcher, m_daemonHost, m_daemonPort);
+
+    CryptoNote::COMMAND_RPC_WAIT_FOR_CHANGE::request request;
+    CryptoNote::COMMAND_RPC_WAIT_FOR_CHANGE::response response;
+    request.tail_block_id = Common::podToHex(lastBlockHash);
+    request.pool_version = 0;
+    request.timeout = CryptoNote::COMMAND_RPC_WAIT_FOR_CHANGE_MAX_TIMEOUT;
+
+    CryptoNote::invokeJsonCommand(client, "/waitforchange", request, response);
+    return true;
+  } catch (System::InterruptedException&) {
+    throw;
+  } catch (std::system_error& e) {
+    if (e.code() == std::errc::function_not_supported) {
+      m_logger(Logging::DEBUGGING) << "Daemon doesn't wait for new blocks, polling every " << m_pollingInterval << " seconds";
+      return false;
+    }
+
+    m_logger(Logging::DEBUGGING) << "Failed to wait for new block, trying again in " << m_pollingInterval << " seconds: " << e.what();
+  } catch (std::exception& e) {
+    m_logger(Logging::DEBUGGING) << "Failed to wait for new block, trying again in " << m_pollingInterval << " seconds: " << e.what();
+  }
+
+  // the daemon is unreachable or restarting, long polling is tried again after the pause
+  System::Timer(m_dispatcher).sleep(std::chrono::seconds(m_pollingInterval));
+  return true;
+}
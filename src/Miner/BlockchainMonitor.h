@@ -43,4 +43,7 @@ private:
   Logging::LoggerRef m_logger;
 
   Crypto::Hash requestLastBlockHash();
+  // long-polls the daemon until the tail block differs from lastBlockHash, pauses for the polling interval on errors;
+  // false if the daemon doesn't know the request
+  bool waitForNewBlock(const Crypto::Hash& lastBlockHash);
 };
@@ -27,11 +27,13 @@
 #include <System/ContextGroup.h>
 #include <System/Dispatcher.h>
 #include <System/Event.h>
-#include <System/EventLock.h>
+#include <System/InterruptedException.h>
 #include <System/Timer.h>
 #include <CryptoNoteCore/TransactionApi.h>
 
+#include "Common/ScopeExit.h"
 #include "Common/StringTools.h"
+#include "CryptoNoteConfig.h"
 #include "CryptoNoteCore/CryptoNoteBasicImpl.h"
 #include "CryptoNoteCore/CryptoNoteFormatUtils.h"
 #include "CryptoNoteCore/CryptoNoteTools.h"
@@ -65,6 +67,8 @@ std::error_code interpretResponseStatus(const std::string& status) {
 NodeRpcProxy::NodeRpcProxy(const std::string& nodeHost, unsigned short nodePort) :
     m_rpcTimeout(10000),
     m_pullInterval(5000),
+    m_minPullInterval(1000),
+    m_currentPullInterval(1000),
     m_nodeHost(nodeHost),
     m_nodePort(nodePort),
     m_lastLocalBlockTimestamp(0),
@@ -83,6 +87,11 @@ void NodeRpcProxy::resetInternalState() {
   m_networkHeight.store(0, std::memory_order_relaxed);
   m_lastKnowHash = CryptoNote::NULL_HASH;
   m_knownTxs.clear();
+  m_currentPullInterval = m_minPullInterval;
+  m_pullChanged = false;
+  m_pullRequested = false;
+  m_longPollSupported = true;
+  m_poolVersion = 0;
 }
 
 void NodeRpcProxy::init(const INode::Callback& callback) {
@@ -93,6 +102,11 @@ void NodeRpcProxy::init(const INode::Callback& callback) {
     return;
   }
 
+  // a worker that failed to start has returned already
+  if (m_workerThread.joinable()) {
+    m_workerThread.join();
+  }
+
   m_state = STATE_INITIALIZING;
   resetInternalState();
   m_workerThread = std::thread([this, callback] { 
@@ -102,25 +116,30 @@ void NodeRpcProxy::init(const INode::Callback& callback) {
 
 bool NodeRpcProxy::shutdown() {
   std::unique_lock<std::mutex> lock(m_mutex);
+  m_cv_initialized.wait(lock, [this] { return m_state != STATE_INITIALIZING; });
+
+  // the dispatcher is gone if the worker thread has left already
+  if (m_dispatcher != nullptr) {
+    // requests in flight and the pause between polls are interrupted, the worker thread then returns
+    m_dispatcher->remoteSpawn([this] {
+      m_stop = true;
+      if (m_pullGroup != nullptr) {
+        m_pullGroup->interrupt();
+      }
 
-  if (m_state == STATE_NOT_INITIALIZED) {
-    return true;
-  } else if (m_state == STATE_INITIALIZING) {
-    m_cv_initialized.wait(lock, [this] { return m_state != STATE_INITIALIZING; });
-    if (m_state == STATE_NOT_INITIALIZED) {
-      return true;
-    }
+      if (m_context_group != nullptr) {
+        m_context_group->interrupt();
+      }
+    });
   }
 
-  assert(m_state == STATE_INITIALIZED);
-  assert(m_dispatcher != nullptr);
-
-  // Simplified for stub dispatcher - just set stop flag
-  m_stop = true;
-
   if (m_workerThread.joinable()) {
+    // the worker thread takes m_mutex to release the dispatcher
+    lock.unlock();
     m_workerThread.join();
+    lock.lock();
   }
+
   m_state = STATE_NOT_INITIALIZED;
   m_cv_initialized.notify_all();
   return true;
@@ -129,48 +148,162 @@ bool NodeRpcProxy::shutdown() {
 void NodeRpcProxy::workerThread(const INode::Callback& initialized_callback) {
   try {
     Dispatcher dispatcher;
-    m_dispatcher = &dispatcher;
-    ContextGroup contextGroup(dispatcher);
-    m_context_group = &contextGroup;
-    HttpClient httpClient(dispatcher, m_nodeHost, m_nodePort);
-    m_httpClient = &httpClient;
+    // the connections are closed before their dispatcher goes away
+    Tools::ScopeExit clearHttpClients([this] {
+      m_freeHttpClients.clear();
+      m_httpClients.clear();
+    });
+
     Event httpEvent(dispatcher);
-    m_httpEvent = &httpEvent;
-    m_httpEvent->set();
+    ContextGroup contextGroup(dispatcher);
+    ContextGroup pullGroup(dispatcher);
+    for (size_t i = 0; i < m_httpConnections; ++i) {
+      m_httpClients.emplace_back(new HttpClient(dispatcher, m_nodeHost, m_nodePort));
+      m_freeHttpClients.push_back(m_httpClients.back().get());
+    }
 
     {
       std::lock_guard<std::mutex> lock(m_mutex);
       assert(m_state == STATE_INITIALIZING);
+      m_dispatcher = &dispatcher;
+      m_context_group = &contextGroup;
+      m_pullGroup = &pullGroup;
+      m_httpEvent = &httpEvent;
       m_state = STATE_INITIALIZED;
       m_cv_initialized.notify_all();
     }
 
+    // once every context has returned, shutdown() and new requests no longer reach the dispatcher
+    Tools::ScopeExit releaseDispatcher([&] {
+      m_stop = true;
+      pullGroup.interrupt();
+      contextGroup.interrupt();
+      pullGroup.wait();
+      contextGroup.wait();
+
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_dispatcher = nullptr;
+      m_context_group = nullptr;
+      m_pullGroup = nullptr;
+      m_httpEvent = nullptr;
+    });
+
     initialized_callback(std::error_code());
 
-    contextGroup.spawn([this]() {
-      Timer pullTimer;
+    pullGroup.spawn([this]() {
       while (!m_stop) {
         updateNodeStatus();
         if (!m_stop) {
-          // Simplified sleep using std::this_thread::sleep_for
-          std::this_thread::sleep_for(std::chrono::milliseconds(m_pullInterval));
+          waitForNextPull();
         }
       }
     });
 
+    pullGroup.wait();
     contextGroup.wait();
-    // Simplified - stub dispatcher doesn't need yield
   } catch (std::exception&) {
+    bool initFailed = false;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_state == STATE_INITIALIZING) {
+        initFailed = true;
+        m_state = STATE_NOT_INITIALIZED;
+        m_cv_initialized.notify_all();
+      }
+    }
+
+    if (initFailed) {
+      initialized_callback(make_error_code(error::NOT_INITIALIZED));
+      return;
+    }
   }
 
-  m_dispatcher = nullptr;
-  m_context_group = nullptr;
-  m_httpClient = nullptr;
-  m_httpEvent = nullptr;
   m_connected = false;
   m_rpcProxyObserverManager.notify(&INodeRpcProxyObserver::connectionStatusUpdated, m_connected);
 }
 
+void NodeRpcProxy::waitForNextPull() {
+  auto pullEnd = std::chrono::steady_clock::now();
+  if (m_pullChanged) {
+    m_currentPullInterval = m_minPullInterval;
+  } else {
+    m_currentPullInterval = std::min(m_currentPullInterval * 2, m_pullInterval);
+  }
+
+  m_pullChanged = false;
+  if (m_pullRequested) {
+    m_pullRequested = false;
+    return;
+  }
+
+  std::chrono::milliseconds pause(m_currentPullInterval);
+  if (m_longPollSupported && m_lastKnowHash != NULL_HASH && waitForNodeChange()) {
+    // the tip of a node that is catching up changes all the time, polls stay m_minPullInterval apart
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - pullEnd);
+    if (elapsed.count() >= static_cast<int64_t>(m_minPullInterval)) {
+      m_pullRequested = false;
+      return;
+    }
+
+    pause = std::chrono::milliseconds(m_minPullInterval) - elapsed;
+  }
+
+  if (m_stop) {
+    return;
+  }
+
+  m_pullSleeping = true;
+  try {
+    Timer pullTimer(*m_dispatcher);
+    pullTimer.sleep(pause);
+  } catch (InterruptedException&) {
+  }
+
+  m_pullSleeping = false;
+  m_pullRequested = false;
+}
+
+bool NodeRpcProxy::waitForNodeChange() {
+  COMMAND_RPC_WAIT_FOR_CHANGE::request req = AUTO_VAL_INIT(req);
+  COMMAND_RPC_WAIT_FOR_CHANGE::response rsp = AUTO_VAL_INIT(rsp);
+  req.tail_block_id = podToHex(m_lastKnowHash);
+
+  std::error_code ec;
+  if (m_poolVersion == 0) {
+    // learn the pool version first, a wait with pool_version 0 would miss pool changes
+    ec = jsonCommand("/waitforchange", req, rsp);
+    if (!ec) {
+      m_poolVersion = rsp.pool_version;
+    }
+  }
+
+  if (!ec) {
+    req.pool_version = m_poolVersion;
+    req.timeout = COMMAND_RPC_WAIT_FOR_CHANGE_MAX_TIMEOUT / 2;
+    ec = jsonCommand("/waitforchange", req, rsp);
+  }
+
+  if (ec) {
+    // only a node that doesn't know the request is polled on the interval from now on, other errors
+    // wait for the next poll like a poll that brought nothing new
+    if (ec == std::errc::function_not_supported) {
+      m_longPollSupported = false;
+    }
+
+    return false;
+  }
+
+  m_poolVersion = rsp.pool_version;
+  return true;
+}
+
+void NodeRpcProxy::requestPull() {
+  m_pullRequested = true;
+  if (m_pullSleeping) {
+    m_pullGroup->interrupt();
+  }
+}
+
 void NodeRpcProxy::updateNodeStatus() {
   bool updateBlockchain = true;
   while (updateBlockchain) {
@@ -197,6 +330,7 @@ bool NodeRpcProxy::updatePoolStatus() {
   }
 
   if (!addedTxs.empty() || !deletedTxsIds.empty()) {
+    m_pullChanged = true;
     updatePoolState(addedTxs, deletedTxsIds);
     m_observerManager.notify(&INodeObserver::poolChanged);
   }
@@ -217,6 +351,7 @@ void NodeRpcProxy::updateBlockchainStatus() {
     }
 
     if (blockHash != m_lastKnowHash) {
+      m_pullChanged = true;
       m_lastKnowHash = blockHash;
       m_nodeHeight.store(static_cast<uint32_t>(rsp.block_header.height), std::memory_order_relaxed);
       m_lastLocalBlockTimestamp.store(rsp.block_header.timestamp, std::memory_order_relaxed);
@@ -237,15 +372,63 @@ void NodeRpcProxy::updateBlockchainStatus() {
       m_observerManager.notify(&INodeObserver::lastKnownBlockHeightUpdated, m_networkHeight.load(std::memory_order_relaxed));
     }
 
+    // the node is still catching up with the network, its tip moves quickly
+    if (lastKnownBlockIndex > m_nodeHeight.load(std::memory_order_relaxed)) {
+      m_pullChanged = true;
+    }
+
     updatePeerCount(getInfoResp.incoming_connections_count + getInfoResp.outgoing_connections_count);
   }
 
-  if (m_connected != m_httpClient->isConnected()) {
-    m_connected = m_httpClient->isConnected();
+  updateConnectionStatus();
+}
+
+void NodeRpcProxy::updateConnectionStatus() {
+  if (m_connected != m_httpConnected) {
+    m_connected = m_httpConnected;
+    if (m_connected) {
+      m_longPollSupported = true;
+    }
+
     m_rpcProxyObserverManager.notify(&INodeRpcProxyObserver::connectionStatusUpdated, m_connected);
   }
 }
 
+std::map<std::string, NodeRpcProxy::RequestStats> NodeRpcProxy::getRequestStats() const {
+  std::lock_guard<std::mutex> lock(m_statsMutex);
+  return m_requestStats;
+}
+
+void NodeRpcProxy::recordRequest(const std::string& name, std::chrono::steady_clock::time_point start, const std::error_code& ec) {
+  uint64_t latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+  std::lock_guard<std::mutex> lock(m_statsMutex);
+  RequestStats& stats = m_requestStats[name];
+  ++stats.calls;
+  if (ec) {
+    ++stats.errors;
+  }
+
+  stats.totalLatency += latency;
+  stats.maxLatency = std::max(stats.maxLatency, latency);
+}
+
+NodeRpcProxy::HttpClientLease::HttpClientLease(NodeRpcProxy& proxy) : m_proxy(proxy) {
+  while (m_proxy.m_freeHttpClients.empty()) {
+    m_proxy.m_httpEvent->clear();
+    m_proxy.m_httpEvent->wait();
+  }
+
+  m_client = m_proxy.m_freeHttpClients.back();
+  m_proxy.m_freeHttpClients.pop_back();
+}
+
+NodeRpcProxy::HttpClientLease::~HttpClientLease() {
+  m_proxy.m_httpConnected = m_client->isConnected();
+  m_proxy.m_freeHttpClients.push_back(m_client);
+  m_proxy.m_httpEvent->set();
+}
+
 void NodeRpcProxy::updatePeerCount(size_t peerCount) {
   if (peerCount != m_peerCount) {
     m_peerCount = peerCount;
@@ -357,6 +540,18 @@ void NodeRpcProxy::getTransactionOutsGlobalIndices(const Crypto::Hash& transacti
     std::ref(outsGlobalIndices)), callback);
 }
 
+void NodeRpcProxy::getTransactionsOutsGlobalIndices(const std::vector<Crypto::Hash>& transactionHashes,
+                                                    std::vector<std::vector<uint32_t>>& outsGlobalIndices, const Callback& callback) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_state != STATE_INITIALIZED) {
+    callback(make_error_code(error::NOT_INITIALIZED));
+    return;
+  }
+
+  scheduleRequest(std::bind(&NodeRpcProxy::doGetTransactionsOutsGlobalIndices, this, std::cref(transactionHashes),
+    std::ref(outsGlobalIndices)), callback);
+}
+
 void NodeRpcProxy::queryBlocks(std::vector<Crypto::Hash>&& knownBlockIds, uint64_t timestamp, std::vector<BlockShortEntry>& newBlocks,
   uint32_t& startHeight, const Callback& callback) {
   std::lock_guard<std::mutex> lock(m_mutex);
@@ -369,6 +564,29 @@ void NodeRpcProxy::queryBlocks(std::vector<Crypto::Hash>&& knownBlockIds, uint64
           std::ref(newBlocks), std::ref(startHeight)), callback);
 }
 
+void NodeRpcProxy::queryBlockFilters(std::vector<Crypto::Hash>&& knownBlockIds, uint64_t timestamp, std::vector<BlockFilterEntry>& newBlocks,
+  uint32_t& startHeight, const Callback& callback) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_state != STATE_INITIALIZED) {
+    callback(make_error_code(error::NOT_INITIALIZED));
+    return;
+  }
+
+  scheduleRequest(std::bind(&NodeRpcProxy::doQueryBlockFilters, this, std::move(knownBlockIds), timestamp,
+          std::ref(newBlocks), std::ref(startHeight)), callback);
+}
+
+void NodeRpcProxy::getBlocksTransactions(const std::vector<Crypto::Hash>& blockHashes, std::vector<std::vector<TransactionShortInfo>>& transactions,
+  const Callback& callback) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_state != STATE_INITIALIZED) {
+    callback(make_error_code(error::NOT_INITIALIZED));
+    return;
+  }
+
+  scheduleRequest(std::bind(&NodeRpcProxy::doGetBlocksTransactions, this, std::cref(blockHashes), std::ref(transactions)), callback);
+}
+
 void NodeRpcProxy::getPoolSymmetricDifference(std::vector<Crypto::Hash>&& knownPoolTxIds, Crypto::Hash knownBlockId, bool& isBcActual,
         std::vector<std::unique_ptr<ITransactionReader>>& newTxs, std::vector<Crypto::Hash>& deletedTxIds, const Callback& callback) {
   std::lock_guard<std::mutex> lock(m_mutex);
@@ -474,7 +692,13 @@ std::error_code NodeRpcProxy::doRelayTransaction(const CryptoNote::Transaction&
   COMMAND_RPC_SEND_RAW_TX::request req;
   COMMAND_RPC_SEND_RAW_TX::response rsp;
   req.tx_as_hex = toHex(toBinaryArray(transaction));
-  return jsonCommand("/sendrawtransaction", req, rsp);
+  std::error_code ec = jsonCommand("/sendrawtransaction", req, rsp);
+  if (!ec) {
+    // the pool of the node has changed, observers learn about it without waiting for the next poll
+    requestPull();
+  }
+
+  return ec;
 }
 
 std::error_code NodeRpcProxy::doGetRandomOutsByAmounts(std::vector<uint64_t>& amounts, uint64_t outsCount,
@@ -525,6 +749,36 @@ std::error_code NodeRpcProxy::doGetTransactionOutsGlobalIndices(const Crypto::Ha
   return ec;
 }
 
+std::error_code NodeRpcProxy::doGetTransactionsOutsGlobalIndices(const std::vector<Crypto::Hash>& transactionHashes,
+                                                                 std::vector<std::vector<uint32_t>>& outsGlobalIndices) {
+  outsGlobalIndices.clear();
+  outsGlobalIndices.reserve(transactionHashes.size());
+
+  // the node refuses requests above the limit, larger batches are split
+  for (size_t first = 0; first < transactionHashes.size(); first += COMMAND_RPC_GET_TXS_GLOBAL_OUTPUTS_INDEXES_MAX_COUNT) {
+    size_t last = std::min(first + COMMAND_RPC_GET_TXS_GLOBAL_OUTPUTS_INDEXES_MAX_COUNT, transactionHashes.size());
+
+    CryptoNote::COMMAND_RPC_GET_TXS_GLOBAL_OUTPUTS_INDEXES::request req = AUTO_VAL_INIT(req);
+    CryptoNote::COMMAND_RPC_GET_TXS_GLOBAL_OUTPUTS_INDEXES::response rsp = AUTO_VAL_INIT(rsp);
+    req.txids.assign(transactionHashes.begin() + first, transactionHashes.begin() + last);
+
+    std::error_code ec = binaryCommand("/get_txs_o_indexes.bin", req, rsp);
+    if (ec) {
+      return ec;
+    }
+
+    if (rsp.txs.size() != req.txids.size()) {
+      return make_error_code(error::INTERNAL_NODE_ERROR);
+    }
+
+    for (const auto& tx : rsp.txs) {
+      outsGlobalIndices.emplace_back(tx.o_indexes.begin(), tx.o_indexes.end());
+    }
+  }
+
+  return std::error_code();
+}
+
 std::error_code NodeRpcProxy::doQueryBlocksLite(const std::vector<Crypto::Hash>& knownBlockIds, uint64_t timestamp,
         std::vector<CryptoNote::BlockShortEntry>& newBlocks, uint32_t& startHeight) {
   CryptoNote::COMMAND_RPC_QUERY_BLOCKS_LITE::request req = AUTO_VAL_INIT(req);
@@ -566,6 +820,82 @@ std::error_code NodeRpcProxy::doQueryBlocksLite(const std::vector<Crypto::Hash>&
   return std::error_code();
 }
 
+std::error_code NodeRpcProxy::doQueryBlockFilters(const std::vector<Crypto::Hash>& knownBlockIds, uint64_t timestamp,
+        std::vector<CryptoNote::BlockFilterEntry>& newBlocks, uint32_t& startHeight) {
+  CryptoNote::COMMAND_RPC_GET_BLOCK_FILTERS::request req = AUTO_VAL_INIT(req);
+  CryptoNote::COMMAND_RPC_GET_BLOCK_FILTERS::response rsp = AUTO_VAL_INIT(rsp);
+
+  req.blockIds = knownBlockIds;
+  req.timestamp = timestamp;
+
+  std::error_code ec = binaryCommand("/getblockfilters.bin", req, rsp);
+  if (ec) {
+    return ec;
+  }
+
+  startHeight = static_cast<uint32_t>(rsp.startHeight);
+
+  for (auto& item: rsp.items) {
+    BlockFilterEntry entry;
+    entry.hasBlock = false;
+
+    entry.blockHash = std::move(item.blockId);
+    if (!item.block.empty()) {
+      if (!fromBinaryArray(entry.block, asBinaryArray(item.block))) {
+        return std::make_error_code(std::errc::invalid_argument);
+      }
+
+      entry.hasBlock = true;
+    }
+
+    for (const auto& txFilter : item.txFilters) {
+      if (txFilter.outputIndexes.size() != txFilter.outputKeys.size()) {
+        return std::make_error_code(std::errc::invalid_argument);
+      }
+    }
+
+    entry.txFilters = std::move(item.txFilters);
+    entry.spendFilter = std::move(item.spendFilter);
+    newBlocks.push_back(std::move(entry));
+  }
+
+  return std::error_code();
+}
+
+std::error_code NodeRpcProxy::doGetBlocksTransactions(const std::vector<Crypto::Hash>& blockHashes,
+        std::vector<std::vector<TransactionShortInfo>>& transactions) {
+  CryptoNote::COMMAND_RPC_GET_BLOCK_TRANSACTION_PREFIXES::request req = AUTO_VAL_INIT(req);
+  CryptoNote::COMMAND_RPC_GET_BLOCK_TRANSACTION_PREFIXES::response rsp = AUTO_VAL_INIT(rsp);
+  req.blockIds = blockHashes;
+
+  std::error_code ec = binaryCommand("/getblocktxprefixes.bin", req, rsp);
+  if (ec) {
+    return ec;
+  }
+
+  if (rsp.items.size() != blockHashes.size()) {
+    return make_error_code(error::INTERNAL_NODE_ERROR);
+  }
+
+  transactions.clear();
+  transactions.reserve(rsp.items.size());
+  for (size_t i = 0; i < rsp.items.size(); ++i) {
+    if (rsp.items[i].blockId != blockHashes[i]) {
+      return make_error_code(error::INTERNAL_NODE_ERROR);
+    }
+
+    transactions.emplace_back();
+    for (const auto& txp : rsp.items[i].txPrefixes) {
+      TransactionShortInfo tsi;
+      tsi.txId = txp.txHash;
+      tsi.txPrefix = txp.txPrefix;
+      transactions.back().push_back(std::move(tsi));
+    }
+  }
+
+  return std::error_code();
+}
+
 std::error_code NodeRpcProxy::doGetPoolSymmetricDifference(std::vector<Crypto::Hash>&& knownPoolTxIds, Crypto::Hash knownBlockId, bool& isBcActual,
         std::vector<std::unique_ptr<ITransactionReader>>& newTxs, std::vector<Crypto::Hash>& deletedTxIds) {
   CryptoNote::COMMAND_RPC_GET_POOL_CHANGES_LITE::request req = AUTO_VAL_INIT(req);
@@ -659,62 +989,80 @@ void NodeRpcProxy::scheduleRequest(std::function<std::error_code()>&& procedure,
     std::function<std::error_code()> procedure;
     Callback callback;
   };
-  assert(m_dispatcher != nullptr && m_context_group != nullptr);
-  // Simplified for stub dispatcher - execute directly
-  m_context_group->spawn(Wrapper([this](std::function<std::error_code()>& procedure, const Callback& callback) {
-      if (m_stop) {
-        callback(std::make_error_code(std::errc::operation_canceled));
-      } else {
-        std::error_code ec = procedure();
-        if (m_connected != m_httpClient->isConnected()) {
-          m_connected = m_httpClient->isConnected();
-          m_rpcProxyObserverManager.notify(&INodeRpcProxyObserver::connectionStatusUpdated, m_connected);
+  // the worker thread is leaving, shutdown() is on its way
+  if (m_dispatcher == nullptr) {
+    callback(make_error_code(error::NOT_INITIALIZED));
+    return;
+  }
+
+  // the context group belongs to the worker thread, the request is handed over through its dispatcher
+  m_dispatcher->remoteSpawn(Wrapper([this](std::function<std::error_code()>& procedure, Callback& callback) {
+    if (m_context_group == nullptr) {
+      callback(std::make_error_code(std::errc::operation_canceled));
+      return;
+    }
+
+    m_context_group->spawn(Wrapper([this](std::function<std::error_code()>& procedure, const Callback& callback) {
+        if (m_stop) {
+          callback(std::make_error_code(std::errc::operation_canceled));
+        } else {
+          std::error_code ec = procedure();
+          updateConnectionStatus();
+          callback(m_stop ? std::make_error_code(std::errc::operation_canceled) : ec);
         }
-        callback(m_stop ? std::make_error_code(std::errc::operation_canceled) : ec);
-      }
-    }, std::move(procedure), std::move(callback)));
+      }, std::move(procedure), std::move(callback)));
+  }, std::move(procedure), std::move(callback)));
 }
 
 template <typename Request, typename Response>
 std::error_code NodeRpcProxy::binaryCommand(const std::string& url, const Request& req, Response& res) {
   std::error_code ec;
+  auto start = std::chrono::steady_clock::now();
 
   try {
-    EventLock eventLock(*m_httpEvent);
-    invokeBinaryCommand(*m_httpClient, url, req, res);
+    HttpClientLease httpClient(*this);
+    invokeBinaryCommand(*httpClient, url, req, res);
     ec = interpretResponseStatus(res.status);
   } catch (const ConnectException&) {
     ec = make_error_code(error::CONNECT_ERROR);
+  } catch (const std::system_error& e) {
+    ec = e.code();
   } catch (const std::exception&) {
     ec = make_error_code(error::NETWORK_ERROR);
   }
 
+  recordRequest(url, start, ec);
   return ec;
 }
 
 template <typename Request, typename Response>
 std::error_code NodeRpcProxy::jsonCommand(const std::string& url, const Request& req, Response& res) {
   std::error_code ec;
+  auto start = std::chrono::steady_clock::now();
 
   try {
-    EventLock eventLock(*m_httpEvent);
-    invokeJsonCommand(*m_httpClient, url, req, res);
+    HttpClientLease httpClient(*this);
+    invokeJsonCommand(*httpClient, url, req, res);
     ec = interpretResponseStatus(res.status);
   } catch (const ConnectException&) {
     ec = make_error_code(error::CONNECT_ERROR);
+  } catch (const std::system_error& e) {
+    ec = e.code();
   } catch (const std::exception&) {
     ec = make_error_code(error::NETWORK_ERROR);
   }
 
+  recordRequest(url, start, ec);
   return ec;
 }
 
 template <typename Request, typename Response>
 std::error_code NodeRpcProxy::jsonRpcCommand(const std::string& method, const Request& req, Response& res) {
   std::error_code ec = make_error_code(error::INTERNAL_NODE_ERROR);
+  auto start = std::chrono::steady_clock::now();
 
   try {
-    EventLock eventLock(*m_httpEvent);
+    HttpClientLease httpClient(*this);
 
     JsonRpc::JsonRpcRequest jsReq;
 
@@ -727,7 +1075,7 @@ std::error_code NodeRpcProxy::jsonRpcCommand(const std::string& method, const Re
     httpReq.setUrl("/json_rpc");
     httpReq.setBody(jsReq.getBody());
 
-    m_httpClient->request(httpReq, httpRes);
+    httpClient->request(httpReq, httpRes);
 
     JsonRpc::JsonRpcResponse jsRes;
 
@@ -743,6 +1091,7 @@ std::error_code NodeRpcProxy::jsonRpcCommand(const std::string& method, const Re
     ec = make_error_code(error::NETWORK_ERROR);
   }
 
+  recordRequest(method, start, ec);
   return ec;
 }
 
@@ -17,12 +17,17 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
 #include <unordered_set>
+#include <vector>
 
 #include "Common/ObserverManager.h"
 #include "INode.h"
@@ -45,6 +50,14 @@ public:
 
 class NodeRpcProxy : public CryptoNote::INode {
 public:
+  struct RequestStats {
+    uint64_t calls = 0;
+    uint64_t errors = 0;
+    // from the call until the response is read, waiting for a free connection included, in microseconds
+    uint64_t totalLatency = 0;
+    uint64_t maxLatency = 0;
+  };
+
   NodeRpcProxy(const std::string& nodeHost, unsigned short nodePort);
   virtual ~NodeRpcProxy();
 
@@ -68,7 +81,10 @@ public:
   virtual void getRandomOutsByAmounts(std::vector<uint64_t>&& amounts, uint64_t outsCount, std::vector<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount>& result, const Callback& callback) override;
   virtual void getNewBlocks(std::vector<Crypto::Hash>&& knownBlockIds, std::vector<CryptoNote::block_complete_entry>& newBlocks, uint32_t& startHeight, const Callback& callback) override;
   virtual void getTransactionOutsGlobalIndices(const Crypto::Hash& transactionHash, std::vector<uint32_t>& outsGlobalIndices, const Callback& callback) override;
+  virtual void getTransactionsOutsGlobalIndices(const std::vector<Crypto::Hash>& transactionHashes, std::vector<std::vector<uint32_t>>& outsGlobalIndices, const Callback& callback) override;
   virtual void queryBlocks(std::vector<Crypto::Hash>&& knownBlockIds, uint64_t timestamp, std::vector<BlockShortEntry>& newBlocks, uint32_t& startHeight, const Callback& callback) override;
+  virtual void queryBlockFilters(std::vector<Crypto::Hash>&& knownBlockIds, uint64_t timestamp, std::vector<BlockFilterEntry>& newBlocks, uint32_t& startHeight, const Callback& callback) override;
+  virtual void getBlocksTransactions(const std::vector<Crypto::Hash>& blockHashes, std::vector<std::vector<TransactionShortInfo>>& transactions, const Callback& callback) override;
   virtual void getPoolSymmetricDifference(std::vector<Crypto::Hash>&& knownPoolTxIds, Crypto::Hash knownBlockId, bool& isBcActual,
           std::vector<std::unique_ptr<ITransactionReader>>& newTxs, std::vector<Crypto::Hash>& deletedTxIds, const Callback& callback) override;
   virtual void getMultisignatureOutputByGlobalIndex(uint64_t amount, uint32_t gindex, MultisignatureOutput& out, const Callback& callback) override;
@@ -83,9 +99,43 @@ public:
   unsigned int rpcTimeout() const { return m_rpcTimeout; }
   void rpcTimeout(unsigned int val) { m_rpcTimeout = val; }
 
+  // keep-alive connections to the node, requests beyond that wait for a free one; set before init
+  size_t httpConnections() const { return m_httpConnections; }
+  void httpConnections(size_t val) { m_httpConnections = std::max<size_t>(val, 1); }
+
+  // the pause between polls in milliseconds, from minInterval after a change up to maxInterval; set before init
+  void pullInterval(uint64_t minInterval, uint64_t maxInterval) {
+    m_minPullInterval = std::max<uint64_t>(minInterval, 1);
+    m_pullInterval = std::max(maxInterval, m_minPullInterval);
+  }
+
+  // per url or JSON-RPC method
+  std::map<std::string, RequestStats> getRequestStats() const;
+
 private:
+  // a connection taken from the pool for one request
+  class HttpClientLease {
+  public:
+    explicit HttpClientLease(NodeRpcProxy& proxy);
+    ~HttpClientLease();
+
+    HttpClient& operator*() { return *m_client; }
+    HttpClient* operator->() { return m_client; }
+
+  private:
+    NodeRpcProxy& m_proxy;
+    HttpClient* m_client;
+  };
+
   void resetInternalState();
   void workerThread(const Callback& initialized_callback);
+  void waitForNextPull();
+  // long-polls the node until its tail block or pool changes, false if that isn't possible
+  bool waitForNodeChange();
+  // polls the node right away, or right after the poll in progress
+  void requestPull();
+  void updateConnectionStatus();
+  void recordRequest(const std::string& name, std::chrono::steady_clock::time_point start, const std::error_code& ec);
 
   std::vector<Crypto::Hash> getKnownTxsVector() const;
   void pullNodeStatusAndScheduleTheNext();
@@ -102,8 +152,14 @@ private:
     std::vector<CryptoNote::block_complete_entry>& newBlocks, uint32_t& startHeight);
   std::error_code doGetTransactionOutsGlobalIndices(const Crypto::Hash& transactionHash,
                                                     std::vector<uint32_t>& outsGlobalIndices);
+  std::error_code doGetTransactionsOutsGlobalIndices(const std::vector<Crypto::Hash>& transactionHashes,
+                                                     std::vector<std::vector<uint32_t>>& outsGlobalIndices);
   std::error_code doQueryBlocksLite(const std::vector<Crypto::Hash>& knownBlockIds, uint64_t timestamp,
     std::vector<CryptoNote::BlockShortEntry>& newBlocks, uint32_t& startHeight);
+  std::error_code doQueryBlockFilters(const std::vector<Crypto::Hash>& knownBlockIds, uint64_t timestamp,
+    std::vector<CryptoNote::BlockFilterEntry>& newBlocks, uint32_t& startHeight);
+  std::error_code doGetBlocksTransactions(const std::vector<Crypto::Hash>& blockHashes,
+    std::vector<std::vector<TransactionShortInfo>>& transactions);
   std::error_code doGetPoolSymmetricDifference(std::vector<Crypto::Hash>&& knownPoolTxIds, Crypto::Hash knownBlockId, bool& isBcActual,
           std::vector<std::unique_ptr<ITransactionReader>>& newTxs, std::vector<Crypto::Hash>& deletedTxIds);
   virtual void getTransaction(const Crypto::Hash &transactionHash, CryptoNote::Transaction &transaction, const Callback &callback) override;
@@ -136,10 +192,28 @@ private:
   const std::string m_nodeHost;
   const unsigned short m_nodePort;
   unsigned int m_rpcTimeout;
-  HttpClient* m_httpClient = nullptr;
+  size_t m_httpConnections = 4;
+  std::vector<std::unique_ptr<HttpClient>> m_httpClients;
+  std::vector<HttpClient*> m_freeHttpClients;
+  // set when a connection goes back to the pool
   System::Event* m_httpEvent = nullptr;
+  bool m_httpConnected = false;
+
+  mutable std::mutex m_statsMutex;
+  std::map<std::string, RequestStats> m_requestStats;
 
+  // the poll interval starts at m_minPullInterval after the node reported a change and doubles
+  // on every poll that brings nothing new, up to m_pullInterval
   uint64_t m_pullInterval;
+  uint64_t m_minPullInterval;
+  uint64_t m_currentPullInterval;
+  bool m_pullChanged = false;
+  bool m_pullRequested = false;
+  bool m_pullSleeping = false;
+  System::ContextGroup* m_pullGroup = nullptr;
+  // nodes without /waitforchange are polled on the interval until the connection is made again
+  bool m_longPollSupported = true;
+  uint64_t m_poolVersion = 0;
 
   // Internal state
   bool m_stop = false;
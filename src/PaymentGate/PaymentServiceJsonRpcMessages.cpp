@@ -421,6 +421,26 @@ void SendTransaction::Response::serialize(CryptoNote::ISerializer &serializer)
   serializer(transactionSecretKey, "transactionSecretKey");
 }
 
+void SentTransaction::serialize(CryptoNote::ISerializer &serializer)
+{
+  serializer(transactionHash, "transactionHash");
+  serializer(transactionSecretKey, "transactionSecretKey");
+  serializer(relayed, "relayed");
+}
+
+void SendTransactions::Request::serialize(CryptoNote::ISerializer &serializer)
+{
+  if (!serializer(transactions, "transactions"))
+  {
+    throw RequestSerializationError();
+  }
+}
+
+void SendTransactions::Response::serialize(CryptoNote::ISerializer &serializer)
+{
+  serializer(transactions, "transactions");
+}
+
 void CreateDelayedTransaction::Request::serialize(CryptoNote::ISerializer &serializer)
 {
   serializer(addresses, "addresses");
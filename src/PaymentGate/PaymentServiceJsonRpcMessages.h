@@ -813,6 +813,32 @@ struct SendTransaction
   };
 };
 
+struct SentTransaction
+{
+  std::string transactionHash;
+  std::string transactionSecretKey;
+  bool relayed;
+
+  void serialize(CryptoNote::ISerializer &serializer);
+};
+
+struct SendTransactions
+{
+  struct Request
+  {
+    std::vector<SendTransaction::Request> transactions;
+
+    void serialize(CryptoNote::ISerializer &serializer);
+  };
+
+  struct Response
+  {
+    std::vector<SentTransaction> transactions;
+
+    void serialize(CryptoNote::ISerializer &serializer);
+  };
+};
+
 struct CreateDelayedTransaction
 {
   struct Request
@@ -17,6 +17,7 @@
 
 #include "WalletService.h"
 
+#include <algorithm>
 #include <future>
 #include <assert.h>
 #include <sstream>
@@ -306,6 +307,19 @@ namespace PaymentService
       return result;
     }
 
+    // Blocks are kept even if none of their transactions pass the filter
+    void filterBlockTransactions(std::vector<CryptoNote::TransactionsInBlockInfo> &blocks, const TransactionsInBlockInfoFilter &filter)
+    {
+      for (auto &block : blocks)
+      {
+        auto &transactions = block.transactions;
+        transactions.erase(std::remove_if(transactions.begin(), transactions.end(), [&filter](const CryptoNote::WalletTransactionWithTransfers &transaction) {
+                             return transaction.transaction.state == CryptoNote::WalletTransactionState::DELETED || !filter.checkTransaction(transaction);
+                           }),
+                           transactions.end());
+      }
+    }
+
     //KD2
 
     PaymentService::TransactionRpcInfo convertTransactionWithTransfersToTransactionRpcInfo(const CryptoNote::WalletTransactionWithTransfers &transactionWithTransfers)
@@ -447,6 +461,38 @@ namespace PaymentService
       return result;
     }
 
+    CryptoNote::TransactionParameters makeSendParameters(const PaymentService::SendTransaction::Request &request, const CryptoNote::Currency &currency, Logging::LoggerRef logger)
+    {
+      validateAddresses(request.sourceAddresses, currency, logger);
+      validateAddresses(collectDestinationAddresses(request.transfers), currency, logger);
+      std::vector<PaymentService::WalletRpcMessage> messages = collectMessages(request.transfers);
+      if (!request.changeAddress.empty())
+      {
+        validateAddresses({request.changeAddress}, currency, logger);
+      }
+
+      CryptoNote::TransactionParameters sendParams;
+      if (!request.paymentId.empty())
+      {
+        addPaymentIdToExtra(request.paymentId, sendParams.extra);
+      }
+      else
+      {
+        sendParams.extra = Common::asString(Common::fromHex(request.extra));
+      }
+
+      sendParams.sourceAddresses = request.sourceAddresses;
+      sendParams.destinations = convertWalletRpcOrdersToWalletOrders(request.transfers);
+      sendParams.messages = convertWalletRpcMessagesToWalletMessages(messages);
+      sendParams.fee = CryptoNote::parameters::MINIMUM_FEE;
+      // Use dynamic ring sizing for optimal privacy (aim for 18, fallback to 8 minimum)
+      sendParams.mixIn = CryptoNote::parameters::MIN_TX_MIXIN_SIZE_V10;
+      sendParams.unlockTimestamp = request.unlockTime;
+      sendParams.changeDestination = request.changeAddress;
+
+      return sendParams;
+    }
+
   } // namespace
 
   void createWalletFile(std::fstream &walletFile, const std::string &filename)
@@ -1353,47 +1399,82 @@ namespace PaymentService
         return make_error_code(CryptoNote::error::DAEMON_NOT_SYNCED);
       }
 
-      validateAddresses(request.sourceAddresses, currency, logger);
-      validateAddresses(collectDestinationAddresses(request.transfers), currency, logger);
-      std::vector<PaymentService::WalletRpcMessage> messages = collectMessages(request.transfers);
-      if (!request.changeAddress.empty())
+      CryptoNote::TransactionParameters sendParams = makeSendParameters(request, currency, logger);
+
+      Crypto::SecretKey transactionSK;
+      size_t transactionId = wallet.transfer(sendParams, transactionSK);
+      transactionHash = Common::podToHex(wallet.getTransaction(transactionId).hash);
+      transactionSecretKey = Common::podToHex(transactionSK);
+      logger(Logging::DEBUGGING) << "Transaction " << transactionHash << " has been sent";
+    }
+    catch (std::system_error &x)
+    {
+      logger(Logging::WARNING) << "Error while sending transaction: " << x.what();
+      return x.code();
+    }
+    catch (std::exception &x)
+    {
+      logger(Logging::WARNING) << "Error while sending transaction: " << x.what();
+      return make_error_code(CryptoNote::error::INTERNAL_WALLET_ERROR);
+    }
+
+    return std::error_code();
+  }
+
+  std::error_code WalletService::sendTransactions(const SendTransactions::Request &request, std::vector<SentTransaction> &transactions)
+  {
+
+    try
+    {
+      System::EventLock lk(readyEvent);
+
+      if (request.transactions.empty())
       {
-        validateAddresses({request.changeAddress}, currency, logger);
+        logger(Logging::WARNING) << "No transactions to send";
+        return make_error_code(CryptoNote::error::WRONG_PARAMETERS);
       }
 
-      CryptoNote::TransactionParameters sendParams;
-      if (!request.paymentId.empty())
+      uint64_t knownBlockCount = node.getKnownBlockCount();
+      uint64_t localBlockCount = node.getLocalBlockCount();
+      uint64_t diff = knownBlockCount - localBlockCount;
+      if ((localBlockCount == 0) || (diff > 2))
       {
-        addPaymentIdToExtra(request.paymentId, sendParams.extra);
+        logger(Logging::WARNING) << "Daemon is not synchronized";
+        return make_error_code(CryptoNote::error::DAEMON_NOT_SYNCED);
       }
-      else
+
+      std::vector<CryptoNote::TransactionParameters> sendParams;
+      sendParams.reserve(request.transactions.size());
+      for (const auto &transactionRequest : request.transactions)
       {
-        sendParams.extra = Common::asString(Common::fromHex(request.extra));
+        sendParams.push_back(makeSendParameters(transactionRequest, currency, logger));
       }
 
-      sendParams.sourceAddresses = request.sourceAddresses;
-      sendParams.destinations = convertWalletRpcOrdersToWalletOrders(request.transfers);
-      sendParams.messages = convertWalletRpcMessagesToWalletMessages(messages);
-      sendParams.fee = CryptoNote::parameters::MINIMUM_FEE;
-      // Use dynamic ring sizing for optimal privacy (aim for 18, fallback to 8 minimum)
-      sendParams.mixIn = parameters::MIN_TX_MIXIN_SIZE_V10;
-      sendParams.unlockTimestamp = request.unlockTime;
-      sendParams.changeDestination = request.changeAddress;
+      std::vector<Crypto::SecretKey> transactionSKs;
+      std::vector<size_t> transactionIds = wallet.transfer(sendParams, transactionSKs);
 
-      Crypto::SecretKey transactionSK;
-      size_t transactionId = wallet.transfer(sendParams, transactionSK);
-      transactionHash = Common::podToHex(wallet.getTransaction(transactionId).hash);
-      transactionSecretKey = Common::podToHex(transactionSK);
-      logger(Logging::DEBUGGING) << "Transaction " << transactionHash << " has been sent";
+      transactions.clear();
+      for (size_t i = 0; i < transactionIds.size(); ++i)
+      {
+        CryptoNote::WalletTransaction transaction = wallet.getTransaction(transactionIds[i]);
+
+        SentTransaction sent;
+        sent.transactionHash = Common::podToHex(transaction.hash);
+        sent.transactionSecretKey = Common::podToHex(transactionSKs[i]);
+        sent.relayed = transaction.state == CryptoNote::WalletTransactionState::SUCCEEDED;
+        transactions.push_back(std::move(sent));
+      }
+
+      logger(Logging::DEBUGGING) << transactions.size() << " transactions have been sent";
     }
     catch (std::system_error &x)
     {
-      logger(Logging::WARNING) << "Error while sending transaction: " << x.what();
+      logger(Logging::WARNING) << "Error while sending transactions: " << x.what();
       return x.code();
     }
     catch (std::exception &x)
     {
-      logger(Logging::WARNING) << "Error while sending transaction: " << x.what();
+      logger(Logging::WARNING) << "Error while sending transactions: " << x.what();
       return make_error_code(CryptoNote::error::INTERNAL_WALLET_ERROR);
     }
 
@@ -2095,6 +2176,41 @@ namespace PaymentService
       return result;
     }
 
+    std::vector<CryptoNote::TransactionsInBlockInfo> WalletService::getFilteredTransactions(const Crypto::Hash &blockHash, size_t blockCount, const TransactionsInBlockInfoFilter &filter) const
+    {
+      if (!filter.havePaymentId)
+      {
+        return filterTransactions(getTransactions(blockHash, blockCount), filter);
+      }
+
+      // The wallet keeps a payment id index, so only matching transactions are fetched
+      std::vector<CryptoNote::TransactionsInBlockInfo> result = wallet.getTransactionsByPaymentId(filter.paymentId, blockHash, blockCount);
+      if (result.empty() && wallet.getTransactions(blockHash, 1).empty())
+      {
+        throw std::system_error(make_error_code(CryptoNote::error::WalletServiceErrorCode::OBJECT_NOT_FOUND));
+      }
+
+      filterBlockTransactions(result, filter);
+      return result;
+    }
+
+    std::vector<CryptoNote::TransactionsInBlockInfo> WalletService::getFilteredTransactions(uint32_t firstBlockIndex, size_t blockCount, const TransactionsInBlockInfoFilter &filter) const
+    {
+      if (!filter.havePaymentId)
+      {
+        return filterTransactions(getTransactions(firstBlockIndex, blockCount), filter);
+      }
+
+      if (firstBlockIndex >= wallet.getBlockCount())
+      {
+        throw std::system_error(make_error_code(CryptoNote::error::WalletServiceErrorCode::OBJECT_NOT_FOUND));
+      }
+
+      std::vector<CryptoNote::TransactionsInBlockInfo> result = wallet.getTransactionsByPaymentId(filter.paymentId, firstBlockIndex, blockCount);
+      filterBlockTransactions(result, filter);
+      return result;
+    }
+
     std::vector<CryptoNote::DepositsInBlockInfo> WalletService::getDeposits(const Crypto::Hash &blockHash, size_t blockCount) const
     {
       std::vector<CryptoNote::DepositsInBlockInfo> result = wallet.getDeposits(blockHash, blockCount);
@@ -2119,31 +2235,27 @@ namespace PaymentService
 
     std::vector<TransactionHashesInBlockRpcInfo> WalletService::getRpcTransactionHashes(const Crypto::Hash &blockHash, size_t blockCount, const TransactionsInBlockInfoFilter &filter) const
     {
-      std::vector<CryptoNote::TransactionsInBlockInfo> allTransactions = getTransactions(blockHash, blockCount);
-      std::vector<CryptoNote::TransactionsInBlockInfo> filteredTransactions = filterTransactions(allTransactions, filter);
+      std::vector<CryptoNote::TransactionsInBlockInfo> filteredTransactions = getFilteredTransactions(blockHash, blockCount, filter);
       return convertTransactionsInBlockInfoToTransactionHashesInBlockRpcInfo(filteredTransactions);
     }
 
     std::vector<TransactionHashesInBlockRpcInfo> WalletService::getRpcTransactionHashes(uint32_t firstBlockIndex, size_t blockCount, const TransactionsInBlockInfoFilter &filter) const
     {
-      std::vector<CryptoNote::TransactionsInBlockInfo> allTransactions = getTransactions(firstBlockIndex, blockCount);
-      std::vector<CryptoNote::TransactionsInBlockInfo> filteredTransactions = filterTransactions(allTransactions, filter);
+      std::vector<CryptoNote::TransactionsInBlockInfo> filteredTransactions = getFilteredTransactions(firstBlockIndex, blockCount, filter);
       return convertTransactionsInBlockInfoToTransactionHashesInBlockRpcInfo(filteredTransactions);
     }
 
     std::vector<TransactionsInBlockRpcInfo> WalletService::getRpcTransactions(const Crypto::Hash &blockHash, size_t blockCount, const TransactionsInBlockInfoFilter &filter) const
     {
       uint32_t knownBlockCount = node.getKnownBlockCount();
-      std::vector<CryptoNote::TransactionsInBlockInfo> allTransactions = getTransactions(blockHash, blockCount);
-      std::vector<CryptoNote::TransactionsInBlockInfo> filteredTransactions = filterTransactions(allTransactions, filter);
+      std::vector<CryptoNote::TransactionsInBlockInfo> filteredTransactions = getFilteredTransactions(blockHash, blockCount, filter);
       return convertTransactionsInBlockInfoToTransactionsInBlockRpcInfo(filteredTransactions, knownBlockCount);
     }
 
     std::vector<TransactionsInBlockRpcInfo> WalletService::getRpcTransactions(uint32_t firstBlockIndex, size_t blockCount, const TransactionsInBlockInfoFilter &filter) const
     {
       uint32_t knownBlockCount = node.getKnownBlockCount();
-      std::vector<CryptoNote::TransactionsInBlockInfo> allTransactions = getTransactions(firstBlockIndex, blockCount);
-      std::vector<CryptoNote::TransactionsInBlockInfo> filteredTransactions = filterTransactions(allTransactions, filter);
+      std::vector<CryptoNote::TransactionsInBlockInfo> filteredTransactions = getFilteredTransactions(firstBlockIndex, blockCount, filter);
       return convertTransactionsInBlockInfoToTransactionsInBlockRpcInfo(filteredTransactions, knownBlockCount);
     }
 
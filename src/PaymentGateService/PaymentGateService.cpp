@@ -233,6 +233,7 @@ void PaymentGateService::runWalletService(const CryptoNote::Currency& currency,
   };
 
   std::unique_ptr<CryptoNote::WalletGreen> wallet(new CryptoNote::WalletGreen(*dispatcher, currency, node, logger));
+  wallet->setBlockFiltersEnabled(config.gateConfiguration.blockFilters);
 
   service = new PaymentService::WalletService(currency, *dispatcher, node, *wallet, *wallet, walletConfiguration, logger);
   std::unique_ptr<PaymentService::WalletService> serviceGuard(service);
@@ -35,6 +35,7 @@ Configuration::Configuration() {
   logFile = "payment_gate.log";
   testnet = false;
   printAddresses = false;
+  blockFilters = false;
   logLevel = Logging::INFO;
   bindAddress = "";
   bindPort = 0;
@@ -57,7 +58,8 @@ void Configuration::initOptions(boost::program_options::options_description& des
       ("log-file,l", po::value<std::string>(), "log file")
       ("server-root", po::value<std::string>(), "server root. The service will use it as working directory. Don't set it if don't want to change it")
       ("log-level", po::value<size_t>(), "log level")
-      ("address", "print wallet addresses and exit");
+      ("address", "print wallet addresses and exit")
+      ("block-filters", "sync from compact block filters of a remote node, fetching transactions only of blocks that concern the wallet");
 }
 
 void Configuration::init(const boost::program_options::variables_map& options) {
@@ -137,6 +139,10 @@ void Configuration::init(const boost::program_options::variables_map& options) {
     printAddresses = true;
   }
 
+  if (options.count("block-filters") != 0) {
+    blockFilters = true;
+  }
+
   if (!registerService && !unregisterService) {
     if (containerFile.empty() || containerPassword.empty()) {
       throw ConfigurationError("Both container-file and container-password parameters are required");
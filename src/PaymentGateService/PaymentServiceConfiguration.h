@@ -54,6 +54,7 @@ struct Configuration {
   bool unregisterService;
   bool testnet;
   bool printAddresses;
+  bool blockFilters;
 
   size_t logLevel;
 };
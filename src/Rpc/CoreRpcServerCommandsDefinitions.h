@@ -213,6 +213,35 @@ struct COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES {
     }
   };
 };
+
+struct COMMAND_RPC_GET_TXS_GLOBAL_OUTPUTS_INDEXES {
+
+  struct request {
+    std::vector<Crypto::Hash> txids;
+
+    void serialize(ISerializer &s) {
+      serializeAsBinary(txids, "txids", s);
+    }
+  };
+
+  struct transaction_indexes {
+    std::vector<uint64_t> o_indexes;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(o_indexes)
+    }
+  };
+
+  struct response {
+    std::vector<transaction_indexes> txs;
+    std::string status;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(txs)
+      KV_MEMBER(status)
+    }
+  };
+};
 //-----------------------------------------------
 struct COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS_request {
   std::vector<uint64_t> amounts;
@@ -326,6 +355,10 @@ struct COMMAND_RPC_GET_INFO {
     uint64_t last_block_timestamp;
     uint64_t last_block_difficulty;
     std::vector<std::string> connections;
+    uint64_t rpc_cache_hits;
+    uint64_t rpc_cache_misses;
+    uint64_t rpc_cache_entries;
+    uint64_t rpc_cache_size;
 
     void serialize(ISerializer &s) {
       KV_MEMBER(status)
@@ -349,6 +382,10 @@ struct COMMAND_RPC_GET_INFO {
       KV_MEMBER(last_block_timestamp)
       KV_MEMBER(last_block_difficulty)
       KV_MEMBER(connections)      
+      KV_MEMBER(rpc_cache_hits)
+      KV_MEMBER(rpc_cache_misses)
+      KV_MEMBER(rpc_cache_entries)
+      KV_MEMBER(rpc_cache_size)
     }
   };
 };
@@ -380,6 +417,76 @@ struct COMMAND_RPC_STOP_DAEMON {
   typedef STATUS_STRUCT response;
 };
 
+//-----------------------------------------------
+struct rpc_endpoint_stats {
+  std::string endpoint;
+  uint64_t calls;
+  uint64_t avg_queue_time;
+  uint64_t max_queue_time;
+  uint64_t running;
+  uint64_t waiting;
+
+  void serialize(ISerializer &s) {
+    KV_MEMBER(endpoint)
+    KV_MEMBER(calls)
+    KV_MEMBER(avg_queue_time)
+    KV_MEMBER(max_queue_time)
+    KV_MEMBER(running)
+    KV_MEMBER(waiting)
+  }
+};
+
+// queue times are in microseconds
+struct COMMAND_RPC_GET_RPC_STATS {
+  typedef EMPTY_STRUCT request;
+
+  struct response {
+    uint64_t worker_threads;
+    std::vector<rpc_endpoint_stats> endpoints;
+    std::string status;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(worker_threads)
+      KV_MEMBER(endpoints)
+      KV_MEMBER(status)
+    }
+  };
+};
+
+// Answers when the tail block differs from tail_block_id, when the pool version differs from
+// pool_version or when timeout milliseconds pass. pool_version 0 waits for blocks only.
+const uint32_t COMMAND_RPC_WAIT_FOR_CHANGE_MAX_TIMEOUT = 60000;
+// requests that wait at the same time, the ones beyond are answered right away
+const size_t COMMAND_RPC_WAIT_FOR_CHANGE_MAX_WAITERS = 256;
+
+struct COMMAND_RPC_WAIT_FOR_CHANGE {
+  struct request {
+    std::string tail_block_id;
+    uint64_t pool_version;
+    uint32_t timeout;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(tail_block_id)
+      KV_MEMBER(pool_version)
+      KV_MEMBER(timeout)
+    }
+  };
+
+  struct response {
+    std::string tail_block_id;
+    uint32_t height;
+    uint64_t pool_version;
+    std::string status;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(tail_block_id)
+      KV_MEMBER(height)
+      KV_MEMBER(pool_version)
+      KV_MEMBER(status)
+    }
+  };
+};
+
 //
 struct COMMAND_RPC_GETBLOCKCOUNT {
   typedef std::vector<std::string> request;
@@ -849,6 +956,54 @@ struct COMMAND_RPC_QUERY_BLOCKS_LITE {
   };
 };
 
+struct COMMAND_RPC_GET_BLOCK_FILTERS {
+  struct request {
+    std::vector<Crypto::Hash> blockIds;
+    uint64_t timestamp;
+
+    void serialize(ISerializer &s) {
+      serializeAsBinary(blockIds, "block_ids", s);
+      KV_MEMBER(timestamp)
+    }
+  };
+
+  struct response {
+    std::string status;
+    uint64_t startHeight;
+    uint64_t currentHeight;
+    uint64_t fullOffset;
+    std::vector<BlockFilterInfo> items;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(status)
+      KV_MEMBER(startHeight)
+      KV_MEMBER(currentHeight)
+      KV_MEMBER(fullOffset)
+      KV_MEMBER(items)
+    }
+  };
+};
+
+struct COMMAND_RPC_GET_BLOCK_TRANSACTION_PREFIXES {
+  struct request {
+    std::vector<Crypto::Hash> blockIds;
+
+    void serialize(ISerializer &s) {
+      serializeAsBinary(blockIds, "block_ids", s);
+    }
+  };
+
+  struct response {
+    std::string status;
+    std::vector<BlockShortInfo> items;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(status)
+      KV_MEMBER(items)
+    }
+  };
+};
+
 struct COMMAND_RPC_GEN_PAYMENT_ID {
   typedef EMPTY_STRUCT request;
   
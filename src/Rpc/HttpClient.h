@@ -18,6 +18,7 @@
 #pragma once
 
 #include <memory>
+#include <system_error>
 
 #include <Common/Base64.h>
 #include <HTTP/HttpRequest.h>
@@ -71,6 +72,11 @@ void invokeJsonCommand(HttpClient& client, const std::string& url, const Request
   hreq.setBody(storeToJson(req));
   client.request(hreq, hres);
 
+  // an older node answers endpoints it doesn't know with 404
+  if (hres.getStatus() == HttpResponse::STATUS_404) {
+    throw std::system_error(std::make_error_code(std::errc::function_not_supported), url);
+  }
+
   if (hres.getStatus() != HttpResponse::STATUS_200) {
     throw std::runtime_error("HTTP status: " + std::to_string(hres.getStatus()));
   }
@@ -129,6 +135,11 @@ void invokeBinaryCommand(HttpClient& client, const std::string& url, const Reque
   hreq.setBody(storeToBinaryKeyValue(req));
   client.request(hreq, hres);
 
+  // an older node answers endpoints it doesn't know with 404
+  if (hres.getStatus() == HttpResponse::STATUS_404) {
+    throw std::system_error(std::make_error_code(std::errc::function_not_supported), url);
+  }
+
   if (!loadFromBinaryKeyValue(res, hres.getBody())) {
     throw std::runtime_error("Failed to parse binary response");
   }
@@ -18,9 +18,9 @@
 #include "HttpServer.h"
 
 #include <Common/Base64.h>
+#include <Common/StreamTools.h>
 #include <HTTP/HttpParser.h>
 #include <System/InterruptedException.h>
-#include <System/TcpStream.h>
 #include <System/Ipv4Address.h>
 
 using namespace Logging;
@@ -32,6 +32,50 @@ namespace {
 		response.addHeader("Content-Type", "text/plain");
 		response.setBody("Authorization required");
 	}
+
+const size_t READ_BUFFER_SIZE = 64 * 1024;
+
+// Gathers the responses to pipelined requests and writes them to the socket in large pieces
+class ConnectionOutputStream : public Common::IOutputStream {
+public:
+  explicit ConnectionOutputStream(System::TcpConnection& connection) : m_connection(connection) {
+  }
+
+  virtual size_t writeSome(const void* data, size_t size) override {
+    if (m_buffer.size() + size > WRITE_BUFFER_SIZE) {
+      flush();
+    }
+
+    if (size >= WRITE_BUFFER_SIZE) {
+      writeAll(data, size);
+    } else {
+      m_buffer.append(static_cast<const char*>(data), size);
+    }
+
+    return size;
+  }
+
+  void flush() {
+    writeAll(m_buffer.data(), m_buffer.size());
+    m_buffer.clear();
+  }
+
+private:
+  static const size_t WRITE_BUFFER_SIZE = 64 * 1024;
+
+  void writeAll(const void* data, size_t size) {
+    const uint8_t* position = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+      size_t written = m_connection.write(position, size);
+      position += written;
+      size -= written;
+    }
+  }
+
+  System::TcpConnection& m_connection;
+  std::string m_buffer;
+};
+
 }
 
 namespace CryptoNote {
@@ -87,17 +131,39 @@ void HttpServer::acceptLoop() {
 
     logger(DEBUGGING) << "Incoming connection from " << addr.first.toDottedDecimal() << ":" << addr.second;
 
-    System::TcpStreambuf streambuf(*connection);
-    std::iostream stream(&streambuf);
     HttpParser parser;
-
-    for (;;) {
+    ConnectionOutputStream output(*connection);
+    std::string input;
+    size_t parsed = 0;
+    bool keepAlive = true;
+
+    // every complete request in the input is answered in order before the responses are flushed together,
+    // so pipelining clients get one write for a whole batch
+    while (keepAlive) {
       HttpRequest req;
+      size_t requestSize = parser.parseRequest(input.data() + parsed, input.size() - parsed, req);
+      if (requestSize == 0) {
+        output.flush();
+        input.erase(0, parsed);
+        parsed = 0;
+
+        size_t oldSize = input.size();
+        input.resize(oldSize + READ_BUFFER_SIZE);
+        size_t readSize = connection->read(reinterpret_cast<uint8_t*>(&input[oldSize]), READ_BUFFER_SIZE);
+        input.resize(oldSize + readSize);
+        if (readSize == 0) {
+          break;
+        }
+
+        continue;
+      }
+
+      parsed += requestSize;
+
       HttpResponse resp;
 	  resp.addHeader("Access-Control-Allow-Origin", "*");
 	  resp.addHeader("content-type", "application/json");
-	
-      parser.receiveRequest(stream, req);
+
 				if (authenticate(req)) {
 					processRequest(req, resp);
 				}
@@ -106,14 +172,20 @@ void HttpServer::acceptLoop() {
 					fillUnauthorizedResponse(resp);
 				}
 
-      stream << resp;
-      stream.flush();
+      keepAlive = req.isKeepAlive();
+      if (!keepAlive) {
+        resp.addHeader("Connection", "close");
+      }
 
-      if (stream.peek() == std::iostream::traits_type::eof()) {
-        break;
+      if (resp.hasChunkedBody() && req.getVersion() == "HTTP/1.0") {
+        resp.bufferBody();
       }
+
+      resp.write(output);
     }
 
+    output.flush();
+
     logger(DEBUGGING) << "Closing connection from " << addr.first.toDottedDecimal() << ":" << addr.second << " total=" << m_connections.size();
 
     // Cleanup: remove connection from active connections
@@ -64,6 +64,91 @@ void invokeJsonRpcCommand(HttpClient& httpClient, JsonRpcRequest& jsReq, JsonRpc
   }
 }
 
+void invokeJsonRpcBatch(HttpClient& httpClient, std::vector<JsonRpcRequest>& requests, std::vector<JsonRpcResponse>& responses, const std::string& user, const std::string& password) {
+  responses.clear();
+  if (requests.empty()) {
+    return;
+  }
+
+  std::string body = "[";
+  for (size_t i = 0; i < requests.size(); ++i) {
+    requests[i].setId(Common::JsonValue(static_cast<Common::JsonValue::Integer>(i)));
+    if (i != 0) {
+      body += ',';
+    }
+
+    body += requests[i].getBody();
+  }
+
+  body += ']';
+
+  HttpRequest httpReq;
+  HttpResponse httpRes;
+
+  if (!user.empty() || !password.empty()) {
+    httpReq.addHeader("Authorization", "Basic " + Tools::Base64::encode(user + ":" + password));
+  }
+  httpReq.addHeader("Content-Type", "application/json");
+  httpReq.setUrl("/json_rpc");
+  httpReq.setBody(std::move(body));
+
+  httpClient.request(httpReq, httpRes);
+
+  if (httpRes.getStatus() != HttpResponse::STATUS_200) {
+    throw std::runtime_error("JSON-RPC call failed, HTTP status = " + std::to_string(httpRes.getStatus()));
+  }
+
+  Common::JsonValue batch;
+  try {
+    batch = Common::JsonValue::fromString(httpRes.getBody());
+  } catch (std::exception&) {
+    throw JsonRpcError(errParseError);
+  }
+
+  // a server without batch support, or one that rejected the whole batch, answers with a single object
+  if (!batch.isArray()) {
+    JsonRpcResponse jsRes;
+    jsRes.parse(batch);
+
+    JsonRpcError err;
+    if (jsRes.getError(err)) {
+      throw err;
+    }
+
+    throw JsonRpcError(errInvalidRequest);
+  }
+
+  responses.resize(requests.size());
+  std::vector<bool> answered(requests.size(), false);
+  for (size_t i = 0; i < batch.size(); ++i) {
+    const Common::JsonValue& item = batch[i];
+    if (!item.isObject() || !item.contains("id") || !item("id").isInteger()) {
+      JsonRpcResponse jsRes;
+      jsRes.parse(item);
+
+      JsonRpcError err;
+      if (item.isObject() && jsRes.getError(err)) {
+        throw err;
+      }
+
+      throw JsonRpcError(errInvalidRequest);
+    }
+
+    Common::JsonValue::Integer index = item("id").getInteger();
+    if (index < 0 || static_cast<size_t>(index) >= requests.size() || answered[index]) {
+      throw JsonRpcError(errInvalidRequest);
+    }
+
+    responses[index].parse(item);
+    answered[index] = true;
+  }
+
+  for (bool isAnswered : answered) {
+    if (!isAnswered) {
+      throw std::runtime_error("JSON-RPC batch call failed, a request is not answered");
+    }
+  }
+}
 
 }
 }
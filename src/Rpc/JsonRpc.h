@@ -19,6 +19,7 @@
 
 #include <boost/optional.hpp>
 #include <functional>
+#include <vector>
 
 #include "CoreRpcServerCommandsDefinitions.h"
 #include <Common/JsonValue.h>
@@ -68,16 +69,23 @@ public:
   JsonRpcRequest() : psReq(Common::JsonValue::OBJECT) {}
 
   bool parseRequest(const std::string& requestBody) {
+    Common::JsonValue request;
     try {
-      psReq = Common::JsonValue::fromString(requestBody);
+      request = Common::JsonValue::fromString(requestBody);
     } catch (std::exception&) {
       throw JsonRpcError(errParseError);
     }
 
-    if (!psReq.contains("method")) {
+    return parseRequest(request);
+  }
+
+  // an element of a batch array is parsed on its own
+  bool parseRequest(const Common::JsonValue& request) {
+    if (!request.isObject() || !request.contains("method") || !request("method").isString()) {
       throw JsonRpcError(errInvalidRequest);
     }
 
+    psReq = request;
     method = psReq("method").getString();
 
     if (psReq.contains("id")) {
@@ -112,6 +120,16 @@ public:
     return id;
   }
 
+  void setId(const Common::JsonValue& requestId) {
+    id = requestId;
+    psReq.set("id", requestId);
+  }
+
+  // equal params give the same text, object members are written in order
+  std::string getCanonicalParams() const {
+    return psReq.contains("params") ? psReq("params").toString() : std::string();
+  }
+
   std::string getBody() {
     psReq.set("jsonrpc", std::string("2.0"));
     psReq.set("method", method);
@@ -139,6 +157,11 @@ public:
     }
   }
 
+  // an element of a batch response
+  void parse(const Common::JsonValue& response) {
+    psResp = response;
+  }
+
   void setId(const OptionalId& id) {
     if (id.is_initialized()) {
       psResp.insert("id", id.get());
@@ -160,15 +183,32 @@ public:
 
   std::string getBody() {
     psResp.set("jsonrpc", std::string("2.0"));
-    return psResp.toString();
+    std::string body = psResp.toString();
+    if (!result.empty()) {
+      body.pop_back();
+      body += ",\"result\":";
+      body += result;
+      body += '}';
+    }
+
+    return body;
   }
 
+  // the result is rendered right away, a large one doesn't go through a JsonValue
   template <typename T>
   bool setResult(const T& v) {
-    psResp.set("result", storeToJsonValue(v));
+    result = storeToJson(v);
     return true;
   }
 
+  const std::string& getRawResult() const {
+    return result;
+  }
+
+  void setRawResult(std::string rawResult) {
+    result = std::move(rawResult);
+  }
+
   template <typename T>
   bool getResult(T& v) const {
     if (!psResp.contains("result")) {
@@ -181,11 +221,16 @@ public:
 
 private:
   Common::JsonValue psResp;
+  std::string result;
 };
 
 
 void invokeJsonRpcCommand(HttpClient& httpClient, JsonRpcRequest& req, JsonRpcResponse& res, const std::string& user = "", const std::string& password = "");
 
+// Sends the requests as one JSON-RPC 2.0 batch. The ids of the requests are replaced by their positions and
+// responses[i] answers requests[i]. An error of a single call is left in its response for getError.
+void invokeJsonRpcBatch(HttpClient& httpClient, std::vector<JsonRpcRequest>& requests, std::vector<JsonRpcResponse>& responses, const std::string& user = "", const std::string& password = "");
+
 template <typename Request, typename Response>
 void invokeJsonRpcCommand(HttpClient& httpClient, const std::string& method, const Request& req, Response& res, const std::string& user = "", const std::string& password = "") {
   JsonRpcRequest jsReq;
@@ -199,6 +244,30 @@ void invokeJsonRpcCommand(HttpClient& httpClient, const std::string& method, con
   jsRes.getResult(res);
 }
 
+// Calls the same method once per element of reqs in a single round trip, throws the first error returned
+template <typename Request, typename Response>
+void invokeJsonRpcBatch(HttpClient& httpClient, const std::string& method, const std::vector<Request>& reqs, std::vector<Response>& res, const std::string& user = "", const std::string& password = "") {
+  std::vector<JsonRpcRequest> jsReqs(reqs.size());
+  std::vector<JsonRpcResponse> jsRes;
+
+  for (size_t i = 0; i < reqs.size(); ++i) {
+    jsReqs[i].setMethod(method);
+    jsReqs[i].setParams(reqs[i]);
+  }
+
+  invokeJsonRpcBatch(httpClient, jsReqs, jsRes, user, password);
+
+  res.resize(jsRes.size());
+  for (size_t i = 0; i < jsRes.size(); ++i) {
+    JsonRpcError err;
+    if (jsRes[i].getError(err)) {
+      throw err;
+    }
+
+    jsRes[i].getResult(res[i]);
+  }
+}
+
 template <typename Request, typename Response, typename Handler>
 bool invokeMethod(const JsonRpcRequest& jsReq, JsonRpcResponse& jsRes, Handler handler) {
   Request req;
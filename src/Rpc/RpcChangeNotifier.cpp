@@ -0,0 +1,130 @@
+// Copyright (c) 2017-2022 Fuego Developers
+//
+// This file is part of Fuego.
+//
+// Fuego is free & open source software distributed in the hope
+// it will be useful, but WITHOUT ANY WARRANTY; without even an
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+// PURPOSE. You may redistribute it and/or modify it under the terms
+// of the GNU General Public License v3 or later versions as published
+// by the Free Software Foundation. Fuego includes elements written
+// by third parties. See file labeled LICENSE for more details.
+// You should have received a copy of the GNU General Public License
+// along with Fuego. If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "RpcChangeNotifier.h"
+
+#include <algorithm>
+#include <functional>
+
+#include <System/InterruptedException.h>
+#include <System/Timer.h>
+
+namespace CryptoNote {
+
+RpcChangeNotifier::RpcChangeNotifier(System::Dispatcher& dispatcher, size_t maxWaiters) : m_dispatcher(dispatcher), m_maxWaiters(maxWaiters),
+  m_poolVersion(1), m_wakePending(false), m_timerGroup(dispatcher), m_timerRunning(false), m_stopped(false) {
+}
+
+RpcChangeNotifier::~RpcChangeNotifier() {
+  m_stopped = true;
+  m_timerGroup.interrupt();
+  m_timerGroup.wait();
+
+  // a wake-up posted by a core thread may still be queued
+  while (m_wakePending) {
+    m_dispatcher.yield();
+  }
+}
+
+uint64_t RpcChangeNotifier::getPoolVersion() const {
+  return m_poolVersion;
+}
+
+bool RpcChangeNotifier::wait(std::chrono::milliseconds timeout) {
+  if (m_waiters.size() >= m_maxWaiters) {
+    return false;
+  }
+
+  System::Event event(m_dispatcher);
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  m_waiters.push_back({ &event, deadline });
+
+  if (!m_timerRunning) {
+    m_timerRunning = true;
+    m_timerDeadline = deadline;
+    m_timerGroup.spawn(std::bind(&RpcChangeNotifier::timerLoop, this));
+  } else if (deadline < m_timerDeadline) {
+    // the timer sleeps past this deadline, it starts over with the new one
+    m_timerGroup.interrupt();
+  }
+
+  auto removeWaiter = [&] {
+    m_waiters.erase(std::find_if(m_waiters.begin(), m_waiters.end(), [&](const Waiter& waiter) { return waiter.event == &event; }));
+  };
+
+  try {
+    event.wait();
+  } catch (System::InterruptedException&) {
+    removeWaiter();
+    throw;
+  }
+
+  removeWaiter();
+  return true;
+}
+
+void RpcChangeNotifier::blockchainUpdated() {
+  ++m_poolVersion;
+  notify();
+}
+
+void RpcChangeNotifier::poolUpdated() {
+  ++m_poolVersion;
+  notify();
+}
+
+void RpcChangeNotifier::notify() {
+  if (!m_wakePending.exchange(true)) {
+    m_dispatcher.remoteSpawn([this] {
+      m_wakePending = false;
+      wakeWaiters();
+    });
+  }
+}
+
+void RpcChangeNotifier::wakeWaiters() {
+  for (const Waiter& waiter : m_waiters) {
+    waiter.event->set();
+  }
+}
+
+void RpcChangeNotifier::timerLoop() {
+  System::Timer timer(m_dispatcher);
+  while (!m_stopped) {
+    auto now = std::chrono::steady_clock::now();
+    m_timerDeadline = std::chrono::steady_clock::time_point::max();
+    for (const Waiter& waiter : m_waiters) {
+      if (waiter.deadline <= now) {
+        waiter.event->set();
+      } else {
+        m_timerDeadline = std::min(m_timerDeadline, waiter.deadline);
+      }
+    }
+
+    // the waiters that are left remove themselves once they run
+    if (m_timerDeadline == std::chrono::steady_clock::time_point::max()) {
+      break;
+    }
+
+    try {
+      timer.sleep(std::chrono::duration_cast<std::chrono::nanoseconds>(m_timerDeadline - now));
+    } catch (System::InterruptedException&) {
+    }
+  }
+
+  m_timerRunning = false;
+}
+
+}
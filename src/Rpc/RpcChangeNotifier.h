@@ -0,0 +1,74 @@
+// Copyright (c) 2017-2022 Fuego Developers
+//
+// This file is part of Fuego.
+//
+// Fuego is free & open source software distributed in the hope
+// it will be useful, but WITHOUT ANY WARRANTY; without even an
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+// PURPOSE. You may redistribute it and/or modify it under the terms
+// of the GNU General Public License v3 or later versions as published
+// by the Free Software Foundation. Fuego includes elements written
+// by third parties. See file labeled LICENSE for more details.
+// You should have received a copy of the GNU General Public License
+// along with Fuego. If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#include <System/ContextGroup.h>
+#include <System/Dispatcher.h>
+#include <System/Event.h>
+
+#include "CryptoNoteCore/ICoreObserver.h"
+
+namespace CryptoNote {
+
+// Wakes long-poll requests when the blockchain or the pool changes. The core notifies from any thread,
+// the waiters and the wake-up belong to the dispatcher thread.
+class RpcChangeNotifier : public ICoreObserver {
+public:
+  RpcChangeNotifier(System::Dispatcher& dispatcher, size_t maxWaiters);
+  ~RpcChangeNotifier();
+
+  RpcChangeNotifier(const RpcChangeNotifier&) = delete;
+  RpcChangeNotifier& operator=(const RpcChangeNotifier&) = delete;
+
+  // starts at 1 and grows with every change of the pool, a block changes the pool too
+  uint64_t getPoolVersion() const;
+
+  // returns on the next change or when the timeout passes, callers check again what they wait for;
+  // false right away if maxWaiters requests wait already
+  bool wait(std::chrono::milliseconds timeout);
+
+  // ICoreObserver
+  virtual void blockchainUpdated() override;
+  virtual void poolUpdated() override;
+
+private:
+  struct Waiter {
+    System::Event* event;
+    std::chrono::steady_clock::time_point deadline;
+  };
+
+  void notify();
+  void wakeWaiters();
+  // one timer for all waiters, it sleeps until the earliest deadline
+  void timerLoop();
+
+  System::Dispatcher& m_dispatcher;
+  const size_t m_maxWaiters;
+  std::atomic<uint64_t> m_poolVersion;
+  // a wake-up is already posted to the dispatcher, changes until it runs share it
+  std::atomic<bool> m_wakePending;
+  std::vector<Waiter> m_waiters;
+  System::ContextGroup m_timerGroup;
+  bool m_timerRunning;
+  bool m_stopped;
+  std::chrono::steady_clock::time_point m_timerDeadline;
+};
+
+}
@@ -0,0 +1,122 @@
+// Copyright (c) 2017-2022 Fuego Developers
+//
+// This file is part of Fuego.
+//
+// Fuego is free & open source software distributed in the hope
+// it will be useful, but WITHOUT ANY WARRANTY; without even an
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+// PURPOSE. You may redistribute it and/or modify it under the terms
+// of the GNU General Public License v3 or later versions as published
+// by the Free Software Foundation. Fuego includes elements written
+// by third parties. See file labeled LICENSE for more details.
+// You should have received a copy of the GNU General Public License
+// along with Fuego. If not, see <https://www.gnu.org/licenses/>.
+
+#include "RpcResponseCache.h"
+
+namespace CryptoNote {
+
+RpcResponseCache::RpcResponseCache(size_t maxSize) : m_maxSize(maxSize), m_size(0), m_version({ 0, 0 }), m_hits(0), m_misses(0) {
+}
+
+void RpcResponseCache::setMaxSize(size_t maxSize) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_maxSize = maxSize;
+  evict();
+}
+
+bool RpcResponseCache::isEnabled() const {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  return m_maxSize != 0;
+}
+
+bool RpcResponseCache::get(const std::string& key, std::string& response) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  auto it = m_entries.find(key);
+  if (it == m_entries.end()) {
+    ++m_misses;
+    return false;
+  }
+
+  if (it->second.expires <= Clock::now()) {
+    erase(it);
+    ++m_misses;
+    return false;
+  }
+
+  m_lru.splice(m_lru.begin(), m_lru, it->second.lruPosition);
+  response = it->second.response;
+  ++m_hits;
+  return true;
+}
+
+RpcResponseCache::Version RpcResponseCache::getVersion() const {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  return m_version;
+}
+
+void RpcResponseCache::put(const std::string& key, const Policy& policy, const Version& version, const std::string& response) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (version.blockchain != m_version.blockchain || (policy.dependsOnPool && version.pool != m_version.pool)) {
+    return;
+  }
+
+  size_t size = key.size() + response.size();
+  if (size > m_maxSize) {
+    return;
+  }
+
+  auto it = m_entries.find(key);
+  if (it != m_entries.end()) {
+    erase(it);
+  }
+
+  m_lru.push_front(key);
+  Entry entry = { response, policy.dependsOnPool, Clock::time_point::max(), m_lru.begin() };
+  if (policy.maxAge.count() != 0) {
+    entry.expires = Clock::now() + policy.maxAge;
+  }
+
+  m_entries.emplace(key, std::move(entry));
+  m_size += size;
+  evict();
+}
+
+RpcResponseCache::Stats RpcResponseCache::getStats() const {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  return { m_hits, m_misses, m_entries.size(), m_size };
+}
+
+void RpcResponseCache::blockchainUpdated() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  ++m_version.blockchain;
+  m_entries.clear();
+  m_lru.clear();
+  m_size = 0;
+}
+
+void RpcResponseCache::poolUpdated() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  ++m_version.pool;
+  for (auto it = m_entries.begin(); it != m_entries.end();) {
+    if (it->second.dependsOnPool) {
+      erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void RpcResponseCache::erase(std::unordered_map<std::string, Entry>::iterator it) {
+  m_size -= it->first.size() + it->second.response.size();
+  m_lru.erase(it->second.lruPosition);
+  m_entries.erase(it);
+}
+
+void RpcResponseCache::evict() {
+  while (m_size > m_maxSize) {
+    erase(m_entries.find(m_lru.back()));
+  }
+}
+
+}
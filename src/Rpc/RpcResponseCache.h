@@ -0,0 +1,90 @@
+// Copyright (c) 2017-2022 Fuego Developers
+//
+// This file is part of Fuego.
+//
+// Fuego is free & open source software distributed in the hope
+// it will be useful, but WITHOUT ANY WARRANTY; without even an
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+// PURPOSE. You may redistribute it and/or modify it under the terms
+// of the GNU General Public License v3 or later versions as published
+// by the Free Software Foundation. Fuego includes elements written
+// by third parties. See file labeled LICENSE for more details.
+// You should have received a copy of the GNU General Public License
+// along with Fuego. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "CryptoNoteCore/ICoreObserver.h"
+
+namespace CryptoNote {
+
+// Rendered responses of read-only RPC methods, dropped as soon as the blockchain changes.
+// Responses that also depend on the pool are dropped when it changes, and maxAge bounds
+// the life of responses that depend on anything else, such as the peer connections.
+class RpcResponseCache : public ICoreObserver {
+public:
+  struct Policy {
+    bool dependsOnPool;
+    std::chrono::milliseconds maxAge;
+  };
+
+  // A response is only stored if nothing changed since the version it was built from
+  struct Version {
+    uint64_t blockchain;
+    uint64_t pool;
+  };
+
+  struct Stats {
+    uint64_t hits;
+    uint64_t misses;
+    size_t entries;
+    size_t size;
+  };
+
+  // maxSize bounds the bytes of keys and responses together, 0 disables the cache
+  explicit RpcResponseCache(size_t maxSize);
+
+  void setMaxSize(size_t maxSize);
+  bool isEnabled() const;
+
+  bool get(const std::string& key, std::string& response);
+  Version getVersion() const;
+  void put(const std::string& key, const Policy& policy, const Version& version, const std::string& response);
+
+  Stats getStats() const;
+
+  // ICoreObserver
+  virtual void blockchainUpdated() override;
+  virtual void poolUpdated() override;
+
+private:
+  typedef std::chrono::steady_clock Clock;
+
+  struct Entry {
+    std::string response;
+    bool dependsOnPool;
+    Clock::time_point expires;
+    std::list<std::string>::iterator lruPosition;
+  };
+
+  void erase(std::unordered_map<std::string, Entry>::iterator it);
+  void evict();
+
+  mutable std::mutex m_mutex;
+  size_t m_maxSize;
+  size_t m_size;
+  Version m_version;
+  uint64_t m_hits;
+  uint64_t m_misses;
+  std::unordered_map<std::string, Entry> m_entries;
+  // most recently used first
+  std::list<std::string> m_lru;
+};
+
+}
@@ -18,6 +18,7 @@
 #include "RpcServer.h"
 
 #include <future>
+#include <memory>
 #include <unordered_map>
 
 // CryptoNote
@@ -63,7 +64,11 @@ RpcServer::HandlerFunction binMethod(bool (RpcServer::*handler)(typename Command
     }
 
     bool result = (obj->*handler)(req, res);
-    response.setBody(storeToBinaryKeyValue(res.data()));
+
+    // the serialized response goes from the serializer's buffer into the connection without another copy
+    auto serializer = std::make_shared<KVBinaryOutputStreamSerializer>();
+    serialize(res.data(), *serializer);
+    response.setBodyWriter([serializer](Common::IOutputStream& out) { serializer->dump(out); }, serializer->dumpSize());
     return result;
   };
 }
@@ -85,40 +90,125 @@ RpcServer::HandlerFunction jsonMethod(bool (RpcServer::*handler)(typename Comman
   };
 }
 
+// Responses served from the cache until the blockchain changes. Those of getinfo also follow the pool,
+// and they hold peer counts and the observed height, so they don't live longer than a second.
+const std::unordered_map<std::string, RpcResponseCache::Policy> CACHED_RESPONSES = {
+  { "/getinfo", { true, std::chrono::milliseconds(1000) } },
+  { "getlastblockheader", { false, std::chrono::milliseconds(0) } },
+  { "getblockheaderbyhash", { false, std::chrono::milliseconds(0) } },
+  { "getblockheaderbyheight", { false, std::chrono::milliseconds(0) } },
+  { "f_blocks_list_json", { false, std::chrono::milliseconds(0) } },
+  { "f_block_json", { false, std::chrono::milliseconds(0) } }
+};
+
+// worker pool statistics of batched read-only calls are kept under this name
+const std::string JSON_RPC_BATCH_ENDPOINT = "json_rpc_batch";
+
+// What a read-only call of a batch costs while it holds the core lock, calls not listed cost 1. One lock
+// acquisition runs calls worth up to JSON_RPC_BATCH_COST_PER_LOCK, so a block list gets the lock to itself,
+// and a batch worth more than JSON_RPC_BATCH_MAX_COST is refused.
+const std::unordered_map<std::string, size_t> JSON_RPC_BATCH_CALL_COSTS = {
+  { "f_blocks_list_json", 100 },
+  { "f_on_transactions_pool_json", 50 },
+  { "getaltblockslist", 20 },
+  { "f_block_json", 20 },
+  { "f_transaction_json", 20 }
+};
+
+const size_t JSON_RPC_BATCH_COST_PER_LOCK = 100;
+const size_t JSON_RPC_BATCH_MAX_COST = 1000;
+
+bool getCanonicalBody(const std::string& body, std::string& canonicalBody) {
+  if (body.empty()) {
+    canonicalBody.clear();
+    return true;
+  }
+
+  try {
+    canonicalBody = Common::JsonValue::fromString(body).toString();
+  } catch (std::exception&) {
+    return false;
+  }
+
+  return true;
+}
+
 }
 
 std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction>> RpcServer::s_handlers = {
 
   // binary handlers
-  { "/getblocks.bin", { binMethod<COMMAND_RPC_GET_BLOCKS_FAST>(&RpcServer::on_get_blocks), false } },
-  { "/queryblocks.bin", { binMethod<COMMAND_RPC_QUERY_BLOCKS>(&RpcServer::on_query_blocks), false } },
-  { "/queryblockslite.bin", { binMethod<COMMAND_RPC_QUERY_BLOCKS_LITE>(&RpcServer::on_query_blocks_lite), false } },
-  { "/get_o_indexes.bin", { binMethod<COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES>(&RpcServer::on_get_indexes), false } },
-  { "/getrandom_outs.bin", { binMethod<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS>(&RpcServer::on_get_random_outs), false } },
-  { "/get_pool_changes.bin", { binMethod<COMMAND_RPC_GET_POOL_CHANGES>(&RpcServer::onGetPoolChanges), false } },
-  { "/get_pool_changes_lite.bin", { binMethod<COMMAND_RPC_GET_POOL_CHANGES_LITE>(&RpcServer::onGetPoolChangesLite), false } },
+  { "/getblocks.bin", { binMethod<COMMAND_RPC_GET_BLOCKS_FAST>(&RpcServer::on_get_blocks), false, true } },
+  { "/queryblocks.bin", { binMethod<COMMAND_RPC_QUERY_BLOCKS>(&RpcServer::on_query_blocks), false, true } },
+  { "/queryblockslite.bin", { binMethod<COMMAND_RPC_QUERY_BLOCKS_LITE>(&RpcServer::on_query_blocks_lite), false, true } },
+  { "/getblockfilters.bin", { binMethod<COMMAND_RPC_GET_BLOCK_FILTERS>(&RpcServer::on_get_block_filters), false, true } },
+  { "/getblocktxprefixes.bin", { binMethod<COMMAND_RPC_GET_BLOCK_TRANSACTION_PREFIXES>(&RpcServer::on_get_block_transaction_prefixes), false, true } },
+  { "/get_o_indexes.bin", { binMethod<COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES>(&RpcServer::on_get_indexes), false, true } },
+  { "/get_txs_o_indexes.bin", { binMethod<COMMAND_RPC_GET_TXS_GLOBAL_OUTPUTS_INDEXES>(&RpcServer::on_get_txs_indexes), false, true } },
+  { "/getrandom_outs.bin", { binMethod<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS>(&RpcServer::on_get_random_outs), false, true } },
+  { "/get_pool_changes.bin", { binMethod<COMMAND_RPC_GET_POOL_CHANGES>(&RpcServer::onGetPoolChanges), false, true } },
+  { "/get_pool_changes_lite.bin", { binMethod<COMMAND_RPC_GET_POOL_CHANGES_LITE>(&RpcServer::onGetPoolChangesLite), false, true } },
 
   // json handlers
-  { "/getinfo", { jsonMethod<COMMAND_RPC_GET_INFO>(&RpcServer::on_get_info), true } },
-  { "/getheight", { jsonMethod<COMMAND_RPC_GET_HEIGHT>(&RpcServer::on_get_height), true } },
-  { "/gettransactions", { jsonMethod<COMMAND_RPC_GET_TRANSACTIONS>(&RpcServer::on_get_transactions), false } },
-  { "/sendrawtransaction", { jsonMethod<COMMAND_RPC_SEND_RAW_TX>(&RpcServer::on_send_raw_tx), false } },
-  { "/feeaddress", { jsonMethod<COMMAND_RPC_GET_FEE_ADDRESS>(&RpcServer::on_get_fee_address), true } },
-  { "/peers", { jsonMethod<COMMAND_RPC_GET_PEER_LIST>(&RpcServer::on_get_peer_list), true } },
-  { "/getpeers", { jsonMethod<COMMAND_RPC_GET_PEER_LIST>(&RpcServer::on_get_peer_list), true } },
-  { "/paymentid", { jsonMethod<COMMAND_RPC_GEN_PAYMENT_ID>(&RpcServer::on_get_payment_id), true } },
+  { "/getinfo", { jsonMethod<COMMAND_RPC_GET_INFO>(&RpcServer::on_get_info), true, false } },
+  { "/getheight", { jsonMethod<COMMAND_RPC_GET_HEIGHT>(&RpcServer::on_get_height), true, false } },
+  { "/gettransactions", { jsonMethod<COMMAND_RPC_GET_TRANSACTIONS>(&RpcServer::on_get_transactions), false, true } },
+  { "/sendrawtransaction", { jsonMethod<COMMAND_RPC_SEND_RAW_TX>(&RpcServer::on_send_raw_tx), false, false } },
+  { "/feeaddress", { jsonMethod<COMMAND_RPC_GET_FEE_ADDRESS>(&RpcServer::on_get_fee_address), true, false } },
+  { "/peers", { jsonMethod<COMMAND_RPC_GET_PEER_LIST>(&RpcServer::on_get_peer_list), true, false } },
+  { "/getpeers", { jsonMethod<COMMAND_RPC_GET_PEER_LIST>(&RpcServer::on_get_peer_list), true, false } },
+  { "/paymentid", { jsonMethod<COMMAND_RPC_GEN_PAYMENT_ID>(&RpcServer::on_get_payment_id), true, false } },
+  { "/getrpcstats", { jsonMethod<COMMAND_RPC_GET_RPC_STATS>(&RpcServer::on_get_rpc_stats), true, false } },
+  { "/waitforchange", { jsonMethod<COMMAND_RPC_WAIT_FOR_CHANGE>(&RpcServer::on_wait_for_change), true, false } },
 
   // disabled in restricted rpc mode
-  { "/start_mining", { jsonMethod<COMMAND_RPC_START_MINING>(&RpcServer::on_start_mining), false } },
-  { "/stop_mining", { jsonMethod<COMMAND_RPC_STOP_MINING>(&RpcServer::on_stop_mining), false } },
-  { "/stop_daemon", { jsonMethod<COMMAND_RPC_STOP_DAEMON>(&RpcServer::on_stop_daemon), true } },
+  { "/start_mining", { jsonMethod<COMMAND_RPC_START_MINING>(&RpcServer::on_start_mining), false, false } },
+  { "/stop_mining", { jsonMethod<COMMAND_RPC_STOP_MINING>(&RpcServer::on_stop_mining), false, false } },
+  { "/stop_daemon", { jsonMethod<COMMAND_RPC_STOP_DAEMON>(&RpcServer::on_stop_daemon), true, false } },
 
   // json rpc
-  { "/json_rpc", { std::bind(&RpcServer::processJsonRpcRequest, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3), true } }
+  { "/json_rpc", { std::bind(&RpcServer::processJsonRpcRequest, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3), true, false } }
+};
+
+std::unordered_map<std::string, RpcServer::RpcHandler<JsonRpc::JsonMemberMethod>> RpcServer::s_jsonRpcHandlers = {
+  { "getaltblockslist", { JsonRpc::makeMemberMethod(&RpcServer::on_alt_blocks_list_json), true, false } },
+  { "f_blocks_list_json", { JsonRpc::makeMemberMethod(&RpcServer::f_on_blocks_list_json), false, true } },
+  { "f_block_json", { JsonRpc::makeMemberMethod(&RpcServer::f_on_block_json), false, true } },
+  { "f_transaction_json", { JsonRpc::makeMemberMethod(&RpcServer::f_on_transaction_json), false, true } },
+  { "f_on_transactions_pool_json", { JsonRpc::makeMemberMethod(&RpcServer::f_on_transactions_pool_json), false, true } },
+  { "check_tx_proof", { JsonRpc::makeMemberMethod(&RpcServer::k_on_check_tx_proof), false, false } },
+  { "check_reserve_proof", { JsonRpc::makeMemberMethod(&RpcServer::k_on_check_reserve_proof), false, false } },
+  { "getblockcount", { JsonRpc::makeMemberMethod(&RpcServer::on_getblockcount), true, false } },
+  { "on_getblockhash", { JsonRpc::makeMemberMethod(&RpcServer::on_getblockhash), false, true } },
+  { "getblocktemplate", { JsonRpc::makeMemberMethod(&RpcServer::on_getblocktemplate), false, false } },
+  { "getcurrencyid", { JsonRpc::makeMemberMethod(&RpcServer::on_get_currency_id), true, false } },
+  { "submitblock", { JsonRpc::makeMemberMethod(&RpcServer::on_submitblock), false, false } },
+  { "getlastblockheader", { JsonRpc::makeMemberMethod(&RpcServer::on_get_last_block_header), false, true } },
+  { "getblockheaderbyhash", { JsonRpc::makeMemberMethod(&RpcServer::on_get_block_header_by_hash), false, true } },
+  { "getblockheaderbyheight", { JsonRpc::makeMemberMethod(&RpcServer::on_get_block_header_by_height), false, true } }
 };
 
 RpcServer::RpcServer(System::Dispatcher& dispatcher, Logging::ILogger& log, core& c, NodeServer& p2p, const ICryptoNoteProtocolQuery& protocolQuery) :
-  HttpServer(dispatcher, log), logger(log, "RpcServer"), m_core(c), m_p2p(p2p), m_protocolQuery(protocolQuery) {
+  HttpServer(dispatcher, log), logger(log, "RpcServer"), m_core(c), m_p2p(p2p), m_protocolQuery(protocolQuery), m_workerPool(dispatcher), m_responseCache(0), m_changeNotifier(dispatcher, COMMAND_RPC_WAIT_FOR_CHANGE_MAX_WAITERS) {
+  m_core.addObserver(&m_responseCache);
+  m_core.addObserver(&m_changeNotifier);
+}
+
+RpcServer::~RpcServer() {
+  m_core.removeObserver(&m_changeNotifier);
+  m_core.removeObserver(&m_responseCache);
+}
+
+void RpcServer::startWorkers(size_t threadCount, const std::map<std::string, size_t>& endpointLimits) {
+  for (const auto& limit : endpointLimits) {
+    m_workerPool.setEndpointLimit(limit.first, limit.second);
+  }
+
+  m_workerPool.start(threadCount);
+}
+
+void RpcServer::setResponseCacheSize(size_t size) {
+  m_responseCache.setMaxSize(size);
 }
 
 void RpcServer::processRequest(const HttpRequest& request, HttpResponse& response) {
@@ -136,7 +226,29 @@ void RpcServer::processRequest(const HttpRequest& request, HttpResponse& respons
     return;
   }
 
-  it->second.handler(this, request, response);
+  auto policy = CACHED_RESPONSES.find(url);
+  std::string cacheKey;
+  RpcResponseCache::Version cacheVersion;
+  if (policy != CACHED_RESPONSES.end() && m_responseCache.isEnabled() && getCanonicalBody(request.getBody(), cacheKey)) {
+    cacheKey.insert(0, url + '\n');
+    std::string body;
+    if (m_responseCache.get(cacheKey, body)) {
+      response.setBody(std::move(body));
+      return;
+    }
+
+    cacheVersion = m_responseCache.getVersion();
+  }
+
+  if (it->second.readOnly) {
+    m_workerPool.run(url, [&] { it->second.handler(this, request, response); });
+  } else {
+    it->second.handler(this, request, response);
+  }
+
+  if (!cacheKey.empty() && response.getStatus() == HttpResponse::STATUS_200 && !response.getBody().empty()) {
+    m_responseCache.put(cacheKey, policy->second, cacheVersion, response.getBody());
+  }
 }
 
 bool RpcServer::processJsonRpcRequest(const HttpRequest& request, HttpResponse& response) {
@@ -148,33 +260,133 @@ bool RpcServer::processJsonRpcRequest(const HttpRequest& request, HttpResponse&
         response.addHeader("Access-Control-Allow-Origin", m_cors_domain);
   }
 
-  JsonRpcRequest jsonRequest;
-  JsonRpcResponse jsonResponse;
+  logger(TRACE) << "JSON-RPC request: " << request.getBody();
+
+  Common::JsonValue body;
+  try {
+    body = Common::JsonValue::fromString(request.getBody());
+  } catch (std::exception&) {
+    JsonRpcResponse jsonResponse;
+    jsonResponse.setError(JsonRpcError(errParseError));
+    response.setBody(jsonResponse.getBody());
+    return true;
+  }
+
+  if (body.isArray()) {
+    response.setBody(processJsonRpcBatch(body));
+  } else {
+    JsonRpcCall call;
+    if (prepareJsonRpcCall(body, call)) {
+      if (call.handler->readOnly) {
+        m_workerPool.run(call.request.getMethod(), [&] { invokeJsonRpcCall(call); });
+      } else {
+        invokeJsonRpcCall(call);
+      }
+    }
+
+    response.setBody(call.response.getBody());
+  }
+
+  logger(TRACE) << "JSON-RPC response: " << response.getBody();
+  return true;
+}
+
+std::string RpcServer::processJsonRpcBatch(const Common::JsonValue& batch) {
+  using namespace JsonRpc;
+
+  if (batch.size() == 0) {
+    JsonRpcResponse jsonResponse;
+    jsonResponse.setError(JsonRpcError(errInvalidRequest));
+    return jsonResponse.getBody();
+  }
+
+  std::vector<JsonRpcCall> calls(batch.size());
+  std::vector<bool> pending(batch.size());
+  size_t batchCost = 0;
+  for (size_t i = 0; i < batch.size(); ++i) {
+    pending[i] = prepareJsonRpcCall(batch[i], calls[i]);
+    if (pending[i]) {
+      batchCost += calls[i].cost;
+    }
+  }
+
+  if (batchCost > JSON_RPC_BATCH_MAX_COST) {
+    JsonRpcResponse jsonResponse;
+    jsonResponse.setError(JsonRpcError(errInvalidRequest, "Batch is too expensive, split it"));
+    return jsonResponse.getBody();
+  }
+
+  // Calls run in batch order. Consecutive read-only ones go to a worker as a single task that takes the core
+  // lock once, as long as they fit JSON_RPC_BATCH_COST_PER_LOCK, and the lock is released before the next
+  // run so block processing isn't held off long.
+  size_t i = 0;
+  while (i < calls.size()) {
+    if (!pending[i]) {
+      ++i;
+      continue;
+    }
+
+    if (!calls[i].handler->readOnly) {
+      invokeJsonRpcCall(calls[i]);
+      ++i;
+      continue;
+    }
+
+    size_t end = i + 1;
+    size_t cost = calls[i].cost;
+    while (end < calls.size()) {
+      if (pending[end]) {
+        if (!calls[end].handler->readOnly || cost + calls[end].cost > JSON_RPC_BATCH_COST_PER_LOCK) {
+          break;
+        }
+
+        cost += calls[end].cost;
+      }
+
+      ++end;
+    }
+
+    m_workerPool.run(JSON_RPC_BATCH_ENDPOINT, [&] {
+      m_core.readLocked([&] {
+        for (size_t j = i; j < end; ++j) {
+          if (pending[j]) {
+            invokeJsonRpcCall(calls[j]);
+          }
+        }
+      });
+    });
+
+    i = end;
+  }
+
+  // notifications get no response, and a batch of them only gets an empty body
+  std::string body;
+  for (size_t j = 0; j < calls.size(); ++j) {
+    if (calls[j].notification) {
+      continue;
+    }
+
+    body += body.empty() ? '[' : ',';
+    body += calls[j].response.getBody();
+  }
+
+  if (!body.empty()) {
+    body += ']';
+  }
+
+  return body;
+}
+
+bool RpcServer::prepareJsonRpcCall(const Common::JsonValue& body, JsonRpcCall& call) {
+  using namespace JsonRpc;
 
   try {
-    logger(TRACE) << "JSON-RPC request: " << request.getBody();
-    jsonRequest.parseRequest(request.getBody());
-    jsonResponse.setId(jsonRequest.getId()); // copy id
-
-    static std::unordered_map<std::string, RpcServer::RpcHandler<JsonMemberMethod>> jsonRpcHandlers = {
-        {"getaltblockslist", {makeMemberMethod(&RpcServer::on_alt_blocks_list_json), true}},
-        {"f_blocks_list_json", {makeMemberMethod(&RpcServer::f_on_blocks_list_json), false}},
-        {"f_block_json", {makeMemberMethod(&RpcServer::f_on_block_json), false}},
-        {"f_transaction_json", {makeMemberMethod(&RpcServer::f_on_transaction_json), false}},
-        {"f_on_transactions_pool_json", {makeMemberMethod(&RpcServer::f_on_transactions_pool_json), false}},
-        {"check_tx_proof", {makeMemberMethod(&RpcServer::k_on_check_tx_proof), false}},
-        {"check_reserve_proof", {makeMemberMethod(&RpcServer::k_on_check_reserve_proof), false}},
-        {"getblockcount", {makeMemberMethod(&RpcServer::on_getblockcount), true}},
-        {"on_getblockhash", {makeMemberMethod(&RpcServer::on_getblockhash), false}},
-        {"getblocktemplate", {makeMemberMethod(&RpcServer::on_getblocktemplate), false}},
-        {"getcurrencyid", {makeMemberMethod(&RpcServer::on_get_currency_id), true}},
-        {"submitblock", {makeMemberMethod(&RpcServer::on_submitblock), false}},
-        {"getlastblockheader", {makeMemberMethod(&RpcServer::on_get_last_block_header), false}},
-        {"getblockheaderbyhash", {makeMemberMethod(&RpcServer::on_get_block_header_by_hash), false}},
-        {"getblockheaderbyheight", {makeMemberMethod(&RpcServer::on_get_block_header_by_height), false}}};
-
-    auto it = jsonRpcHandlers.find(jsonRequest.getMethod());
-    if (it == jsonRpcHandlers.end()) {
+    call.request.parseRequest(body);
+    call.response.setId(call.request.getId()); // copy id
+    call.notification = !call.request.getId();
+
+    auto it = s_jsonRpcHandlers.find(call.request.getMethod());
+    if (it == s_jsonRpcHandlers.end()) {
       throw JsonRpcError(JsonRpc::errMethodNotFound);
     }
 
@@ -182,19 +394,55 @@ bool RpcServer::processJsonRpcRequest(const HttpRequest& request, HttpResponse&
       throw JsonRpcError(CORE_RPC_ERROR_CODE_CORE_BUSY, "Core is busy");
     }
 
-    it->second.handler(this, jsonRequest, jsonResponse);
+    call.handler = &it->second;
 
+    auto cost = JSON_RPC_BATCH_CALL_COSTS.find(call.request.getMethod());
+    if (cost != JSON_RPC_BATCH_CALL_COSTS.end()) {
+      call.cost = cost->second;
+    }
+
+    auto policy = CACHED_RESPONSES.find(call.request.getMethod());
+    if (policy != CACHED_RESPONSES.end() && m_responseCache.isEnabled()) {
+      std::string cacheKey = call.request.getMethod() + '\n' + call.request.getCanonicalParams();
+      std::string result;
+      if (m_responseCache.get(cacheKey, result)) {
+        call.response.setRawResult(std::move(result));
+        return false;
+      }
+
+      call.cachePolicy = &policy->second;
+      call.cacheKey = std::move(cacheKey);
+      call.cacheVersion = m_responseCache.getVersion();
+    }
   } catch (const JsonRpcError& err) {
-    jsonResponse.setError(err);
+    call.response.setError(err);
+    return false;
   } catch (const std::exception& e) {
-    jsonResponse.setError(JsonRpcError(JsonRpc::errInternalError, e.what()));
+    call.response.setError(JsonRpcError(JsonRpc::errInternalError, e.what()));
+    return false;
   }
 
-  response.setBody(jsonResponse.getBody());
-  logger(TRACE) << "JSON-RPC response: " << jsonResponse.getBody();
   return true;
 }
 
+void RpcServer::invokeJsonRpcCall(JsonRpcCall& call) {
+  using namespace JsonRpc;
+
+  try {
+    call.handler->handler(this, call.request, call.response);
+  } catch (const JsonRpcError& err) {
+    call.response.setError(err);
+    return;
+  } catch (const std::exception& e) {
+    call.response.setError(JsonRpcError(JsonRpc::errInternalError, e.what()));
+    return;
+  }
+
+  if (call.cachePolicy != nullptr && !call.response.getRawResult().empty()) {
+    m_responseCache.put(call.cacheKey, *call.cachePolicy, call.cacheVersion, call.response.getRawResult());
+  }
+}
+
 bool RpcServer::restrictRPC(const bool is_restricted) {
   m_restricted_rpc = is_restricted;
   return true;
@@ -519,6 +767,38 @@ bool RpcServer::on_query_blocks_lite(const COMMAND_RPC_QUERY_BLOCKS_LITE::reques
   return true;
 }
 
+bool RpcServer::on_get_block_filters(const COMMAND_RPC_GET_BLOCK_FILTERS::request& req, COMMAND_RPC_GET_BLOCK_FILTERS::response& res) {
+  uint32_t startHeight;
+  uint32_t currentHeight;
+  uint32_t fullOffset;
+  if (!m_core.getBlockFilters(req.blockIds, req.timestamp, startHeight, currentHeight, fullOffset, res.items)) {
+    res.status = "Failed to perform query";
+    return false;
+  }
+
+  res.startHeight = startHeight;
+  res.currentHeight = currentHeight;
+  res.fullOffset = fullOffset;
+  res.status = CORE_RPC_STATUS_OK;
+  return true;
+}
+
+bool RpcServer::on_get_block_transaction_prefixes(const COMMAND_RPC_GET_BLOCK_TRANSACTION_PREFIXES::request& req, COMMAND_RPC_GET_BLOCK_TRANSACTION_PREFIXES::response& res) {
+  if (req.blockIds.size() > BLOCKS_SYNCHRONIZING_DEFAULT_COUNT) {
+    res.status = "Too many blocks requested";
+    return true;
+  }
+
+  if (!m_core.getBlockTransactionPrefixes(req.blockIds, res.items)) {
+    res.items.clear();
+    res.status = "Failed";
+    return true;
+  }
+
+  res.status = CORE_RPC_STATUS_OK;
+  return true;
+}
+
 bool RpcServer::setFeeAddress(const std::string& fee_address, const AccountPublicAddress& fee_acc) {
   m_fee_address = fee_address;
   m_fee_acc = fee_acc;
@@ -559,6 +839,30 @@ bool RpcServer::on_get_indexes(const COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES::
   return true;
 }
 
+bool RpcServer::on_get_txs_indexes(const COMMAND_RPC_GET_TXS_GLOBAL_OUTPUTS_INDEXES::request& req, COMMAND_RPC_GET_TXS_GLOBAL_OUTPUTS_INDEXES::response& res) {
+  if (req.txids.size() > COMMAND_RPC_GET_TXS_GLOBAL_OUTPUTS_INDEXES_MAX_COUNT) {
+    res.status = "Failed: too many transactions requested";
+    return true;
+  }
+
+  std::vector<uint32_t> outputIndexes;
+  res.txs.reserve(req.txids.size());
+  for (const auto& txid : req.txids) {
+    if (!m_core.get_tx_outputs_gindexs(txid, outputIndexes)) {
+      res.txs.clear();
+      res.status = "Failed";
+      return true;
+    }
+
+    res.txs.emplace_back();
+    res.txs.back().o_indexes.assign(outputIndexes.begin(), outputIndexes.end());
+  }
+
+  res.status = CORE_RPC_STATUS_OK;
+  logger(TRACE) << "COMMAND_RPC_GET_TXS_GLOBAL_OUTPUTS_INDEXES: [" << res.txs.size() << "]";
+  return true;
+}
+
 bool RpcServer::on_get_random_outs(const COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::request& req, COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::response& res) {
   res.status = "Failed";
   if (!m_core.get_random_outs_for_amounts(req, res)) {
@@ -567,6 +871,10 @@ bool RpcServer::on_get_random_outs(const COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOU
 
   res.status = CORE_RPC_STATUS_OK;
 
+  if (!logger.isEnabled(TRACE)) {
+    return true;
+  }
+
   std::stringstream ss;
   typedef COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount outs_for_amount;
   typedef COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::out_entry out_entry;
@@ -676,6 +984,12 @@ bool RpcServer::on_get_info(const COMMAND_RPC_GET_INFO::request& req, COMMAND_RP
   m_core.getBlockDifficulty(static_cast<uint32_t>(last_block_height), res.last_block_difficulty);
 
   res.connections = m_p2p.get_payload_object().all_connections();
+
+  RpcResponseCache::Stats cacheStats = m_responseCache.getStats();
+  res.rpc_cache_hits = cacheStats.hits;
+  res.rpc_cache_misses = cacheStats.misses;
+  res.rpc_cache_entries = cacheStats.entries;
+  res.rpc_cache_size = cacheStats.size;
   return true;
 }
 
@@ -853,6 +1167,50 @@ bool RpcServer::on_get_payment_id(const COMMAND_RPC_GEN_PAYMENT_ID::request& req
   res.payment_id = pid;
   return true;
 }
+
+bool RpcServer::on_get_rpc_stats(const COMMAND_RPC_GET_RPC_STATS::request& req, COMMAND_RPC_GET_RPC_STATS::response& res) {
+  res.worker_threads = m_workerPool.threadCount();
+  for (const auto& endpoint : m_workerPool.getStats()) {
+    rpc_endpoint_stats stats;
+    stats.endpoint = endpoint.first;
+    stats.calls = endpoint.second.calls;
+    stats.avg_queue_time = endpoint.second.calls == 0 ? 0 : endpoint.second.totalQueueTime / endpoint.second.calls;
+    stats.max_queue_time = endpoint.second.maxQueueTime;
+    stats.running = endpoint.second.running;
+    stats.waiting = endpoint.second.waiting;
+    res.endpoints.push_back(stats);
+  }
+
+  res.status = CORE_RPC_STATUS_OK;
+  return true;
+}
+
+bool RpcServer::on_wait_for_change(const COMMAND_RPC_WAIT_FOR_CHANGE::request& req, COMMAND_RPC_WAIT_FOR_CHANGE::response& res) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::min(req.timeout, COMMAND_RPC_WAIT_FOR_CHANGE_MAX_TIMEOUT));
+
+  Crypto::Hash topId;
+  for (;;) {
+    m_core.get_blockchain_top(res.height, topId);
+    res.tail_block_id = Common::podToHex(topId);
+    res.pool_version = m_changeNotifier.getPoolVersion();
+    if (res.tail_block_id != req.tail_block_id || (req.pool_version != 0 && res.pool_version != req.pool_version)) {
+      break;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (now >= deadline) {
+      break;
+    }
+
+    // too many requests wait already, this one gets the current state
+    if (!m_changeNotifier.wait(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now))) {
+      break;
+    }
+  }
+
+  res.status = CORE_RPC_STATUS_OK;
+  return true;
+}
 //------------------------------------------------------------------------------------------------------------------------------
 // JSON RPC methods
 //------------------------------------------------------------------------------------------------------------------------------
@@ -18,11 +18,16 @@
 #include "HttpServer.h"
 
 #include <functional>
+#include <map>
 #include <unordered_map>
 
 #include <Logging/LoggerRef.h>
 #include "Common/Math.h"
 #include "CoreRpcServerCommandsDefinitions.h"
+#include "JsonRpc.h"
+#include "RpcChangeNotifier.h"
+#include "RpcResponseCache.h"
+#include "RpcWorkerPool.h"
 
 namespace CryptoNote {
 
@@ -33,6 +38,7 @@ class ICryptoNoteProtocolQuery;
 class RpcServer : public HttpServer {
 public:
   RpcServer(System::Dispatcher& dispatcher, Logging::ILogger& log, core& c, NodeServer& p2p, const ICryptoNoteProtocolQuery& protocolQuery);
+  ~RpcServer();
   typedef std::function<bool(RpcServer*, const HttpRequest& request, HttpResponse& response)> HandlerFunction;
   bool setFeeAddress(const std::string& fee_address, const AccountPublicAddress& fee_acc);
   bool setViewKey(const std::string& view_key);
@@ -41,6 +47,10 @@ public:
   bool k_on_check_reserve_proof(const K_COMMAND_RPC_CHECK_RESERVE_PROOF::request& req, K_COMMAND_RPC_CHECK_RESERVE_PROOF::response& res);  
   bool enableCors(const std::string domain);  
   bool remotenode_check_incoming_tx(const BinaryArray& tx_blob);
+  // Read-only requests run on threadCount threads, the others stay on the dispatcher
+  void startWorkers(size_t threadCount, const std::map<std::string, size_t>& endpointLimits);
+  // 0 turns the response cache off
+  void setResponseCacheSize(size_t size);
 
 private:
 
@@ -48,20 +58,44 @@ private:
   struct RpcHandler {
     const Handler handler;
     const bool allowBusyCore;
+    // the handler only reads the blockchain and the pool, so it may run on a worker thread
+    const bool readOnly;
+  };
+
+  // a JSON-RPC request, on its own or as an element of a batch
+  struct JsonRpcCall {
+    JsonRpc::JsonRpcRequest request;
+    JsonRpc::JsonRpcResponse response;
+    const RpcHandler<JsonRpc::JsonMemberMethod>* handler = nullptr;
+    const RpcResponseCache::Policy* cachePolicy = nullptr;
+    std::string cacheKey;
+    RpcResponseCache::Version cacheVersion;
+    // lock cost when it runs in a batch
+    size_t cost = 1;
+    // no id, left out of a batch response
+    bool notification = false;
   };
 
   typedef void (RpcServer::*HandlerPtr)(const HttpRequest& request, HttpResponse& response);
   static std::unordered_map<std::string, RpcHandler<HandlerFunction>> s_handlers;
+  static std::unordered_map<std::string, RpcHandler<JsonRpc::JsonMemberMethod>> s_jsonRpcHandlers;
 
   virtual void processRequest(const HttpRequest& request, HttpResponse& response) override;
   bool processJsonRpcRequest(const HttpRequest& request, HttpResponse& response);
+  std::string processJsonRpcBatch(const Common::JsonValue& batch);
+  // false when the response is already complete, with an error or a cached result
+  bool prepareJsonRpcCall(const Common::JsonValue& body, JsonRpcCall& call);
+  void invokeJsonRpcCall(JsonRpcCall& call);
   bool isCoreReady();
 
   // binary handlers
   bool on_get_blocks(const COMMAND_RPC_GET_BLOCKS_FAST::request& req, COMMAND_RPC_GET_BLOCKS_FAST::response& res);
   bool on_query_blocks(const COMMAND_RPC_QUERY_BLOCKS::request& req, COMMAND_RPC_QUERY_BLOCKS::response& res);
   bool on_query_blocks_lite(const COMMAND_RPC_QUERY_BLOCKS_LITE::request& req, COMMAND_RPC_QUERY_BLOCKS_LITE::response& res);
+  bool on_get_block_filters(const COMMAND_RPC_GET_BLOCK_FILTERS::request& req, COMMAND_RPC_GET_BLOCK_FILTERS::response& res);
+  bool on_get_block_transaction_prefixes(const COMMAND_RPC_GET_BLOCK_TRANSACTION_PREFIXES::request& req, COMMAND_RPC_GET_BLOCK_TRANSACTION_PREFIXES::response& res);
   bool on_get_indexes(const COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES::request& req, COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES::response& res);
+  bool on_get_txs_indexes(const COMMAND_RPC_GET_TXS_GLOBAL_OUTPUTS_INDEXES::request& req, COMMAND_RPC_GET_TXS_GLOBAL_OUTPUTS_INDEXES::response& res);
   bool on_get_random_outs(const COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::request& req, COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::response& res);
   bool onGetPoolChanges(const COMMAND_RPC_GET_POOL_CHANGES::request& req, COMMAND_RPC_GET_POOL_CHANGES::response& rsp);
   bool onGetPoolChangesLite(const COMMAND_RPC_GET_POOL_CHANGES_LITE::request& req, COMMAND_RPC_GET_POOL_CHANGES_LITE::response& rsp);
@@ -78,6 +112,8 @@ private:
   bool on_get_fee_address(const COMMAND_RPC_GET_FEE_ADDRESS::request& req, COMMAND_RPC_GET_FEE_ADDRESS::response& res);
   bool on_alt_blocks_list_json(const COMMAND_RPC_GET_ALT_BLOCKS_LIST::request &req, COMMAND_RPC_GET_ALT_BLOCKS_LIST::response &res);
   bool on_get_payment_id(const COMMAND_RPC_GEN_PAYMENT_ID::request& req, COMMAND_RPC_GEN_PAYMENT_ID::response& res);
+  bool on_get_rpc_stats(const COMMAND_RPC_GET_RPC_STATS::request& req, COMMAND_RPC_GET_RPC_STATS::response& res);
+  bool on_wait_for_change(const COMMAND_RPC_WAIT_FOR_CHANGE::request& req, COMMAND_RPC_WAIT_FOR_CHANGE::response& res);
 
   // json rpc
   bool on_getblockcount(const COMMAND_RPC_GETBLOCKCOUNT::request& req, COMMAND_RPC_GETBLOCKCOUNT::response& res);
@@ -106,6 +142,9 @@ private:
   std::string m_fee_address;
   Crypto::SecretKey m_view_key = NULL_SECRET_KEY;
   AccountPublicAddress m_fee_acc; 
+  RpcWorkerPool m_workerPool;
+  RpcResponseCache m_responseCache;
+  RpcChangeNotifier m_changeNotifier;
 };
 
 }
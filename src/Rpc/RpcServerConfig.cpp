@@ -16,6 +16,9 @@
 // along with Fuego. If not, see <https://www.gnu.org/licenses/>.
 
 #include "RpcServerConfig.h"
+
+#include <stdexcept>
+
 #include "Common/CommandLine.h"
 #include "CryptoNoteConfig.h"
 
@@ -25,13 +28,36 @@ namespace CryptoNote {
 
     const std::string DEFAULT_RPC_IP = "127.0.0.1";
     const uint16_t DEFAULT_RPC_PORT = RPC_DEFAULT_PORT;
+    const size_t DEFAULT_RPC_THREADS = 2;
+    const size_t DEFAULT_RPC_CACHE_SIZE = 16;
 
     const command_line::arg_descriptor<std::string> arg_rpc_bind_ip = { "rpc-bind-ip", "", DEFAULT_RPC_IP };
     const command_line::arg_descriptor<uint16_t> arg_rpc_bind_port = { "rpc-bind-port", "", DEFAULT_RPC_PORT };
+    const command_line::arg_descriptor<size_t> arg_rpc_threads = { "rpc-threads", "Number of threads running read-only RPC requests, 0 runs them on the network thread", DEFAULT_RPC_THREADS };
+    const command_line::arg_descriptor<size_t> arg_rpc_cache_size = { "rpc-cache-size", "Megabytes of RPC responses kept until the blockchain changes, 0 disables the cache", DEFAULT_RPC_CACHE_SIZE };
+    const command_line::arg_descriptor<std::vector<std::string>> arg_rpc_endpoint_limit = { "rpc-endpoint-limit", "Maximum number of concurrent requests of an RPC endpoint, as <endpoint>=<count>" };
+
+    std::map<std::string, size_t> parseEndpointLimits(const std::vector<std::string>& values) {
+      std::map<std::string, size_t> limits;
+      for (const auto& value : values) {
+        size_t separator = value.rfind('=');
+        if (separator == 0 || separator == std::string::npos) {
+          throw std::runtime_error("Invalid RPC endpoint limit: " + value);
+        }
+
+        try {
+          limits[value.substr(0, separator)] = std::stoul(value.substr(separator + 1));
+        } catch (const std::logic_error&) {
+          throw std::runtime_error("Invalid RPC endpoint limit: " + value);
+        }
+      }
+
+      return limits;
+    }
   }
 
 
-  RpcServerConfig::RpcServerConfig() : bindIp(DEFAULT_RPC_IP), bindPort(DEFAULT_RPC_PORT) {
+  RpcServerConfig::RpcServerConfig() : bindIp(DEFAULT_RPC_IP), bindPort(DEFAULT_RPC_PORT), workerThreads(DEFAULT_RPC_THREADS), responseCacheSize(DEFAULT_RPC_CACHE_SIZE * 1024 * 1024) {
   }
 
   std::string RpcServerConfig::getBindAddress() const {
@@ -41,11 +67,17 @@ namespace CryptoNote {
   void RpcServerConfig::initOptions(boost::program_options::options_description& desc) {
     command_line::add_arg(desc, arg_rpc_bind_ip);
     command_line::add_arg(desc, arg_rpc_bind_port);
+    command_line::add_arg(desc, arg_rpc_threads);
+    command_line::add_arg(desc, arg_rpc_endpoint_limit);
+    command_line::add_arg(desc, arg_rpc_cache_size);
   }
 
   void RpcServerConfig::init(const boost::program_options::variables_map& vm)  {
     bindIp = command_line::get_arg(vm, arg_rpc_bind_ip);
     bindPort = command_line::get_arg(vm, arg_rpc_bind_port);
+    workerThreads = command_line::get_arg(vm, arg_rpc_threads);
+    endpointLimits = parseEndpointLimits(command_line::get_arg(vm, arg_rpc_endpoint_limit));
+    responseCacheSize = command_line::get_arg(vm, arg_rpc_cache_size) * 1024 * 1024;
   }
 
 }
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <map>
+
 #include <boost/program_options.hpp>
 
 namespace CryptoNote {
@@ -33,6 +35,9 @@ public:
 
   std::string bindIp;
   uint16_t bindPort;
+  size_t workerThreads;
+  std::map<std::string, size_t> endpointLimits;
+  size_t responseCacheSize;
 };
 
 }
@@ -0,0 +1,192 @@
+// Copyright (c) 2017-2022 Fuego Developers
+//
+// This file is part of Fuego.
+//
+// Fuego is free & open source software distributed in the hope
+// it will be useful, but WITHOUT ANY WARRANTY; without even an
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+// PURPOSE. You may redistribute it and/or modify it under the terms
+// of the GNU General Public License v3 or later versions as published
+// by the Free Software Foundation. Fuego includes elements written
+// by third parties. See file labeled LICENSE for more details.
+// You should have received a copy of the GNU General Public License
+// along with Fuego. If not, see <https://www.gnu.org/licenses/>.
+
+#include "RpcWorkerPool.h"
+
+#include <algorithm>
+#include <exception>
+#include <system_error>
+
+#include <System/InterruptedException.h>
+
+namespace CryptoNote {
+
+RpcWorkerPool::RpcWorkerPool(System::Dispatcher& dispatcher) : m_dispatcher(dispatcher), m_stopped(false) {
+}
+
+RpcWorkerPool::~RpcWorkerPool() {
+  stop();
+}
+
+void RpcWorkerPool::start(size_t threadCount) {
+  m_stopped = false;
+  for (size_t i = 0; i < threadCount; ++i) {
+    try {
+      m_threads.emplace_back(&RpcWorkerPool::workerProcedure, this);
+    } catch (const std::system_error&) {
+      // work with the threads we have
+      break;
+    }
+  }
+}
+
+void RpcWorkerPool::stop() {
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_stopped = true;
+  }
+
+  m_haveTask.notify_all();
+  for (auto& thread : m_threads) {
+    thread.join();
+  }
+
+  m_threads.clear();
+}
+
+size_t RpcWorkerPool::threadCount() const {
+  return m_threads.size();
+}
+
+void RpcWorkerPool::setEndpointLimit(const std::string& endpoint, size_t limit) {
+  m_endpoints[endpoint].limit = limit;
+}
+
+void RpcWorkerPool::run(const std::string& endpoint, const std::function<void()>& task) {
+  if (m_threads.empty()) {
+    task();
+    return;
+  }
+
+  Endpoint& state = m_endpoints[endpoint];
+  Clock::time_point queued = Clock::now();
+  acquire(state);
+
+  Clock::time_point started;
+  std::exception_ptr error;
+  System::Event done(m_dispatcher);
+
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_tasks.emplace_back([&] {
+      started = Clock::now();
+      try {
+        task();
+      } catch (...) {
+        error = std::current_exception();
+      }
+
+      // nothing of the request frame may be touched after this
+      System::Event* doneEvent = &done;
+      m_dispatcher.remoteSpawn([doneEvent] { doneEvent->set(); });
+    });
+  }
+
+  m_haveTask.notify_one();
+
+  // the task refers to this frame, so an interrupt is only passed on once it has finished
+  bool interrupted = false;
+  while (!done.get()) {
+    try {
+      done.wait();
+    } catch (System::InterruptedException&) {
+      interrupted = true;
+    }
+  }
+
+  release(state);
+
+  uint64_t queueTime = std::chrono::duration_cast<std::chrono::microseconds>(started - queued).count();
+  ++state.stats.calls;
+  state.stats.totalQueueTime += queueTime;
+  state.stats.maxQueueTime = std::max(state.stats.maxQueueTime, queueTime);
+
+  if (interrupted) {
+    m_dispatcher.interrupt();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+std::map<std::string, RpcWorkerPool::EndpointStats> RpcWorkerPool::getStats() const {
+  std::map<std::string, EndpointStats> stats;
+  for (const auto& endpoint : m_endpoints) {
+    stats.emplace(endpoint.first, endpoint.second.stats);
+  }
+
+  return stats;
+}
+
+void RpcWorkerPool::acquire(Endpoint& endpoint) {
+  if (endpoint.limit == 0 || endpoint.stats.running < endpoint.limit) {
+    ++endpoint.stats.running;
+    return;
+  }
+
+  System::Event slot(m_dispatcher);
+  endpoint.waiters.push_back(&slot);
+  ++endpoint.stats.waiting;
+
+  try {
+    slot.wait();
+  } catch (System::InterruptedException&) {
+    auto it = std::find(endpoint.waiters.begin(), endpoint.waiters.end(), &slot);
+    if (it != endpoint.waiters.end()) {
+      endpoint.waiters.erase(it);
+      --endpoint.stats.waiting;
+    } else {
+      // the slot was handed over already, pass it on
+      release(endpoint);
+    }
+
+    throw;
+  }
+
+  // the finished request left its running slot to this one
+}
+
+void RpcWorkerPool::release(Endpoint& endpoint) {
+  if (endpoint.waiters.empty()) {
+    --endpoint.stats.running;
+    return;
+  }
+
+  endpoint.waiters.front()->set();
+  endpoint.waiters.pop_front();
+  --endpoint.stats.waiting;
+}
+
+void RpcWorkerPool::workerProcedure() {
+  for (;;) {
+    std::function<void()> task;
+
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_haveTask.wait(lock, [this] { return m_stopped || !m_tasks.empty(); });
+      // queued tasks are run even when stopping, their request contexts wait for them
+      if (m_tasks.empty()) {
+        return;
+      }
+
+      task = std::move(m_tasks.front());
+      m_tasks.pop_front();
+    }
+
+    task();
+  }
+}
+
+}
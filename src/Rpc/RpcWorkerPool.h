@@ -0,0 +1,90 @@
+// Copyright (c) 2017-2022 Fuego Developers
+//
+// This file is part of Fuego.
+//
+// Fuego is free & open source software distributed in the hope
+// it will be useful, but WITHOUT ANY WARRANTY; without even an
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+// PURPOSE. You may redistribute it and/or modify it under the terms
+// of the GNU General Public License v3 or later versions as published
+// by the Free Software Foundation. Fuego includes elements written
+// by third parties. See file labeled LICENSE for more details.
+// You should have received a copy of the GNU General Public License
+// along with Fuego. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <System/Dispatcher.h>
+#include <System/Event.h>
+
+namespace CryptoNote {
+
+// Threads that run RPC handlers away from the dispatcher. A request context hands its handler over
+// and sleeps until a worker posts the completion back through the dispatcher.
+// Everything but the task queue belongs to the dispatcher thread.
+class RpcWorkerPool {
+public:
+  struct EndpointStats {
+    uint64_t calls = 0;
+    // time from the request reaching the pool until a worker picked it up, in microseconds
+    uint64_t totalQueueTime = 0;
+    uint64_t maxQueueTime = 0;
+    size_t running = 0;
+    size_t waiting = 0;
+  };
+
+  explicit RpcWorkerPool(System::Dispatcher& dispatcher);
+  ~RpcWorkerPool();
+
+  RpcWorkerPool(const RpcWorkerPool&) = delete;
+  RpcWorkerPool& operator=(const RpcWorkerPool&) = delete;
+
+  // 0 threads runs every task in the calling context
+  void start(size_t threadCount);
+  void stop();
+  size_t threadCount() const;
+
+  // At most limit tasks of the endpoint are queued or running at once, 0 means no limit
+  void setEndpointLimit(const std::string& endpoint, size_t limit);
+
+  // Runs task on a worker and suspends the calling context until it is done.
+  // An exception thrown by the task is rethrown here.
+  void run(const std::string& endpoint, const std::function<void()>& task);
+
+  std::map<std::string, EndpointStats> getStats() const;
+
+private:
+  typedef std::chrono::steady_clock Clock;
+
+  struct Endpoint {
+    size_t limit = 0;
+    EndpointStats stats;
+    std::deque<System::Event*> waiters;
+  };
+
+  void acquire(Endpoint& endpoint);
+  void release(Endpoint& endpoint);
+  void workerProcedure();
+
+  System::Dispatcher& m_dispatcher;
+  std::unordered_map<std::string, Endpoint> m_endpoints;
+  std::vector<std::thread> m_threads;
+
+  std::mutex m_mutex;
+  std::condition_variable m_haveTask;
+  std::deque<std::function<void()>> m_tasks;
+  bool m_stopped;
+};
+
+}
@@ -0,0 +1,236 @@
+// Copyright (c) 2017-2022 Fuego Developers
+//
+// This file is part of Fuego.
+//
+// Fuego is free & open source software distributed in the hope
+// it will be useful, but WITHOUT ANY WARRANTY; without even an
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+// PURPOSE. You may redistribute it and/or modify it under the terms
+// of the GNU General Public License v3 or later versions as published
+// by the Free Software Foundation. Fuego includes elements written
+// by third parties. See file labeled LICENSE for more details.
+// You should have received a copy of the GNU General Public License
+// along with Fuego. If not, see <https://www.gnu.org/licenses/>.
+
+#include "JsonOutputBufferSerializer.h"
+
+#include <cassert>
+#include <cstdio>
+
+using namespace CryptoNote;
+
+namespace {
+
+const char HEX_DIGITS[] = "0123456789abcdef";
+
+// characters that are written as they are: anything from the space up, except the quote and the backslash
+bool isPlain(char c) {
+  return static_cast<unsigned char>(c) >= 0x20 && c != '"' && c != '\\';
+}
+
+}
+
+JsonOutputBufferSerializer::JsonOutputBufferSerializer(std::string& buffer) : m_buffer(buffer) {
+}
+
+JsonOutputBufferSerializer::~JsonOutputBufferSerializer() {
+}
+
+ISerializer::SerializerType JsonOutputBufferSerializer::type() const {
+  return ISerializer::OUTPUT;
+}
+
+bool JsonOutputBufferSerializer::beginObject(Common::StringView name) {
+  writeName(name);
+  m_buffer += '{';
+  m_chain.push_back({ false, true });
+  return true;
+}
+
+void JsonOutputBufferSerializer::endObject() {
+  assert(!m_chain.empty() && !m_chain.back().isArray);
+  m_chain.pop_back();
+  m_buffer += '}';
+}
+
+bool JsonOutputBufferSerializer::beginArray(size_t& size, Common::StringView name) {
+  writeName(name);
+  m_buffer += '[';
+  m_chain.push_back({ true, true });
+  return true;
+}
+
+void JsonOutputBufferSerializer::endArray() {
+  assert(!m_chain.empty() && m_chain.back().isArray);
+  m_chain.pop_back();
+  m_buffer += ']';
+}
+
+// unsigned values are written as JsonOutputStreamSerializer writes them, as signed 64-bit integers
+bool JsonOutputBufferSerializer::operator()(uint64_t& value, Common::StringView name) {
+  writeName(name);
+  writeInteger(static_cast<int64_t>(value));
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(uint16_t& value, Common::StringView name) {
+  writeName(name);
+  writeInteger(value);
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(int16_t& value, Common::StringView name) {
+  writeName(name);
+  writeInteger(value);
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(uint32_t& value, Common::StringView name) {
+  writeName(name);
+  writeInteger(value);
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(int32_t& value, Common::StringView name) {
+  writeName(name);
+  writeInteger(value);
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(int64_t& value, Common::StringView name) {
+  writeName(name);
+  writeInteger(value);
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(uint8_t& value, Common::StringView name) {
+  writeName(name);
+  writeInteger(value);
+  return true;
+}
+
+// the format of Common::JsonValue: eleven decimals with the trailing zeros cut, but one
+bool JsonOutputBufferSerializer::operator()(double& value, Common::StringView name) {
+  writeName(name);
+
+  char text[352];
+  int size = snprintf(text, sizeof(text), "%.11f", value);
+  assert(size > 0 && static_cast<size_t>(size) < sizeof(text));
+  while (size > 1 && text[size - 2] != '.' && text[size - 1] == '0') {
+    --size;
+  }
+
+  m_buffer.append(text, size);
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(bool& value, Common::StringView name) {
+  writeName(name);
+  m_buffer += value ? "true" : "false";
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(std::string& value, Common::StringView name) {
+  writeName(name);
+  writeString(value.data(), value.size());
+  return true;
+}
+
+bool JsonOutputBufferSerializer::binary(void* value, size_t size, Common::StringView name) {
+  writeName(name);
+
+  size_t offset = m_buffer.size();
+  m_buffer.resize(offset + size * 2 + 2);
+  char* out = &m_buffer[offset];
+  *out++ = '"';
+  const uint8_t* data = static_cast<const uint8_t*>(value);
+  for (size_t i = 0; i < size; ++i) {
+    *out++ = HEX_DIGITS[data[i] >> 4];
+    *out++ = HEX_DIGITS[data[i] & 15];
+  }
+
+  *out = '"';
+  return true;
+}
+
+bool JsonOutputBufferSerializer::binary(std::string& value, Common::StringView name) {
+  return binary(const_cast<char*>(value.data()), value.size(), name);
+}
+
+void JsonOutputBufferSerializer::writeName(Common::StringView name) {
+  // the root value has no name
+  if (m_chain.empty()) {
+    return;
+  }
+
+  Level& level = m_chain.back();
+  if (!level.isEmpty) {
+    m_buffer += ',';
+  }
+
+  level.isEmpty = false;
+  if (!level.isArray) {
+    m_buffer += '"';
+    m_buffer.append(name.getData(), name.getSize());
+    m_buffer += "\":";
+  }
+}
+
+void JsonOutputBufferSerializer::writeInteger(int64_t value) {
+  char text[20];
+  char* end = text + sizeof(text);
+  char* begin = end;
+
+  // negated as unsigned, which also covers the smallest value
+  uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+  do {
+    *--begin = static_cast<char>('0' + magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude != 0);
+
+  if (value < 0) {
+    m_buffer += '-';
+  }
+
+  m_buffer.append(begin, end - begin);
+}
+
+void JsonOutputBufferSerializer::writeString(const char* data, size_t size) {
+  m_buffer += '"';
+
+  size_t plainBegin = 0;
+  for (size_t i = 0; i < size; ++i) {
+    char c = data[i];
+    if (isPlain(c)) {
+      continue;
+    }
+
+    m_buffer.append(data + plainBegin, i - plainBegin);
+    plainBegin = i + 1;
+
+    m_buffer += '\\';
+    switch (c) {
+    case '"':
+    case '\\':
+      m_buffer += c;
+      break;
+    case '\n':
+      m_buffer += 'n';
+      break;
+    case '\r':
+      m_buffer += 'r';
+      break;
+    case '\t':
+      m_buffer += 't';
+      break;
+    default:
+      m_buffer += "u00";
+      m_buffer += HEX_DIGITS[static_cast<unsigned char>(c) >> 4];
+      m_buffer += HEX_DIGITS[c & 15];
+      break;
+    }
+  }
+
+  m_buffer.append(data + plainBegin, size - plainBegin);
+  m_buffer += '"';
+}
@@ -50,6 +50,18 @@ void writeElementName(IOutputStream& s, Common::StringView name) {
   write(s, name.getData(), len);
 }
 
+size_t getArraySizeLength(size_t val) {
+  if (val <= 63) {
+    return sizeof(uint8_t);
+  } else if (val <= 16383) {
+    return sizeof(uint16_t);
+  } else if (val <= 1073741823) {
+    return sizeof(uint32_t);
+  } else {
+    return sizeof(uint64_t);
+  }
+}
+
 size_t writeArraySize(IOutputStream& s, size_t val) {
   if (val <= 63) {
     return packVarint<uint8_t>(s, PORTABLE_RAW_SIZE_MARK_BYTE, val);
@@ -87,6 +99,13 @@ void KVBinaryOutputStreamSerializer::dump(IOutputStream& target) {
   write(target, stream().data(), stream().size());
 }
 
+size_t KVBinaryOutputStreamSerializer::dumpSize() {
+  assert(m_objectsStack.size() == 1);
+  assert(m_stack.size() == 1);
+
+  return sizeof(KVBinaryStorageBlockHeader) + getArraySizeLength(m_stack.front().count) + stream().size();
+}
+
 ISerializer::SerializerType KVBinaryOutputStreamSerializer::type() const {
   return ISerializer::OUTPUT;
 }
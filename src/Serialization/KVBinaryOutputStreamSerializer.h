@@ -31,6 +31,8 @@ public:
   virtual ~KVBinaryOutputStreamSerializer() {}
 
   void dump(Common::IOutputStream& target);
+  // number of bytes dump writes
+  size_t dumpSize();
 
   virtual ISerializer::SerializerType type() const override;
 
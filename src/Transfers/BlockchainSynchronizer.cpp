@@ -45,7 +45,8 @@ BlockchainSynchronizer::BlockchainSynchronizer(INode& node, const Hash& genesisB
   m_node(node),
   m_genesisBlockHash(genesisBlockHash),
   m_currentState(State::stopped),
-  m_futureState(State::stopped) {
+  m_futureState(State::stopped),
+  m_blockFiltersEnabled(false) {
 }
 
 BlockchainSynchronizer::~BlockchainSynchronizer() {
@@ -70,9 +71,32 @@ bool BlockchainSynchronizer::removeConsumer(IBlockchainConsumer* consumer) {
     throw std::runtime_error("Can't remove consumer, because BlockchainSynchronizer isn't stopped");
   }
 
+  m_pausedConsumers.erase(consumer);
   return m_consumers.erase(consumer) > 0;
 }
 
+void BlockchainSynchronizer::pauseConsumer(IBlockchainConsumer* consumer) {
+  assert(consumer != nullptr);
+
+  // blocks and pool changes are handed out under this lock, none is underway once it is taken
+  std::unique_lock<std::mutex> lk(m_consumersMutex);
+  m_pausedConsumers.insert(consumer);
+}
+
+void BlockchainSynchronizer::resumeConsumer(IBlockchainConsumer* consumer) {
+  assert(consumer != nullptr);
+
+  {
+    std::unique_lock<std::mutex> lk(m_consumersMutex);
+    if (m_pausedConsumers.erase(consumer) == 0) {
+      return;
+    }
+  }
+
+  // fetch what the consumer missed meanwhile
+  setFutureState(State::blockchainSync);
+}
+
 IStreamSerializable* BlockchainSynchronizer::getConsumerState(IBlockchainConsumer* consumer) const {
   std::unique_lock<std::mutex> lk(m_consumersMutex);
   return getConsumerSynchronizationState(consumer);
@@ -89,6 +113,41 @@ std::vector<Crypto::Hash> BlockchainSynchronizer::getConsumerKnownBlocks(IBlockc
   return state->getKnownBlockHashes();
 }
 
+uint32_t BlockchainSynchronizer::getConsumerKnownBlocks(IBlockchainConsumer& consumer, uint32_t fromHeight, std::vector<Crypto::Hash>& blockHashes) const {
+  std::unique_lock<std::mutex> lk(m_consumersMutex);
+
+  auto state = getConsumerSynchronizationState(&consumer);
+  if (state == nullptr) {
+    throw std::invalid_argument("Consumer not found");
+  }
+
+  const auto& knownBlocks = state->getKnownBlockHashes();
+  uint32_t height = state->getHeight();
+  blockHashes.assign(knownBlocks.begin() + std::min(fromHeight, height), knownBlocks.end());
+  return height;
+}
+
+void BlockchainSynchronizer::setConsumerKnownBlocks(IBlockchainConsumer& consumer, uint32_t fromHeight, const std::vector<Crypto::Hash>& blockHashes) {
+  std::unique_lock<std::mutex> lk(m_consumersMutex);
+
+  auto state = getConsumerSynchronizationState(&consumer);
+  if (state == nullptr) {
+    throw std::invalid_argument("Consumer not found");
+  }
+
+  if (fromHeight == 0 || fromHeight > state->getHeight()) {
+    throw std::invalid_argument("Known blocks don't follow the consumer blockchain");
+  }
+
+  if (fromHeight < state->getHeight()) {
+    state->detach(fromHeight);
+  }
+
+  if (!blockHashes.empty()) {
+    state->addBlocks(blockHashes.data(), fromHeight, static_cast<uint32_t>(blockHashes.size()));
+  }
+}
+
 std::future<std::error_code> BlockchainSynchronizer::addUnconfirmedTransaction(const ITransactionReader& transaction) {
   std::unique_lock<std::mutex> lock(m_stateMutex);
 
@@ -122,9 +181,14 @@ std::future<void> BlockchainSynchronizer::removeUnconfirmedTransaction(const Cry
 std::error_code BlockchainSynchronizer::doAddUnconfirmedTransaction(const ITransactionReader& transaction) {
   std::unique_lock<std::mutex> lk(m_consumersMutex);
 
+  // a paused consumer picks the transaction up from the pool once resumed
   std::error_code ec;
   auto addIt = m_consumers.begin();
   for (; addIt != m_consumers.end(); ++addIt) {
+    if (m_pausedConsumers.count(addIt->first) != 0) {
+      continue;
+    }
+
     ec = addIt->first->addUnconfirmedTransaction(transaction);
     if (ec) {
       break;
@@ -134,6 +198,10 @@ std::error_code BlockchainSynchronizer::doAddUnconfirmedTransaction(const ITrans
   if (ec) {
     auto transactionHash = transaction.getTransactionHash();
     for (auto rollbackIt = m_consumers.begin(); rollbackIt != addIt; ++rollbackIt) {
+      if (m_pausedConsumers.count(rollbackIt->first) != 0) {
+        continue;
+      }
+
       rollbackIt->first->removeUnconfirmedTransaction(transactionHash);
     }
   }
@@ -145,6 +213,10 @@ void BlockchainSynchronizer::doRemoveUnconfirmedTransaction(const Crypto::Hash&
   std::unique_lock<std::mutex> lk(m_consumersMutex);
 
   for (auto& consumer : m_consumers) {
+    if (m_pausedConsumers.count(consumer.first) != 0) {
+      continue;
+    }
+
     consumer.first->removeUnconfirmedTransaction(transactionHash);
   }
 }
@@ -283,6 +355,10 @@ void BlockchainSynchronizer::stop() {
   workingThread.reset();
 }
 
+void BlockchainSynchronizer::setBlockFiltersEnabled(bool enabled) {
+  m_blockFiltersEnabled = enabled;
+}
+
 void BlockchainSynchronizer::localBlockchainUpdated(uint32_t /*height*/) {
   setFutureState(State::blockchainSync);
 }
@@ -299,13 +375,19 @@ void BlockchainSynchronizer::poolChanged() {
 void BlockchainSynchronizer::getPoolUnionAndIntersection(std::unordered_set<Crypto::Hash>& poolUnion, std::unordered_set<Crypto::Hash>& poolIntersection) const {
   std::unique_lock<std::mutex> lk(m_consumersMutex);
 
-  auto itConsumers = m_consumers.begin();
-  poolUnion = itConsumers->first->getKnownPoolTxIds();
-  poolIntersection = itConsumers->first->getKnownPoolTxIds();
-  ++itConsumers;
+  bool first = true;
+  for (auto itConsumers = m_consumers.begin(); itConsumers != m_consumers.end(); ++itConsumers) {
+    if (m_pausedConsumers.count(itConsumers->first) != 0) {
+      continue;
+    }
 
-  for (; itConsumers != m_consumers.end(); ++itConsumers) {
     const std::unordered_set<Crypto::Hash>& consumerKnownIds = itConsumers->first->getKnownPoolTxIds();
+    if (first) {
+      poolUnion = consumerKnownIds;
+      poolIntersection = consumerKnownIds;
+      first = false;
+      continue;
+    }
 
     poolUnion.insert(consumerKnownIds.begin(), consumerKnownIds.end());
 
@@ -326,20 +408,32 @@ BlockchainSynchronizer::GetBlocksRequest BlockchainSynchronizer::getCommonHistor
     return request;
   }
 
-  auto shortest = m_consumers.begin();
-  auto syncStart = shortest->first->getSyncStart();
-  auto it = shortest;
-  ++it;
-  for (; it != m_consumers.end(); ++it) {
+  auto shortest = m_consumers.end();
+  SynchronizationStart syncStart;
+  for (auto it = m_consumers.begin(); it != m_consumers.end(); ++it) {
+    if (m_pausedConsumers.count(it->first) != 0) {
+      continue;
+    }
+
+    auto consumerStart = it->first->getSyncStart();
+    if (shortest == m_consumers.end()) {
+      shortest = it;
+      syncStart = consumerStart;
+      continue;
+    }
+
     if (it->second->getHeight() < shortest->second->getHeight()) {
       shortest = it;
     }
 
-    auto consumerStart = it->first->getSyncStart();
     syncStart.timestamp = std::min(syncStart.timestamp, consumerStart.timestamp);
     syncStart.height = std::min(syncStart.height, consumerStart.height);
   }
 
+  if (shortest == m_consumers.end()) {
+    return request;
+  }
+
   request.knownBlocks = shortest->second->getShortHistory(m_node.getLastLocalBlockHeight());
   request.syncStart = syncStart;
   return request;
@@ -351,20 +445,17 @@ void BlockchainSynchronizer::startBlockchainSync() {
 
   try {
     if (!req.knownBlocks.empty()) {
-      auto queryBlocksCompleted = std::promise<std::error_code>();
-      auto queryBlocksWaitFuture = queryBlocksCompleted.get_future();
-
-      m_node.queryBlocks(
-        std::move(req.knownBlocks),
-        req.syncStart.timestamp,
-        response.newBlocks,
-        response.startHeight,
-        [&queryBlocksCompleted](std::error_code ec) {
-          auto detachedPromise = std::move(queryBlocksCompleted);
-          detachedPromise.set_value(ec);
-        });
-
-      std::error_code ec = queryBlocksWaitFuture.get();
+      std::error_code ec;
+      if (m_blockFiltersEnabled) {
+        ec = queryFilteredBlocksSync(req, response);
+        if (ec == std::errc::function_not_supported) {
+          m_blockFiltersEnabled = false;
+          response.newBlocks.clear();
+          ec = queryBlocksSync(std::move(req), response);
+        }
+      } else {
+        ec = queryBlocksSync(std::move(req), response);
+      }
 
       if (ec) {
         setFutureStateIf(State::idle, [this] { return m_futureState != State::stopped; });
@@ -379,6 +470,102 @@ void BlockchainSynchronizer::startBlockchainSync() {
   }
 }
 
+std::error_code BlockchainSynchronizer::queryBlocksSync(GetBlocksRequest&& request, GetBlocksResponse& response) {
+  auto queryBlocksCompleted = std::promise<std::error_code>();
+  auto queryBlocksWaitFuture = queryBlocksCompleted.get_future();
+
+  m_node.queryBlocks(
+    std::move(request.knownBlocks),
+    request.syncStart.timestamp,
+    response.newBlocks,
+    response.startHeight,
+    [&queryBlocksCompleted](std::error_code ec) {
+      auto detachedPromise = std::move(queryBlocksCompleted);
+      detachedPromise.set_value(ec);
+    });
+
+  return queryBlocksWaitFuture.get();
+}
+
+std::error_code BlockchainSynchronizer::queryFilteredBlocksSync(const GetBlocksRequest& request, GetBlocksResponse& response) {
+  std::vector<BlockFilterEntry> filters;
+  auto queryFiltersCompleted = std::promise<std::error_code>();
+  auto queryFiltersWaitFuture = queryFiltersCompleted.get_future();
+
+  m_node.queryBlockFilters(
+    std::vector<Hash>(request.knownBlocks),
+    request.syncStart.timestamp,
+    filters,
+    response.startHeight,
+    [&queryFiltersCompleted](std::error_code ec) {
+      auto detachedPromise = std::move(queryFiltersCompleted);
+      detachedPromise.set_value(ec);
+    });
+
+  std::error_code ec = queryFiltersWaitFuture.get();
+  if (ec) {
+    return ec;
+  }
+
+  // a block is fetched in full if any consumer needs it
+  std::vector<bool> neededBlocks(filters.size(), false);
+  if (!filters.empty()) {
+    std::unique_lock<std::mutex> lk(m_consumersMutex);
+    for (auto& kv : m_consumers) {
+      if (m_pausedConsumers.count(kv.first) != 0) {
+        continue;
+      }
+
+      kv.first->selectFilteredBlocks(filters.data(), response.startHeight, static_cast<uint32_t>(filters.size()), neededBlocks);
+    }
+  }
+
+  std::vector<Hash> neededBlockHashes;
+  for (size_t i = 0; i < filters.size(); ++i) {
+    if (neededBlocks[i] && filters[i].hasBlock) {
+      neededBlockHashes.push_back(filters[i].blockHash);
+    }
+  }
+
+  std::vector<std::vector<TransactionShortInfo>> transactions;
+  if (!neededBlockHashes.empty()) {
+    auto getTransactionsCompleted = std::promise<std::error_code>();
+    auto getTransactionsWaitFuture = getTransactionsCompleted.get_future();
+
+    m_node.getBlocksTransactions(neededBlockHashes, transactions, [&getTransactionsCompleted](std::error_code ec) {
+      auto detachedPromise = std::move(getTransactionsCompleted);
+      detachedPromise.set_value(ec);
+    });
+
+    ec = getTransactionsWaitFuture.get();
+    if (ec) {
+      return ec;
+    }
+
+    if (transactions.size() != neededBlockHashes.size()) {
+      return std::make_error_code(std::errc::invalid_argument);
+    }
+  }
+
+  auto blockTransactions = transactions.begin();
+  response.newBlocks.reserve(filters.size());
+  for (size_t i = 0; i < filters.size(); ++i) {
+    BlockShortEntry entry;
+    entry.blockHash = filters[i].blockHash;
+    entry.hasBlock = filters[i].hasBlock;
+    if (entry.hasBlock) {
+      entry.block = std::move(filters[i].block);
+      if (neededBlocks[i]) {
+        entry.txsShortInfo = std::move(*blockTransactions++);
+      }
+    }
+
+    response.newBlocks.push_back(std::move(entry));
+  }
+
+  return std::error_code();
+}
+
 void BlockchainSynchronizer::processBlocks(GetBlocksResponse& response) {
   BlockchainInterval interval;
   interval.startHeight = response.startHeight;
@@ -455,6 +642,10 @@ BlockchainSynchronizer::UpdateConsumersResult BlockchainSynchronizer::updateCons
   bool smthChanged = false;
 
   for (auto& kv : m_consumers) {
+    if (m_pausedConsumers.count(kv.first) != 0) {
+      continue;
+    }
+
     auto result = kv.second->checkInterval(interval);
 
     if (result.detachRequired) {
@@ -557,6 +748,10 @@ std::error_code BlockchainSynchronizer::processPoolTxs(GetPoolResponse& response
         return std::make_error_code(std::errc::interrupted);
       }
 
+      if (m_pausedConsumers.count(consumer.first) != 0) {
+        continue;
+      }
+
       error = consumer.first->onPoolUpdated(response.newTxs, response.deletedTxIds);
       if (error) {
         break;
@@ -571,7 +766,7 @@ std::error_code BlockchainSynchronizer::processPoolTxs(GetPoolResponse& response
 SynchronizationState* BlockchainSynchronizer::getConsumerSynchronizationState(IBlockchainConsumer* consumer) const {
   assert(consumer != nullptr);
 
-  if (!(checkIfStopped() && checkIfShouldStop())) {
+  if (!(checkIfStopped() && checkIfShouldStop()) && m_pausedConsumers.count(consumer) == 0) {
     throw std::runtime_error("Can't get consumer state, because BlockchainSynchronizer isn't stopped");
   }
 
@@ -27,6 +27,7 @@
 #include <mutex>
 #include <atomic>
 #include <future>
+#include <unordered_set>
 
 namespace CryptoNote {
 
@@ -43,6 +44,8 @@ public:
   virtual bool removeConsumer(IBlockchainConsumer* consumer) override;
   virtual IStreamSerializable* getConsumerState(IBlockchainConsumer* consumer) const override;
   virtual std::vector<Crypto::Hash> getConsumerKnownBlocks(IBlockchainConsumer& consumer) const override;
+  virtual uint32_t getConsumerKnownBlocks(IBlockchainConsumer& consumer, uint32_t fromHeight, std::vector<Crypto::Hash>& blockHashes) const override;
+  virtual void setConsumerKnownBlocks(IBlockchainConsumer& consumer, uint32_t fromHeight, const std::vector<Crypto::Hash>& blockHashes) override;
 
   virtual std::future<std::error_code> addUnconfirmedTransaction(const ITransactionReader& transaction) override;
   virtual std::future<void> removeUnconfirmedTransaction(const Crypto::Hash& transactionHash) override;
@@ -50,6 +53,15 @@ public:
   virtual void start() override;
   virtual void stop() override;
 
+  // A paused consumer gets no blocks or pool changes, so its state can be read and saved while the
+  // others keep synchronizing. It catches up once resumed.
+  void pauseConsumer(IBlockchainConsumer* consumer);
+  void resumeConsumer(IBlockchainConsumer* consumer);
+
+  // With block filters, only the blocks consumers select by their filters come with transactions.
+  // Turned off again if the node doesn't serve filters.
+  void setBlockFiltersEnabled(bool enabled);
+
   // IStreamSerializable
   virtual void save(std::ostream& os) override;
   virtual void load(std::istream& in) override;
@@ -103,6 +115,8 @@ private:
   void startPoolSync();
   void startBlockchainSync();
 
+  std::error_code queryBlocksSync(GetBlocksRequest&& request, GetBlocksResponse& response);
+  std::error_code queryFilteredBlocksSync(const GetBlocksRequest& request, GetBlocksResponse& response);
   void processBlocks(GetBlocksResponse& response);
   UpdateConsumersResult updateConsumers(const BlockchainInterval& interval, const std::vector<CompleteBlock>& blocks);
   std::error_code processPoolTxs(GetPoolResponse& response);
@@ -127,6 +141,7 @@ private:
   typedef std::map<IBlockchainConsumer*, std::shared_ptr<SynchronizationState>> ConsumersMap;
 
   ConsumersMap m_consumers;
+  std::unordered_set<IBlockchainConsumer*> m_pausedConsumers;
   INode& m_node;
   const Crypto::Hash m_genesisBlockHash;
 
@@ -134,6 +149,7 @@ private:
 
   State m_currentState;
   State m_futureState;
+  std::atomic<bool> m_blockFiltersEnabled;
   std::unique_ptr<std::thread> workingThread;
   std::list<std::pair<const ITransactionReader*, std::promise<std::error_code>>> m_addTransactionTasks;
   std::list<std::pair<const Crypto::Hash*, std::promise<void>>> m_removeTransactionTasks;
@@ -31,6 +31,7 @@
 
 namespace CryptoNote {
 
+struct BlockFilterEntry;
 struct CompleteBlock;
 
 class IBlockchainSynchronizerObserver {
@@ -48,6 +49,11 @@ public:
   virtual const std::unordered_set<Crypto::Hash>& getKnownPoolTxIds() const = 0;
   virtual void onBlockchainDetach(uint32_t height) = 0;
   virtual bool onNewBlocks(const CompleteBlock* blocks, uint32_t startHeight, uint32_t count) = 0;
+  // Sets neededBlocks[i] if the transactions of blocks[i] have to be fetched, judging by its filter alone.
+  // A consumer that can't tell keeps this default and gets every block in full.
+  virtual void selectFilteredBlocks(const BlockFilterEntry* blocks, uint32_t startHeight, uint32_t count, std::vector<bool>& neededBlocks) {
+    neededBlocks.assign(count, true);
+  }
   virtual std::error_code onPoolUpdated(const std::vector<std::unique_ptr<ITransactionReader>>& addedTransactions, const std::vector<Crypto::Hash>& deletedTransactions) = 0;
 
   virtual std::error_code addUnconfirmedTransaction(const ITransactionReader& transaction) = 0;
@@ -71,6 +77,11 @@ public:
   virtual bool removeConsumer(IBlockchainConsumer* consumer) = 0;
   virtual IStreamSerializable* getConsumerState(IBlockchainConsumer* consumer) const = 0;
   virtual std::vector<Crypto::Hash> getConsumerKnownBlocks(IBlockchainConsumer& consumer) const = 0;
+  // The known blocks from fromHeight on, fromHeight is lowered to the consumer height if above it.
+  // Returns the consumer height.
+  virtual uint32_t getConsumerKnownBlocks(IBlockchainConsumer& consumer, uint32_t fromHeight, std::vector<Crypto::Hash>& blockHashes) const = 0;
+  // Replaces the known blocks from fromHeight on, the genesis block stays
+  virtual void setConsumerKnownBlocks(IBlockchainConsumer& consumer, uint32_t fromHeight, const std::vector<Crypto::Hash>& blockHashes) = 0;
 
   virtual std::future<std::error_code> addUnconfirmedTransaction(const ITransactionReader& transaction) = 0;
   virtual std::future<void> removeUnconfirmedTransaction(const Crypto::Hash& transactionHash) = 0;
@@ -0,0 +1,86 @@
+// Copyright (c) 2017-2022 Fuego Developers
+//
+// This file is part of Fuego.
+//
+// Fuego is free software distributed in the hope that it
+// will be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+// PURPOSE. You can redistribute it and/or modify it under the terms
+// of the GNU General Public License v3 or later versions as published
+// by the Free Software Foundation. Fuego includes elements written
+// by third parties. See file labeled LICENSE for more details.
+// You should have received a copy of the GNU General Public License
+// along with Fuego. If not, see <https://www.gnu.org/licenses/>.
+
+#include "SharedTransfersSynchronizer.h"
+
+#include <cassert>
+
+#include "CryptoNoteCore/Currency.h"
+
+namespace CryptoNote {
+
+SharedTransfersSynchronizer::SharedTransfersSynchronizer(const Currency& currency, Logging::ILogger& logger, INode& node) :
+  m_blockchainSynchronizer(node, currency.genesisBlockHash()),
+  m_transfersSynchronizer(currency, logger, m_blockchainSynchronizer, node),
+  m_pauseCount(0),
+  m_started(false) {
+}
+
+SharedTransfersSynchronizer::~SharedTransfersSynchronizer() {
+  m_blockchainSynchronizer.stop();
+}
+
+BlockchainSynchronizer& SharedTransfersSynchronizer::getBlockchainSynchronizer() {
+  return m_blockchainSynchronizer;
+}
+
+TransfersSyncronizer& SharedTransfersSynchronizer::getTransfersSynchronizer() {
+  return m_transfersSynchronizer;
+}
+
+void SharedTransfersSynchronizer::pause() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  if (m_pauseCount++ == 0 && m_started) {
+    m_blockchainSynchronizer.stop();
+    m_started = false;
+  }
+}
+
+void SharedTransfersSynchronizer::resume() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  assert(m_pauseCount > 0);
+  if (--m_pauseCount == 0 && !m_started && m_transfersSynchronizer.hasSubscriptions()) {
+    m_blockchainSynchronizer.start();
+    m_started = true;
+  }
+}
+
+void SharedTransfersSynchronizer::pause(const Crypto::PublicKey& viewPublicKey) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  if (m_consumerPauseCounts[viewPublicKey]++ == 0) {
+    IBlockchainConsumer* consumer = m_transfersSynchronizer.getConsumer(viewPublicKey);
+    if (consumer != nullptr) {
+      m_blockchainSynchronizer.pauseConsumer(consumer);
+    }
+  }
+}
+
+void SharedTransfersSynchronizer::resume(const Crypto::PublicKey& viewPublicKey) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  auto it = m_consumerPauseCounts.find(viewPublicKey);
+  assert(it != m_consumerPauseCounts.end() && it->second > 0);
+  if (--it->second == 0) {
+    m_consumerPauseCounts.erase(it);
+    IBlockchainConsumer* consumer = m_transfersSynchronizer.getConsumer(viewPublicKey);
+    if (consumer != nullptr) {
+      m_blockchainSynchronizer.resumeConsumer(consumer);
+    }
+  }
+}
+
+}
@@ -0,0 +1,63 @@
+// Copyright (c) 2017-2022 Fuego Developers
+//
+// This file is part of Fuego.
+//
+// Fuego is free software distributed in the hope that it
+// will be useful, but WITHOUT ANY WARRANTY; without even the
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+// PURPOSE. You can redistribute it and/or modify it under the terms
+// of the GNU General Public License v3 or later versions as published
+// by the Free Software Foundation. Fuego includes elements written
+// by third parties. See file labeled LICENSE for more details.
+// You should have received a copy of the GNU General Public License
+// along with Fuego. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+
+#include "BlockchainSynchronizer.h"
+#include "TransfersSynchronizer.h"
+
+namespace CryptoNote {
+
+class Currency;
+class INode;
+
+// One block stream and one transfers synchronizer for every wallet container of a process.
+// Blocks are downloaded and their transactions parsed once, then handed to one consumer per
+// view key. Each tenant (one view key) keeps its own subscriptions and serialized state.
+//
+// The synchronizer has to be stopped while consumers are added or removed, so a tenant pauses
+// it around such changes. It runs whenever no tenant holds a pause and there is something to
+// scan. Tenants must be driven from one thread, and a view key may be served by one tenant at
+// a time.
+class SharedTransfersSynchronizer {
+public:
+  SharedTransfersSynchronizer(const Currency& currency, Logging::ILogger& logger, INode& node);
+  ~SharedTransfersSynchronizer();
+
+  BlockchainSynchronizer& getBlockchainSynchronizer();
+  TransfersSyncronizer& getTransfersSynchronizer();
+
+  // Stops the synchronizer for every container, it runs again once each pause is resumed
+  void pause();
+  void resume();
+
+  // Holds back only the consumer of one view key, so its container can be saved while the others keep
+  // synchronizing. Counted per view key like pause().
+  void pause(const Crypto::PublicKey& viewPublicKey);
+  void resume(const Crypto::PublicKey& viewPublicKey);
+
+private:
+  BlockchainSynchronizer m_blockchainSynchronizer;
+  TransfersSyncronizer m_transfersSynchronizer;
+
+  std::mutex m_mutex;
+  size_t m_pauseCount;
+  bool m_started;
+  std::unordered_map<Crypto::PublicKey, size_t> m_consumerPauseCounts;
+};
+
+}
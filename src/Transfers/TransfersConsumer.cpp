@@ -18,12 +18,17 @@
 
 #include "TransfersConsumer.h"
 
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <mutex>
 #include <numeric>
-#include <future>
+#include <sstream>
 
 #include "CommonTypes.h"
 #include "Common/StringTools.h"
-#include "Common/BlockingQueue.h"
+#include "CryptoNoteCore/BlockFilter.h"
 #include "CryptoNoteCore/CryptoNoteFormatUtils.h"
 #include "CryptoNoteCore/TransactionApi.h"
 #include "CryptoNoteCore/TransactionExtra.h"
@@ -44,23 +49,6 @@ namespace {
 
 using namespace CryptoNote;
 
-void checkOutputKey(
-  const KeyDerivation& derivation,
-  const PublicKey& key,
-  size_t keyIndex,
-  size_t outputIndex,
-  const std::unordered_set<PublicKey>& spendKeys,
-  std::unordered_map<PublicKey, std::vector<uint32_t>>& outputs) {
-
-  PublicKey spendKey;
-  underive_public_key(derivation, keyIndex, key, spendKey);
-
-  if (spendKeys.find(spendKey) != spendKeys.end()) {
-    outputs[spendKey].push_back(static_cast<uint32_t>(outputIndex));
-  }
-
-}
-
 void findMyOutputs(
   const ITransactionReader& tx,
   const SecretKey& viewSecretKey,
@@ -68,15 +56,14 @@ void findMyOutputs(
   std::unordered_map<PublicKey, std::vector<uint32_t>>& outputs) {
 
   auto txPublicKey = tx.getTransactionPublicKey();
-  KeyDerivation derivation;
-
-  if (!generate_key_derivation( txPublicKey, viewSecretKey, derivation)) {
-    return;
-  }
-
   size_t keyIndex = 0;
   size_t outputCount = tx.getOutputCount();
 
+  std::vector<OutputScanEntry> entries;
+  std::vector<uint32_t> entryOutputs;
+  entries.reserve(outputCount);
+  entryOutputs.reserve(outputCount);
+
   for (size_t idx = 0; idx < outputCount; ++idx) {
 
     auto outType = tx.getOutputType(size_t(idx));
@@ -86,7 +73,8 @@ void findMyOutputs(
       uint64_t amount;
       KeyOutput out;
       tx.getOutput(idx, out, amount);
-      checkOutputKey(derivation, out.key, keyIndex, idx, spendKeys, outputs);
+      entries.push_back({ txPublicKey, out.key, keyIndex });
+      entryOutputs.push_back(static_cast<uint32_t>(idx));
       ++keyIndex;
 
     } else if (outType == TransactionTypes::OutputType::Multisignature) {
@@ -95,11 +83,53 @@ void findMyOutputs(
       MultisignatureOutput out;
       tx.getOutput(idx, out, amount);
       for (const auto& key : out.keys) {
-        checkOutputKey(derivation, key, idx, idx, spendKeys, outputs);
+        entries.push_back({ txPublicKey, key, idx });
+        entryOutputs.push_back(static_cast<uint32_t>(idx));
         ++keyIndex;
      }
     }
   }
+
+  if (entries.empty()) {
+    return;
+  }
+
+  std::vector<PublicKey> spendKeysFound(entries.size());
+  std::unique_ptr<bool[]> valid(new bool[entries.size()]);
+  underive_public_keys(viewSecretKey, entries.data(), entries.size(), spendKeysFound.data(), valid.get());
+
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (valid[i] && spendKeys.find(spendKeysFound[i]) != spendKeys.end()) {
+      outputs[spendKeysFound[i]].push_back(entryOutputs[i]);
+    }
+  }
+}
+
+struct FilterScanEntry {
+  const TransactionFilterInfo* transaction;
+  size_t key;
+};
+
+// the same derivation indices findMyOutputs uses: a key output's position among all keys, a multisignature output's index
+void addFilterScanEntries(const TransactionFilterInfo& filter, std::vector<OutputScanEntry>& entries, std::vector<FilterScanEntry>& origins) {
+  if (filter.txPublicKey == NULL_PUBLIC_KEY) {
+    return;
+  }
+
+  auto multisignatureKey = filter.multisignatureKeys.begin();
+  for (size_t i = 0; i < filter.outputKeys.size(); ++i) {
+    bool isMultisignature = multisignatureKey != filter.multisignatureKeys.end() && *multisignatureKey == i;
+    if (isMultisignature) {
+      ++multisignatureKey;
+    }
+
+    entries.push_back({ filter.txPublicKey, filter.outputKeys[i], isMultisignature ? filter.outputIndexes[i] : i });
+    origins.push_back({ &filter, i });
+  }
+}
+
+bool isMultisignatureKey(const TransactionFilterInfo& filter, size_t key) {
+  return std::binary_search(filter.multisignatureKeys.begin(), filter.multisignatureKeys.end(), static_cast<uint32_t>(key));
 }
 
 std::vector<Crypto::Hash> getBlockHashes(const CryptoNote::CompleteBlock* blocks, size_t count) {
@@ -118,7 +148,14 @@ std::vector<Crypto::Hash> getBlockHashes(const CryptoNote::CompleteBlock* blocks
 namespace CryptoNote {
 
 TransfersConsumer::TransfersConsumer(const CryptoNote::Currency& currency, INode& node, Logging::ILogger& logger, const SecretKey& viewSecret) :
-  m_node(node), m_viewSecret(viewSecret), m_currency(currency), m_logger(logger, "TransfersConsumer") {
+  m_node(node), m_viewSecret(viewSecret), m_currency(currency), m_logger(logger, "TransfersConsumer"),
+  m_ownWorkerPool(new Tools::WorkerPool()), m_workerPool(*m_ownWorkerPool), m_batchGlobalIndicesSupported(true) {
+  updateSyncStart();
+}
+
+TransfersConsumer::TransfersConsumer(const CryptoNote::Currency& currency, INode& node, Logging::ILogger& logger, const SecretKey& viewSecret, Tools::WorkerPool& workerPool) :
+  m_node(node), m_viewSecret(viewSecret), m_currency(currency), m_logger(logger, "TransfersConsumer"), m_workerPool(workerPool),
+  m_batchGlobalIndicesSupported(true) {
   updateSyncStart();
 }
 
@@ -132,6 +169,7 @@ ITransfersSubscription& TransfersConsumer::addSubscription(const AccountSubscrip
   if (res.get() == nullptr) {
     res.reset(new TransfersSubscription(m_currency, subscription));
     m_spendKeys.insert(subscription.keys.address.spendPublicKey);
+    m_changedSubscriptions.insert(subscription.keys.address.spendPublicKey);
     updateSyncStart();
   }
 
@@ -141,6 +179,7 @@ ITransfersSubscription& TransfersConsumer::addSubscription(const AccountSubscrip
 bool TransfersConsumer::removeSubscription(const AccountPublicAddress& address) {
   m_subscriptions.erase(address.spendPublicKey);
   m_spendKeys.erase(address.spendPublicKey);
+  m_changedSubscriptions.erase(address.spendPublicKey);
   updateSyncStart();
   return m_subscriptions.empty();
 }
@@ -193,6 +232,7 @@ void TransfersConsumer::onBlockchainDetach(uint32_t height) {
 
   for (const auto& kv : m_subscriptions) {
     kv.second->onBlockchainDetach(height);
+    m_changedSubscriptions.insert(kv.first);
   }
 }
 
@@ -207,87 +247,93 @@ bool TransfersConsumer::onNewBlocks(const CompleteBlock* blocks, uint32_t startH
 
   struct PreprocessedTx : Tx, PreprocessInfo {};
 
-  std::vector<PreprocessedTx> preprocessedTransactions;
-  std::mutex preprocessedTransactionsMutex;
-
-  size_t workers = std::thread::hardware_concurrency();
-  if (workers == 0) {
-    workers = 2;
-  }
-
-  BlockingQueue<Tx> inputQueue(workers * 2);
-
+  // every block is preprocessed by one worker into its own slot, so the results
+  // come out in chain order without a lock or a sort
+  std::vector<std::vector<PreprocessedTx>> blockTransactions(count);
   std::atomic<bool> stopProcessing(false);
+  std::mutex processingErrorMutex;
+  std::error_code processingError;
 
-  auto pushingThread = std::async(std::launch::async, [&] {
-    for( uint32_t i = 0; i < count && !stopProcessing; ++i) {
-      const auto& block = blocks[i].block;
-
-      if (!block.is_initialized()) {
-        continue;
-      }
+  m_workerPool.run(count, [&](size_t i) {
+    const auto& block = blocks[i].block;
+    if (stopProcessing || !block.is_initialized()) {
+      return;
+    }
 
-      // filter by syncStartTimestamp
-      if (m_syncStart.timestamp && block->timestamp < m_syncStart.timestamp) {
-        continue;
-      }
+    // filter by syncStartTimestamp
+    if (m_syncStart.timestamp && block->timestamp < m_syncStart.timestamp) {
+      return;
+    }
 
-      TransactionBlockInfo blockInfo;
-      blockInfo.height = startHeight + i;
-      blockInfo.timestamp = block->timestamp;
-      blockInfo.transactionIndex = 0; // position in block
+    TransactionBlockInfo blockInfo;
+    blockInfo.height = startHeight + static_cast<uint32_t>(i);
+    blockInfo.timestamp = block->timestamp;
+    blockInfo.transactionIndex = 0; // position in block
 
+    std::error_code ec;
+    auto& output = blockTransactions[i];
+    try {
       for (const auto& tx : blocks[i].transactions) {
-        auto pubKey = tx->getTransactionPublicKey();
-        if (pubKey == NULL_PUBLIC_KEY) {
-          ++blockInfo.transactionIndex;
-          continue;
+        if (tx->getTransactionPublicKey() != NULL_PUBLIC_KEY) {
+          PreprocessedTx item;
+          item.blockInfo = blockInfo;
+          item.tx = tx.get();
+
+          ec = preprocessOutputs(blockInfo, *tx, item);
+          if (ec || stopProcessing) {
+            break;
+          }
+
+          output.push_back(std::move(item));
         }
 
-        Tx item = { blockInfo, tx.get() };
-        inputQueue.push(item);
         ++blockInfo.transactionIndex;
       }
+    } catch (const std::system_error& e) {
+      ec = e.code();
+    } catch (const std::exception&) {
+      ec = std::make_error_code(std::errc::operation_canceled);
     }
 
-    inputQueue.close();
-  });
-
-  auto processingFunction = [&] {
-    Tx item;
-    std::error_code ec;
-    while (!stopProcessing && inputQueue.pop(item)) {
-      PreprocessedTx output;
-      static_cast<Tx&>(output) = item;
-
-      ec = preprocessOutputs(item.blockInfo, *item.tx, output);
-      if (ec) {
-        stopProcessing = true;
-        break;
+    if (ec) {
+      stopProcessing = true;
+      std::lock_guard<std::mutex> lk(processingErrorMutex);
+      if (!processingError) {
+        processingError = ec;
       }
+    }
+  });
 
-      std::lock_guard<std::mutex> lk(preprocessedTransactionsMutex);
-      preprocessedTransactions.push_back(std::move(output));
+  std::vector<PreprocessedTx> preprocessedTransactions;
+  if (!processingError) {
+    size_t transactionCount = 0;
+    for (const auto& transactions : blockTransactions) {
+      transactionCount += transactions.size();
     }
-    return ec;
-  };
 
-  std::vector<std::future<std::error_code>> processingThreads;
-  for (size_t i = 0; i < workers; ++i) {
-    processingThreads.push_back(std::async(std::launch::async, processingFunction));
+    preprocessedTransactions.reserve(transactionCount);
+    for (auto& transactions : blockTransactions) {
+      std::move(transactions.begin(), transactions.end(), std::back_inserter(preprocessedTransactions));
+    }
   }
 
-  std::error_code processingError;
-  for (auto& f : processingThreads) {
-    try {
-      std::error_code ec = f.get();
-      if (!processingError && ec) {
-        processingError = ec;
+  // global output indices of every transaction that pays us, in one node request for the whole batch
+  if (!processingError) {
+    std::vector<Crypto::Hash> transactionHashes;
+    std::vector<PreprocessedTx*> paidTransactions;
+    for (auto& tx : preprocessedTransactions) {
+      if (!tx.outputs.empty()) {
+        transactionHashes.push_back(tx.tx->getTransactionHash());
+        paidTransactions.push_back(&tx);
+      }
+    }
+
+    if (!transactionHashes.empty()) {
+      std::vector<std::vector<uint32_t>> globalIdxs;
+      processingError = getGlobalIndices(transactionHashes, globalIdxs);
+      for (size_t i = 0; !processingError && i < paidTransactions.size(); ++i) {
+        processingError = assignGlobalIndices(*paidTransactions[i], std::move(globalIdxs[i]));
       }
-    } catch (const std::system_error& e) {
-      processingError = e.code();
-    } catch (const std::exception&) {
-      processingError = std::make_error_code(std::errc::operation_canceled);
     }
   }
 
@@ -295,18 +341,15 @@ bool TransfersConsumer::onNewBlocks(const CompleteBlock* blocks, uint32_t startH
   if (!processingError) {
     m_observerManager.notify(&IBlockchainConsumerObserver::onBlocksAdded, this, blockHashes);
 
-    // sort by block height and transaction index in block
-    std::sort(preprocessedTransactions.begin(), preprocessedTransactions.end(), [](const PreprocessedTx& a, const PreprocessedTx& b) {
-      return std::tie(a.blockInfo.height, a.blockInfo.transactionIndex) < std::tie(b.blockInfo.height, b.blockInfo.transactionIndex);
-    });
-
     for (const auto& tx : preprocessedTransactions) {
       processTransaction(tx.blockInfo, *tx.tx, tx);
     }
   } else {
-    forEachSubscription([&](TransfersSubscription& sub) {
-      sub.onError(processingError, startHeight);
-    });
+    for (const auto& kv : m_subscriptions) {
+      // the error detaches the container
+      kv.second->onError(processingError, startHeight);
+      m_changedSubscriptions.insert(kv.first);
+    }
 
     return false;
   }
@@ -319,6 +362,83 @@ bool TransfersConsumer::onNewBlocks(const CompleteBlock* blocks, uint32_t startH
   return true;
 }
 
+void TransfersConsumer::selectFilteredBlocks(const BlockFilterEntry* blocks, uint32_t startHeight, uint32_t count, std::vector<bool>& neededBlocks) {
+  assert(neededBlocks.size() == count);
+
+  std::vector<Hash> spendTags;
+  for (const auto& kv : m_subscriptions) {
+    std::vector<KeyImage> keyImages;
+    std::vector<std::pair<uint64_t, uint32_t>> multisignatureOutputs;
+    kv.second->getOutputsAwaitingSpend(keyImages, multisignatureOutputs);
+
+    for (const auto& keyImage : keyImages) {
+      spendTags.push_back(getSpendTag(keyImage));
+    }
+
+    for (const auto& output : multisignatureOutputs) {
+      spendTags.push_back(getSpendTag(output.first, output.second));
+    }
+  }
+
+  // the spend of a multisignature output can't be recognized before its global index is known,
+  // so every block after one that pays us with it is fetched in full
+  bool receivedMultisignature = false;
+  for (uint32_t i = 0; i < count; ++i) {
+    const auto& entry = blocks[i];
+    if (!entry.hasBlock || (m_syncStart.timestamp && entry.block.timestamp < m_syncStart.timestamp)) {
+      continue;
+    }
+
+    if (receivedMultisignature) {
+      neededBlocks[i] = true;
+      continue;
+    }
+
+    // the coinbase comes with the block, it only matters for the key images of what it pays us
+    TransactionFilterInfo baseFilter = getTransactionFilterInfo(entry.block.baseTransaction);
+    std::vector<OutputScanEntry> scanEntries;
+    std::vector<FilterScanEntry> origins;
+    addFilterScanEntries(baseFilter, scanEntries, origins);
+    for (const auto& filter : entry.txFilters) {
+      addFilterScanEntries(filter, scanEntries, origins);
+    }
+
+    bool needed = false;
+    if (!scanEntries.empty()) {
+      std::vector<PublicKey> spendKeysFound(scanEntries.size());
+      std::unique_ptr<bool[]> valid(new bool[scanEntries.size()]);
+      underive_public_keys(m_viewSecret, scanEntries.data(), scanEntries.size(), spendKeysFound.data(), valid.get());
+
+      for (size_t j = 0; j < scanEntries.size(); ++j) {
+        if (!valid[j] || m_spendKeys.count(spendKeysFound[j]) == 0) {
+          continue;
+        }
+
+        const auto& origin = origins[j];
+        needed = needed || origin.transaction != &baseFilter;
+        if (isMultisignatureKey(*origin.transaction, origin.key)) {
+          receivedMultisignature = true;
+          continue;
+        }
+
+        const auto& keys = m_subscriptions[spendKeysFound[j]]->getKeys();
+        if (keys.spendSecretKey != NULL_SECRET_KEY) {
+          KeyPair ephemeral;
+          KeyImage keyImage;
+          generate_key_image_helper(keys, origin.transaction->txPublicKey, origin.transaction->outputIndexes[origin.key], ephemeral, keyImage);
+          spendTags.push_back(getSpendTag(keyImage));
+        }
+      }
+    }
+
+    if (!needed && !entry.txFilters.empty()) {
+      needed = spendFilterMatchesAny(entry.spendFilter, entry.blockHash, spendTags);
+    }
+
+    neededBlocks[i] = neededBlocks[i] || needed;
+  }
+}
+
 std::error_code TransfersConsumer::onPoolUpdated(const std::vector<std::unique_ptr<ITransactionReader>>& addedTransactions, const std::vector<Hash>& deletedTransactions) {
   TransactionBlockInfo unconfirmedBlockInfo;
   unconfirmedBlockInfo.timestamp = 0; 
@@ -342,7 +462,9 @@ std::error_code TransfersConsumer::onPoolUpdated(const std::vector<std::unique_p
 
     m_observerManager.notify(&IBlockchainConsumerObserver::onTransactionDeleteBegin, this, deletedTxHash);
     for (auto& sub : m_subscriptions) {
-      sub.second->deleteUnconfirmedTransaction(*reinterpret_cast<const Hash*>(&deletedTxHash));
+      if (sub.second->deleteUnconfirmedTransaction(*reinterpret_cast<const Hash*>(&deletedTxHash))) {
+        m_changedSubscriptions.insert(sub.first);
+      }
     }
 
     m_observerManager.notify(&IBlockchainConsumerObserver::onTransactionDeleteEnd, this, deletedTxHash);
@@ -367,7 +489,9 @@ std::error_code TransfersConsumer::addUnconfirmedTransaction(const ITransactionR
 void TransfersConsumer::removeUnconfirmedTransaction(const Crypto::Hash& transactionHash) {
   m_observerManager.notify(&IBlockchainConsumerObserver::onTransactionDeleteBegin, this, transactionHash);
   for (auto& subscription : m_subscriptions) {
-    subscription.second->deleteUnconfirmedTransaction(transactionHash);
+    if (subscription.second->deleteUnconfirmedTransaction(transactionHash)) {
+      m_changedSubscriptions.insert(subscription.first);
+    }
   }
   m_observerManager.notify(&IBlockchainConsumerObserver::onTransactionDeleteEnd, this, transactionHash);
 }
@@ -377,13 +501,96 @@ void TransfersConsumer::addPublicKeysSeen(const Crypto::Hash& transactionHash, c
     transactions_hash_seen.insert(transactionHash);
     public_keys_seen.insert(outputKey);
 }	
+
+void TransfersConsumer::saveChanges(ISerializer& s) {
+  size_t count = m_changedSubscriptions.size();
+  s.beginArray(count, "subscriptions");
+  for (const auto& spendKey : m_changedSubscriptions) {
+    auto& subscription = *m_subscriptions.at(spendKey);
+    AccountPublicAddress address = subscription.getAddress();
+    std::stringstream stream;
+    subscription.getContainer().saveChanges(stream);
+    std::string changes = stream.str();
+
+    s.beginObject("");
+    s(address, "address");
+    s(changes, "changes");
+    s.endObject();
+  }
+
+  s.endArray();
+}
+
+void TransfersConsumer::loadChanges(ISerializer& s, uint32_t containerHeight) {
+  std::vector<std::pair<TransfersSubscription*, std::string>> changes;
+  size_t count = 0;
+  s.beginArray(count, "subscriptions");
+  while (count--) {
+    AccountPublicAddress address;
+    std::string subscriptionChanges;
+    s.beginObject("");
+    s(address, "address");
+    s(subscriptionChanges, "changes");
+    s.endObject();
+
+    // an address removed since is skipped
+    auto it = m_subscriptions.find(address.spendPublicKey);
+    if (it != m_subscriptions.end()) {
+      changes.emplace_back(it->second.get(), std::move(subscriptionChanges));
+    }
+  }
+
+  s.endArray();
+
+  std::vector<std::pair<TransfersSubscription*, std::string>> replaced;
+  try {
+    for (const auto& change : changes) {
+      std::stringstream stream(change.second);
+      std::stringstream previous;
+      change.first->getContainer().loadChanges(stream, previous);
+      replaced.emplace_back(change.first, previous.str());
+    }
+  } catch (...) {
+    for (auto it = replaced.rbegin(); it != replaced.rend(); ++it) {
+      std::stringstream stream(it->second);
+      std::stringstream previous;
+      it->first->getContainer().loadChanges(stream, previous);
+    }
+
+    throw;
+  }
+
+  std::unordered_set<TransfersSubscription*> changedSubscriptions;
+  for (const auto& change : changes) {
+    changedSubscriptions.insert(change.first);
+  }
+
+  for (const auto& kv : m_subscriptions) {
+    if (changedSubscriptions.count(kv.second.get()) == 0) {
+      kv.second->getContainer().restoreHeight(containerHeight);
+    }
+  }
+}
+
+void TransfersConsumer::clearChanges() {
+  for (const auto& spendKey : m_changedSubscriptions) {
+    m_subscriptions.at(spendKey)->getContainer().clearChanges();
+  }
+
+  m_changedSubscriptions.clear();
+}
+
+void TransfersConsumer::copyContainers(std::vector<std::pair<AccountPublicAddress, std::unique_ptr<TransfersContainer>>>& containers) {
+  for (const auto& kv : m_subscriptions) {
+    containers.emplace_back(kv.second->getAddress(), std::unique_ptr<TransfersContainer>(new TransfersContainer(kv.second->getContainer())));
+  }
+}
 	
 std::error_code createTransfers(
   const AccountKeys& account,
   const TransactionBlockInfo& blockInfo,
   const ITransactionReader& tx,
   const std::vector<uint32_t>& outputs,
-  const std::vector<uint32_t>& globalIdxs,
   std::vector<TransactionOutputInformationIn>& transfers) {
 
   auto txPubKey = tx.getTransactionPublicKey();
@@ -421,8 +628,7 @@ std::error_code createTransfers(
     info.type = outType;
     info.transactionPublicKey = txPubKey;
     info.outputInTransaction = idx;
-    info.globalOutputIndex = (blockInfo.height == WALLET_UNCONFIRMED_TRANSACTION_HEIGHT) ?
-      UNCONFIRMED_TRANSACTION_GLOBAL_OUTPUT_INDEX : globalIdxs[idx];
+    info.globalOutputIndex = UNCONFIRMED_TRANSACTION_GLOBAL_OUTPUT_INDEX;
 
     if (outType == TransactionTypes::OutputType::Key) {
       uint64_t amount;
@@ -504,20 +710,12 @@ std::error_code TransfersConsumer::preprocessOutputs(const TransactionBlockInfo&
   }
 
   std::error_code errorCode;
-  auto txHash = tx.getTransactionHash();
-  if (blockInfo.height != WALLET_UNCONFIRMED_TRANSACTION_HEIGHT) {
-    errorCode = getGlobalIndices(reinterpret_cast<const Hash&>(txHash), info.globalIdxs);
-    if (errorCode) {
-      return errorCode;
-    }
-  }
-
   for (const auto& kv : outputs) {
     auto it = m_subscriptions.find(kv.first);
     if (it != m_subscriptions.end()) {
       auto& transfers = info.outputs[kv.first];
        try {
-		  errorCode = createTransfers(it->second->getKeys(), blockInfo, tx, kv.second, info.globalIdxs, transfers);
+		  errorCode = createTransfers(it->second->getKeys(), blockInfo, tx, kv.second, transfers);
 		  if (errorCode) {
 			  return errorCode;
 		  }
@@ -532,6 +730,22 @@ std::error_code TransfersConsumer::preprocessOutputs(const TransactionBlockInfo&
   return std::error_code();
 }
 
+// transfers are created with UNCONFIRMED_TRANSACTION_GLOBAL_OUTPUT_INDEX, confirmed ones get their indices here
+std::error_code TransfersConsumer::assignGlobalIndices(PreprocessInfo& info, std::vector<uint32_t>&& globalIdxs) {
+  for (auto& kv : info.outputs) {
+    for (auto& output : kv.second) {
+      if (output.outputInTransaction >= globalIdxs.size()) {
+        return std::make_error_code(std::errc::argument_out_of_domain);
+      }
+
+      output.globalOutputIndex = globalIdxs[output.outputInTransaction];
+    }
+  }
+
+  info.globalIdxs = std::move(globalIdxs);
+  return std::error_code();
+}
+
 std::error_code TransfersConsumer::processTransaction(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx) {
   PreprocessInfo info;
   auto ec = preprocessOutputs(blockInfo, tx, info);
@@ -539,6 +753,18 @@ std::error_code TransfersConsumer::processTransaction(const TransactionBlockInfo
     return ec;
   }
 
+  if (blockInfo.height != WALLET_UNCONFIRMED_TRANSACTION_HEIGHT && !info.outputs.empty()) {
+    std::vector<uint32_t> globalIdxs;
+    ec = getGlobalIndices(tx.getTransactionHash(), globalIdxs);
+    if (!ec) {
+      ec = assignGlobalIndices(info, std::move(globalIdxs));
+    }
+
+    if (ec) {
+      return ec;
+    }
+  }
+
   processTransaction(blockInfo, tx, info);
   return std::error_code();
 }
@@ -555,6 +781,9 @@ void TransfersConsumer::processTransaction(const TransactionBlockInfo& blockInfo
     bool containerUpdated;
     processOutputs(blockInfo, *kv.second, tx, subscriptionOutputs, info.globalIdxs, containerContainsTx, containerUpdated);
     someContainerUpdated = someContainerUpdated || containerUpdated;
+    if (containerUpdated) {
+      m_changedSubscriptions.insert(kv.first);
+    }
     if (containerContainsTx) {
       transactionContainers.emplace_back(&kv.second->getContainer());
     }
@@ -602,4 +831,42 @@ std::error_code TransfersConsumer::getGlobalIndices(const Hash& transactionHash,
   return f.get();
 }
 
+std::error_code TransfersConsumer::getGlobalIndices(const std::vector<Hash>& transactionHashes, std::vector<std::vector<uint32_t>>& outsGlobalIndices) {
+  if (m_batchGlobalIndicesSupported) {
+    std::promise<std::error_code> prom;
+    std::future<std::error_code> f = prom.get_future();
+
+    INode::Callback cb = [&prom](std::error_code ec) {
+      std::promise<std::error_code> p(std::move(prom));
+      p.set_value(ec);
+    };
+
+    outsGlobalIndices.clear();
+    m_node.getTransactionsOutsGlobalIndices(transactionHashes, outsGlobalIndices, cb);
+
+    std::error_code ec = f.get();
+    if (ec != std::errc::function_not_supported) {
+      if (!ec && outsGlobalIndices.size() != transactionHashes.size()) {
+        ec = std::make_error_code(std::errc::result_out_of_range);
+      }
+
+      return ec;
+    }
+
+    m_logger(Logging::INFO) << "Node doesn't support batch requests for global output indices, requesting them one transaction at a time";
+    m_batchGlobalIndicesSupported = false;
+  }
+
+  // a node from before the batch request
+  outsGlobalIndices.assign(transactionHashes.size(), std::vector<uint32_t>());
+  for (size_t i = 0; i < transactionHashes.size(); ++i) {
+    std::error_code ec = getGlobalIndices(transactionHashes[i], outsGlobalIndices[i]);
+    if (ec) {
+      return ec;
+    }
+  }
+
+  return std::error_code();
+}
+
 }
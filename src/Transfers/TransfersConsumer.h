@@ -23,10 +23,12 @@
 #include "TypeHelpers.h"
 
 #include "crypto/crypto.h"
+#include "Common/WorkerPool.h"
 #include "Logging/LoggerRef.h"
 
 #include "IObservableImpl.h"
 
+#include <memory>
 #include <unordered_set>
 
 namespace CryptoNote {
@@ -37,6 +39,8 @@ class TransfersConsumer: public IObservableImpl<IBlockchainConsumerObserver, IBl
 public:
 
   TransfersConsumer(const CryptoNote::Currency& currency, INode& node, Logging::ILogger& logger, const Crypto::SecretKey& viewSecret);
+  // blocks are preprocessed on workerPool, which may be shared with other consumers
+  TransfersConsumer(const CryptoNote::Currency& currency, INode& node, Logging::ILogger& logger, const Crypto::SecretKey& viewSecret, Tools::WorkerPool& workerPool);
 
   ITransfersSubscription& addSubscription(const AccountSubscription& subscription);
   // returns true if no subscribers left
@@ -46,11 +50,21 @@ public:
 
   void initTransactionPool(const std::unordered_set<Crypto::Hash>& uncommitedTransactions);
   void addPublicKeysSeen(const Crypto::Hash& transactionHash, const Crypto::PublicKey& outputKey);
+
+  // Journal records: the changes of the subscriptions whose containers changed since clearChanges(), new
+  // subscriptions included. The containers of the others just follow the consumer to containerHeight,
+  // loadChanges moves them there. It leaves every container as it was if it throws.
+  void saveChanges(ISerializer& s);
+  void loadChanges(ISerializer& s, uint32_t containerHeight);
+  void clearChanges();
+  // copies of the subscription containers, to be saved while the consumer goes on
+  void copyContainers(std::vector<std::pair<AccountPublicAddress, std::unique_ptr<TransfersContainer>>>& containers);
   
   // IBlockchainConsumer
   virtual SynchronizationStart getSyncStart() override;
   virtual void onBlockchainDetach(uint32_t height) override;
   virtual bool onNewBlocks(const CompleteBlock* blocks, uint32_t startHeight, uint32_t count) override;
+  virtual void selectFilteredBlocks(const BlockFilterEntry* blocks, uint32_t startHeight, uint32_t count, std::vector<bool>& neededBlocks) override;
   virtual std::error_code onPoolUpdated(const std::vector<std::unique_ptr<ITransactionReader>>& addedTransactions, const std::vector<Crypto::Hash>& deletedTransactions) override;
   virtual const std::unordered_set<Crypto::Hash>& getKnownPoolTxIds() const override;
 
@@ -72,12 +86,14 @@ private:
   };
 
   std::error_code preprocessOutputs(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx, PreprocessInfo& info);
+  static std::error_code assignGlobalIndices(PreprocessInfo& info, std::vector<uint32_t>&& globalIdxs);
   std::error_code processTransaction(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx);
   void processTransaction(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx, const PreprocessInfo& info);
   void processOutputs(const TransactionBlockInfo& blockInfo, TransfersSubscription& sub, const ITransactionReader& tx,
     const std::vector<TransactionOutputInformationIn>& outputs, const std::vector<uint32_t>& globalIdxs, bool& contains, bool& updated);
 
   std::error_code getGlobalIndices(const Crypto::Hash& transactionHash, std::vector<uint32_t>& outsGlobalIndices);
+  std::error_code getGlobalIndices(const std::vector<Crypto::Hash>& transactionHashes, std::vector<std::vector<uint32_t>>& outsGlobalIndices);
 
   void updateSyncStart();
 
@@ -86,11 +102,17 @@ private:
   // map { spend public key -> subscription }
   std::unordered_map<Crypto::PublicKey, std::unique_ptr<TransfersSubscription>> m_subscriptions;
   std::unordered_set<Crypto::PublicKey> m_spendKeys;
+  // spend keys of the subscriptions whose containers changed since clearChanges()
+  std::unordered_set<Crypto::PublicKey> m_changedSubscriptions;
   std::unordered_set<Crypto::Hash> m_poolTxs;
 
   INode& m_node;
   const CryptoNote::Currency& m_currency;
   Logging::LoggerRef m_logger;
+
+  std::unique_ptr<Tools::WorkerPool> m_ownWorkerPool;
+  Tools::WorkerPool& m_workerPool;
+  bool m_batchGlobalIndicesSupported;
 };
 
 }
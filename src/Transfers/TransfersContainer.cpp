@@ -16,6 +16,9 @@
 // along with Fuego. If not, see <https://www.gnu.org/licenses/>.
 
 #include "TransfersContainer.h"
+
+#include <algorithm>
+
 #include "IWalletLegacy.h"
 #include "Common/StdInputStream.h"
 #include "Common/StdOutputStream.h"
@@ -44,6 +47,28 @@ void serialize(TransactionInformation& ti, CryptoNote::ISerializer& s) {
 
 const uint32_t TRANSFERS_CONTAINER_STORAGE_VERSION = 1;
 
+struct TransfersContainer::TransactionChanges {
+  Crypto::Hash transactionHash;
+  // false once the transaction is gone, then it has no transfers either
+  bool exists;
+  TransactionInformation transaction;
+  std::vector<TransactionOutputInformationEx> unconfirmedTransfers;
+  std::vector<TransactionOutputInformationEx> availableTransfers;
+  std::vector<SpentTransactionOutput> spentTransfers;
+
+  void serialize(ISerializer& s) {
+    s(transactionHash, "transactionHash");
+    s(exists, "exists");
+    if (exists) {
+      s(transaction, "transaction");
+    }
+
+    s(unconfirmedTransfers, "unconfirmedTransfers");
+    s(availableTransfers, "availableTransfers");
+    s(spentTransfers, "spentTransfers");
+  }
+};
+
 namespace {
   template<typename TIterator>
   class TransferIteratorList {
@@ -197,6 +222,20 @@ TransfersContainer::TransfersContainer(const Currency& currency, size_t transact
   m_transactionSpendableAge(transactionSpendableAge) {
 }
 
+TransfersContainer::TransfersContainer(const TransfersContainer& other) :
+  m_currentHeight(0),
+  m_currency(other.m_currency),
+  m_transactionSpendableAge(other.m_transactionSpendableAge) {
+  std::lock_guard<std::mutex> lk(other.m_mutex);
+  m_transactions = other.m_transactions;
+  m_unconfirmedTransfers = other.m_unconfirmedTransfers;
+  m_availableTransfers = other.m_availableTransfers;
+  m_spentTransfers = other.m_spentTransfers;
+  m_transfersUnlockJobs = other.m_transfersUnlockJobs;
+  m_changedTransactions = other.m_changedTransactions;
+  m_currentHeight = other.m_currentHeight;
+}
+
 bool TransfersContainer::addTransaction(const TransactionBlockInfo& block, const ITransactionReader& tx,
                                         const std::vector<TransactionOutputInformationIn>& transfers,
                                         std::vector<std::string>&& messages,
@@ -253,6 +292,7 @@ void TransfersContainer::addTransaction(const TransactionBlockInfo& block, const
   auto result = m_transactions.emplace(std::move(txInfo));
   (void)result; // Disable unused warning
   assert(result.second);
+  m_changedTransactions.insert(txHash);
 }
 
 /**
@@ -396,6 +436,7 @@ bool TransfersContainer::deleteUnconfirmedTransaction(const Crypto::Hash& transa
     return false;
   } else {
     deleteTransactionTransfers(it->transactionHash);
+    m_changedTransactions.insert(it->transactionHash);
     m_transactions.erase(it);
     return true;
   }
@@ -422,6 +463,7 @@ bool TransfersContainer::markTransactionConfirmed(const TransactionBlockInfo& bl
   txInfo.blockHeight = block.height;
   txInfo.timestamp = block.timestamp;
   m_transactions.replace(transactionIt, txInfo);
+  m_changedTransactions.insert(transactionHash);
 
   auto availableRange = m_unconfirmedTransfers.get<ContainingTransactionIndex>().equal_range(transactionHash);
   for (auto transferIt = availableRange.first; transferIt != availableRange.second; ) {
@@ -466,6 +508,7 @@ bool TransfersContainer::markTransactionConfirmed(const TransactionBlockInfo& bl
 
     transfer.spendingBlock = block;
     spendingTransactionIndex.replace(transferIt, transfer);
+    m_changedTransactions.insert(transfer.transactionHash);
   }
 
   return true;
@@ -475,6 +518,8 @@ bool TransfersContainer::markTransactionConfirmed(const TransactionBlockInfo& bl
  * \pre m_mutex is locked.
  */
 void TransfersContainer::deleteTransactionTransfers(const Crypto::Hash& transactionHash) {
+  m_changedTransactions.insert(transactionHash);
+
   auto& spendingTransactionIndex = m_spentTransfers.get<SpendingTransactionIndex>();
   auto spentTransfersRange = spendingTransactionIndex.equal_range(transactionHash);
   for (auto it = spentTransfersRange.first; it != spentTransfersRange.second;) {
@@ -482,6 +527,7 @@ void TransfersContainer::deleteTransactionTransfers(const Crypto::Hash& transact
     assert(it->globalOutputIndex != UNCONFIRMED_TRANSACTION_GLOBAL_OUTPUT_INDEX);
 
     const TransactionOutputInformationEx& unspendingTransfer = static_cast<const TransactionOutputInformationEx&>(*it);
+    m_changedTransactions.insert(unspendingTransfer.transactionHash);
 
     addUnlockJob(unspendingTransfer);
     auto result = m_availableTransfers.emplace(unspendingTransfer);
@@ -535,6 +581,7 @@ void TransfersContainer::copyToSpent(const TransactionBlockInfo& block, const IT
   auto result = m_spentTransfers.emplace(std::move(spentOutput));
   (void)result; // Disable unused warning
   assert(result.second);
+  m_changedTransactions.insert(output.transactionHash);
 }
 
 void TransfersContainer::detach(uint32_t height, std::vector<Crypto::Hash>& deletedTransactions, std::vector<TransactionOutputInformation>& lockedTransfers) {
@@ -581,11 +628,12 @@ void TransfersContainer::detach(uint32_t height, std::vector<Crypto::Hash>& dele
 
 namespace {
   template<typename C, typename T>
-  void updateVisibility(C& collection, const T& range, bool visible) {
+  void updateVisibility(C& collection, const T& range, bool visible, std::unordered_set<Crypto::Hash>& changedTransactions) {
     for (auto it = range.first; it != range.second; ++it) {
       auto updated = *it;
       updated.visible = visible;
       collection.replace(it, updated);
+      changedTransactions.insert(updated.transactionHash);
     }
   }
 }
@@ -609,12 +657,12 @@ void TransfersContainer::updateTransfersVisibility(const KeyImage& keyImage) {
   assert(spentCount == 0 || spentCount == 1);
 
   if (spentCount > 0) {
-    updateVisibility(unconfirmedIndex, unconfirmedRange, false);
-    updateVisibility(availableIndex, availableRange, false);
-    updateVisibility(spentIndex, spentRange, true);
+    updateVisibility(unconfirmedIndex, unconfirmedRange, false, m_changedTransactions);
+    updateVisibility(availableIndex, availableRange, false, m_changedTransactions);
+    updateVisibility(spentIndex, spentRange, true, m_changedTransactions);
   } else if (availableCount > 0) {
-    updateVisibility(unconfirmedIndex, unconfirmedRange, false);
-    updateVisibility(availableIndex, availableRange, false);
+    updateVisibility(unconfirmedIndex, unconfirmedRange, false, m_changedTransactions);
+    updateVisibility(availableIndex, availableRange, false, m_changedTransactions);
 
     auto iteratorList = createTransferIteratorList(availableRange);
     auto earliestTransferIt = iteratorList.minElement();
@@ -624,7 +672,7 @@ void TransfersContainer::updateTransfersVisibility(const KeyImage& keyImage) {
     earliestTransfer.visible = true;
     availableIndex.replace(earliestTransferIt, earliestTransfer);
   } else {
-    updateVisibility(unconfirmedIndex, unconfirmedRange, unconfirmedCount == 1);
+    updateVisibility(unconfirmedIndex, unconfirmedRange, unconfirmedCount == 1, m_changedTransactions);
   }
 }
 
@@ -789,6 +837,33 @@ std::vector<TransactionOutputInformation> TransfersContainer::getTransactionInpu
   return result;
 }
 
+void TransfersContainer::getOutputsAwaitingSpend(std::vector<Crypto::KeyImage>& keyImages,
+  std::vector<std::pair<uint64_t, uint32_t>>& multisignatureOutputs) const {
+  auto addOutput = [&](const TransactionOutputInformationEx& output) {
+    if (output.type == TransactionTypes::OutputType::Key) {
+      keyImages.push_back(output.keyImage);
+    } else if (output.type == TransactionTypes::OutputType::Multisignature &&
+      output.globalOutputIndex != UNCONFIRMED_TRANSACTION_GLOBAL_OUTPUT_INDEX) {
+      multisignatureOutputs.emplace_back(output.amount, output.globalOutputIndex);
+    }
+  };
+
+  std::lock_guard<std::mutex> lk(m_mutex);
+  for (const auto& output : m_availableTransfers) {
+    addOutput(output);
+  }
+
+  for (const auto& output : m_unconfirmedTransfers) {
+    addOutput(output);
+  }
+
+  for (const auto& output : m_spentTransfers) {
+    if (output.spendingBlock.height == WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT) {
+      addOutput(output);
+    }
+  }
+}
+
 void TransfersContainer::getUnconfirmedTransactions(std::vector<Crypto::Hash>& transactions) const {
   std::lock_guard<std::mutex> lk(m_mutex);
   transactions.clear();
@@ -915,6 +990,182 @@ void TransfersContainer::load(std::istream& in) {
   m_availableTransfers = std::move(availableTransfers);
   m_spentTransfers = std::move(spentTransfers);
   m_transfersUnlockJobs = std::move(transfersUnlockJobs);
+  m_changedTransactions.clear();
+}
+
+void TransfersContainer::saveChanges(std::ostream& os) {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  StdOutputStream stream(os);
+  CryptoNote::BinaryOutputStreamSerializer s(stream);
+
+  s(const_cast<uint32_t&>(TRANSFERS_CONTAINER_STORAGE_VERSION), "version");
+  s(m_currentHeight, "height");
+
+  size_t count = m_changedTransactions.size();
+  s.beginArray(count, "transactions");
+  for (const auto& transactionHash : m_changedTransactions) {
+    TransactionChanges changes = getTransactionChanges(transactionHash);
+    s(changes, "");
+  }
+
+  s.endArray();
+}
+
+void TransfersContainer::loadChanges(std::istream& in, std::ostream& previous) {
+  StdInputStream stream(in);
+  CryptoNote::BinaryInputStreamSerializer s(stream);
+
+  uint32_t version = 0;
+  s(version, "version");
+  if (version > TRANSFERS_CONTAINER_STORAGE_VERSION) {
+    throw std::runtime_error("Unsupported transfers storage version");
+  }
+
+  uint32_t height = 0;
+  std::vector<TransactionChanges> changes;
+  s(height, "height");
+  readSequence<TransactionChanges>(std::back_inserter(changes), "transactions", s);
+
+  // every entry is looked up by its transaction, so each one has to belong to it
+  std::unordered_set<Crypto::Hash> changedTransactions;
+  for (const auto& change : changes) {
+    auto ownedBy = [&change](const TransactionOutputInformationEx& transfer) { return transfer.transactionHash == change.transactionHash; };
+    if (!changedTransactions.insert(change.transactionHash).second ||
+        (change.exists && change.transaction.transactionHash != change.transactionHash) ||
+        (!change.exists && !(change.unconfirmedTransfers.empty() && change.availableTransfers.empty() && change.spentTransfers.empty())) ||
+        !std::all_of(change.unconfirmedTransfers.begin(), change.unconfirmedTransfers.end(), ownedBy) ||
+        !std::all_of(change.availableTransfers.begin(), change.availableTransfers.end(), ownedBy) ||
+        !std::all_of(change.spentTransfers.begin(), change.spentTransfers.end(), ownedBy)) {
+      throw std::runtime_error("Malformed transfers container changes");
+    }
+  }
+
+  std::lock_guard<std::mutex> lk(m_mutex);
+
+  std::vector<TransactionChanges> replaced;
+  replaced.reserve(changes.size());
+  for (const auto& change : changes) {
+    replaced.push_back(getTransactionChanges(change.transactionHash));
+  }
+
+  StdOutputStream previousStream(previous);
+  CryptoNote::BinaryOutputStreamSerializer previousSerializer(previousStream);
+  previousSerializer(const_cast<uint32_t&>(TRANSFERS_CONTAINER_STORAGE_VERSION), "version");
+  previousSerializer(m_currentHeight, "height");
+  writeSequence<TransactionChanges>(replaced.begin(), replaced.end(), "transactions", previousSerializer);
+
+  // all of them go before any comes back, an output can move from one transaction to another
+  for (const auto& change : changes) {
+    eraseTransactionChanges(change.transactionHash);
+  }
+
+  bool inserted = std::all_of(changes.begin(), changes.end(), [this](const TransactionChanges& change) { return insertTransactionChanges(change); });
+  if (!inserted) {
+    for (const auto& change : changes) {
+      eraseTransactionChanges(change.transactionHash);
+    }
+
+    for (const auto& change : replaced) {
+      bool restored = insertTransactionChanges(change);
+      (void)restored; // Disable unused warning
+      assert(restored);
+    }
+
+    throw std::runtime_error("Transfers container changes don't match its state");
+  }
+
+  m_currentHeight = height;
+}
+
+void TransfersContainer::clearChanges() {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  m_changedTransactions.clear();
+}
+
+uint32_t TransfersContainer::restoreHeight(uint32_t height) {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  std::swap(m_currentHeight, height);
+  return height;
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+TransfersContainer::TransactionChanges TransfersContainer::getTransactionChanges(const Crypto::Hash& transactionHash) const {
+  TransactionChanges changes;
+  changes.transactionHash = transactionHash;
+
+  auto transactionIt = m_transactions.find(transactionHash);
+  changes.exists = transactionIt != m_transactions.end();
+  if (changes.exists) {
+    changes.transaction = *transactionIt;
+  }
+
+  auto unconfirmedRange = m_unconfirmedTransfers.get<ContainingTransactionIndex>().equal_range(transactionHash);
+  changes.unconfirmedTransfers.assign(unconfirmedRange.first, unconfirmedRange.second);
+  auto availableRange = m_availableTransfers.get<ContainingTransactionIndex>().equal_range(transactionHash);
+  changes.availableTransfers.assign(availableRange.first, availableRange.second);
+  auto spentRange = m_spentTransfers.get<ContainingTransactionIndex>().equal_range(transactionHash);
+  changes.spentTransfers.assign(spentRange.first, spentRange.second);
+
+  return changes;
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::eraseTransactionChanges(const Crypto::Hash& transactionHash) {
+  m_transactions.erase(transactionHash);
+  m_unconfirmedTransfers.get<ContainingTransactionIndex>().erase(transactionHash);
+
+  auto& availableIndex = m_availableTransfers.get<ContainingTransactionIndex>();
+  auto availableRange = availableIndex.equal_range(transactionHash);
+  for (auto it = availableRange.first; it != availableRange.second; ++it) {
+    deleteUnlockJob(*it);
+  }
+
+  availableIndex.erase(availableRange.first, availableRange.second);
+
+  // containers saved before version 1 rebuilt unlock jobs for spent transfers too
+  auto& spentIndex = m_spentTransfers.get<ContainingTransactionIndex>();
+  auto spentRange = spentIndex.equal_range(transactionHash);
+  for (auto it = spentRange.first; it != spentRange.second; ++it) {
+    deleteUnlockJob(*it);
+  }
+
+  spentIndex.erase(spentRange.first, spentRange.second);
+}
+
+/**
+ * \pre m_mutex is locked.
+ * \pre nothing of the transaction is in the container.
+ */
+bool TransfersContainer::insertTransactionChanges(const TransactionChanges& changes) {
+  if (changes.exists && !m_transactions.insert(changes.transaction).second) {
+    return false;
+  }
+
+  for (const auto& transfer : changes.unconfirmedTransfers) {
+    if (!m_unconfirmedTransfers.insert(transfer).second) {
+      return false;
+    }
+  }
+
+  for (const auto& transfer : changes.availableTransfers) {
+    if (!m_availableTransfers.insert(transfer).second) {
+      return false;
+    }
+
+    addUnlockJob(transfer);
+  }
+
+  for (const auto& transfer : changes.spentTransfers) {
+    if (!m_spentTransfers.insert(transfer).second) {
+      return false;
+    }
+  }
+
+  return true;
 }
 
 void TransfersContainer::rebuildTransfersUnlockJobs(TransfersUnlockMultiIndex& transfersUnlockJobs, const AvailableTransfersMultiIndex& availableTransfers,
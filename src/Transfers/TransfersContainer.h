@@ -19,6 +19,7 @@
 
 #include <cstdint>
 #include <unordered_map>
+#include <unordered_set>
 #include <mutex>
 
 #include <boost/multi_index_container.hpp>
@@ -197,6 +198,8 @@ class TransfersContainer : public ITransfersContainer {
 public:
 
   TransfersContainer(const CryptoNote::Currency& currency, size_t transactionSpendableAge);
+  // copies the state of other under its lock, so the copy can be saved while other goes on changing
+  TransfersContainer(const TransfersContainer& other);
 
   bool addTransaction(const TransactionBlockInfo& block, const ITransactionReader& tx,
                       const std::vector<TransactionOutputInformationIn>& transfers,
@@ -207,6 +210,9 @@ public:
   void detach(uint32_t height, std::vector<Crypto::Hash>& deletedTransactions, std::vector<TransactionOutputInformation>& lockedTransfers);
   //returns outputs that are being unlocked
   std::vector<TransactionOutputInformation> advanceHeight(uint32_t height);
+  // outputs whose spend is still to be seen in a block: unspent ones and ones spent by an unconfirmed transaction;
+  // key outputs by key image, multisignature outputs by amount and global index
+  void getOutputsAwaitingSpend(std::vector<Crypto::KeyImage>& keyImages, std::vector<std::pair<uint64_t, uint32_t>>& multisignatureOutputs) const;
 
   // ITransfersContainer
   virtual size_t transfersCount() const override;
@@ -226,7 +232,17 @@ public:
   virtual void save(std::ostream& os) override;
   virtual void load(std::istream& in) override;
 
+  // Journal records: the height and the transactions changed since clearChanges(), each one with all
+  // of its transfers. loadChanges writes what it replaces to previous, loading that back undoes it.
+  void saveChanges(std::ostream& os);
+  void loadChanges(std::istream& in, std::ostream& previous);
+  void clearChanges();
+  // sets the height without unlocking or locking anything, returns the previous one
+  uint32_t restoreHeight(uint32_t height);
+
 private:
+  struct TransactionChanges;
+
   struct ContainingTransactionIndex { };
   struct SpendingTransactionIndex { };
   struct SpentOutputDescriptorIndex { };
@@ -373,12 +389,18 @@ private:
                                   const SpentTransfersMultiIndex& spentTransfers);
   std::vector<TransactionOutputInformation> doAdvanceHeight(uint32_t height);
 
+  TransactionChanges getTransactionChanges(const Crypto::Hash& transactionHash) const;
+  void eraseTransactionChanges(const Crypto::Hash& transactionHash);
+  bool insertTransactionChanges(const TransactionChanges& changes);
+
 private:
   TransactionMultiIndex m_transactions;
   UnconfirmedTransfersMultiIndex m_unconfirmedTransfers;
   AvailableTransfersMultiIndex m_availableTransfers;
   SpentTransfersMultiIndex m_spentTransfers;
   TransfersUnlockMultiIndex m_transfersUnlockJobs;
+  // transactions whose information or transfers changed since clearChanges()
+  std::unordered_set<Crypto::Hash> m_changedTransactions;
   //std::unordered_map<KeyImage, KeyOutputInfo, boost::hash<KeyImage>> m_keyImages;
 
   uint32_t m_currentHeight; // current height is needed to check if a transfer is unlocked
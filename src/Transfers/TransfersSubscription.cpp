@@ -86,14 +86,17 @@ AccountPublicAddress TransfersSubscription::getAddress() {
   return subscription.keys.address;
 }
 
-ITransfersContainer& TransfersSubscription::getContainer() {
+TransfersContainer& TransfersSubscription::getContainer() {
   return transfers;
 }
 
-void TransfersSubscription::deleteUnconfirmedTransaction(const Hash& transactionHash) {
-  if (transfers.deleteUnconfirmedTransaction(transactionHash)) {
-    m_observerManager.notify(&ITransfersObserver::onTransactionDeleted, this, transactionHash);
+bool TransfersSubscription::deleteUnconfirmedTransaction(const Hash& transactionHash) {
+  if (!transfers.deleteUnconfirmedTransaction(transactionHash)) {
+    return false;
   }
+
+  m_observerManager.notify(&ITransfersObserver::onTransactionDeleted, this, transactionHash);
+  return true;
 }
 
 void TransfersSubscription::markTransactionConfirmed(const TransactionBlockInfo& block, const Hash& transactionHash,
@@ -102,4 +105,9 @@ void TransfersSubscription::markTransactionConfirmed(const TransactionBlockInfo&
   m_observerManager.notify(&ITransfersObserver::onTransactionUpdated, this, transactionHash);
 }
 
+void TransfersSubscription::getOutputsAwaitingSpend(std::vector<Crypto::KeyImage>& keyImages,
+                                                    std::vector<std::pair<uint64_t, uint32_t>>& multisignatureOutputs) const {
+  transfers.getOutputsAwaitingSpend(keyImages, multisignatureOutputs);
+}
+
 }
@@ -35,12 +35,13 @@ public:
   bool addTransaction(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx,
                       const std::vector<TransactionOutputInformationIn>& transfers, std::vector<std::string>&& messages);
 
-  void deleteUnconfirmedTransaction(const Crypto::Hash& transactionHash);
+  bool deleteUnconfirmedTransaction(const Crypto::Hash& transactionHash);
   void markTransactionConfirmed(const TransactionBlockInfo& block, const Crypto::Hash& transactionHash, const std::vector<uint32_t>& globalIndices);
+  void getOutputsAwaitingSpend(std::vector<Crypto::KeyImage>& keyImages, std::vector<std::pair<uint64_t, uint32_t>>& multisignatureOutputs) const;
 
   // ITransfersSubscription
   virtual AccountPublicAddress getAddress() override;
-  virtual ITransfersContainer& getContainer() override;
+  virtual TransfersContainer& getContainer() override;
 
 private:
   TransfersContainer transfers;
@@ -17,6 +17,7 @@
 
 #include "TransfersSynchronizer.h"
 #include "TransfersConsumer.h"
+#include "SynchronizationState.h"
 
 #include "Common/StdInputStream.h"
 #include "Common/StdOutputStream.h"
@@ -47,15 +48,23 @@ void TransfersSyncronizer::initTransactionPool(const std::unordered_set<Crypto::
   }
 }
 
+void TransfersSyncronizer::initTransactionPool(const Crypto::PublicKey& viewPublicKey, const std::unordered_set<Crypto::Hash>& uncommitedTransactions) {
+  auto it = m_consumers.find(viewPublicKey);
+  if (it != m_consumers.end()) {
+    it->second->initTransactionPool(uncommitedTransactions);
+  }
+}
+
 ITransfersSubscription& TransfersSyncronizer::addSubscription(const AccountSubscription& acc) {
   auto it = m_consumers.find(acc.keys.address.viewPublicKey);
 
   if (it == m_consumers.end()) {
     std::unique_ptr<TransfersConsumer> consumer(
-      new TransfersConsumer(m_currency, m_node, m_logger.getLogger(), acc.keys.viewSecretKey));
+      new TransfersConsumer(m_currency, m_node, m_logger.getLogger(), acc.keys.viewSecretKey, m_workerPool));
 
     m_sync.addConsumer(consumer.get());
     consumer->addObserver(this);
+    m_consumerViewKeys.emplace(consumer.get(), acc.keys.address.viewPublicKey);
     it = m_consumers.insert(std::make_pair(acc.keys.address.viewPublicKey, std::move(consumer))).first;
   }
     
@@ -69,6 +78,7 @@ bool TransfersSyncronizer::removeSubscription(const AccountPublicAddress& acc) {
 
   if (it->second->removeSubscription(acc)) {
     m_sync.removeConsumer(it->second.get());
+    m_consumerViewKeys.erase(it->second.get());
     m_consumers.erase(it);
 
     m_subscribers.erase(acc.viewPublicKey);
@@ -83,6 +93,22 @@ void TransfersSyncronizer::getSubscriptions(std::vector<AccountPublicAddress>& s
   }
 }
 
+void TransfersSyncronizer::getSubscriptions(const Crypto::PublicKey& viewPublicKey, std::vector<AccountPublicAddress>& subscriptions) {
+  auto it = m_consumers.find(viewPublicKey);
+  if (it != m_consumers.end()) {
+    it->second->getSubscriptions(subscriptions);
+  }
+}
+
+bool TransfersSyncronizer::hasSubscriptions() const {
+  return !m_consumers.empty();
+}
+
+IBlockchainConsumer* TransfersSyncronizer::getConsumer(const Crypto::PublicKey& viewPublicKey) const {
+  auto it = m_consumers.find(viewPublicKey);
+  return it == m_consumers.end() ? nullptr : it->second.get();
+}
+
 ITransfersSubscription* TransfersSyncronizer::getSubscription(const AccountPublicAddress& acc) {
   auto it = m_consumers.find(acc.viewPublicKey);
   return (it == m_consumers.end()) ? nullptr : it->second->getSubscription(acc);
@@ -159,55 +185,152 @@ void TransfersSyncronizer::unsubscribeConsumerNotifications(const Crypto::Public
 }
 
 void TransfersSyncronizer::save(std::ostream& os) {
+  std::vector<ConsumersContainer::const_iterator> consumers;
+  for (auto it = m_consumers.cbegin(); it != m_consumers.cend(); ++it) {
+    consumers.push_back(it);
+  }
+
+  saveConsumers(os, consumers);
+}
+
+void TransfersSyncronizer::save(std::ostream& os, const Crypto::PublicKey& viewPublicKey) {
+  std::vector<ConsumersContainer::const_iterator> consumers;
+  auto it = m_consumers.find(viewPublicKey);
+  if (it != m_consumers.end()) {
+    consumers.push_back(it);
+  }
+
+  saveConsumers(os, consumers);
+}
+
+namespace {
+void saveConsumer(CryptoNote::ISerializer& s, const PublicKey& viewKey, IStreamSerializable& synchronizationState,
+                  const std::vector<std::pair<AccountPublicAddress, IStreamSerializable*>>& containers) {
+  s.beginObject("");
+  s(const_cast<PublicKey&>(viewKey), "view_key");
+
+  std::stringstream consumerState;
+  // synchronization state
+  synchronizationState.save(consumerState);
+
+  std::string blob = consumerState.str();
+  s(blob, "state");
+
+  size_t subCount = containers.size();
+  s.beginArray(subCount, "subscriptions");
+
+  for (const auto& container : containers) {
+    s.beginObject("");
+
+    std::stringstream subState;
+    container.second->save(subState);
+    // store data block
+    std::string blob = subState.str();
+    s(const_cast<AccountPublicAddress&>(container.first), "address");
+    s(blob, "state");
+
+    s.endObject();
+  }
+
+  s.endArray();
+  s.endObject();
+}
+
+// What saveConsumers writes for one view key, copied from the consumer and written later
+class ConsumerSnapshot : public IStreamSerializable {
+public:
+  ConsumerSnapshot(const std::string& synchronizerState, const PublicKey& viewKey) :
+    m_synchronizerState(synchronizerState), m_viewKey(viewKey), m_hasConsumer(false) {
+  }
+
+  void copyConsumer(std::vector<Hash>&& knownBlocks, TransfersConsumer& consumer) {
+    m_knownBlocks = std::move(knownBlocks);
+    consumer.copyContainers(m_containers);
+    m_hasConsumer = true;
+  }
+
+  virtual void save(std::ostream& os) override {
+    os.write(m_synchronizerState.data(), m_synchronizerState.size());
+
+    StdOutputStream stream(os);
+    CryptoNote::BinaryOutputStreamSerializer s(stream);
+    s(const_cast<uint32_t&>(TRANSFERS_STORAGE_ARCHIVE_VERSION), "version");
+
+    size_t consumerCount = m_hasConsumer ? 1 : 0;
+    s.beginArray(consumerCount, "consumers");
+
+    if (m_hasConsumer) {
+      assert(!m_knownBlocks.empty());
+      SynchronizationState synchronizationState(m_knownBlocks.front());
+      synchronizationState.addBlocks(m_knownBlocks.data() + 1, 1, static_cast<uint32_t>(m_knownBlocks.size() - 1));
+
+      std::vector<std::pair<AccountPublicAddress, IStreamSerializable*>> containers;
+      for (const auto& container : m_containers) {
+        containers.emplace_back(container.first, container.second.get());
+      }
+
+      saveConsumer(s, m_viewKey, synchronizationState, containers);
+    }
+
+    s.endArray();
+  }
+
+  virtual void load(std::istream& in) override {
+    throw std::logic_error("Transfers synchronizer snapshot can't be loaded");
+  }
+
+private:
+  std::string m_synchronizerState;
+  PublicKey m_viewKey;
+  bool m_hasConsumer;
+  std::vector<Hash> m_knownBlocks;
+  std::vector<std::pair<AccountPublicAddress, std::unique_ptr<TransfersContainer>>> m_containers;
+};
+
+}
+
+void TransfersSyncronizer::saveConsumers(std::ostream& os, const std::vector<ConsumersContainer::const_iterator>& consumers) {
   m_sync.save(os);
 
   StdOutputStream stream(os);
   CryptoNote::BinaryOutputStreamSerializer s(stream);
   s(const_cast<uint32_t&>(TRANSFERS_STORAGE_ARCHIVE_VERSION), "version");
 
-  size_t subscriptionCount = m_consumers.size();
+  size_t subscriptionCount = consumers.size();
 
   s.beginArray(subscriptionCount, "consumers");
 
-  for (const auto& consumer : m_consumers) {
-    s.beginObject("");
-    s(const_cast<PublicKey&>(consumer.first), "view_key");
-
-    std::stringstream consumerState;
-    // synchronization state
-    m_sync.getConsumerState(consumer.second.get())->save(consumerState);
+  for (const auto& consumerIt : consumers) {
+    const auto& consumer = *consumerIt;
 
-    std::string blob = consumerState.str();
-    s(blob, "state");
-    
     std::vector<AccountPublicAddress> subscriptions;
     consumer.second->getSubscriptions(subscriptions);
-    size_t subCount = subscriptions.size();
-
-    s.beginArray(subCount, "subscriptions");
 
+    std::vector<std::pair<AccountPublicAddress, IStreamSerializable*>> containers;
     for (auto& addr : subscriptions) {
       auto sub = consumer.second->getSubscription(addr);
       if (sub != nullptr) {
-        s.beginObject("");
-
-        std::stringstream subState;
-        assert(sub);
-        sub->getContainer().save(subState);
-        // store data block
-        std::string blob = subState.str();
-        s(addr, "address");
-        s(blob, "state");
-
-        s.endObject();
+        containers.emplace_back(addr, &sub->getContainer());
       }
     }
 
-    s.endArray();
-    s.endObject();
+    saveConsumer(s, consumer.first, *m_sync.getConsumerState(consumer.second.get()), containers);
   }
 }
 
+std::unique_ptr<IStreamSerializable> TransfersSyncronizer::getSnapshot(const Crypto::PublicKey& viewPublicKey) {
+  std::stringstream synchronizerState;
+  m_sync.save(synchronizerState);
+
+  std::unique_ptr<ConsumerSnapshot> snapshot(new ConsumerSnapshot(synchronizerState.str(), viewPublicKey));
+  auto it = m_consumers.find(viewPublicKey);
+  if (it != m_consumers.end()) {
+    snapshot->copyConsumer(m_sync.getConsumerKnownBlocks(*it->second), *it->second);
+  }
+
+  return std::move(snapshot);
+}
+
 namespace {
 std::string getObjectState(IStreamSerializable& obj) {
   std::stringstream stream;
@@ -223,6 +346,14 @@ void setObjectState(IStreamSerializable& obj, const std::string& state) {
 }
 
 void TransfersSyncronizer::load(std::istream& is) {
+  loadConsumers(is, nullptr);
+}
+
+void TransfersSyncronizer::load(std::istream& is, const Crypto::PublicKey& viewPublicKey) {
+  loadConsumers(is, &viewPublicKey);
+}
+
+void TransfersSyncronizer::loadConsumers(std::istream& is, const Crypto::PublicKey* viewPublicKey) {
   m_sync.load(is);
 
   StdInputStream inputStream(is);
@@ -256,7 +387,7 @@ void TransfersSyncronizer::load(std::istream& is) {
       std::string blob;
       s(blob, "state");
 
-      auto subIter = m_consumers.find(viewKey);
+      auto subIter = (viewPublicKey == nullptr || *viewPublicKey == viewKey) ? m_consumers.find(viewKey) : m_consumers.end();
       if (subIter != m_consumers.end()) {
         auto consumerState = m_sync.getConsumerState(subIter->second.get());
         assert(consumerState);
@@ -293,6 +424,20 @@ void TransfersSyncronizer::load(std::istream& is) {
           s.endObject();
         }
         s.endArray();
+      } else {
+        // skip subscriptions of a consumer that is not loaded, so the following ones stay aligned
+        size_t subCount = 0;
+        s.beginArray(subCount, "subscriptions");
+
+        while (subCount--) {
+          AccountPublicAddress acc;
+          std::string state;
+          s.beginObject("");
+          s(acc, "address");
+          s(state, "state");
+          s.endObject();
+        }
+        s.endArray();
       }
     }
 
@@ -313,17 +458,72 @@ void TransfersSyncronizer::load(std::istream& is) {
 
 }
 
-bool TransfersSyncronizer::findViewKeyForConsumer(IBlockchainConsumer* consumer, Crypto::PublicKey& viewKey) const {
-  //since we have only couple of consumers linear complexity is fine
-  auto it = std::find_if(m_consumers.begin(), m_consumers.end(), [consumer] (const ConsumersContainer::value_type& subscription) {
-    return subscription.second.get() == consumer;
-  });
+uint32_t TransfersSyncronizer::saveChanges(std::ostream& os, const Crypto::PublicKey& viewPublicKey, uint32_t fromHeight) {
+  auto it = m_consumers.find(viewPublicKey);
+  if (it == m_consumers.end()) {
+    throw std::invalid_argument("Consumer not found");
+  }
 
+  // the genesis block never changes
+  std::vector<Crypto::Hash> newBlocks;
+  uint32_t height = m_sync.getConsumerKnownBlocks(*it->second, std::max<uint32_t>(fromHeight, 1), newBlocks);
+  fromHeight = height - static_cast<uint32_t>(newBlocks.size());
+
+  StdOutputStream stream(os);
+  CryptoNote::BinaryOutputStreamSerializer s(stream);
+  s(const_cast<uint32_t&>(TRANSFERS_STORAGE_ARCHIVE_VERSION), "version");
+  s(fromHeight, "fromHeight");
+  s(newBlocks, "blockchain");
+  it->second->saveChanges(s);
+  return height;
+}
+
+void TransfersSyncronizer::loadChanges(std::istream& in, const Crypto::PublicKey& viewPublicKey) {
+  auto it = m_consumers.find(viewPublicKey);
   if (it == m_consumers.end()) {
+    throw std::invalid_argument("Consumer not found");
+  }
+
+  StdInputStream stream(in);
+  CryptoNote::BinaryInputStreamSerializer s(stream);
+  uint32_t version = 0;
+  s(version, "version");
+  if (version > TRANSFERS_STORAGE_ARCHIVE_VERSION) {
+    throw std::runtime_error("TransfersSyncronizer version mismatch");
+  }
+
+  uint32_t fromHeight = 0;
+  std::vector<Crypto::Hash> newBlocks;
+  s(fromHeight, "fromHeight");
+  s(newBlocks, "blockchain");
+
+  std::vector<Crypto::Hash> knownBlocks;
+  uint32_t knownHeight = m_sync.getConsumerKnownBlocks(*it->second, fromHeight, knownBlocks);
+  if (fromHeight == 0 || fromHeight > knownHeight) {
+    throw std::runtime_error("Synchronizer changes don't follow the loaded state");
+  }
+
+  // the consumer advances every container to the last block it took
+  uint32_t height = fromHeight + static_cast<uint32_t>(newBlocks.size());
+  it->second->loadChanges(s, height - 1);
+  m_sync.setConsumerKnownBlocks(*it->second, fromHeight, newBlocks);
+}
+
+void TransfersSyncronizer::clearChanges(const Crypto::PublicKey& viewPublicKey) {
+  auto it = m_consumers.find(viewPublicKey);
+  if (it != m_consumers.end()) {
+    it->second->clearChanges();
+  }
+}
+
+bool TransfersSyncronizer::findViewKeyForConsumer(IBlockchainConsumer* consumer, Crypto::PublicKey& viewKey) const {
+  // a shared synchronizer may hold thousands of consumers, so this is a lookup rather than a scan
+  auto it = m_consumerViewKeys.find(consumer);
+  if (it == m_consumerViewKeys.end()) {
     return false;
   }
 
-  viewKey = it->first;
+  viewKey = it->second;
   return true;
 }
 
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "Common/ObserverManager.h"
+#include "Common/WorkerPool.h"
 #include "ITransfersSynchronizer.h"
 #include "IBlockchainSynchronizer.h"
 #include "TypeHelpers.h"
@@ -43,6 +44,7 @@ public:
   virtual ~TransfersSyncronizer();
 
   void initTransactionPool(const std::unordered_set<Crypto::Hash>& uncommitedTransactions);
+  void initTransactionPool(const Crypto::PublicKey& viewPublicKey, const std::unordered_set<Crypto::Hash>& uncommitedTransactions);
 
   // ITransfersSynchronizer
   virtual ITransfersSubscription& addSubscription(const AccountSubscription& acc) override;
@@ -51,6 +53,11 @@ public:
   virtual ITransfersSubscription* getSubscription(const AccountPublicAddress& acc) override;
   virtual std::vector<Crypto::Hash> getViewKeyKnownBlocks(const Crypto::PublicKey& publicViewKey) override;
 
+  void getSubscriptions(const Crypto::PublicKey& viewPublicKey, std::vector<AccountPublicAddress>& subscriptions);
+  bool hasSubscriptions() const;
+  // nullptr if the view key has no subscriptions
+  IBlockchainConsumer* getConsumer(const Crypto::PublicKey& viewPublicKey) const;
+
   void subscribeConsumerNotifications(const Crypto::PublicKey& viewPublicKey, ITransfersSynchronizerObserver* observer);
   void unsubscribeConsumerNotifications(const Crypto::PublicKey& viewPublicKey, ITransfersSynchronizerObserver* observer);
   void addPublicKeysSeen(const AccountPublicAddress& acc, const Crypto::Hash& transactionHash, const Crypto::PublicKey& outputKey);
@@ -59,6 +66,22 @@ public:
   virtual void save(std::ostream& os) override;
   virtual void load(std::istream& in) override;
 
+  // Same format as save/load, restricted to the consumer of one view key. Used when several
+  // wallet containers share the synchronizer and each one keeps its own state.
+  void save(std::ostream& os, const Crypto::PublicKey& viewPublicKey);
+  void load(std::istream& in, const Crypto::PublicKey& viewPublicKey);
+  // A copy of what save(os, viewPublicKey) writes, to be written later while synchronization goes on.
+  // The consumer of the view key must be paused meanwhile so its blocks and containers agree.
+  std::unique_ptr<IStreamSerializable> getSnapshot(const Crypto::PublicKey& viewPublicKey);
+
+  // Writes what changed in the consumer of a view key since its blockchain was fromHeight long and
+  // since clearChanges(): the later block hashes and the changed entries of the containers touched.
+  // Returns the current height of the consumer blockchain.
+  uint32_t saveChanges(std::ostream& os, const Crypto::PublicKey& viewPublicKey, uint32_t fromHeight);
+  void loadChanges(std::istream& in, const Crypto::PublicKey& viewPublicKey);
+  // called once the changes are saved, the next ones start from here
+  void clearChanges(const Crypto::PublicKey& viewPublicKey);
+
 private:
   Logging::LoggerRef m_logger;
 
@@ -70,11 +93,17 @@ private:
   typedef std::unordered_map<Crypto::PublicKey, std::unique_ptr<SubscribersNotifier>> SubscribersContainer;
   SubscribersContainer m_subscribers;
 
+  // map { consumer -> view public key }, notifications are looked up by consumer
+  std::unordered_map<IBlockchainConsumer*, Crypto::PublicKey> m_consumerViewKeys;
+
   // std::unordered_map<AccountAddress, std::unique_ptr<TransfersConsumer>> m_subscriptions;
   IBlockchainSynchronizer& m_sync;
   INode& m_node;
   const CryptoNote::Currency& m_currency;
 
+  // started once and shared by every consumer, they are fed blocks one after another
+  Tools::WorkerPool m_workerPool;
+
   virtual void onBlocksAdded(IBlockchainConsumer* consumer, const std::vector<Crypto::Hash>& blockHashes) override;
   virtual void onBlockchainDetach(IBlockchainConsumer* consumer, uint32_t blockIndex) override;
   virtual void onTransactionDeleteBegin(IBlockchainConsumer* consumer, Crypto::Hash transactionHash) override;
@@ -82,6 +111,9 @@ private:
   virtual void onTransactionUpdated(IBlockchainConsumer* consumer, const Crypto::Hash& transactionHash,
     const std::vector<ITransfersContainer*>& containers) override;
 
+  void saveConsumers(std::ostream& os, const std::vector<ConsumersContainer::const_iterator>& consumers);
+  // nullptr loads every known consumer
+  void loadConsumers(std::istream& is, const Crypto::PublicKey* viewPublicKey);
   bool findViewKeyForConsumer(IBlockchainConsumer* consumer, Crypto::PublicKey& viewKey) const;
   SubscribersContainer::const_iterator findSubscriberForConsumer(IBlockchainConsumer* consumer) const;
 };
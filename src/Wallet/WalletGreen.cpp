@@ -18,6 +18,7 @@
 #include "WalletGreen.h"
 
 #include <algorithm>
+#include <atomic>
 #include <ctime>
 #include <cassert>
 #include <numeric>
@@ -36,6 +37,7 @@
 #include "Common/StdInputStream.h"
 #include "Common/StdOutputStream.h"
 #include "Common/StringTools.h"
+#include "Common/WorkerPool.h"
 #include "CryptoNoteCore/Account.h"
 #include "CryptoNoteCore/Currency.h"
 #include "CryptoNoteCore/CryptoNoteFormatUtils.h"
@@ -58,6 +60,10 @@ using namespace Logging;
 namespace
 {
 
+  // A journal is folded into a new container snapshot once replaying it would cost more than rewriting the snapshot
+  const uint64_t WALLET_JOURNAL_MIN_COMPACTION_SIZE = 4 * 1024 * 1024;
+  const size_t WALLET_JOURNAL_MAX_RECORDS = 1024;
+
   std::vector<uint64_t> split(uint64_t amount, uint64_t dustThreshold)
   {
     std::vector<uint64_t> amounts;
@@ -282,14 +288,25 @@ namespace
 namespace CryptoNote
 {
 
-  WalletGreen::WalletGreen(System::Dispatcher &dispatcher, const Currency &currency, INode &node, Logging::ILogger &logger, uint32_t transactionSoftLockTime) : m_dispatcher(dispatcher),
+  WalletGreen::WalletGreen(System::Dispatcher &dispatcher, const Currency &currency, INode &node, Logging::ILogger &logger, uint32_t transactionSoftLockTime) : WalletGreen(dispatcher, currency, node, logger, transactionSoftLockTime, nullptr)
+  {
+  }
+
+  WalletGreen::WalletGreen(System::Dispatcher &dispatcher, const Currency &currency, INode &node, Logging::ILogger &logger, SharedTransfersSynchronizer &synchronizer, uint32_t transactionSoftLockTime) : WalletGreen(dispatcher, currency, node, logger, transactionSoftLockTime, &synchronizer)
+  {
+  }
+
+  WalletGreen::WalletGreen(System::Dispatcher &dispatcher, const Currency &currency, INode &node, Logging::ILogger &logger, uint32_t transactionSoftLockTime, SharedTransfersSynchronizer *sharedSynchronizer) : m_dispatcher(dispatcher),
                                                                                                                                                                 m_currency(currency),
                                                                                                                                                                 m_node(node),
                                                                                                                                                                 m_logger(logger, "WalletGreen"),
                                                                                                                                                                 m_stopped(false),
-                                                                                                                                                                m_blockchainSynchronizerStarted(false),
-                                                                                                                                                                m_blockchainSynchronizer(node, currency.genesisBlockHash()),
-                                                                                                                                                                m_synchronizer(currency, logger, m_blockchainSynchronizer, node),
+                                                                                                                                                                m_blockchainSynchronizerStarted(sharedSynchronizer != nullptr),
+                                                                                                                                                                m_sharedSynchronizer(sharedSynchronizer),
+                                                                                                                                                                m_ownBlockchainSynchronizer(sharedSynchronizer == nullptr ? new BlockchainSynchronizer(node, currency.genesisBlockHash()) : nullptr),
+                                                                                                                                                                m_ownSynchronizer(sharedSynchronizer == nullptr ? new TransfersSyncronizer(currency, logger, *m_ownBlockchainSynchronizer, node) : nullptr),
+                                                                                                                                                                m_blockchainSynchronizer(sharedSynchronizer == nullptr ? *m_ownBlockchainSynchronizer : sharedSynchronizer->getBlockchainSynchronizer()),
+                                                                                                                                                                m_synchronizer(sharedSynchronizer == nullptr ? *m_ownSynchronizer : sharedSynchronizer->getTransfersSynchronizer()),
                                                                                                                                                                 m_eventOccurred(m_dispatcher),
                                                                                                                                                                 m_readyEvent(m_dispatcher),
                                                                                                                                                                 m_state(WalletState::NOT_INITIALIZED),
@@ -297,7 +314,12 @@ namespace CryptoNote
                                                                                                                                                                 m_pendingBalance(0),
                                                                                                                                                                 m_lockedDepositBalance(0),
                                                                                                                                                                 m_unlockedDepositBalance(0),
-                                                                                                                                                                m_transactionSoftLockTime(transactionSoftLockTime)
+                                                                                                                                                                m_transactionSoftLockTime(transactionSoftLockTime),
+                                                                                                                                                                m_journalSyncHeight(0),
+                                                                                                                                                                m_journalNeedsSnapshot(true),
+                                                                                                                                                                m_snapshotSize(0),
+                                                                                                                                                                m_journalCompacting(false),
+                                                                                                                                                                m_journalCompacted(m_dispatcher)
   {
     m_upperTransactionSizeLimit = m_currency.transactionMaxSize();
     m_readyEvent.set();
@@ -309,6 +331,12 @@ namespace CryptoNote
     {
       doShutdown();
     }
+    else if (m_sharedSynchronizer != nullptr && !m_blockchainSynchronizerStarted)
+    {
+      // a failed load keeps the shared synchronizer paused and may leave subscriptions behind
+      removeSubscriptions();
+      startBlockchainSynchronizer();
+    }
 
     m_dispatcher.yield(); //let remote spawns finish
   }
@@ -420,7 +448,7 @@ namespace CryptoNote
     }
 
     transactionHash = Common::podToHex(transaction->getTransactionHash());
-    size_t id = validateSaveAndSendTransaction(*transaction, {}, false, true);
+    size_t id = validateSaveAndSendTransaction(*transaction, {}, {container}, false, true);
   }
 
   Crypto::SecretKey WalletGreen::getTransactionDeterministicSecretKey(Crypto::Hash &transactionHash) const
@@ -672,22 +700,21 @@ namespace CryptoNote
     prepareInputs(selectedTransfers, mixinResult, 4, keysInfo);
 
     /* Add the inputs to the transaction */
+    std::vector<TransactionTypes::InputKeyInfo> inputsInfo;
     std::vector<KeyPair> ephKeys;
     for (auto &input : keysInfo)
     {
       transaction->addInput(makeAccountKeys(*input.walletRecord), input.keyInfo, input.ephKeys);
+      inputsInfo.push_back(input.keyInfo);
+      ephKeys.push_back(input.ephKeys);
     }
 
     /* Now sign the inputs so we can proceed with the transaction */
-    size_t i = 0;
-    for (auto &input : keysInfo)
-    {
-      transaction->signInputKey(i++, input.keyInfo, input.ephKeys);
-    }
+    transaction->signInputKeys(inputsInfo, ephKeys);
 
     /* Return the transaction hash */
     transactionHash = Common::podToHex(transaction->getTransactionHash());
-    size_t id = validateSaveAndSendTransaction(*transaction, {}, false, true);
+    size_t id = validateSaveAndSendTransaction(*transaction, {}, getSourceContainers(selectedTransfers), false, true);
   }
 
   void WalletGreen::validateOrders(const std::vector<WalletOrder> &orders) const
@@ -905,11 +932,300 @@ namespace CryptoNote
 
     m_extra = extra;
 
+    if (&storage == &m_containerStorage)
+    {
+      resetJournal(saveLevel, transactions.size() != m_transactions.size());
+    }
+
     m_logger(INFO) << "Container saving finished";
   }
 
+  Crypto::chacha8_iv WalletGreen::getContainerSuffixIv(ContainerStorage &storage)
+  {
+    Common::MemoryInputStream suffixStream(storage.suffix(), storage.suffixSize());
+    BinaryInputStreamSerializer suffixSerializer(suffixStream);
+    Crypto::chacha8_iv suffixIv;
+    suffixSerializer(suffixIv, "suffixIv");
+
+    return suffixIv;
+  }
+
+  void WalletGreen::saveJournalRecord(const std::string &extra)
+  {
+    std::string record;
+    Common::StringOutputStream recordStream(record);
+    WalletSerializerV2 s(
+        *this,
+        m_viewPublicKey,
+        m_viewSecretKey,
+        m_actualBalance,
+        m_pendingBalance,
+        m_lockedDepositBalance,
+        m_unlockedDepositBalance,
+        m_walletsContainer,
+        m_synchronizer,
+        m_unlockTransactionsJob,
+        m_transactions,
+        m_transfers,
+        m_deposits,
+        m_uncommitedTransactions,
+        const_cast<std::string &>(extra),
+        m_transactionSoftLockTime);
+    uint32_t syncHeight = m_journalSyncHeight;
+    s.saveDelta(recordStream, m_journalTransactions, m_journalDeposits, m_journalWallets, syncHeight);
+    m_journal.append(m_key, record);
+
+    m_journalTransactions.clear();
+    m_journalDeposits.clear();
+    m_journalWallets.clear();
+    m_synchronizer.clearChanges(m_viewPublicKey);
+    m_journalSyncHeight = syncHeight;
+    m_extra = extra;
+  }
+
+  void WalletGreen::loadJournal(std::string &extra)
+  {
+    m_snapshotSize = m_containerStorage.suffixSize();
+
+    std::vector<std::string> records;
+    try
+    {
+      if (!m_journal.open(m_journalPath, m_key, getContainerSuffixIv(m_containerStorage), records))
+      {
+        return;
+      }
+    }
+    catch (const std::exception &e)
+    {
+      m_logger(WARNING, BRIGHT_YELLOW) << "Failed to open wallet journal: " << e.what();
+      m_journal.close();
+      return;
+    }
+
+    m_journalNeedsSnapshot = false;
+
+    size_t applied = 0;
+    for (const auto &record : records)
+    {
+      try
+      {
+        Common::MemoryInputStream recordStream(record.data(), record.size());
+        WalletSerializerV2 s(
+            *this,
+            m_viewPublicKey,
+            m_viewSecretKey,
+            m_actualBalance,
+            m_pendingBalance,
+            m_lockedDepositBalance,
+            m_unlockedDepositBalance,
+            m_walletsContainer,
+            m_synchronizer,
+            m_unlockTransactionsJob,
+            m_transactions,
+            m_transfers,
+            m_deposits,
+            m_uncommitedTransactions,
+            extra,
+            m_transactionSoftLockTime);
+        s.loadDelta(recordStream);
+        ++applied;
+      }
+      catch (const std::exception &e)
+      {
+        // Keep what was replayed so far, the next save folds it into a new snapshot
+        m_logger(WARNING, BRIGHT_YELLOW) << "Failed to replay wallet journal record " << applied << ": " << e.what();
+        m_journalNeedsSnapshot = true;
+        break;
+      }
+    }
+
+    // Each record carries the transfers synchronizer changes, so scanning goes on from where the last one left it
+    m_journalSyncHeight = getSynchronizerHeight();
+    m_logger(INFO) << "Wallet journal replayed, records " << applied;
+  }
+
+  void WalletGreen::resetJournal(WalletSaveLevel saveLevel, bool hasFilteredTransactions)
+  {
+    // The snapshot holds everything, synchronization is paused while it is saved
+    m_journalTransactions.clear();
+    m_journalDeposits.clear();
+    m_journalWallets.clear();
+    m_synchronizer.clearChanges(m_viewPublicKey);
+    m_snapshotSize = m_containerStorage.suffixSize();
+
+    // Journal records address transactions and deposits by position, so they must match the snapshot
+    m_journalNeedsSnapshot = saveLevel != WalletSaveLevel::SAVE_ALL || hasFilteredTransactions || m_journalPath.empty();
+    if (m_journalNeedsSnapshot)
+    {
+      m_journal.close();
+      if (!m_journalPath.empty())
+      {
+        WalletJournal::remove(m_journalPath);
+      }
+
+      return;
+    }
+
+    try
+    {
+      m_journal.reset(m_journalPath, getContainerSuffixIv(m_containerStorage));
+      m_journalSyncHeight = getSynchronizerHeight();
+    }
+    catch (const std::exception &e)
+    {
+      m_logger(WARNING, BRIGHT_YELLOW) << "Failed to reset wallet journal: " << e.what();
+      m_journal.close();
+      m_journalNeedsSnapshot = true;
+    }
+  }
+
+  bool WalletGreen::journalNeedsCompaction() const
+  {
+    return m_journal.size() > std::max(WALLET_JOURNAL_MIN_COMPACTION_SIZE, m_snapshotSize / 2) ||
+           m_journal.recordCount() >= WALLET_JOURNAL_MAX_RECORDS;
+  }
+
+  void WalletGreen::startJournalCompaction()
+  {
+    if (m_journalCompacting || !journalNeedsCompaction())
+    {
+      return;
+    }
+
+    m_journalCompacting = true;
+    m_journalCompacted.clear();
+    m_dispatcher.remoteSpawn([this] { compactJournal(); });
+  }
+
+  void WalletGreen::compactJournal()
+  {
+    Tools::ScopeExit compactionDone([this] {
+      m_journalCompacting = false;
+      m_journalCompacted.set();
+    });
+
+    if (m_state != WalletState::INITIALIZED || m_journalNeedsSnapshot || !m_journal.isOpened())
+    {
+      return;
+    }
+
+    try
+    {
+      if (std::any_of(m_transactions.begin(), m_transactions.end(), [](const WalletTransaction &tx) { return tx.state == WalletTransactionState::DELETED; }))
+      {
+        // Records written meanwhile address transactions by position, so the snapshot can't leave any out
+        m_journalNeedsSnapshot = true;
+        return;
+      }
+
+      Crypto::chacha8_iv snapshotIv = getContainerSuffixIv(m_containerStorage);
+      size_t compactedRecords = m_journal.recordCount();
+      Crypto::chacha8_key key = m_key;
+
+      // Copy the state while synchronization is held back, it is serialized and encrypted off the dispatcher
+      Crypto::PublicKey viewPublicKey = m_viewPublicKey;
+      Crypto::SecretKey viewSecretKey = m_viewSecretKey;
+      uint64_t actualBalance = m_actualBalance;
+      uint64_t pendingBalance = m_pendingBalance;
+      uint64_t lockedDepositBalance = m_lockedDepositBalance;
+      uint64_t unlockedDepositBalance = m_unlockedDepositBalance;
+      WalletsContainer walletsContainer;
+      UnlockTransactionJobs unlockTransactionsJob;
+      WalletTransactions transactions;
+      WalletTransfers transfers;
+      WalletDeposits deposits;
+      UncommitedTransactions uncommitedTransactions;
+      std::string extra = m_extra;
+      std::unique_ptr<IStreamSerializable> synchronizerSnapshot;
+      pauseSynchronizationForSave();
+      {
+        Tools::ScopeExit restartSynchronizer([this] { resumeSynchronizationAfterSave(); });
+        walletsContainer = m_walletsContainer;
+        unlockTransactionsJob = m_unlockTransactionsJob;
+        transactions = m_transactions;
+        transfers = m_transfers;
+        deposits = m_deposits;
+        uncommitedTransactions = m_uncommitedTransactions;
+        synchronizerSnapshot = m_synchronizer.getSnapshot(m_viewPublicKey);
+      }
+
+      ContainerStoragePrefix *prefix = reinterpret_cast<ContainerStoragePrefix *>(m_containerStorage.prefix());
+      Crypto::chacha8_iv suffixIv = prefix->nextIv;
+      incIv(prefix->nextIv);
+
+      std::string suffix;
+      System::RemoteContext<void> context(m_dispatcher, [&] {
+        std::string containerData;
+        Common::StringOutputStream containerStream(containerData);
+        WalletSerializerV2 s(
+            *this,
+            viewPublicKey,
+            viewSecretKey,
+            actualBalance,
+            pendingBalance,
+            lockedDepositBalance,
+            unlockedDepositBalance,
+            walletsContainer,
+            m_synchronizer,
+            unlockTransactionsJob,
+            transactions,
+            transfers,
+            deposits,
+            uncommitedTransactions,
+            extra,
+            m_transactionSoftLockTime);
+        s.save(containerStream, WalletSaveLevel::SAVE_ALL, *synchronizerSnapshot);
+        suffix = encryptContainerData(key, suffixIv, containerData.data(), containerData.size());
+      });
+      context.get();
+
+      // A snapshot saved meanwhile or a new address makes this one stale
+      Crypto::chacha8_iv currentIv = getContainerSuffixIv(m_containerStorage);
+      if (m_state != WalletState::INITIALIZED || m_journalNeedsSnapshot || !m_journal.isOpened() ||
+          memcmp(&currentIv, &snapshotIv, sizeof(snapshotIv)) != 0)
+      {
+        return;
+      }
+
+      m_containerStorage.resizeSuffix(suffix.size());
+      std::copy(suffix.begin(), suffix.end(), m_containerStorage.suffix());
+      m_containerStorage.flush();
+      m_snapshotSize = m_containerStorage.suffixSize();
+
+      // Records appended while the snapshot was written stay in the journal
+      m_journal.rebase(suffixIv, compactedRecords);
+      m_logger(INFO) << "Wallet journal compacted, records left " << m_journal.recordCount();
+    }
+    catch (const std::exception &e)
+    {
+      m_logger(WARNING, BRIGHT_YELLOW) << "Failed to compact wallet journal: " << e.what();
+      m_journal.close();
+      m_journalNeedsSnapshot = true;
+    }
+  }
+
+  void WalletGreen::waitJournalCompaction()
+  {
+    if (m_journalCompacting)
+    {
+      m_journalCompacted.wait();
+    }
+  }
+
+  uint32_t WalletGreen::getSynchronizerHeight()
+  {
+    if (m_walletsContainer.empty())
+    {
+      return 0;
+    }
+
+    return static_cast<uint32_t>(m_synchronizer.getViewKeyKnownBlocks(m_viewPublicKey).size());
+  }
+
   void WalletGreen::doShutdown()
   {
+    waitJournalCompaction();
+
     if (m_walletsContainer.size() != 0)
     {
       m_synchronizer.unsubscribeConsumerNotifications(m_viewPublicKey, this);
@@ -922,9 +1238,22 @@ namespace CryptoNote
     m_walletsContainer.clear();
     clearCaches(true, true);
 
+    m_journal.close();
+    m_journalPath.clear();
+    m_journalTransactions.clear();
+    m_journalDeposits.clear();
+    m_journalWallets.clear();
+    m_journalNeedsSnapshot = true;
+
     std::queue<WalletEvent> noEvents;
     std::swap(m_events, noEvents);
 
+    if (m_sharedSynchronizer != nullptr)
+    {
+      // other containers keep scanning
+      startBlockchainSynchronizer();
+    }
+
     m_state = WalletState::NOT_INITIALIZED;
   }
 
@@ -935,7 +1264,7 @@ namespace CryptoNote
                    [](const UncommitedTransactions::value_type &pair) {
                      return getObjectHash(pair.second);
                    });
-    m_synchronizer.initTransactionPool(uncommitedTransactionsSet);
+    m_synchronizer.initTransactionPool(m_viewPublicKey, uncommitedTransactionsSet);
   }
 
   void WalletGreen::initWithKeys(const std::string &path, const std::string &password,
@@ -969,6 +1298,7 @@ namespace CryptoNote
     m_viewSecretKey = viewSecretKey;
     m_password = password;
     m_path = path;
+    m_journalPath = path + ".journal";
     m_logger = Logging::LoggerRef(m_logger.getLogger(), "WalletGreen/" + podToHex(m_viewPublicKey).substr(0, 5));
 
     assert(m_blockchain.empty());
@@ -986,7 +1316,24 @@ namespace CryptoNote
     throwIfNotInitialized();
     throwIfStopped();
 
-    stopBlockchainSynchronizer();
+    pauseSynchronizationForSave();
+
+    if (saveLevel == WalletSaveLevel::SAVE_ALL && !m_journalNeedsSnapshot && m_journal.isOpened())
+    {
+      try
+      {
+        saveJournalRecord(extra);
+        resumeSynchronizationAfterSave();
+        m_logger(INFO, BRIGHT_WHITE) << "Container changes saved to journal";
+
+        startJournalCompaction();
+        return;
+      }
+      catch (const std::exception &e)
+      {
+        m_logger(WARNING, BRIGHT_YELLOW) << "Failed to append to wallet journal, saving whole container: " << e.what();
+      }
+    }
 
     try
     {
@@ -995,11 +1342,11 @@ namespace CryptoNote
     catch (const std::exception &e)
     {
       m_logger(ERROR, BRIGHT_RED) << "Failed to save container: " << e.what();
-      startBlockchainSynchronizer();
+      resumeSynchronizationAfterSave();
       throw;
     }
 
-    startBlockchainSynchronizer();
+    resumeSynchronizationAfterSave();
     m_logger(INFO, BRIGHT_WHITE) << "Container saved";
   }
 
@@ -1052,7 +1399,7 @@ namespace CryptoNote
 
     throwIfNotInitialized();
     throwIfStopped();
-    stopBlockchainSynchronizer();
+    pauseSynchronizationForSave();
 
     try
     {
@@ -1091,11 +1438,11 @@ namespace CryptoNote
     catch (const std::exception &e)
     {
       m_logger(ERROR, BRIGHT_RED) << "Failed to export container: " << e.what();
-      startBlockchainSynchronizer();
+      resumeSynchronizationAfterSave();
       throw;
     }
 
-    startBlockchainSynchronizer();
+    resumeSynchronizationAfterSave();
     m_logger(INFO, BRIGHT_WHITE) << "Container exported";
   }
 
@@ -1105,7 +1452,7 @@ namespace CryptoNote
 
     throwIfNotInitialized();
     throwIfStopped();
-    stopBlockchainSynchronizer();
+    pauseSynchronizationForSave();
 
     try
     {
@@ -1144,11 +1491,11 @@ namespace CryptoNote
     catch (const std::exception &e)
     {
       m_logger(ERROR, BRIGHT_RED) << "Failed to export container: " << e.what();
-      startBlockchainSynchronizer();
+      resumeSynchronizationAfterSave();
       throw;
     }
 
-    startBlockchainSynchronizer();
+    resumeSynchronizationAfterSave();
     m_logger(INFO, BRIGHT_WHITE) << "Container exported";
   }
 
@@ -1302,6 +1649,13 @@ namespace CryptoNote
     Crypto::chacha8_iv suffixIv = prefix->nextIv;
     incIv(prefix->nextIv);
 
+    std::string suffix = encryptContainerData(key, suffixIv, containerData, containerDataSize);
+    storage.resizeSuffix(suffix.size());
+    std::copy(suffix.begin(), suffix.end(), storage.suffix());
+  }
+
+  std::string WalletGreen::encryptContainerData(const Crypto::chacha8_key &key, const Crypto::chacha8_iv &suffixIv, const void *containerData, size_t containerDataSize)
+  {
     BinaryArray encryptedContainer;
     encryptedContainer.resize(containerDataSize);
     chacha8(containerData, containerDataSize, key, suffixIv, reinterpret_cast<char *>(encryptedContainer.data()));
@@ -1309,11 +1663,10 @@ namespace CryptoNote
     std::string suffix;
     Common::StringOutputStream suffixStream(suffix);
     BinaryOutputStreamSerializer suffixSerializer(suffixStream);
-    suffixSerializer(suffixIv, "suffixIv");
+    suffixSerializer(const_cast<Crypto::chacha8_iv &>(suffixIv), "suffixIv");
     suffixSerializer(encryptedContainer, "encryptedContainer");
 
-    storage.resizeSuffix(suffix.size());
-    std::copy(suffix.begin(), suffix.end(), storage.suffix());
+    return suffix;
   }
 
   void WalletGreen::incIv(Crypto::chacha8_iv &iv)
@@ -1346,6 +1699,7 @@ namespace CryptoNote
 
     Crypto::cn_context cnContext;
     generate_chacha8_key(cnContext, password, m_key);
+    m_journalPath = path + ".journal";
 
     std::ifstream walletFileStream(path, std::ios_base::binary);
     int version = walletFileStream.peek();
@@ -1380,6 +1734,11 @@ namespace CryptoNote
           std::unordered_set<Crypto::PublicKey> deletedSpendKeys;
           loadWalletCache(addedSpendKeys, deletedSpendKeys, extra);
 
+          if (addedSpendKeys.empty() && deletedSpendKeys.empty())
+          {
+            loadJournal(extra);
+          }
+
           if (!addedSpendKeys.empty())
           {
             m_logger(WARNING, BRIGHT_YELLOW) << "Found addresses not saved in container cache. Resynchronize container";
@@ -1411,7 +1770,7 @@ namespace CryptoNote
     try
     {
       std::vector<AccountPublicAddress> subscriptionList;
-      m_synchronizer.getSubscriptions(subscriptionList);
+      m_synchronizer.getSubscriptions(m_viewPublicKey, subscriptionList);
       for (auto &addr : subscriptionList)
       {
         auto sub = m_synchronizer.getSubscription(addr);
@@ -1439,6 +1798,7 @@ namespace CryptoNote
     m_blockchainSynchronizer.addObserver(this);
 
     initTransactionPool();
+    rebuildPaymentIdIndex();
 
     assert(m_blockchain.empty());
     if (m_walletsContainer.get<RandomAccessIndex>().size() != 0)
@@ -1452,6 +1812,9 @@ namespace CryptoNote
     {
       m_blockchain.push_back(m_currency.genesisBlockHash());
       m_logger(DEBUGGING) << "Add genesis block hash to blockchain";
+
+      // without addresses this only releases a shared synchronizer
+      startBlockchainSynchronizer();
     }
 
     m_password = password;
@@ -1469,6 +1832,7 @@ namespace CryptoNote
       m_transactions.clear();
       m_transfers.clear();
       m_deposits.clear();
+      m_paymentIdTransactions.clear();
     }
 
     if (clearCachedData)
@@ -1496,9 +1860,7 @@ namespace CryptoNote
         }
       }
 
-      std::vector<AccountPublicAddress> subscriptions;
-      m_synchronizer.getSubscriptions(subscriptions);
-      std::for_each(subscriptions.begin(), subscriptions.end(), [this](const AccountPublicAddress &address) { m_synchronizer.removeSubscription(address); });
+      removeSubscriptions();
 
       m_uncommitedTransactions.clear();
       m_unlockTransactionsJob.clear();
@@ -1507,8 +1869,12 @@ namespace CryptoNote
       m_lockedDepositBalance = 0;
       m_unlockedDepositBalance = 0;
       m_fusionTxsCache.clear();
+      m_unlockedOutputs.clear();
       m_blockchain.clear();
     }
+
+    // Journal records build on the cleared state, so only a new snapshot can follow
+    m_journalNeedsSnapshot = true;
   }
 
   void WalletGreen::subscribeWallets()
@@ -1543,12 +1909,7 @@ namespace CryptoNote
     {
       m_logger(ERROR, BRIGHT_RED) << "Failed to subscribe wallets: " << e.what();
 
-      std::vector<AccountPublicAddress> subscriptionList;
-      m_synchronizer.getSubscriptions(subscriptionList);
-      for (auto &subscription : subscriptionList)
-      {
-        m_synchronizer.removeSubscription(subscription);
-      }
+      removeSubscriptions();
 
       throw;
     }
@@ -1784,6 +2145,7 @@ namespace CryptoNote
 
     m_containerStorage.push_back(encryptKeyPair(spendPublicKey, spendSecretKey, creationTimestamp));
     incNextIv();
+    m_journalNeedsSnapshot = true;
 
     try
     {
@@ -1857,6 +2219,7 @@ namespace CryptoNote
     m_synchronizer.removeSubscription(pubAddr);
 
     deleteContainerFromUnlockTransactionJobs(it->container);
+    m_unlockedOutputs.erase(it->container);
     std::vector<size_t> deletedTransactions;
     std::vector<size_t> updatedTransactions = deleteTransfersForAddress(address, deletedTransactions);
     deleteFromUncommitedTransactions(deletedTransactions);
@@ -1867,6 +2230,7 @@ namespace CryptoNote
         m_walletsContainer.get<RandomAccessIndex>().begin(), m_walletsContainer.project<RandomAccessIndex>(it));
 
     m_containerStorage.erase(std::next(m_containerStorage.begin(), addressIndex));
+    m_journalNeedsSnapshot = true;
 
     if (m_walletsContainer.get<RandomAccessIndex>().size() != 0)
     {
@@ -1876,6 +2240,9 @@ namespace CryptoNote
     {
       m_blockchain.clear();
       m_blockchain.push_back(m_currency.genesisBlockHash());
+
+      // without addresses this only releases a shared synchronizer
+      startBlockchainSynchronizer();
     }
 
     for (auto transactionId : updatedTransactions)
@@ -2036,6 +2403,26 @@ namespace CryptoNote
     return doTransfer(transactionParameters, transactionSK);
   }
 
+  std::vector<size_t> WalletGreen::transfer(const std::vector<TransactionParameters> &sendingTransactions, std::vector<Crypto::SecretKey> &transactionSKs)
+  {
+    Tools::ScopeExit releaseContext([this] {
+      m_dispatcher.yield();
+    });
+
+    System::EventLock lk(m_readyEvent);
+
+    throwIfNotInitialized();
+    throwIfTrackingMode();
+    throwIfStopped();
+
+    if (sendingTransactions.empty())
+    {
+      throw std::system_error(make_error_code(error::WRONG_PARAMETERS), "No transactions to send");
+    }
+
+    return doTransfers(sendingTransactions, transactionSKs);
+  }
+
   void WalletGreen::prepareTransaction(
       std::vector<WalletOuts> &&wallets,
       const std::vector<WalletOrder> &orders,
@@ -2069,8 +2456,25 @@ namespace CryptoNote
       requestMixinOuts(selectedTransfers, mixIn, mixinResult);
     }
 
+    buildTransaction(selectedTransfers, foundMoney, mixinResult, messages, mixIn, extra, unlockTimestamp, donation, changeDestination, preparedTransaction, transactionSK);
+  }
+
+  void WalletGreen::buildTransaction(
+      const std::vector<OutputToTransfer> &selectedTransfers,
+      uint64_t foundMoney,
+      std::vector<CryptoNote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount> &mixinResult,
+      const std::vector<WalletMessage> &messages,
+      uint64_t mixIn,
+      const std::string &extra,
+      uint64_t unlockTimestamp,
+      const DonationSettings &donation,
+      const CryptoNote::AccountPublicAddress &changeDestination,
+      PreparedTransaction &preparedTransaction,
+      Crypto::SecretKey &transactionSK)
+  {
     std::vector<InputInfo> keysInfo;
     prepareInputs(selectedTransfers, mixinResult, mixIn, keysInfo);
+    preparedTransaction.sourceContainers = getSourceContainers(selectedTransfers);
 
     uint64_t donationAmount = pushDonationTransferIfPossible(donation, foundMoney - preparedTransaction.neededMoney, m_currency.defaultDustThreshold(), preparedTransaction.destinations);
     preparedTransaction.changeAmount = foundMoney - preparedTransaction.neededMoney - donationAmount;
@@ -2137,7 +2541,231 @@ namespace CryptoNote
         preparedTransaction,
         transactionSK);
 
-    return validateSaveAndSendTransaction(*preparedTransaction.transaction, preparedTransaction.destinations, false, true);
+    return validateSaveAndSendTransaction(*preparedTransaction.transaction, preparedTransaction.destinations, preparedTransaction.sourceContainers, false, true);
+  }
+
+  std::vector<size_t> WalletGreen::doTransfers(const std::vector<TransactionParameters> &sendingTransactions, std::vector<Crypto::SecretKey> &transactionSKs)
+  {
+    std::vector<BatchTransaction> batch(sendingTransactions.size());
+
+    /* Outputs stay reserved until the transactions spending them are stored
+       in the transfers containers, or until the batch is abandoned */
+    Tools::ScopeExit releaseReservedOutputs([this] { m_reservedOutputs.clear(); });
+
+    selectBatchTransfers(sendingTransactions, batch);
+    requestBatchMixinOuts(sendingTransactions, batch);
+    buildBatchTransactions(sendingTransactions, batch);
+
+    transactionSKs.clear();
+    for (const auto &transaction : batch)
+    {
+      transactionSKs.push_back(transaction.transactionSK);
+    }
+
+    return relayBatchTransactions(batch);
+  }
+
+  void WalletGreen::selectBatchTransfers(const std::vector<TransactionParameters> &sendingTransactions, std::vector<BatchTransaction> &batch)
+  {
+    for (size_t i = 0; i < sendingTransactions.size(); ++i)
+    {
+      const TransactionParameters &transactionParameters = sendingTransactions[i];
+      BatchTransaction &transaction = batch[i];
+
+      validateTransactionParameters(transactionParameters);
+      transaction.changeDestination = getChangeDestination(transactionParameters.changeDestination, transactionParameters.sourceAddresses);
+
+      std::vector<WalletOuts> wallets;
+      if (!transactionParameters.sourceAddresses.empty())
+      {
+        wallets = pickWallets(transactionParameters.sourceAddresses);
+      }
+      else
+      {
+        wallets = pickWalletsWithMoney();
+      }
+
+      PreparedTransaction &preparedTransaction = transaction.preparedTransaction;
+      preparedTransaction.destinations = convertOrdersToTransfers(transactionParameters.destinations);
+      preparedTransaction.neededMoney = countNeededMoney(preparedTransaction.destinations, transactionParameters.fee);
+
+      transaction.foundMoney = selectTransfers(preparedTransaction.neededMoney, transactionParameters.mixIn == 0, m_currency.defaultDustThreshold(), std::move(wallets), transaction.selectedTransfers);
+      if (transaction.foundMoney < preparedTransaction.neededMoney)
+      {
+        throw std::system_error(make_error_code(error::WRONG_AMOUNT), "Not enough money for transaction " + std::to_string(i));
+      }
+
+      for (const auto &selected : transaction.selectedTransfers)
+      {
+        m_reservedOutputs.insert(selected.out.outputKey);
+      }
+    }
+  }
+
+  void WalletGreen::requestBatchMixinOuts(const std::vector<TransactionParameters> &sendingTransactions, std::vector<BatchTransaction> &batch)
+  {
+    typedef CryptoNote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount outs_for_amount;
+
+    /* One node request per distinct mixin, usually a single one for the whole batch */
+    std::map<uint64_t, std::vector<size_t>> transactionsByMixin;
+    for (size_t i = 0; i < sendingTransactions.size(); ++i)
+    {
+      if (sendingTransactions[i].mixIn != 0)
+      {
+        transactionsByMixin[sendingTransactions[i].mixIn].push_back(i);
+      }
+    }
+
+    for (const auto &group : transactionsByMixin)
+    {
+      std::vector<OutputToTransfer> selectedTransfers;
+      for (size_t i : group.second)
+      {
+        selectedTransfers.insert(selectedTransfers.end(), batch[i].selectedTransfers.begin(), batch[i].selectedTransfers.end());
+      }
+
+      std::vector<outs_for_amount> mixinResult;
+      requestMixinOuts(selectedTransfers, group.first, mixinResult);
+
+      auto resultIt = mixinResult.begin();
+      for (size_t i : group.second)
+      {
+        auto resultEnd = std::next(resultIt, batch[i].selectedTransfers.size());
+        batch[i].mixinResult.assign(std::make_move_iterator(resultIt), std::make_move_iterator(resultEnd));
+        resultIt = resultEnd;
+      }
+    }
+  }
+
+  void WalletGreen::buildBatchTransactions(const std::vector<TransactionParameters> &sendingTransactions, std::vector<BatchTransaction> &batch)
+  {
+    /* Key derivation and ring signing only read the wallet keys, so the transactions
+       are built on a pool shared by all wallets while the dispatcher keeps running.
+       Signing uses its own fixed pool, so the number of threads doesn't grow with the batch */
+    static Tools::WorkerPool buildPool;
+
+    std::vector<std::exception_ptr> errors(batch.size());
+    std::atomic<bool> failed(false);
+    std::function<void(size_t)> build = [&](size_t i) {
+      if (failed)
+      {
+        return;
+      }
+
+      const TransactionParameters &transactionParameters = sendingTransactions[i];
+      BatchTransaction &transaction = batch[i];
+
+      try
+      {
+        buildTransaction(
+            transaction.selectedTransfers,
+            transaction.foundMoney,
+            transaction.mixinResult,
+            transactionParameters.messages,
+            transactionParameters.mixIn,
+            transactionParameters.extra,
+            transactionParameters.unlockTimestamp,
+            transactionParameters.donation,
+            transaction.changeDestination,
+            transaction.preparedTransaction,
+            transaction.transactionSK);
+      }
+      catch (...)
+      {
+        errors[i] = std::current_exception();
+        failed = true;
+      }
+    };
+
+    System::RemoteContext<void> context(m_dispatcher, [&] { buildPool.run(batch.size(), build); });
+    context.get();
+
+    for (const auto &error : errors)
+    {
+      if (error)
+      {
+        std::rethrow_exception(error);
+      }
+    }
+  }
+
+  std::vector<size_t> WalletGreen::relayBatchTransactions(std::vector<BatchTransaction> &batch)
+  {
+    std::vector<size_t> transactionIds;
+    Tools::ScopeExit rollbackSavedTransactions([this, &transactionIds] {
+      for (size_t transactionId : transactionIds)
+      {
+        try
+        {
+          removeUnconfirmedTransaction(getObjectHash(m_uncommitedTransactions[transactionId]));
+        }
+        catch (...)
+        {
+          // Same as in validateSaveAndSendTransaction, the transaction is dropped during the next pool synchronization
+        }
+
+        m_uncommitedTransactions.erase(transactionId);
+        updateTransactionStateAndPushEvent(transactionId, WalletTransactionState::FAILED);
+      }
+    });
+
+    /* Store all transactions as delayed ones first, so their inputs are spent
+       in the containers before the first relay request goes out */
+    for (auto &transaction : batch)
+    {
+      const PreparedTransaction &preparedTransaction = transaction.preparedTransaction;
+      transactionIds.push_back(validateSaveAndSendTransaction(*preparedTransaction.transaction, preparedTransaction.destinations, preparedTransaction.sourceContainers, false, false));
+    }
+
+    throwIfStopped();
+    rollbackSavedTransactions.cancel();
+
+    std::vector<std::error_code> relayErrors(transactionIds.size());
+    size_t pendingRelays = transactionIds.size();
+    System::Event relaysFinished(m_dispatcher);
+
+    for (size_t i = 0; i < transactionIds.size(); ++i)
+    {
+      m_node.relayTransaction(m_uncommitedTransactions[transactionIds[i]], [this, i, &relayErrors, &pendingRelays, &relaysFinished](std::error_code error) {
+        this->m_dispatcher.remoteSpawn([i, error, &relayErrors, &pendingRelays, &relaysFinished] {
+          relayErrors[i] = error;
+          if (--pendingRelays == 0)
+          {
+            relaysFinished.set();
+          }
+        });
+      });
+    }
+
+    if (pendingRelays != 0)
+    {
+      relaysFinished.wait();
+    }
+
+    for (size_t i = 0; i < transactionIds.size(); ++i)
+    {
+      size_t transactionId = transactionIds[i];
+      if (!relayErrors[i])
+      {
+        updateTransactionStateAndPushEvent(transactionId, WalletTransactionState::SUCCEEDED);
+        m_uncommitedTransactions.erase(transactionId);
+        continue;
+      }
+
+      m_logger(WARNING, BRIGHT_YELLOW) << "Failed to relay transaction " << Common::podToHex(m_transactions[transactionId].hash) << ": " << relayErrors[i].message();
+      try
+      {
+        removeUnconfirmedTransaction(getObjectHash(m_uncommitedTransactions[transactionId]));
+      }
+      catch (...)
+      {
+      }
+
+      m_uncommitedTransactions.erase(transactionId);
+      updateTransactionStateAndPushEvent(transactionId, WalletTransactionState::FAILED);
+    }
+
+    return transactionIds;
   }
 
   size_t WalletGreen::makeTransaction(const TransactionParameters &sendingTransaction)
@@ -2187,7 +2815,7 @@ namespace CryptoNote
         preparedTransaction,
         txSecretKey);
 
-    id = validateSaveAndSendTransaction(*preparedTransaction.transaction, preparedTransaction.destinations, false, false);
+    id = validateSaveAndSendTransaction(*preparedTransaction.transaction, preparedTransaction.destinations, preparedTransaction.sourceContainers, false, false);
     return id;
   }
 
@@ -2271,6 +2899,8 @@ namespace CryptoNote
 
       m_transfers.emplace_back(txId, std::move(d));
     }
+
+    m_journalTransactions.insert(txId);
   }
 
   size_t WalletGreen::insertOutgoingTransactionAndPushEvent(const Hash &transactionHash, uint64_t fee, const BinaryArray &extra, uint64_t unlockTimestamp)
@@ -2291,6 +2921,8 @@ namespace CryptoNote
 
     size_t txId = m_transactions.get<RandomAccessIndex>().size();
     m_transactions.get<RandomAccessIndex>().push_back(std::move(insertTx));
+    updatePaymentIdIndex(txId);
+    m_journalTransactions.insert(txId);
 
     pushEvent(makeTransactionCreatedEvent(txId));
 
@@ -2306,6 +2938,8 @@ namespace CryptoNote
       m_transactions.get<RandomAccessIndex>().modify(it, [state](WalletTransaction &tx) {
         tx.state = state;
       });
+      updatePaymentIdIndex(transactionId);
+      m_journalTransactions.insert(transactionId);
 
       pushEvent(makeTransactionUpdatedEvent(transactionId));
     }
@@ -2328,6 +2962,11 @@ namespace CryptoNote
 
     assert(r);
 
+    if (updated)
+    {
+      m_journalDeposits.insert(depositId);
+    }
+
     return updated;
   }
 
@@ -2392,6 +3031,13 @@ namespace CryptoNote
 
     assert(r);
 
+    /* A deleted transaction may come back, and old wallets may only now get the extra */
+    if (updated)
+    {
+      updatePaymentIdIndex(transactionId);
+      m_journalTransactions.insert(transactionId);
+    }
+
     return updated;
   }
 
@@ -2423,6 +3069,8 @@ namespace CryptoNote
 
     size_t txId = index.size();
     index.push_back(std::move(tx));
+    updatePaymentIdIndex(txId);
+    m_journalTransactions.insert(txId);
 
     return txId;
   }
@@ -2678,6 +3326,7 @@ namespace CryptoNote
 
     WalletTransfer transfer{WalletTransferType::USUAL, address, amount};
     m_transfers.emplace(insertIt, std::piecewise_construct, std::forward_as_tuple(transactionId), std::forward_as_tuple(transfer));
+    m_journalTransactions.insert(transactionId);
   }
 
   bool WalletGreen::adjustTransfer(size_t transactionId, size_t firstTransferIdx, const std::string &address, int64_t amount)
@@ -2724,6 +3373,11 @@ namespace CryptoNote
       updated = true;
     }
 
+    if (updated)
+    {
+      m_journalTransactions.insert(transactionId);
+    }
+
     return updated;
   }
 
@@ -2745,6 +3399,11 @@ namespace CryptoNote
       }
     }
 
+    if (erased)
+    {
+      m_journalTransactions.insert(transactionId);
+    }
+
     return erased;
   }
 
@@ -2810,16 +3469,16 @@ namespace CryptoNote
     tx->setUnlockTime(unlockTimestamp);
     tx->appendExtra(Common::asBinaryArray(extra));
 
+    std::vector<TransactionTypes::InputKeyInfo> inputsInfo;
+    std::vector<KeyPair> ephKeys;
     for (auto &input : keysInfo)
     {
       tx->addInput(makeAccountKeys(*input.walletRecord), input.keyInfo, input.ephKeys);
+      inputsInfo.push_back(input.keyInfo);
+      ephKeys.push_back(input.ephKeys);
     }
 
-    size_t i = 0;
-    for (auto &input : keysInfo)
-    {
-      tx->signInputKey(i++, input.keyInfo, input.ephKeys);
-    }
+    tx->signInputKeys(inputsInfo, ephKeys);
 
     return tx;
   }
@@ -2845,6 +3504,7 @@ namespace CryptoNote
   size_t WalletGreen::validateSaveAndSendTransaction(
       const ITransactionReader &transaction,
       const std::vector<WalletTransfer> &destinations,
+      const std::vector<ITransfersContainer *> &sourceContainers,
       bool isFusion,
       bool send)
   {
@@ -2877,7 +3537,7 @@ namespace CryptoNote
     m_fusionTxsCache.emplace(transactionId, isFusion);
     pushBackOutgoingTransfers(transactionId, destinations);
 
-    addUnconfirmedTransaction(transaction);
+    addUnconfirmedTransaction(transaction, sourceContainers);
     Tools::ScopeExit rollbackAddingUnconfirmedTransaction([this, &transaction] {
       try
       {
@@ -2957,56 +3617,22 @@ namespace CryptoNote
       std::vector<WalletOuts> &&wallets,
       std::vector<OutputToTransfer> &selectedTransfers)
   {
-    uint64_t foundMoney = 0;
-
-    typedef std::pair<WalletRecord *, TransactionOutputInformation> OutputData;
-    std::vector<OutputData> walletOuts;
-    std::unordered_map<uint64_t, std::vector<OutputData>> buckets;
-
-    for (auto walletIt = wallets.begin(); walletIt != wallets.end(); ++walletIt)
+    /* See selectUnlockedOutputs for the order the outputs are taken in */
+    std::vector<const UnlockedOutputs *> sources;
+    sources.reserve(wallets.size());
+    for (const auto &wallet : wallets)
     {
-      for (auto outIt = walletIt->outs.begin(); outIt != walletIt->outs.end(); ++outIt)
-      {
-        int numberOfDigits = floor(log10(outIt->amount)) + 1;
-
-        if (outIt->amount > dustThreshold)
-        {
-          buckets[numberOfDigits].emplace_back(
-              std::piecewise_construct,
-              std::forward_as_tuple(walletIt->wallet),
-              std::forward_as_tuple(*outIt));
-        }
-      }
+      sources.push_back(wallet.outs.get());
     }
 
-    while (foundMoney < neededMoney && !buckets.empty())
-    {
-      /* Take one element from each bucket, smallest first. */
-      for (auto bucket = buckets.begin(); bucket != buckets.end();)
-      {
-        /* Bucket has been exhausted, remove from list */
-        if (bucket->second.empty())
-        {
-          bucket = buckets.erase(bucket);
-        }
-        else
-        {
-          /** Add the amount to the selected transfers so long as 
-           * foundMoney is still less than neededMoney. This prevents 
-           * larger outputs than we need when we already have enough funds */
-          if (foundMoney < neededMoney)
-          {
-            auto out = bucket->second.back();
-            selectedTransfers.emplace_back(OutputToTransfer{std::move(out.second), std::move(out.first)});
-            foundMoney += out.second.amount;
-          }
+    std::vector<std::pair<size_t, TransactionOutputInformation>> selected;
+    uint64_t foundMoney = selectUnlockedOutputs(neededMoney, dustThreshold, sources, m_reservedOutputs, selected);
 
-          /* Remove amount we just added */
-          bucket->second.pop_back();
-          bucket++;
-        }
-      }
+    for (auto &output : selected)
+    {
+      selectedTransfers.emplace_back(OutputToTransfer{std::move(output.second), wallets[output.first].wallet});
     }
+
     return foundMoney;
   };
 
@@ -3022,10 +3648,8 @@ namespace CryptoNote
         continue;
       }
 
-      ITransfersContainer *container = wallet.container;
-
       WalletOuts outs;
-      container->getOutputs(outs.outs, ITransfersContainer::IncludeKeyUnlocked);
+      outs.outs = getUnlockedOutputs(wallet);
       outs.wallet = const_cast<WalletRecord *>(&wallet);
 
       walletOuts.push_back(std::move(outs));
@@ -3038,9 +3662,8 @@ namespace CryptoNote
   {
     const auto &wallet = getWalletRecord(address);
 
-    ITransfersContainer *container = wallet.container;
     WalletOuts outs;
-    container->getOutputs(outs.outs, ITransfersContainer::IncludeKeyUnlocked);
+    outs.outs = getUnlockedOutputs(wallet);
     outs.wallet = const_cast<WalletRecord *>(&wallet);
 
     return outs;
@@ -3054,7 +3677,7 @@ namespace CryptoNote
     for (const auto &address : addresses)
     {
       WalletOuts wallet = pickWallet(address);
-      if (!wallet.outs.empty())
+      if (!wallet.outs->empty())
       {
         wallets.emplace_back(std::move(wallet));
       }
@@ -3063,6 +3686,59 @@ namespace CryptoNote
     return wallets;
   }
 
+  std::shared_ptr<const UnlockedOutputs> WalletGreen::getUnlockedOutputs(const WalletRecord &wallet) const
+  {
+    auto it = m_unlockedOutputs.find(wallet.container);
+    if (it != m_unlockedOutputs.end())
+    {
+      return it->second;
+    }
+
+    std::vector<TransactionOutputInformation> outputs;
+    wallet.container->getOutputs(outputs, ITransfersContainer::IncludeKeyUnlocked);
+
+    auto index = std::make_shared<UnlockedOutputs>();
+    for (const auto &output : outputs)
+    {
+      index->add(output);
+    }
+
+    m_unlockedOutputs[wallet.container] = index;
+    return index;
+  }
+
+  /* Only the containers a transaction touches are looked at, a wallet can hold tens of thousands of addresses */
+  void WalletGreen::removeSpentOutputs(const Crypto::Hash &transactionHash, const std::vector<ITransfersContainer *> &containers)
+  {
+    for (ITransfersContainer *container : containers)
+    {
+      auto it = m_unlockedOutputs.find(container);
+      if (it == m_unlockedOutputs.end())
+      {
+        continue;
+      }
+
+      for (const auto &output : container->getTransactionInputs(transactionHash, ITransfersContainer::IncludeTypeKey))
+      {
+        it->second->remove(output);
+      }
+    }
+  }
+
+  std::vector<ITransfersContainer *> WalletGreen::getSourceContainers(const std::vector<OutputToTransfer> &selectedTransfers)
+  {
+    std::vector<ITransfersContainer *> containers;
+    for (const auto &selected : selectedTransfers)
+    {
+      if (std::find(containers.begin(), containers.end(), selected.wallet->container) == containers.end())
+      {
+        containers.push_back(selected.wallet->container);
+      }
+    }
+
+    return containers;
+  }
+
   std::vector<CryptoNote::WalletGreen::ReceiverAmounts> WalletGreen::splitDestinations(const std::vector<CryptoNote::WalletTransfer> &destinations,
                                                                                        uint64_t dustThreshold,
                                                                                        const CryptoNote::Currency &currency)
@@ -3215,6 +3891,32 @@ namespace CryptoNote
     return getTransactionsInBlocks(blockIndex, count);
   }
 
+  std::vector<TransactionsInBlockInfo> WalletGreen::getTransactionsByPaymentId(const Crypto::Hash &paymentId, const Crypto::Hash &blockHash, size_t count) const
+  {
+    throwIfNotInitialized();
+    throwIfStopped();
+
+    auto &hashIndex = m_blockchain.get<BlockHashIndex>();
+    auto it = hashIndex.find(blockHash);
+    if (it == hashIndex.end())
+    {
+      return std::vector<TransactionsInBlockInfo>();
+    }
+
+    auto heightIt = m_blockchain.project<BlockHeightIndex>(it);
+
+    uint32_t blockIndex = static_cast<uint32_t>(std::distance(m_blockchain.get<BlockHeightIndex>().begin(), heightIt));
+    return getTransactionsInBlocksByPaymentId(paymentId, blockIndex, count);
+  }
+
+  std::vector<TransactionsInBlockInfo> WalletGreen::getTransactionsByPaymentId(const Crypto::Hash &paymentId, uint32_t blockIndex, size_t count) const
+  {
+    throwIfNotInitialized();
+    throwIfStopped();
+
+    return getTransactionsInBlocksByPaymentId(paymentId, blockIndex, count);
+  }
+
   std::vector<DepositsInBlockInfo> WalletGreen::getDeposits(uint32_t blockIndex, size_t count) const
   {
     throwIfNotInitialized();
@@ -3297,6 +3999,11 @@ namespace CryptoNote
     m_stopped = false;
   }
 
+  void WalletGreen::setBlockFiltersEnabled(bool enabled)
+  {
+    m_blockchainSynchronizer.setBlockFiltersEnabled(enabled);
+  }
+
   void WalletGreen::stop()
   {
     m_stopped = true;
@@ -3390,6 +4097,12 @@ namespace CryptoNote
 
   void WalletGreen::onBlockchainDetach(const Crypto::PublicKey &viewPublicKey, uint32_t blockIndex)
   {
+    // Called on the synchronizer thread, so the next journal record can't miss the detach
+    uint32_t syncHeight = m_journalSyncHeight;
+    while (blockIndex < syncHeight && !m_journalSyncHeight.compare_exchange_weak(syncHeight, blockIndex))
+    {
+    }
+
     m_dispatcher.remoteSpawn([this, blockIndex]() { blocksRollback(blockIndex); });
   }
 
@@ -3528,6 +4241,7 @@ namespace CryptoNote
 
     DepositId id = m_deposits.size();
     m_deposits.push_back(std::move(info));
+    m_journalDeposits.insert(id);
 
     m_logger(DEBUGGING, BRIGHT_GREEN) << "New deposit created, id "
                                       << id << ", locking "
@@ -3550,6 +4264,15 @@ namespace CryptoNote
       return;
     }
 
+    std::vector<ITransfersContainer *> containers;
+    containers.reserve(containerAmountsList.size());
+    for (const auto &containerAmounts : containerAmountsList)
+    {
+      containers.push_back(containerAmounts.container);
+    }
+
+    removeSpentOutputs(transactionInfo.transactionHash, containers);
+
     size_t firstDepositId = std::numeric_limits<DepositId>::max();
     size_t depositCount = 0;
 
@@ -3590,6 +4313,15 @@ namespace CryptoNote
         {
           continue;
         }
+
+        /* The deposit may already be known when blocks saved before a restart are scanned again */
+        auto knownId = getDepositId(newDepositOuts[i].transactionHash);
+        if (knownId != WALLET_INVALID_DEPOSIT_ID)
+        {
+          updatedDepositIds.push_back(knownId);
+          continue;
+        }
+
         auto id = insertNewDeposit(newDepositOuts[i], transactionId, m_currency, transactionInfo.blockHeight);
         updatedDepositIds.push_back(id);
       }
@@ -3693,6 +4425,51 @@ namespace CryptoNote
     m_dispatcher.remoteSpawn([object, transactionHash, this]() { this->transactionDeleted(object, transactionHash); });
   }
 
+  void WalletGreen::onTransfersUnlocked(ITransfersSubscription *object, const std::vector<TransactionOutputInformation> &unlockedTransfers)
+  {
+    ITransfersContainer *container = &object->getContainer();
+    m_dispatcher.remoteSpawn([this, container, unlockedTransfers] { transfersUnlockChanged(container, unlockedTransfers, true); });
+  }
+
+  void WalletGreen::onTransfersLocked(ITransfersSubscription *object, const std::vector<TransactionOutputInformation> &lockedTransfers)
+  {
+    ITransfersContainer *container = &object->getContainer();
+    m_dispatcher.remoteSpawn([this, container, lockedTransfers] { transfersUnlockChanged(container, lockedTransfers, false); });
+  }
+
+  void WalletGreen::transfersUnlockChanged(ITransfersContainer *container, const std::vector<TransactionOutputInformation> &transfers, bool unlocked)
+  {
+    System::EventLock lk(m_readyEvent);
+
+    if (m_state == WalletState::NOT_INITIALIZED)
+    {
+      return;
+    }
+
+    auto it = m_unlockedOutputs.find(container);
+    if (it == m_unlockedOutputs.end())
+    {
+      return;
+    }
+
+    for (const auto &transfer : transfers)
+    {
+      if (transfer.type != TransactionTypes::OutputType::Key)
+      {
+        continue;
+      }
+
+      if (unlocked)
+      {
+        it->second->add(transfer);
+      }
+      else
+      {
+        it->second->remove(transfer);
+      }
+    }
+  }
+
   void WalletGreen::transactionDeleted(ITransfersSubscription *object, const Hash &transactionHash)
   {
     System::EventLock lk(m_readyEvent);
@@ -3702,13 +4479,16 @@ namespace CryptoNote
       return;
     }
 
+    /* Outputs spent by the transaction are available again, rebuild the index on next use */
+    CryptoNote::ITransfersContainer *container = &object->getContainer();
+    m_unlockedOutputs.erase(container);
+
     auto it = m_transactions.get<TransactionIndex>().find(transactionHash);
     if (it == m_transactions.get<TransactionIndex>().end())
     {
       return;
     }
 
-    CryptoNote::ITransfersContainer *container = &object->getContainer();
     updateBalance(container);
     deleteUnlockTransactionJob(transactionHash);
 
@@ -3730,12 +4510,20 @@ namespace CryptoNote
     if (updated)
     {
       auto transactionId = getTransactionId(transactionHash);
+      m_journalTransactions.insert(transactionId);
       pushEvent(makeTransactionUpdatedEvent(transactionId));
     }
   }
 
   void WalletGreen::insertUnlockTransactionJob(const Hash &transactionHash, uint32_t blockHeight, CryptoNote::ITransfersContainer *container)
   {
+    auto &hashIndex = m_unlockTransactionsJob.get<TransactionHashIndex>();
+    auto range = hashIndex.equal_range(transactionHash);
+    if (std::any_of(range.first, range.second, [container](const UnlockTransactionJob &job) { return job.container == container; }))
+    {
+      return;
+    }
+
     auto &index = m_unlockTransactionsJob.get<BlockHeightIndex>();
     index.insert({blockHeight, container, transactionHash});
   }
@@ -3748,7 +4536,16 @@ namespace CryptoNote
 
   void WalletGreen::startBlockchainSynchronizer()
   {
-    if (!m_walletsContainer.empty() && !m_blockchainSynchronizerStarted)
+    if (m_sharedSynchronizer != nullptr)
+    {
+      // the shared synchronizer decides itself whether there is anything to scan
+      if (!m_blockchainSynchronizerStarted)
+      {
+        m_sharedSynchronizer->resume();
+        m_blockchainSynchronizerStarted = true;
+      }
+    }
+    else if (!m_walletsContainer.empty() && !m_blockchainSynchronizerStarted)
     {
       m_blockchainSynchronizer.start();
       m_blockchainSynchronizerStarted = true;
@@ -3759,12 +4556,64 @@ namespace CryptoNote
   {
     if (m_blockchainSynchronizerStarted)
     {
-      m_blockchainSynchronizer.stop();
+      if (m_sharedSynchronizer != nullptr)
+      {
+        m_sharedSynchronizer->pause();
+      }
+      else
+      {
+        m_blockchainSynchronizer.stop();
+      }
+
       m_blockchainSynchronizerStarted = false;
     }
   }
 
-  void WalletGreen::addUnconfirmedTransaction(const ITransactionReader &transaction)
+  void WalletGreen::pauseSynchronizationForSave()
+  {
+    if (m_sharedSynchronizer != nullptr)
+    {
+      // only this container's consumer is held back, the other containers keep synchronizing
+      m_sharedSynchronizer->pause(m_viewPublicKey);
+    }
+    else
+    {
+      // the synchronizer keeps running, only this container's consumer stops taking blocks
+      IBlockchainConsumer *consumer = m_synchronizer.getConsumer(m_viewPublicKey);
+      if (consumer != nullptr)
+      {
+        m_blockchainSynchronizer.pauseConsumer(consumer);
+      }
+    }
+  }
+
+  void WalletGreen::resumeSynchronizationAfterSave()
+  {
+    if (m_sharedSynchronizer != nullptr)
+    {
+      m_sharedSynchronizer->resume(m_viewPublicKey);
+    }
+    else
+    {
+      IBlockchainConsumer *consumer = m_synchronizer.getConsumer(m_viewPublicKey);
+      if (consumer != nullptr)
+      {
+        m_blockchainSynchronizer.resumeConsumer(consumer);
+      }
+    }
+  }
+
+  void WalletGreen::removeSubscriptions()
+  {
+    std::vector<AccountPublicAddress> subscriptions;
+    m_synchronizer.getSubscriptions(m_viewPublicKey, subscriptions);
+    for (const auto &subscription : subscriptions)
+    {
+      m_synchronizer.removeSubscription(subscription);
+    }
+  }
+
+  void WalletGreen::addUnconfirmedTransaction(const ITransactionReader &transaction, const std::vector<ITransfersContainer *> &sourceContainers)
   {
     System::RemoteContext<std::error_code> context(m_dispatcher, [this, &transaction] {
       return m_blockchainSynchronizer.addUnconfirmedTransaction(transaction).get();
@@ -3775,6 +4624,10 @@ namespace CryptoNote
     {
       throw std::system_error(ec, "Failed to add unconfirmed transaction");
     }
+
+    /* The container event for the transaction is handled later, take its inputs
+       out of the unlocked outputs now so the next transfer can't select them */
+    removeSpentOutputs(transaction.getTransactionHash(), sourceContainers);
   }
 
   void WalletGreen::removeUnconfirmedTransaction(const Crypto::Hash &transactionHash)
@@ -3885,6 +4738,8 @@ namespace CryptoNote
     /* Write any changes to the wallet balances to the container */
     if (updated)
     {
+      m_journalWallets.insert(it->spendPublicKey);
+
       m_walletsContainer.get<TransfersContainerIndex>().modify(it, [actual, pending, locked, unlocked](WalletRecord &wallet) {
         wallet.actualBalance = actual;
         wallet.pendingBalance = pending;
@@ -4070,7 +4925,7 @@ namespace CryptoNote
       throw std::system_error(make_error_code(error::MINIMUM_INPUT_COUNT));
     }
 
-    id = validateSaveAndSendTransaction(*fusionTransaction, {}, true, true);
+    id = validateSaveAndSendTransaction(*fusionTransaction, {}, getSourceContainers(fusionInputs), true, true);
     return id;
   }
 
@@ -4221,17 +5076,18 @@ namespace CryptoNote
     bucketSizes.fill(0);
     for (size_t walletIndex = 0; walletIndex < walletOuts.size(); ++walletIndex)
     {
-      for (auto &out : walletOuts[walletIndex].outs)
+      const UnlockedOutputs &outs = *walletOuts[walletIndex].outs;
+      for (auto it = outs.begin(), end = outs.lower_bound(threshold); it != end; ++it)
       {
         uint8_t powerOfTen = 0;
-        if (m_currency.isAmountApplicableInFusionTransactionInput(out.amount, threshold, powerOfTen, m_node.getLastKnownBlockHeight()))
+        if (m_currency.isAmountApplicableInFusionTransactionInput(it->first, threshold, powerOfTen, m_node.getLastKnownBlockHeight()))
         {
           assert(powerOfTen < std::numeric_limits<uint64_t>::digits10 + 1);
           bucketSizes[powerOfTen]++;
         }
       }
 
-      result.totalOutputCount += walletOuts[walletIndex].outs.size();
+      result.totalOutputCount += outs.size();
     }
 
     for (auto bucketSize : bucketSizes)
@@ -4255,12 +5111,13 @@ namespace CryptoNote
     bucketSizes.fill(0);
     for (size_t walletIndex = 0; walletIndex < walletOuts.size(); ++walletIndex)
     {
-      for (auto &out : walletOuts[walletIndex].outs)
+      const UnlockedOutputs &outs = *walletOuts[walletIndex].outs;
+      for (auto it = outs.begin(), end = outs.lower_bound(threshold); it != end; ++it)
       {
         uint8_t powerOfTen = 0;
-        if (m_currency.isAmountApplicableInFusionTransactionInput(out.amount, threshold, powerOfTen, m_node.getLastKnownBlockHeight()))
+        if (m_currency.isAmountApplicableInFusionTransactionInput(it->first, threshold, powerOfTen, m_node.getLastKnownBlockHeight()))
         {
-          allFusionReadyOuts.push_back({std::move(out), walletOuts[walletIndex].wallet});
+          allFusionReadyOuts.push_back({it->second, walletOuts[walletIndex].wallet});
           assert(powerOfTen < std::numeric_limits<uint64_t>::digits10 + 1);
           bucketSizes[powerOfTen]++;
         }
@@ -4406,6 +5263,120 @@ namespace CryptoNote
     return result;
   }
 
+  std::vector<TransactionsInBlockInfo> WalletGreen::getTransactionsInBlocksByPaymentId(const Crypto::Hash &paymentId, uint32_t blockIndex, size_t count) const
+  {
+    if (count == 0)
+    {
+      throw std::system_error(make_error_code(error::WRONG_PARAMETERS), "blocks count must be greater than zero");
+    }
+
+    std::vector<TransactionsInBlockInfo> result;
+
+    if (blockIndex >= m_blockchain.size())
+    {
+      return result;
+    }
+
+    uint32_t stopIndex = static_cast<uint32_t>(std::min(m_blockchain.size(), blockIndex + count));
+
+    /* Only the transactions found in the index are copied, the extra of the others is never parsed */
+    std::map<uint32_t, std::vector<const WalletTransaction *>> matches;
+    auto paymentIdIt = m_paymentIdTransactions.find(paymentId);
+    if (paymentIdIt != m_paymentIdTransactions.end())
+    {
+      for (size_t transactionId : paymentIdIt->second)
+      {
+        const WalletTransaction &transaction = m_transactions.get<RandomAccessIndex>()[transactionId];
+        if (transaction.state != WalletTransactionState::DELETED && transaction.blockHeight >= blockIndex && transaction.blockHeight < stopIndex)
+        {
+          matches[transaction.blockHeight].push_back(&transaction);
+        }
+      }
+    }
+
+    /* Blocks holding other wallet transactions are listed with no transactions, as a payment id filter over getTransactions would */
+    auto &blockHeightIndex = m_transactions.get<BlockHeightIndex>();
+    for (auto it = blockHeightIndex.lower_bound(blockIndex), end = blockHeightIndex.lower_bound(stopIndex); it != end; it = blockHeightIndex.upper_bound(it->blockHeight))
+    {
+      uint32_t height = it->blockHeight;
+      auto range = blockHeightIndex.equal_range(height);
+      if (std::none_of(range.first, range.second, [](const WalletTransaction &transaction) { return transaction.state != WalletTransactionState::DELETED; }))
+      {
+        continue;
+      }
+
+      TransactionsInBlockInfo info;
+      info.blockHash = m_blockchain[height];
+
+      auto matchIt = matches.find(height);
+      if (matchIt != matches.end())
+      {
+        for (const WalletTransaction *transaction : matchIt->second)
+        {
+          WalletTransactionWithTransfers transactionWithTransfers;
+          transactionWithTransfers.transaction = *transaction;
+          transactionWithTransfers.transfers = getTransactionTransfers(*transaction);
+          info.transactions.emplace_back(std::move(transactionWithTransfers));
+        }
+      }
+
+      result.emplace_back(std::move(info));
+    }
+
+    return result;
+  }
+
+  void WalletGreen::updatePaymentIdIndex(size_t transactionId)
+  {
+    const WalletTransaction &transaction = m_transactions.get<RandomAccessIndex>()[transactionId];
+
+    Crypto::Hash paymentId;
+    if (transaction.extra.empty() || !getPaymentIdFromTxExtra(Common::asBinaryArray(transaction.extra), paymentId))
+    {
+      return;
+    }
+
+    /* Deleted transactions are never returned, so they leave the index */
+    if (transaction.state == WalletTransactionState::DELETED)
+    {
+      auto paymentIdIt = m_paymentIdTransactions.find(paymentId);
+      if (paymentIdIt == m_paymentIdTransactions.end())
+      {
+        return;
+      }
+
+      auto &transactionIds = paymentIdIt->second;
+      auto it = std::lower_bound(transactionIds.begin(), transactionIds.end(), transactionId);
+      if (it != transactionIds.end() && *it == transactionId)
+      {
+        transactionIds.erase(it);
+      }
+
+      if (transactionIds.empty())
+      {
+        m_paymentIdTransactions.erase(paymentIdIt);
+      }
+
+      return;
+    }
+
+    auto &transactionIds = m_paymentIdTransactions[paymentId];
+    auto it = std::lower_bound(transactionIds.begin(), transactionIds.end(), transactionId);
+    if (it == transactionIds.end() || *it != transactionId)
+    {
+      transactionIds.insert(it, transactionId);
+    }
+  }
+
+  void WalletGreen::rebuildPaymentIdIndex()
+  {
+    m_paymentIdTransactions.clear();
+    for (size_t transactionId = 0; transactionId < m_transactions.size(); ++transactionId)
+    {
+      updatePaymentIdIndex(transactionId);
+    }
+  }
+
   Crypto::Hash WalletGreen::getBlockHashByIndex(uint32_t blockIndex) const
   {
     assert(blockIndex < m_blockchain.size());
@@ -4582,6 +5553,7 @@ namespace CryptoNote
 
         if (!transfersLeft)
         {
+          updatePaymentIdIndex(transactionId);
           deletedTransactions.push_back(transactionId);
         }
 
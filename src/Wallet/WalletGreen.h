@@ -19,17 +19,25 @@
 
 #include "IWallet.h"
 
+#include <atomic>
+#include <map>
+#include <memory>
 #include <queue>
+#include <set>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "IFusionManager.h"
 #include "WalletIndices.h"
+#include "WalletJournal.h"
+#include "WalletUnlockedOutputs.h"
 #include "Common/StringOutputStream.h"
 #include "Logging/LoggerRef.h"
 #include <System/Dispatcher.h>
 #include <System/Event.h>
 #include "Transfers/TransfersSynchronizer.h"
 #include "Transfers/BlockchainSynchronizer.h"
+#include "Transfers/SharedTransfersSynchronizer.h"
 
 namespace CryptoNote
 {
@@ -42,8 +50,13 @@ class WalletGreen : public IWallet,
 {
 public:
   WalletGreen(System::Dispatcher &dispatcher, const Currency &currency, INode &node, Logging::ILogger &logger, uint32_t transactionSoftLockTime = 1);
+  // Scans through a synchronizer shared with the other containers of the process instead of an own one
+  WalletGreen(System::Dispatcher &dispatcher, const Currency &currency, INode &node, Logging::ILogger &logger, SharedTransfersSynchronizer &synchronizer, uint32_t transactionSoftLockTime = 1);
   virtual ~WalletGreen();
 
+  // Opt-in: sync from compact block filters when the node serves them, see BlockchainSynchronizer
+  void setBlockFiltersEnabled(bool enabled);
+
   /* Deposit related functions */
   virtual void createDeposit(uint64_t amount, uint64_t term, std::string sourceAddress, std::string destinationAddress, std::string &transactionHash, const DepositCommitment& commitment = DepositCommitment()) override;
   virtual void withdrawDeposit(DepositId depositId, std::string &transactionHash) override;
@@ -119,6 +132,8 @@ private:
 
   virtual std::vector<TransactionsInBlockInfo> getTransactions(const Crypto::Hash &blockHash, size_t count) const;
   virtual std::vector<TransactionsInBlockInfo> getTransactions(uint32_t blockIndex, size_t count) const;
+  virtual std::vector<TransactionsInBlockInfo> getTransactionsByPaymentId(const Crypto::Hash &paymentId, const Crypto::Hash &blockHash, size_t count) const override;
+  virtual std::vector<TransactionsInBlockInfo> getTransactionsByPaymentId(const Crypto::Hash &paymentId, uint32_t blockIndex, size_t count) const override;
   
   virtual std::vector<DepositsInBlockInfo> getDeposits(const Crypto::Hash &blockHash, size_t count) const;
   virtual std::vector<DepositsInBlockInfo> getDeposits(uint32_t blockIndex, size_t count) const;
@@ -130,6 +145,7 @@ private:
   virtual std::vector<size_t> getDelayedTransactionIds() const override;
 
   virtual size_t transfer(const TransactionParameters &sendingTransaction, Crypto::SecretKey &transactionSK) override;
+  virtual std::vector<size_t> transfer(const std::vector<TransactionParameters> &sendingTransactions, std::vector<Crypto::SecretKey> &transactionSKs) override;
 
   virtual size_t makeTransaction(const TransactionParameters &sendingTransaction) override;
   virtual void commitTransaction(size_t) override;
@@ -203,7 +219,7 @@ protected:
   struct WalletOuts
   {
     WalletRecord *wallet;
-    std::vector<TransactionOutputInformation> outs;
+    std::shared_ptr<const UnlockedOutputs> outs;
   };
 
   typedef std::pair<WalletTransfers::const_iterator, WalletTransfers::const_iterator> TransfersRange;
@@ -240,6 +256,10 @@ protected:
   virtual void onTransactionDeleted(ITransfersSubscription *object, const Crypto::Hash &transactionHash) override;
   void transactionDeleted(ITransfersSubscription *object, const Crypto::Hash &transactionHash);
 
+  virtual void onTransfersUnlocked(ITransfersSubscription *object, const std::vector<TransactionOutputInformation> &unlockedTransfers) override;
+  virtual void onTransfersLocked(ITransfersSubscription *object, const std::vector<TransactionOutputInformation> &lockedTransfers) override;
+  void transfersUnlockChanged(ITransfersContainer *container, const std::vector<TransactionOutputInformation> &transfers, bool unlocked);
+
   virtual void synchronizationProgressUpdated(uint32_t processedBlockCount, uint32_t totalBlockCount) override;
   virtual void synchronizationCompleted(std::error_code result) override;
 
@@ -261,6 +281,9 @@ protected:
   std::vector<WalletOuts> pickWalletsWithMoney() const;
   WalletOuts pickWallet(const std::string &address) const;
   std::vector<WalletOuts> pickWallets(const std::vector<std::string> &addresses) const;
+  std::shared_ptr<const UnlockedOutputs> getUnlockedOutputs(const WalletRecord &wallet) const;
+  void removeSpentOutputs(const Crypto::Hash &transactionHash, const std::vector<ITransfersContainer *> &containers);
+  static std::vector<ITransfersContainer *> getSourceContainers(const std::vector<OutputToTransfer> &selectedTransfers);
 
   void updateBalance(CryptoNote::ITransfersContainer *container);
   void unlockBalances(uint32_t height);
@@ -281,10 +304,21 @@ protected:
   {
     std::unique_ptr<ITransaction> transaction;
     std::vector<WalletTransfer> destinations;
+    std::vector<ITransfersContainer *> sourceContainers;
     uint64_t neededMoney;
     uint64_t changeAmount;
   };
 
+  struct BatchTransaction
+  {
+    CryptoNote::AccountPublicAddress changeDestination;
+    std::vector<OutputToTransfer> selectedTransfers;
+    uint64_t foundMoney;
+    std::vector<CryptoNote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount> mixinResult;
+    PreparedTransaction preparedTransaction;
+    Crypto::SecretKey transactionSK;
+  };
+
   void prepareTransaction(std::vector<WalletOuts> &&wallets,
                           const std::vector<WalletOrder> &orders,
                           const std::vector<WalletMessage> &messages,
@@ -296,6 +330,17 @@ protected:
                           const CryptoNote::AccountPublicAddress &changeDestinationAddress,
                           PreparedTransaction &preparedTransaction,
                           Crypto::SecretKey &transactionSK);
+  void buildTransaction(const std::vector<OutputToTransfer> &selectedTransfers,
+                        uint64_t foundMoney,
+                        std::vector<CryptoNote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount> &mixinResult,
+                        const std::vector<WalletMessage> &messages,
+                        uint64_t mixIn,
+                        const std::string &extra,
+                        uint64_t unlockTimestamp,
+                        const DonationSettings &donation,
+                        const CryptoNote::AccountPublicAddress &changeDestination,
+                        PreparedTransaction &preparedTransaction,
+                        Crypto::SecretKey &transactionSK);
   void validateAddresses(const std::vector<std::string> &addresses) const;
   void validateSourceAddresses(const std::vector<std::string> &sourceAddresses) const;
   void validateChangeDestination(const std::vector<std::string> &sourceAddresses, const std::string &changeDestination, bool isFusion) const;
@@ -303,6 +348,11 @@ protected:
 
   void validateTransactionParameters(const TransactionParameters &transactionParameters) const;
   size_t doTransfer(const TransactionParameters &transactionParameters, Crypto::SecretKey &transactionSK);
+  std::vector<size_t> doTransfers(const std::vector<TransactionParameters> &sendingTransactions, std::vector<Crypto::SecretKey> &transactionSKs);
+  void selectBatchTransfers(const std::vector<TransactionParameters> &sendingTransactions, std::vector<BatchTransaction> &batch);
+  void requestBatchMixinOuts(const std::vector<TransactionParameters> &sendingTransactions, std::vector<BatchTransaction> &batch);
+  void buildBatchTransactions(const std::vector<TransactionParameters> &sendingTransactions, std::vector<BatchTransaction> &batch);
+  std::vector<size_t> relayBatchTransactions(std::vector<BatchTransaction> &batch);
 
   void requestMixinOuts(const std::vector<OutputToTransfer> &selectedTransfers,
                         uint64_t mixIn,
@@ -327,7 +377,8 @@ protected:
                                                             std::vector<InputInfo> &keysInfo, const std::vector<WalletMessage> &messages, const std::string &extra, uint64_t unlockTimestamp, Crypto::SecretKey &transactionSK);
 
   void sendTransaction(const CryptoNote::Transaction &cryptoNoteTransaction);
-  size_t validateSaveAndSendTransaction(const ITransactionReader &transaction, const std::vector<WalletTransfer> &destinations, bool isFusion, bool send);
+  size_t validateSaveAndSendTransaction(const ITransactionReader &transaction, const std::vector<WalletTransfer> &destinations,
+                                        const std::vector<ITransfersContainer *> &sourceContainers, bool isFusion, bool send);
 
   size_t insertBlockchainTransaction(const TransactionInformation &info, int64_t txBalance);
   size_t insertOutgoingTransactionAndPushEvent(const Crypto::Hash &transactionHash, uint64_t fee, const BinaryArray &extra, uint64_t unlockTimestamp);
@@ -351,9 +402,14 @@ protected:
   void pushBackOutgoingTransfers(size_t txId, const std::vector<WalletTransfer> &destinations);
   void insertUnlockTransactionJob(const Crypto::Hash &transactionHash, uint32_t blockHeight, CryptoNote::ITransfersContainer *container);
   void deleteUnlockTransactionJob(const Crypto::Hash &transactionHash);
+  WalletGreen(System::Dispatcher &dispatcher, const Currency &currency, INode &node, Logging::ILogger &logger, uint32_t transactionSoftLockTime, SharedTransfersSynchronizer *sharedSynchronizer);
   void startBlockchainSynchronizer();
   void stopBlockchainSynchronizer();
-  void addUnconfirmedTransaction(const ITransactionReader &transaction);
+  // what a save reads stops changing, a shared synchronizer keeps running for the other containers
+  void pauseSynchronizationForSave();
+  void resumeSynchronizationAfterSave();
+  void removeSubscriptions();
+  void addUnconfirmedTransaction(const ITransactionReader &transaction, const std::vector<ITransfersContainer *> &sourceContainers);
   void removeUnconfirmedTransaction(const Crypto::Hash &transactionHash);
   void initTransactionPool();
   static void loadAndDecryptContainerData(ContainerStorage& storage, const Crypto::chacha8_key& key, BinaryArray& containerData);
@@ -365,6 +421,16 @@ protected:
   
     void deleteOrphanTransactions(const std::unordered_set<Crypto::PublicKey>& deletedKeys);
   void saveWalletCache(ContainerStorage& storage, const Crypto::chacha8_key& key, WalletSaveLevel saveLevel, const std::string& extra);
+  static Crypto::chacha8_iv getContainerSuffixIv(ContainerStorage& storage);
+  void saveJournalRecord(const std::string& extra);
+  void loadJournal(std::string& extra);
+  void resetJournal(WalletSaveLevel saveLevel, bool hasFilteredTransactions);
+  bool journalNeedsCompaction() const;
+  void startJournalCompaction();
+  void compactJournal();
+  void waitJournalCompaction();
+  uint32_t getSynchronizerHeight();
+  static std::string encryptContainerData(const Crypto::chacha8_key& key, const Crypto::chacha8_iv& suffixIv, const void* containerData, size_t containerDataSize);
   void loadSpendKeys();
     void loadContainerStorage(const std::string& path);
 
@@ -392,6 +458,9 @@ protected:
 
   TransfersRange getTransactionTransfersRange(size_t transactionIndex) const;
   std::vector<TransactionsInBlockInfo> getTransactionsInBlocks(uint32_t blockIndex, size_t count) const;
+  std::vector<TransactionsInBlockInfo> getTransactionsInBlocksByPaymentId(const Crypto::Hash &paymentId, uint32_t blockIndex, size_t count) const;
+  void updatePaymentIdIndex(size_t transactionId);
+  void rebuildPaymentIdIndex();
   std::vector<DepositsInBlockInfo> getDepositsInBlocks(uint32_t blockIndex, size_t count) const;
   Crypto::Hash getBlockHashByIndex(uint32_t blockIndex) const;
 
@@ -417,12 +486,18 @@ protected:
   UnlockTransactionJobs m_unlockTransactionsJob;
   WalletTransactions m_transactions;
   WalletTransfers m_transfers;                               //sorted
+  std::unordered_map<Crypto::Hash, std::vector<size_t>> m_paymentIdTransactions; // payment id -> ascending transaction ids
   mutable std::unordered_map<size_t, bool> m_fusionTxsCache; // txIndex -> isFusion
+  mutable std::unordered_map<const ITransfersContainer *, std::shared_ptr<UnlockedOutputs>> m_unlockedOutputs; // built on demand, then kept up to date by the transfers events
+  std::unordered_set<Crypto::PublicKey> m_reservedOutputs; // output keys spent by transactions still being built
   UncommitedTransactions m_uncommitedTransactions;
 
-  bool m_blockchainSynchronizerStarted;
-  BlockchainSynchronizer m_blockchainSynchronizer;
-  TransfersSyncronizer m_synchronizer;
+  bool m_blockchainSynchronizerStarted; // with a shared synchronizer: this container holds no pause on it
+  SharedTransfersSynchronizer *m_sharedSynchronizer;
+  std::unique_ptr<BlockchainSynchronizer> m_ownBlockchainSynchronizer;
+  std::unique_ptr<TransfersSyncronizer> m_ownSynchronizer;
+  BlockchainSynchronizer &m_blockchainSynchronizer;
+  TransfersSyncronizer &m_synchronizer;
 
   System::Event m_eventOccurred;
   std::queue<WalletEvent> m_events;
@@ -450,6 +525,20 @@ protected:
 
   // Burn deposit secrets storage (local, never on blockchain)
   std::map<std::string, BurnDepositInfo> m_burnDepositSecrets;
+
+  // Changes since the last container snapshot are appended to a journal next to the wallet file
+  WalletJournal m_journal;
+  std::string m_journalPath;
+  std::set<size_t> m_journalTransactions; // changed since the last journal record
+  std::set<size_t> m_journalDeposits;
+  std::unordered_set<Crypto::PublicKey> m_journalWallets; // spend keys of the addresses whose balances changed
+  // Transfers synchronizer blockchain height the last journal record left, lowered by detaches
+  std::atomic<uint32_t> m_journalSyncHeight;
+  bool m_journalNeedsSnapshot;
+  uint64_t m_snapshotSize;
+  // The snapshot a long journal is folded into is written after save() returns
+  bool m_journalCompacting;
+  System::Event m_journalCompacted;
 };
 
 } //namespace CryptoNote
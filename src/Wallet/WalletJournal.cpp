@@ -0,0 +1,297 @@
+// Copyright (c) 2017-2022 Fuego Developers
+//
+// This file is part of Fuego.
+//
+// Fuego is free & open source software distributed in the hope
+// it will be useful, but WITHOUT ANY WARRANTY; without even an
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+// PURPOSE. You may redistribute it and/or modify it under the terms
+// of the GNU General Public License v3 or later versions as published
+// by the Free Software Foundation. Fuego includes elements written
+// by third parties. See file labeled LICENSE for more details.
+// You should have received a copy of the GNU General Public License
+// along with Fuego. If not, see <https://www.gnu.org/licenses/>.
+
+#include "WalletJournal.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <system_error>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <boost/filesystem.hpp>
+
+#include "crypto/hash.h"
+
+namespace {
+
+const char JOURNAL_SIGNATURE[8] = { 'F', 'U', 'E', 'G', 'O', 'J', 'N', 'L' };
+const uint32_t MAX_RECORD_SIZE = 512 * 1024 * 1024;
+
+#pragma pack(push, 1)
+struct JournalHeader {
+  char signature[sizeof(JOURNAL_SIGNATURE)];
+  Crypto::chacha8_iv snapshotIv;
+};
+
+struct RecordHeader {
+  Crypto::chacha8_iv iv;
+  uint32_t size;
+  uint32_t checksum;
+};
+#pragma pack(pop)
+
+uint32_t recordChecksum(const Crypto::chacha8_iv& iv, const std::string& cipher) {
+  Crypto::Hash hash = Crypto::cn_fast_hash(cipher.data(), cipher.size());
+  for (size_t i = 0; i < sizeof(iv.data); ++i) {
+    hash.data[i] ^= iv.data[i];
+  }
+
+  uint32_t checksum;
+  memcpy(&checksum, hash.data, sizeof(checksum));
+  return checksum;
+}
+
+typedef std::unique_ptr<FILE, int(*)(FILE*)> FilePtr;
+
+void throwIoError(const std::string& message) {
+  throw std::system_error(std::make_error_code(std::errc::io_error), message);
+}
+
+FilePtr openFile(const std::string& path, const char* mode, const std::string& message) {
+  FilePtr file(fopen(path.c_str(), mode), &fclose);
+  if (!file) {
+    throwIoError(message);
+  }
+
+  return file;
+}
+
+void writeFile(FILE* file, const void* data, size_t size, const std::string& message) {
+  if (size != 0 && fwrite(data, 1, size, file) != size) {
+    throwIoError(message);
+  }
+}
+
+// Flushing the stream only hands the data to the OS, a crash of the machine could still lose it
+void syncFile(FILE* file, const std::string& message) {
+  if (fflush(file) != 0) {
+    throwIoError(message);
+  }
+
+#ifdef _WIN32
+  int result = _commit(_fileno(file));
+#else
+  int result = fsync(fileno(file));
+#endif
+  if (result != 0) {
+    throwIoError(message);
+  }
+}
+
+// A created or renamed file is durable once its directory entry is
+void syncDirectory(const std::string& path) {
+#ifndef _WIN32
+  boost::filesystem::path directory = boost::filesystem::absolute(path).parent_path();
+  int fd = ::open(directory.string().c_str(), O_RDONLY);
+  if (fd != -1) {
+    ::fsync(fd);
+    ::close(fd);
+  }
+#endif
+}
+
+}
+
+namespace CryptoNote {
+
+WalletJournal::WalletJournal() : m_size(0), m_recordCount(0) {
+}
+
+bool WalletJournal::isOpened() const {
+  return !m_path.empty();
+}
+
+uint64_t WalletJournal::size() const {
+  return m_size;
+}
+
+size_t WalletJournal::recordCount() const {
+  return m_recordCount;
+}
+
+bool WalletJournal::open(const std::string& path, const Crypto::chacha8_key& key, const Crypto::chacha8_iv& snapshotIv, std::vector<std::string>& records) {
+  close();
+
+  std::ifstream file(path, std::ios_base::binary);
+  if (!file) {
+    return false;
+  }
+
+  JournalHeader header;
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+      memcmp(header.signature, JOURNAL_SIGNATURE, sizeof(JOURNAL_SIGNATURE)) != 0 ||
+      memcmp(&header.snapshotIv, &snapshotIv, sizeof(snapshotIv)) != 0) {
+    return false;
+  }
+
+  uint64_t validSize = sizeof(header);
+  std::string cipher;
+  for (;;) {
+    RecordHeader recordHeader;
+    if (!file.read(reinterpret_cast<char*>(&recordHeader), sizeof(recordHeader)) || recordHeader.size > MAX_RECORD_SIZE) {
+      break;
+    }
+
+    cipher.resize(recordHeader.size);
+    if (!file.read(&cipher[0], cipher.size()) || recordChecksum(recordHeader.iv, cipher) != recordHeader.checksum) {
+      break;
+    }
+
+    std::string record(cipher.size(), '\0');
+    Crypto::chacha8(cipher.data(), cipher.size(), key, recordHeader.iv, &record[0]);
+    records.emplace_back(std::move(record));
+    validSize += sizeof(recordHeader) + cipher.size();
+  }
+
+  file.close();
+
+  if (boost::filesystem::file_size(path) != validSize) {
+    boost::filesystem::resize_file(path, validSize);
+  }
+
+  m_path = path;
+  m_size = validSize;
+  m_recordCount = records.size();
+  return true;
+}
+
+void WalletJournal::reset(const std::string& path, const Crypto::chacha8_iv& snapshotIv) {
+  close();
+
+  JournalHeader header;
+  memcpy(header.signature, JOURNAL_SIGNATURE, sizeof(JOURNAL_SIGNATURE));
+  header.snapshotIv = snapshotIv;
+
+  const std::string message = "Failed to reset wallet journal";
+  FilePtr file = openFile(path, "wb", message);
+  writeFile(file.get(), &header, sizeof(header), message);
+  syncFile(file.get(), message);
+  file.reset();
+  syncDirectory(path);
+
+  m_path = path;
+  m_size = sizeof(header);
+  m_recordCount = 0;
+}
+
+void WalletJournal::rebase(const Crypto::chacha8_iv& snapshotIv, size_t firstRecord) {
+  if (!isOpened()) {
+    throw std::system_error(std::make_error_code(std::errc::bad_file_descriptor), "Wallet journal is not opened");
+  }
+
+  if (firstRecord > m_recordCount) {
+    throw std::invalid_argument("Wallet journal doesn't have that many records");
+  }
+
+  const std::string message = "Failed to rebase wallet journal";
+  std::ifstream source(m_path, std::ios_base::binary);
+  JournalHeader header;
+  if (!source.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+    throwIoError(message);
+  }
+
+  uint64_t offset = sizeof(header);
+  for (size_t i = 0; i < firstRecord; ++i) {
+    RecordHeader recordHeader;
+    if (!source.read(reinterpret_cast<char*>(&recordHeader), sizeof(recordHeader)) || !source.seekg(recordHeader.size, std::ios_base::cur)) {
+      throwIoError(message);
+    }
+
+    offset += sizeof(recordHeader) + recordHeader.size;
+  }
+
+  std::string keptRecords(m_size - offset, '\0');
+  if (!keptRecords.empty() && !source.read(&keptRecords[0], keptRecords.size())) {
+    throwIoError(message);
+  }
+
+  source.close();
+
+  header.snapshotIv = snapshotIv;
+  std::string tmpPath = m_path + ".tmp";
+  {
+    FilePtr file = openFile(tmpPath, "wb", message);
+    writeFile(file.get(), &header, sizeof(header), message);
+    writeFile(file.get(), keptRecords.data(), keptRecords.size(), message);
+    syncFile(file.get(), message);
+  }
+
+  boost::system::error_code ec;
+  boost::filesystem::rename(tmpPath, m_path, ec);
+  if (ec) {
+    remove(tmpPath);
+    throwIoError(message);
+  }
+
+  syncDirectory(m_path);
+
+  m_size = sizeof(header) + keptRecords.size();
+  m_recordCount -= firstRecord;
+}
+
+void WalletJournal::append(const Crypto::chacha8_key& key, const std::string& record) {
+  if (!isOpened()) {
+    throw std::system_error(std::make_error_code(std::errc::bad_file_descriptor), "Wallet journal is not opened");
+  }
+
+  if (record.size() > MAX_RECORD_SIZE) {
+    throw std::system_error(std::make_error_code(std::errc::value_too_large), "Wallet journal record is too large");
+  }
+
+  RecordHeader recordHeader;
+  recordHeader.iv = Crypto::randomChachaIV();
+  recordHeader.size = static_cast<uint32_t>(record.size());
+
+  std::string cipher(record.size(), '\0');
+  Crypto::chacha8(record.data(), record.size(), key, recordHeader.iv, &cipher[0]);
+  recordHeader.checksum = recordChecksum(recordHeader.iv, cipher);
+
+  const std::string message = "Failed to append wallet journal record";
+  FilePtr file = openFile(m_path, "ab", message);
+  try {
+    writeFile(file.get(), &recordHeader, sizeof(recordHeader), message);
+    writeFile(file.get(), cipher.data(), cipher.size(), message);
+    syncFile(file.get(), message);
+  } catch (std::exception&) {
+    // Drop a partly written record, so the following ones aren't cut off with it on open
+    file.reset();
+    boost::system::error_code ignore;
+    boost::filesystem::resize_file(m_path, m_size, ignore);
+    throw;
+  }
+
+  m_size += sizeof(recordHeader) + cipher.size();
+  ++m_recordCount;
+}
+
+void WalletJournal::close() {
+  m_path.clear();
+  m_size = 0;
+  m_recordCount = 0;
+}
+
+void WalletJournal::remove(const std::string& path) {
+  boost::system::error_code ignore;
+  boost::filesystem::remove(path, ignore);
+}
+
+}
@@ -0,0 +1,57 @@
+// Copyright (c) 2017-2022 Fuego Developers
+//
+// This file is part of Fuego.
+//
+// Fuego is free & open source software distributed in the hope
+// it will be useful, but WITHOUT ANY WARRANTY; without even an
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+// PURPOSE. You may redistribute it and/or modify it under the terms
+// of the GNU General Public License v3 or later versions as published
+// by the Free Software Foundation. Fuego includes elements written
+// by third parties. See file labeled LICENSE for more details.
+// You should have received a copy of the GNU General Public License
+// along with Fuego. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "crypto/chacha8.h"
+
+namespace CryptoNote {
+
+// Append-only file of encrypted wallet cache records written between two
+// container snapshots. A journal belongs to the snapshot whose suffix was
+// encrypted with snapshotIv; any other journal found on disk is stale.
+class WalletJournal {
+public:
+  WalletJournal();
+
+  bool isOpened() const;
+  uint64_t size() const;
+  size_t recordCount() const;
+
+  // Reads all intact records of the journal bound to snapshotIv and opens it
+  // for appending. A torn record at the tail is cut off. Returns false if
+  // there is no journal for this snapshot.
+  bool open(const std::string& path, const Crypto::chacha8_key& key, const Crypto::chacha8_iv& snapshotIv, std::vector<std::string>& records);
+  // Truncates the journal and binds it to a new snapshot
+  void reset(const std::string& path, const Crypto::chacha8_iv& snapshotIv);
+  // Binds the journal to a new snapshot that already holds the first firstRecord records,
+  // the later ones are kept. The journal is replaced atomically.
+  void rebase(const Crypto::chacha8_iv& snapshotIv, size_t firstRecord);
+  // The record is on disk when append returns
+  void append(const Crypto::chacha8_key& key, const std::string& record);
+  void close();
+
+  static void remove(const std::string& path);
+
+private:
+  std::string m_path;
+  uint64_t m_size;
+  size_t m_recordCount;
+};
+
+}
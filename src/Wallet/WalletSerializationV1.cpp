@@ -416,7 +416,7 @@ void WalletSerializer::saveBalances(Common::IOutputStream& destination, bool sav
 
 void WalletSerializer::saveTransfersSynchronizer(Common::IOutputStream& destination, CryptoContext& cryptoContext) {
   std::stringstream stream;
-  m_synchronizer.save(stream);
+  m_synchronizer.save(stream, m_viewPublicKey);
   stream.flush();
 
   std::string plain = stream.str();
@@ -753,7 +753,7 @@ void WalletSerializer::loadTransfersSynchronizer(Common::IInputStream& source, C
   std::stringstream stream(deciphered);
   deciphered.clear();
 
-  m_synchronizer.load(stream);
+  m_synchronizer.load(stream, m_viewPublicKey);
 }
 
 void WalletSerializer::loadObsoleteSpentOutputs(Common::IInputStream& source, CryptoContext& cryptoContext) {
@@ -815,7 +815,7 @@ void WalletSerializer::initTransactionPool() {
     [](const UncommitedTransactions::value_type& pair) {
       return getObjectHash(pair.second);
     });
-  m_synchronizer.initTransactionPool(uncommitedTransactionsSet);
+  m_synchronizer.initTransactionPool(m_viewPublicKey, uncommitedTransactionsSet);
 }
 
 void WalletSerializer::resetCachedBalance() {
@@ -16,6 +16,10 @@
 // along with Fuego. If not, see <https://www.gnu.org/licenses/>.
 
 #include "WalletSerializationV2.h"
+
+#include <algorithm>
+#include <stdexcept>
+
 #include "IWallet.h"
 #include "CryptoNoteCore/CryptoNoteSerialization.h"
 #include "Serialization/BinaryInputStreamSerializer.h"
@@ -161,6 +165,51 @@ void serialize(WalletDepositDtoV2& value, CryptoNote::ISerializer& serializer) {
   serializer(value.address, "address");
 }
 
+CryptoNote::WalletTransaction toWalletTransaction(const WalletTransactionDtoV2& dto) {
+  CryptoNote::WalletTransaction tx;
+  tx.state = dto.state;
+  tx.timestamp = dto.timestamp;
+  tx.blockHeight = dto.blockHeight;
+  tx.hash = dto.hash;
+  tx.depositCount = dto.depositCount;
+  tx.firstDepositId = dto.firstDepositId;
+  tx.totalAmount = dto.totalAmount;
+  tx.fee = dto.fee;
+  tx.creationTime = dto.creationTime;
+  tx.unlockTime = dto.unlockTime;
+  tx.extra = dto.extra;
+  tx.isBase = dto.isBase;
+  return tx;
+}
+
+CryptoNote::WalletTransfer toWalletTransfer(const WalletTransferDtoV2& dto) {
+  CryptoNote::WalletTransfer tr;
+  tr.address = dto.address;
+  tr.amount = dto.amount;
+  tr.type = static_cast<CryptoNote::WalletTransferType>(dto.type);
+  return tr;
+}
+
+CryptoNote::Deposit toDeposit(const WalletDepositDtoV2& dto) {
+  CryptoNote::Deposit dp;
+  dp.creatingTransactionId = dto.creatingTransactionId;
+  dp.spendingTransactionId = dto.spendingTransactionId;
+  dp.term = dto.term;
+  dp.amount = dto.amount;
+  dp.interest = dto.interest;
+  dp.height = dto.height;
+  dp.unlockHeight = dto.unlockHeight;
+  dp.locked = dto.locked;
+  dp.transactionHash = dto.transactionHash;
+  dp.outputInTransaction = dto.outputInTransaction;
+  dp.address = dto.address;
+  return dp;
+}
+
+bool transferLess(const CryptoNote::TransactionTransferPair& a, const CryptoNote::TransactionTransferPair& b) {
+  return a.first < b.first;
+}
+
 }
 
 namespace CryptoNote {
@@ -184,6 +233,7 @@ WalletSerializerV2::WalletSerializerV2(
   uint32_t transactionSoftLockTime
 ) :
   m_transfersObserver(transfersObserver),
+  m_viewPublicKey(viewPublicKey),
   m_actualBalance(actualBalance),
   m_pendingBalance(pendingBalance),
   m_lockedDepositBalance(lockedDepositBalance),
@@ -225,6 +275,14 @@ void WalletSerializerV2::load(Common::IInputStream& source, uint8_t version) {
 }
 
 void WalletSerializerV2::save(Common::IOutputStream& destination, WalletSaveLevel saveLevel) {
+  doSave(destination, saveLevel, nullptr);
+}
+
+void WalletSerializerV2::save(Common::IOutputStream& destination, WalletSaveLevel saveLevel, IStreamSerializable& synchronizerSnapshot) {
+  doSave(destination, saveLevel, &synchronizerSnapshot);
+}
+
+void WalletSerializerV2::doSave(Common::IOutputStream& destination, WalletSaveLevel saveLevel, IStreamSerializable* synchronizerSnapshot) {
   CryptoNote::BinaryOutputStreamSerializer s(destination);
 
   uint8_t saveLevelValue = static_cast<uint8_t>(saveLevel);
@@ -239,7 +297,7 @@ void WalletSerializerV2::save(Common::IOutputStream& destination, WalletSaveLeve
   }
 
   if (saveLevel == WalletSaveLevel::SAVE_ALL) {
-    saveTransfersSynchronizer(s);
+    saveTransfersSynchronizer(s, synchronizerSnapshot);
     saveUnlockTransactionsJobs(s);
     s(m_uncommitedTransactions, "uncommitedTransactions");
   }
@@ -247,6 +305,214 @@ void WalletSerializerV2::save(Common::IOutputStream& destination, WalletSaveLeve
   s(m_extra, "extra");
 }
 
+void WalletSerializerV2::loadDelta(Common::IInputStream& source) {
+  CryptoNote::BinaryInputStreamSerializer s(source);
+
+  auto& transactions = m_transactions.get<RandomAccessIndex>();
+  auto& deposits = m_deposits.get<RandomAccessIndex>();
+
+  // Read the whole record before touching the wallet, so a damaged record leaves it intact
+  std::vector<std::pair<size_t, WalletTransaction>> changedTransactions;
+  WalletTransfers changedTransfers;
+  uint64_t count = 0;
+  s(count, "transactionCount");
+  size_t nextTransactionId = transactions.size();
+  for (uint64_t i = 0; i < count; ++i) {
+    uint64_t txId = 0;
+    WalletTransactionDtoV2 dto;
+    s(txId, "transactionId");
+    s(dto, "transaction");
+    if (txId > nextTransactionId || (!changedTransactions.empty() && txId <= changedTransactions.back().first)) {
+      throw std::runtime_error("Journal record refers to an unknown transaction");
+    }
+
+    nextTransactionId = std::max(nextTransactionId, static_cast<size_t>(txId) + 1);
+    changedTransactions.emplace_back(txId, toWalletTransaction(dto));
+
+    uint64_t transferCount = 0;
+    s(transferCount, "transferCount");
+    for (uint64_t j = 0; j < transferCount; ++j) {
+      WalletTransferDtoV2 tr;
+      s(tr, "transfer");
+      changedTransfers.emplace_back(txId, toWalletTransfer(tr));
+    }
+  }
+
+  std::vector<std::pair<size_t, Deposit>> changedDeposits;
+  s(count, "depositCount");
+  size_t nextDepositId = deposits.size();
+  for (uint64_t i = 0; i < count; ++i) {
+    uint64_t depositId = 0;
+    WalletDepositDtoV2 dto;
+    s(depositId, "depositId");
+    s(dto, "deposit");
+    if (depositId > nextDepositId || (!changedDeposits.empty() && depositId <= changedDeposits.back().first)) {
+      throw std::runtime_error("Journal record refers to an unknown deposit");
+    }
+
+    nextDepositId = std::max(nextDepositId, static_cast<size_t>(depositId) + 1);
+    changedDeposits.emplace_back(depositId, toDeposit(dto));
+  }
+
+  std::vector<UnlockTransactionJobDtoV2> unlockJobs;
+  s(count, "unlockTransactionsJobsCount");
+  for (uint64_t i = 0; i < count; ++i) {
+    UnlockTransactionJobDtoV2 dto;
+    s(dto, "unlockTransactionsJob");
+    unlockJobs.push_back(dto);
+  }
+
+  UncommitedTransactions uncommitedTransactions;
+  s(uncommitedTransactions, "uncommitedTransactions");
+
+  auto& walletsIndex = m_walletsContainer.get<KeysIndex>();
+  std::vector<WalletRecord> balances;
+  s(count, "walletCount");
+  for (uint64_t i = 0; i < count; ++i) {
+    WalletRecord wallet;
+    s(wallet.spendPublicKey, "spendPublicKey");
+    s(wallet.actualBalance, "actualBalance");
+    s(wallet.pendingBalance, "pendingBalance");
+    s(wallet.lockedDepositBalance, "lockedDepositBalance");
+    s(wallet.unlockedDepositBalance, "unlockedDepositBalance");
+    if (walletsIndex.count(wallet.spendPublicKey) == 0) {
+      throw std::runtime_error("Journal record refers to an unknown address");
+    }
+
+    balances.push_back(wallet);
+  }
+
+  std::string extra;
+  s(extra, "extra");
+
+  std::string transfersSynchronizerData;
+  s(transfersSynchronizerData, "transfersSynchronizer");
+
+  // The synchronizer rolls itself back if its changes don't apply
+  if (!transfersSynchronizerData.empty()) {
+    std::stringstream stream(transfersSynchronizerData);
+    m_synchronizer.loadChanges(stream, m_viewPublicKey);
+  }
+
+  for (auto& entry : changedTransactions) {
+    bool r = entry.first < transactions.size() ?
+      transactions.replace(std::next(transactions.begin(), entry.first), entry.second) :
+      transactions.push_back(entry.second).second;
+    if (!r) {
+      throw std::runtime_error("Failed to apply journal transaction");
+    }
+
+    auto range = std::equal_range(m_transfers.begin(), m_transfers.end(), TransactionTransferPair(entry.first, WalletTransfer()), transferLess);
+    auto insertIt = m_transfers.erase(range.first, range.second);
+    auto newRange = std::equal_range(changedTransfers.begin(), changedTransfers.end(), TransactionTransferPair(entry.first, WalletTransfer()), transferLess);
+    m_transfers.insert(insertIt, newRange.first, newRange.second);
+  }
+
+  for (auto& entry : changedDeposits) {
+    bool r = entry.first < deposits.size() ?
+      deposits.replace(std::next(deposits.begin(), entry.first), entry.second) :
+      deposits.push_back(entry.second).second;
+    if (!r) {
+      throw std::runtime_error("Failed to apply journal deposit");
+    }
+  }
+
+  m_unlockTransactions.clear();
+  for (const auto& dto : unlockJobs) {
+    auto walletIt = walletsIndex.find(dto.walletSpendPublicKey);
+    if (walletIt != walletsIndex.end()) {
+      m_unlockTransactions.get<TransactionHashIndex>().insert({dto.blockHeight, walletIt->container, dto.transactionHash});
+    }
+  }
+
+  m_uncommitedTransactions = std::move(uncommitedTransactions);
+
+  // only the addresses whose balances changed are in the record
+  for (const auto& balance : balances) {
+    auto walletIt = walletsIndex.find(balance.spendPublicKey);
+    m_actualBalance = m_actualBalance - walletIt->actualBalance + balance.actualBalance;
+    m_pendingBalance = m_pendingBalance - walletIt->pendingBalance + balance.pendingBalance;
+    m_lockedDepositBalance = m_lockedDepositBalance - walletIt->lockedDepositBalance + balance.lockedDepositBalance;
+    m_unlockedDepositBalance = m_unlockedDepositBalance - walletIt->unlockedDepositBalance + balance.unlockedDepositBalance;
+
+    walletsIndex.modify(walletIt, [&balance](WalletRecord& wallet) {
+      wallet.actualBalance = balance.actualBalance;
+      wallet.pendingBalance = balance.pendingBalance;
+      wallet.lockedDepositBalance = balance.lockedDepositBalance;
+      wallet.unlockedDepositBalance = balance.unlockedDepositBalance;
+    });
+  }
+
+  m_extra = extra;
+}
+
+void WalletSerializerV2::saveDelta(Common::IOutputStream& destination, const std::set<size_t>& transactionIds, const std::set<size_t>& depositIds,
+                                   const std::unordered_set<Crypto::PublicKey>& spendPublicKeys, uint32_t& synchronizerHeight) {
+  CryptoNote::BinaryOutputStreamSerializer s(destination);
+
+  const auto& transactions = m_transactions.get<RandomAccessIndex>();
+  uint64_t count = transactionIds.size();
+  s(count, "transactionCount");
+  for (size_t id : transactionIds) {
+    uint64_t txId = id;
+    WalletTransactionDtoV2 dto(transactions[id]);
+    s(txId, "transactionId");
+    s(dto, "transaction");
+
+    auto range = std::equal_range(m_transfers.begin(), m_transfers.end(), TransactionTransferPair(id, WalletTransfer()), transferLess);
+    uint64_t transferCount = std::distance(range.first, range.second);
+    s(transferCount, "transferCount");
+    for (auto it = range.first; it != range.second; ++it) {
+      WalletTransferDtoV2 tr(it->second);
+      s(tr, "transfer");
+    }
+  }
+
+  const auto& deposits = m_deposits.get<RandomAccessIndex>();
+  count = depositIds.size();
+  s(count, "depositCount");
+  for (size_t id : depositIds) {
+    uint64_t depositId = id;
+    WalletDepositDtoV2 dto(deposits[id]);
+    s(depositId, "depositId");
+    s(dto, "deposit");
+  }
+
+  saveUnlockTransactionsJobs(s);
+  s(m_uncommitedTransactions, "uncommitedTransactions");
+
+  auto& walletsIndex = m_walletsContainer.get<KeysIndex>();
+  std::vector<WalletRecord> wallets;
+  for (const auto& spendPublicKey : spendPublicKeys) {
+    auto walletIt = walletsIndex.find(spendPublicKey);
+    if (walletIt != walletsIndex.end()) {
+      wallets.push_back(*walletIt);
+    }
+  }
+
+  count = wallets.size();
+  s(count, "walletCount");
+  for (auto& wallet : wallets) {
+    s(wallet.spendPublicKey, "spendPublicKey");
+    s(wallet.actualBalance, "actualBalance");
+    s(wallet.pendingBalance, "pendingBalance");
+    s(wallet.lockedDepositBalance, "lockedDepositBalance");
+    s(wallet.unlockedDepositBalance, "unlockedDepositBalance");
+  }
+
+  s(m_extra, "extra");
+
+  // A wallet without addresses has nothing to synchronize
+  std::string transfersSynchronizerData;
+  if (!m_walletsContainer.empty()) {
+    std::stringstream stream;
+    synchronizerHeight = m_synchronizer.saveChanges(stream, m_viewPublicKey, synchronizerHeight);
+    transfersSynchronizerData = stream.str();
+  }
+
+  s(transfersSynchronizerData, "transfersSynchronizer");
+}
+
 std::unordered_set<Crypto::PublicKey>& WalletSerializerV2::addedKeys() {
   return m_addedKeys;
 }
@@ -335,21 +601,7 @@ void WalletSerializerV2::loadTransactions(CryptoNote::ISerializer& serializer) {
     WalletTransactionDtoV2 dto;
     serializer(dto, "transaction");
 
-    WalletTransaction tx;
-    tx.state = dto.state;
-    tx.timestamp = dto.timestamp;
-    tx.blockHeight = dto.blockHeight;
-    tx.hash = dto.hash;
-    tx.depositCount = dto.depositCount;
-    tx.firstDepositId = dto.firstDepositId;
-    tx.totalAmount = dto.totalAmount;
-    tx.fee = dto.fee;
-    tx.creationTime = dto.creationTime;
-    tx.unlockTime = dto.unlockTime;
-    tx.extra = dto.extra;
-    tx.isBase = dto.isBase;
-
-    m_transactions.get<RandomAccessIndex>().emplace_back(std::move(tx));
+    m_transactions.get<RandomAccessIndex>().emplace_back(toWalletTransaction(dto));
   }
 }
 
@@ -363,20 +615,7 @@ void WalletSerializerV2::loadDeposits(CryptoNote::ISerializer& serializer) {
     WalletDepositDtoV2 dto;
     serializer(dto, "deposit");
 
-    Deposit dp;
-    dp.creatingTransactionId = dto.creatingTransactionId;
-    dp.spendingTransactionId = dto.spendingTransactionId;
-    dp.term = dto.term;
-    dp.amount = dto.amount;
-    dp.interest = dto.interest;
-    dp.height = dto.height;
-    dp.unlockHeight = dto.unlockHeight;
-    dp.locked = dto.locked;
-    dp.transactionHash = dto.transactionHash;
-    dp.outputInTransaction = dto.outputInTransaction;
-    dp.address = dto.address;
-
-    m_deposits.get<RandomAccessIndex>().emplace_back(std::move(dp));
+    m_deposits.get<RandomAccessIndex>().emplace_back(toDeposit(dto));
   }
 }
 
@@ -413,12 +652,7 @@ void WalletSerializerV2::loadTransfers(CryptoNote::ISerializer& serializer) {
     WalletTransferDtoV2 dto;
     serializer(dto, "transfer");
 
-    WalletTransfer tr;
-    tr.address = dto.address;
-    tr.amount = dto.amount;
-    tr.type = static_cast<WalletTransferType>(dto.type);
-
-    m_transfers.emplace_back(std::piecewise_construct, std::forward_as_tuple(txId), std::forward_as_tuple(std::move(tr)));
+    m_transfers.emplace_back(std::piecewise_construct, std::forward_as_tuple(txId), std::forward_as_tuple(toWalletTransfer(dto)));
   }
 }
 
@@ -441,12 +675,16 @@ void WalletSerializerV2::loadTransfersSynchronizer(CryptoNote::ISerializer& seri
   serializer(transfersSynchronizerData, "transfersSynchronizer");
 
   std::stringstream stream(transfersSynchronizerData);
-  m_synchronizer.load(stream);
+  m_synchronizer.load(stream, m_viewPublicKey);
 }
 
-void WalletSerializerV2::saveTransfersSynchronizer(CryptoNote::ISerializer& serializer) {
+void WalletSerializerV2::saveTransfersSynchronizer(CryptoNote::ISerializer& serializer, IStreamSerializable* synchronizerSnapshot) {
   std::stringstream stream;
-  m_synchronizer.save(stream);
+  if (synchronizerSnapshot != nullptr) {
+    synchronizerSnapshot->save(stream);
+  } else {
+    m_synchronizer.save(stream, m_viewPublicKey);
+  }
   stream.flush();
 
   std::string transfersSynchronizerData = stream.str();
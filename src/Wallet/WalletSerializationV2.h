@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <set>
+
 #include "Common/IInputStream.h"
 #include "Common/IOutputStream.h"
 #include "Serialization/ISerializer.h"
@@ -49,6 +51,16 @@ public:
 
   void load(Common::IInputStream& source, uint8_t version);
   void save(Common::IOutputStream& destination, WalletSaveLevel saveLevel);
+  // Writes synchronizerSnapshot in place of the transfers synchronizer state
+  void save(Common::IOutputStream& destination, WalletSaveLevel saveLevel, IStreamSerializable& synchronizerSnapshot);
+
+  // Journal records: the given transactions with their transfers, the given
+  // deposits, the balances of the given addresses, the small wallet-wide state and
+  // the transfers synchronizer changes since its blockchain was synchronizerHeight
+  // long. synchronizerHeight is set to the height the record leaves the synchronizer at.
+  void loadDelta(Common::IInputStream& source);
+  void saveDelta(Common::IOutputStream& destination, const std::set<size_t>& transactionIds, const std::set<size_t>& depositIds,
+    const std::unordered_set<Crypto::PublicKey>& spendPublicKeys, uint32_t& synchronizerHeight);
 
   std::unordered_set<Crypto::PublicKey>& addedKeys();
   std::unordered_set<Crypto::PublicKey>& deletedKeys();
@@ -57,6 +69,8 @@ public:
   static const uint8_t SERIALIZATION_VERSION = 6;
 
 private:
+  void doSave(Common::IOutputStream& destination, WalletSaveLevel saveLevel, IStreamSerializable* synchronizerSnapshot);
+
   void loadKeyListAndBanalces(CryptoNote::ISerializer& serializer, bool saveCache);
   void saveKeyListAndBanalces(CryptoNote::ISerializer& serializer, bool saveCache);
     
@@ -70,12 +84,13 @@ private:
   void saveTransfers(CryptoNote::ISerializer& serializer);
 
   void loadTransfersSynchronizer(CryptoNote::ISerializer& serializer);
-  void saveTransfersSynchronizer(CryptoNote::ISerializer& serializer);
+  void saveTransfersSynchronizer(CryptoNote::ISerializer& serializer, IStreamSerializable* synchronizerSnapshot);
 
   void loadUnlockTransactionsJobs(CryptoNote::ISerializer& serializer);
   void saveUnlockTransactionsJobs(CryptoNote::ISerializer& serializer);
 
   ITransfersObserver& m_transfersObserver;
+  Crypto::PublicKey& m_viewPublicKey;
   uint64_t& m_actualBalance;
   uint64_t& m_pendingBalance;
   uint64_t& m_lockedDepositBalance;
@@ -0,0 +1,115 @@
+// Copyright (c) 2017-2022 Fuego Developers
+//
+// This file is part of Fuego.
+//
+// Fuego is free & open source software distributed in the hope
+// it will be useful, but WITHOUT ANY WARRANTY; without even an
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+// PURPOSE. You may redistribute it and/or modify it under the terms
+// of the GNU General Public License v3 or later versions as published
+// by the Free Software Foundation. Fuego includes elements written
+// by third parties. See file labeled LICENSE for more details.
+// You should have received a copy of the GNU General Public License
+// along with Fuego. If not, see <https://www.gnu.org/licenses/>.
+
+#include "WalletUnlockedOutputs.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace CryptoNote {
+
+bool UnlockedOutputs::add(const TransactionOutputInformation& output) {
+  if (find(output) != m_outputs.end()) {
+    return false;
+  }
+
+  m_outputs.emplace(output.amount, output);
+  return true;
+}
+
+bool UnlockedOutputs::remove(const TransactionOutputInformation& output) {
+  auto it = find(output);
+  if (it == m_outputs.end()) {
+    return false;
+  }
+
+  m_outputs.erase(it);
+  return true;
+}
+
+UnlockedOutputs::Outputs::iterator UnlockedOutputs::find(const TransactionOutputInformation& output) {
+  auto range = m_outputs.equal_range(output.amount);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second.transactionHash == output.transactionHash && it->second.outputInTransaction == output.outputInTransaction) {
+      return it;
+    }
+  }
+
+  return m_outputs.end();
+}
+
+uint64_t selectUnlockedOutputs(uint64_t neededMoney, uint64_t dustThreshold, const std::vector<const UnlockedOutputs*>& sources,
+  const std::unordered_set<Crypto::PublicKey>& reservedOutputs, std::vector<std::pair<size_t, TransactionOutputInformation>>& selected) {
+  struct OutputRange {
+    size_t source;
+    UnlockedOutputs::const_reverse_iterator current;
+    UnlockedOutputs::const_reverse_iterator end;
+  };
+
+  const int maxNumberOfDigits = std::numeric_limits<uint64_t>::digits10 + 1;
+  std::map<int, std::vector<OutputRange>> buckets;
+
+  for (size_t source = 0; source < sources.size(); ++source) {
+    const UnlockedOutputs& outs = *sources[source];
+    uint64_t lowerBound = 1;
+    for (int numberOfDigits = 1; numberOfDigits <= maxNumberOfDigits; ++numberOfDigits, lowerBound *= 10) {
+      bool lastBucket = numberOfDigits == maxNumberOfDigits;
+      if (!lastBucket && lowerBound * 10 <= dustThreshold + 1) {
+        continue;
+      }
+
+      auto first = outs.lower_bound(std::max(lowerBound, dustThreshold + 1));
+      auto last = lastBucket ? outs.end() : outs.lower_bound(lowerBound * 10);
+      if (first != last) {
+        buckets[numberOfDigits].push_back(OutputRange{source, UnlockedOutputs::const_reverse_iterator(last), UnlockedOutputs::const_reverse_iterator(first)});
+      }
+
+      if (lastBucket) {
+        break;
+      }
+    }
+  }
+
+  uint64_t foundMoney = 0;
+  while (foundMoney < neededMoney && !buckets.empty()) {
+    // one output from each bucket per round, smallest bucket first
+    for (auto bucket = buckets.begin(); bucket != buckets.end() && foundMoney < neededMoney;) {
+      if (bucket->second.empty()) {
+        bucket = buckets.erase(bucket);
+        continue;
+      }
+
+      OutputRange& range = bucket->second.back();
+      const TransactionOutputInformation& output = range.current->second;
+      bool reserved = reservedOutputs.count(output.outputKey) != 0;
+      if (!reserved) {
+        selected.emplace_back(range.source, output);
+        foundMoney += output.amount;
+      }
+
+      if (++range.current == range.end) {
+        bucket->second.pop_back();
+      }
+
+      // an output taken by another transaction doesn't use up the bucket's turn
+      if (!reserved) {
+        ++bucket;
+      }
+    }
+  }
+
+  return foundMoney;
+}
+
+}
@@ -0,0 +1,63 @@
+// Copyright (c) 2017-2022 Fuego Developers
+//
+// This file is part of Fuego.
+//
+// Fuego is free & open source software distributed in the hope
+// it will be useful, but WITHOUT ANY WARRANTY; without even an
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+// PURPOSE. You may redistribute it and/or modify it under the terms
+// of the GNU General Public License v3 or later versions as published
+// by the Free Software Foundation. Fuego includes elements written
+// by third parties. See file labeled LICENSE for more details.
+// You should have received a copy of the GNU General Public License
+// along with Fuego. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "ITransfersContainer.h"
+#include "crypto/crypto.h"
+
+namespace CryptoNote {
+
+// Unspent unlocked key outputs of one transfers container, ordered by amount.
+// It is kept up to date from the transfers observer events, so adding and
+// removing an output that is already (or no longer) there is a no-op.
+class UnlockedOutputs {
+public:
+  typedef std::multimap<uint64_t, TransactionOutputInformation> Outputs;
+  typedef Outputs::const_iterator const_iterator;
+  typedef Outputs::const_reverse_iterator const_reverse_iterator;
+
+  bool add(const TransactionOutputInformation& output);
+  bool remove(const TransactionOutputInformation& output);
+
+  const_iterator begin() const { return m_outputs.begin(); }
+  const_iterator end() const { return m_outputs.end(); }
+  const_iterator lower_bound(uint64_t amount) const { return m_outputs.lower_bound(amount); }
+  size_t size() const { return m_outputs.size(); }
+  bool empty() const { return m_outputs.empty(); }
+
+private:
+  Outputs::iterator find(const TransactionOutputInformation& output);
+
+  Outputs m_outputs;
+};
+
+// Picks outputs above dustThreshold from the given sources until neededMoney
+// is covered. Amounts are grouped by their number of decimal digits; every
+// round takes one output from each group, from the smallest group up. Within
+// a group the sources are drained one after another, last source first, each
+// from its largest amount down. Outputs whose keys are in
+// reservedOutputs are skipped. Selected outputs are returned together with
+// the index of their source. Returns the amount found, which is less than
+// neededMoney if the sources don't hold enough.
+uint64_t selectUnlockedOutputs(uint64_t neededMoney, uint64_t dustThreshold, const std::vector<const UnlockedOutputs*>& sources,
+  const std::unordered_set<Crypto::PublicKey>& reservedOutputs, std::vector<std::pair<size_t, TransactionOutputInformation>>& selected);
+
+}
@@ -535,10 +535,7 @@ namespace CryptoNote
         ephKeys.push_back(std::move(ephKey));
       }
 
-      for (size_t i = 0; i < inputs.size(); ++i)
-      {
-        transaction->signInputKey(i, inputs[i], ephKeys[i]);
-      }
+      transaction->signInputKeys(inputs, ephKeys);
 
       transactionInfo.hash = transaction->getTransactionHash();
 
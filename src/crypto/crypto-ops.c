@@ -5,6 +5,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <assert.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "crypto-ops.h"
@@ -1208,6 +1209,52 @@ void ge_double_scalarmult_base_vartime(ge_p2 *r, const unsigned char *a, const g
   }
 }
 
+/*
+Returns 0 if l * A is the identity, i.e. A lies in the prime-order subgroup, -1 otherwise.
+Variable time: only meant for public points such as key images.
+*/
+
+int ge_check_subgroup_vartime(const ge_p3 *A) {
+  static const unsigned char l[32] = {
+    0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10
+  };
+  signed char lslide[256];
+  ge_dsmp Ai; /* A, 3A, 5A, 7A, 9A, 11A, 13A, 15A */
+  ge_p1p1 t;
+  ge_p3 u;
+  ge_p2 r;
+  fe d;
+  int i;
+
+  slide(lslide, l);
+  ge_dsm_precomp(Ai, A);
+
+  ge_p2_0(&r);
+
+  for (i = 255; i >= 0; --i) {
+    if (lslide[i]) break;
+  }
+
+  for (; i >= 0; --i) {
+    ge_p2_dbl(&t, &r);
+
+    if (lslide[i] > 0) {
+      ge_p1p1_to_p3(&u, &t);
+      ge_add(&t, &u, &Ai[lslide[i]/2]);
+    } else if (lslide[i] < 0) {
+      ge_p1p1_to_p3(&u, &t);
+      ge_sub(&t, &u, &Ai[(-lslide[i])/2]);
+    }
+
+    ge_p1p1_to_p2(&r, &t);
+  }
+
+  /* The identity is (0 : Z : Z) in projective coordinates, no inversion needed */
+  fe_sub(d, r.Y, r.Z);
+  return (fe_isnonzero(r.X) || fe_isnonzero(d)) ? -1 : 0;
+}
+
 /* From ge_frombytes.c, modified */
 
 int ge_frombytes_vartime(ge_p3 *h, const unsigned char *s) {
@@ -1593,6 +1640,41 @@ void ge_tobytes(unsigned char *s, const ge_p2 *h) {
   s[31] ^= fe_isnegative(x) << 7;
 }
 
+/* Batched ge_tobytes: one field inversion for the whole batch (Montgomery's trick).
+   tmp must have room for count field elements; every Z must be nonzero. */
+
+void ge_p2_batch_tobytes(unsigned char *s, const ge_p2 *h, size_t count, fe *tmp) {
+  fe inv;
+  fe recip;
+  fe x;
+  fe y;
+  size_t i;
+
+  if (count == 0) {
+    return;
+  }
+
+  fe_copy(tmp[0], h[0].Z);
+  for (i = 1; i < count; i++) {
+    fe_mul(tmp[i], tmp[i - 1], h[i].Z);
+  }
+
+  fe_invert(inv, tmp[count - 1]);
+  for (i = count - 1; i > 0; i--) {
+    fe_mul(recip, inv, tmp[i - 1]);
+    fe_mul(inv, inv, h[i].Z);
+    fe_mul(x, h[i].X, recip);
+    fe_mul(y, h[i].Y, recip);
+    fe_tobytes(s + 32 * i, y);
+    s[32 * i + 31] ^= fe_isnegative(x) << 7;
+  }
+
+  fe_mul(x, h[0].X, inv);
+  fe_mul(y, h[0].Y, inv);
+  fe_tobytes(s, y);
+  s[31] ^= fe_isnegative(x) << 7;
+}
+
 /* From sc_reduce.c */
 
 /*
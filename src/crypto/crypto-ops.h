@@ -49,6 +49,7 @@ typedef ge_cached ge_dsmp[8];
 extern const ge_precomp ge_Bi[8];
 void ge_dsm_precomp(ge_dsmp r, const ge_p3 *s);
 void ge_double_scalarmult_base_vartime(ge_p2 *, const unsigned char *, const ge_p3 *, const unsigned char *);
+int ge_check_subgroup_vartime(const ge_p3 *);
 
 /* From ge_frombytes.c, modified */
 
@@ -93,6 +94,7 @@ void ge_sub(ge_p1p1 *, const ge_p3 *, const ge_cached *);
 /* From ge_tobytes.c */
 
 void ge_tobytes(unsigned char *, const ge_p2 *);
+void ge_p2_batch_tobytes(unsigned char *, const ge_p2 *, size_t, fe *);
 
 /* From sc_reduce.c */
 
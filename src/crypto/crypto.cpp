@@ -262,6 +262,57 @@ namespace Crypto {
     return true;
   }
 
+  void crypto_ops::underive_public_keys(const SecretKey &viewSecretKey, const OutputScanEntry *entries, size_t count,
+    PublicKey *bases, bool *valid) {
+    std::unique_ptr<ge_p2[]> points(new ge_p2[count]);
+    std::unique_ptr<size_t[]> positions(new size_t[count]);
+    size_t pointCount = 0;
+
+    KeyDerivation derivation;
+    const PublicKey *derivationKey = nullptr;
+    bool derivationValid = false;
+
+    for (size_t i = 0; i < count; ++i) {
+      const OutputScanEntry &entry = entries[i];
+      if (derivationKey == nullptr || entry.transactionPublicKey != *derivationKey) {
+        derivationKey = std::addressof(entry.transactionPublicKey);
+        derivationValid = generate_key_derivation(entry.transactionPublicKey, viewSecretKey, derivation);
+      }
+
+      valid[i] = false;
+      if (!derivationValid) {
+        continue;
+      }
+
+      EllipticCurveScalar scalar;
+      ge_p3 point1;
+      ge_p3 point2;
+      ge_cached point3;
+      ge_p1p1 point4;
+      if (ge_frombytes_vartime(&point1, reinterpret_cast<const unsigned char*>(&entry.outputKey)) != 0) {
+        continue;
+      }
+      derivation_to_scalar(derivation, entry.outputIndex, scalar);
+      ge_scalarmult_base(&point2, reinterpret_cast<unsigned char*>(&scalar));
+      ge_p3_to_cached(&point3, &point2);
+      ge_sub(&point4, &point1, &point3);
+      ge_p1p1_to_p2(&points[pointCount], &point4);
+      positions[pointCount++] = i;
+      valid[i] = true;
+    }
+
+    if (pointCount == 0) {
+      return;
+    }
+
+    std::unique_ptr<PublicKey[]> encoded(new PublicKey[pointCount]);
+    std::unique_ptr<fe[]> scratch(new fe[pointCount]);
+    ge_p2_batch_tobytes(reinterpret_cast<unsigned char*>(encoded.get()), points.get(), pointCount, scratch.get());
+    for (size_t i = 0; i < pointCount; ++i) {
+      bases[positions[i]] = encoded[i];
+    }
+  }
+
 
   struct s_comm {
     Hash h;
@@ -446,6 +497,14 @@ void crypto_ops::generate_tx_proof(const Hash &prefix_hash, const PublicKey &R,
     ge_p1p1_to_p3(&res, &point2);
   }
 
+  bool crypto_ops::check_key_image(const KeyImage &image) {
+    ge_p3 point;
+    if (ge_frombytes_vartime(&point, reinterpret_cast<const unsigned char*>(&image)) != 0) {
+      return false;
+    }
+    return ge_check_subgroup_vartime(&point) == 0;
+  }
+
   KeyImage crypto_ops::scalarmultKey(const KeyImage & P, const KeyImage & a) {
     ge_p3 A;
     ge_p2 R;
@@ -502,11 +561,33 @@ void crypto_ops::generate_tx_proof(const Hash &prefix_hash, const PublicKey &R,
     const PublicKey *const *pubs, size_t pubs_count,
     const SecretKey &sec, size_t sec_index,
     Signature *sig) {
+    EllipticCurveScalar k;
+    generate_ring_signature_scalars(pubs_count, sec_index, k, sig);
+    generate_ring_signature(prefix_hash, image, pubs, pubs_count, sec, sec_index, k, sig);
+  }
+
+  void crypto_ops::generate_ring_signature_scalars(size_t pubs_count, size_t sec_index,
+    EllipticCurveScalar &k, Signature *sig) {
+    assert(sec_index < pubs_count);
     lock_guard<mutex> lock(random_lock);
+    for (size_t i = 0; i < pubs_count; i++) {
+      if (i == sec_index) {
+        random_scalar(k);
+      } else {
+        random_scalar(reinterpret_cast<EllipticCurveScalar&>(sig[i]));
+        random_scalar(*reinterpret_cast<EllipticCurveScalar*>(reinterpret_cast<unsigned char*>(&sig[i]) + 32));
+      }
+    }
+  }
+
+  void crypto_ops::generate_ring_signature(const Hash &prefix_hash, const KeyImage &image,
+    const PublicKey *const *pubs, size_t pubs_count,
+    const SecretKey &sec, size_t sec_index,
+    const EllipticCurveScalar &k, Signature *sig) {
     size_t i;
     ge_p3 image_unp;
     ge_dsmp image_pre;
-    EllipticCurveScalar sum, k, h;
+    EllipticCurveScalar sum, h;
     rs_comm *const buf = reinterpret_cast<rs_comm *>(alloca(rs_comm_size(pubs_count)));
     assert(sec_index < pubs_count);
 #if !defined(NDEBUG)
@@ -535,15 +616,12 @@ void crypto_ops::generate_tx_proof(const Hash &prefix_hash, const PublicKey &R,
       ge_p2 tmp2;
       ge_p3 tmp3;
       if (i == sec_index) {
-        random_scalar(k);
-        ge_scalarmult_base(&tmp3, reinterpret_cast<unsigned char*>(&k));
+        ge_scalarmult_base(&tmp3, &k);
         ge_p3_tobytes(reinterpret_cast<unsigned char*>(&buf->ab[i].a), &tmp3);
         hash_to_ec(*pubs[i], tmp3);
-        ge_scalarmult(&tmp2, reinterpret_cast<unsigned char*>(&k), &tmp3);
+        ge_scalarmult(&tmp2, &k, &tmp3);
         ge_tobytes(reinterpret_cast<unsigned char*>(&buf->ab[i].b), &tmp2);
       } else {
-        random_scalar(reinterpret_cast<EllipticCurveScalar&>(sig[i]));
-        random_scalar(*reinterpret_cast<EllipticCurveScalar*>(reinterpret_cast<unsigned char*>(&sig[i]) + 32));
         if (ge_frombytes_vartime(&tmp3, reinterpret_cast<const unsigned char*>(&*pubs[i])) != 0) {
           abort();
         }
@@ -557,7 +635,7 @@ void crypto_ops::generate_tx_proof(const Hash &prefix_hash, const PublicKey &R,
     }
     hash_to_scalar(buf, rs_comm_size(pubs_count), h);
     sc_sub(reinterpret_cast<unsigned char*>(&sig[sec_index]), reinterpret_cast<unsigned char*>(&h), reinterpret_cast<unsigned char*>(&sum));
-    sc_mulsub(reinterpret_cast<unsigned char*>(&sig[sec_index]) + 32, reinterpret_cast<unsigned char*>(&sig[sec_index]), reinterpret_cast<const unsigned char*>(&sec), reinterpret_cast<unsigned char*>(&k));
+    sc_mulsub(reinterpret_cast<unsigned char*>(&sig[sec_index]) + 32, reinterpret_cast<unsigned char*>(&sig[sec_index]), reinterpret_cast<const unsigned char*>(&sec), &k);
   }
 
   bool crypto_ops::check_ring_signature(const Hash &prefix_hash, const KeyImage &image,
@@ -36,6 +36,12 @@ namespace Crypto {
 
   extern std::mutex random_lock;
 
+  struct OutputScanEntry {
+    PublicKey transactionPublicKey;
+    PublicKey outputKey;
+    size_t outputIndex;
+  };
+
   class crypto_ops {
     crypto_ops();
     crypto_ops(const crypto_ops &);
@@ -70,18 +76,26 @@ namespace Crypto {
     friend bool underive_public_key(const KeyDerivation &, size_t, const PublicKey &, PublicKey &);
     static bool underive_public_key(const KeyDerivation &, size_t, const PublicKey &, const uint8_t*, size_t, PublicKey &);
     friend bool underive_public_key(const KeyDerivation &, size_t, const PublicKey &, const uint8_t*, size_t, PublicKey &);
+    static void underive_public_keys(const SecretKey &, const OutputScanEntry *, size_t, PublicKey *, bool *);
+    friend void underive_public_keys(const SecretKey &, const OutputScanEntry *, size_t, PublicKey *, bool *);
     static void generate_signature(const Hash &, const PublicKey &, const SecretKey &, Signature &);
     friend void generate_signature(const Hash &, const PublicKey &, const SecretKey &, Signature &);
     static bool check_signature(const Hash &, const PublicKey &, const Signature &);
     friend bool check_signature(const Hash &, const PublicKey &, const Signature &);
     static void generate_key_image(const PublicKey &, const SecretKey &, KeyImage &);
     friend void generate_key_image(const PublicKey &, const SecretKey &, KeyImage &);
+    static bool check_key_image(const KeyImage &);
+    friend bool check_key_image(const KeyImage &);
     static KeyImage scalarmultKey(const KeyImage & P, const KeyImage & a);
     friend KeyImage scalarmultKey(const KeyImage & P, const KeyImage & a);
     static void hash_data_to_ec(const uint8_t*, std::size_t, PublicKey&);
     friend void hash_data_to_ec(const uint8_t*, std::size_t, PublicKey&);
     static void generate_ring_signature(const Hash &, const KeyImage &,
       const PublicKey *const *, size_t, const SecretKey &, size_t, Signature *);
+    static void generate_ring_signature_scalars(size_t, size_t, EllipticCurveScalar &, Signature *);
+    friend void generate_ring_signature_scalars(size_t, size_t, EllipticCurveScalar &, Signature *);
+    static void generate_ring_signature(const Hash &, const KeyImage &,
+      const PublicKey *const *, size_t, const SecretKey &, size_t, const EllipticCurveScalar &, Signature *);
 	  static void generate_tx_proof(const Hash &, const PublicKey &, const PublicKey &, const PublicKey &, const SecretKey &, Signature &);
 	friend void generate_tx_proof(const Hash &, const PublicKey &, const PublicKey &, const PublicKey &, const SecretKey &, Signature &);
 	static bool check_tx_proof(const Hash &, const PublicKey &, const PublicKey &, const PublicKey &, const Signature &);
@@ -89,6 +103,8 @@ namespace Crypto {
 
     friend void generate_ring_signature(const Hash &, const KeyImage &,
       const PublicKey *const *, size_t, const SecretKey &, size_t, Signature *);
+    friend void generate_ring_signature(const Hash &, const KeyImage &,
+      const PublicKey *const *, size_t, const SecretKey &, size_t, const EllipticCurveScalar &, Signature *);
 
     static bool check_ring_signature(const Hash &, const KeyImage &,
       const PublicKey *const *, size_t, const Signature *);
@@ -211,6 +227,16 @@ namespace Crypto {
     return crypto_ops::underive_public_key(derivation, output_index, derived_key, base);
   }
 
+  /* Batched output scanning: for every (transaction public key, output key, output index) entry computes
+   * underive_public_key(generate_key_derivation(transactionPublicKey, viewSecretKey), outputIndex, outputKey).
+   * The derivation is computed once per run of entries sharing a transaction key, and all resulting points are
+   * encoded with a single field inversion. valid[i] is set to false if either key of entry i is not a valid point.
+   */
+  inline void underive_public_keys(const SecretKey &viewSecretKey, const OutputScanEntry *entries, size_t count,
+    PublicKey *bases, bool *valid) {
+    crypto_ops::underive_public_keys(viewSecretKey, entries, count, bases, valid);
+  }
+
   /* Generation and checking of a standard signature.
    */
   inline void generate_signature(const Hash &prefix_hash, const PublicKey &pub, const SecretKey &sec, Signature &sig) {
@@ -240,6 +266,13 @@ namespace Crypto {
     crypto_ops::generate_key_image(pub, sec, image);
   }
 
+  /* Check that a key image is a valid point of the prime-order subgroup (l * I == identity).
+   * Uses a variable-time sliding window and skips the final point encoding, unlike scalarmultKey(I, L) == 1.
+   */
+  inline bool check_key_image(const KeyImage &image) {
+    return crypto_ops::check_key_image(image);
+  }
+
   inline KeyImage scalarmultKey(const KeyImage & P, const KeyImage & a) {
     return crypto_ops::scalarmultKey(P, a);
   }
@@ -254,6 +287,23 @@ namespace Crypto {
     Signature *sig) {
     crypto_ops::generate_ring_signature(prefix_hash, image, pubs, pubs_count, sec, sec_index, sig);
   }
+
+  /* Draws the random scalars of a ring signature: the commitment scalar k and the
+   * responses of every ring member except sec_index, which are stored in sig.
+   * Only this step takes random_lock, so the signatures themselves can be computed in parallel.
+   */
+  inline void generate_ring_signature_scalars(std::size_t pubs_count, std::size_t sec_index,
+    EllipticCurveScalar &k, Signature *sig) {
+    crypto_ops::generate_ring_signature_scalars(pubs_count, sec_index, k, sig);
+  }
+  /* Completes a ring signature whose scalars were drawn by generate_ring_signature_scalars.
+   */
+  inline void generate_ring_signature(const Hash &prefix_hash, const KeyImage &image,
+    const PublicKey *const *pubs, std::size_t pubs_count,
+    const SecretKey &sec, std::size_t sec_index,
+    const EllipticCurveScalar &k, Signature *sig) {
+    crypto_ops::generate_ring_signature(prefix_hash, image, pubs, pubs_count, sec, sec_index, k, sig);
+  }
   inline bool check_ring_signature(const Hash &prefix_hash, const KeyImage &image,
     const PublicKey *const *pubs, size_t pubs_count,
     const Signature *sig) {
@@ -64,6 +64,8 @@ enum {
 };
 
 void cn_fast_hash(const void *data, size_t length, char *hash);
+/* Four independent inputs of the same length; inputs are fully read before any hash is written */
+void cn_fast_hash_x4(const void *const data[4], size_t length, char *const hash[4]);
 
 void cn_slow_hash(const void *data, size_t length, char *hash, int light, int variant, int prehashed); 
 
@@ -24,3 +24,9 @@ void cn_fast_hash(const void *data, size_t length, char *hash) {
   hash_process(&state, data, length);
   memcpy(hash, &state, HASH_SIZE);
 }
+
+void cn_fast_hash_x4(const void *const data[4], size_t length, char *const hash[4]) {
+  const uint8_t *in[4] = { data[0], data[1], data[2], data[3] };
+  uint8_t *md[4] = { (uint8_t *) hash[0], (uint8_t *) hash[1], (uint8_t *) hash[2], (uint8_t *) hash[3] };
+  keccak_x4(in, (int) length, md, HASH_SIZE);
+}
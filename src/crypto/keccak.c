@@ -112,3 +112,154 @@ void keccak1600(const uint8_t *in, int inlen, uint8_t *md)
 {
     keccak(in, inlen, md, sizeof(state_t));
 }
+
+// update four states at once; AVX2 keeps one lane of all four states in a register
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+static inline __m256i rotl64x4(__m256i x, int y)
+{
+    return _mm256_or_si256(_mm256_sll_epi64(x, _mm_cvtsi32_si128(y)), _mm256_srl_epi64(x, _mm_cvtsi32_si128(64 - y)));
+}
+
+void keccakf_x4(uint64_t st[25][4], int rounds)
+{
+    int i, j, round;
+    __m256i s[25], t, bc[5];
+
+    for (i = 0; i < 25; i++)
+        s[i] = _mm256_loadu_si256((const __m256i *) st[i]);
+
+    for (round = 0; round < rounds; round++) {
+
+        // Theta
+        for (i = 0; i < 5; i++)
+            bc[i] = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(s[i], s[i + 5]), _mm256_xor_si256(s[i + 10], s[i + 15])), s[i + 20]);
+
+        for (i = 0; i < 5; i++) {
+            t = _mm256_xor_si256(bc[(i + 4) % 5], rotl64x4(bc[(i + 1) % 5], 1));
+            for (j = 0; j < 25; j += 5)
+                s[j + i] = _mm256_xor_si256(s[j + i], t);
+        }
+
+        // Rho Pi
+        t = s[1];
+        for (i = 0; i < 24; i++) {
+            j = keccakf_piln[i];
+            bc[0] = s[j];
+            s[j] = rotl64x4(t, keccakf_rotc[i]);
+            t = bc[0];
+        }
+
+        //  Chi
+        for (j = 0; j < 25; j += 5) {
+            for (i = 0; i < 5; i++)
+                bc[i] = s[j + i];
+            for (i = 0; i < 5; i++)
+                s[j + i] = _mm256_xor_si256(s[j + i], _mm256_andnot_si256(bc[(i + 1) % 5], bc[(i + 2) % 5]));
+        }
+
+        //  Iota
+        s[0] = _mm256_xor_si256(s[0], _mm256_set1_epi64x((long long) keccakf_rndc[round]));
+    }
+
+    for (i = 0; i < 25; i++)
+        _mm256_storeu_si256((__m256i *) st[i], s[i]);
+}
+
+#else
+
+// portable fallback, the inner loops over the four instances are left for the compiler to vectorize
+void keccakf_x4(uint64_t st[25][4], int rounds)
+{
+    int i, j, k, round;
+    uint64_t t[4], bc[5][4];
+
+    for (round = 0; round < rounds; round++) {
+
+        // Theta
+        for (i = 0; i < 5; i++)
+            for (k = 0; k < 4; k++)
+                bc[i][k] = st[i][k] ^ st[i + 5][k] ^ st[i + 10][k] ^ st[i + 15][k] ^ st[i + 20][k];
+
+        for (i = 0; i < 5; i++) {
+            for (k = 0; k < 4; k++)
+                t[k] = bc[(i + 4) % 5][k] ^ ROTL64(bc[(i + 1) % 5][k], 1);
+            for (j = 0; j < 25; j += 5)
+                for (k = 0; k < 4; k++)
+                    st[j + i][k] ^= t[k];
+        }
+
+        // Rho Pi
+        for (k = 0; k < 4; k++)
+            t[k] = st[1][k];
+        for (i = 0; i < 24; i++) {
+            j = keccakf_piln[i];
+            for (k = 0; k < 4; k++) {
+                bc[0][k] = st[j][k];
+                st[j][k] = ROTL64(t[k], keccakf_rotc[i]);
+                t[k] = bc[0][k];
+            }
+        }
+
+        //  Chi
+        for (j = 0; j < 25; j += 5) {
+            for (i = 0; i < 5; i++)
+                for (k = 0; k < 4; k++)
+                    bc[i][k] = st[j + i][k];
+            for (i = 0; i < 5; i++)
+                for (k = 0; k < 4; k++)
+                    st[j + i][k] ^= (~bc[(i + 1) % 5][k]) & bc[(i + 2) % 5][k];
+        }
+
+        //  Iota
+        for (k = 0; k < 4; k++)
+            st[0][k] ^= keccakf_rndc[round];
+    }
+}
+
+#endif
+
+// keccak() over four inputs of the same length; every input is absorbed before any output is written,
+// so md may overlap in
+int keccak_x4(const uint8_t *const in[4], int inlen, uint8_t *const md[4], int mdlen)
+{
+    uint64_t st[25][4];
+    uint8_t temp[4][144];
+    int i, k, rsiz, rsizw, offset;
+
+    const int HASH_DATA_AREA = 136;
+
+    rsiz = sizeof(state_t) == mdlen ? HASH_DATA_AREA : 200 - 2 * mdlen;
+    rsizw = rsiz / 8;
+
+    memset(st, 0, sizeof(st));
+
+    for (offset = 0; inlen >= rsiz; inlen -= rsiz, offset += rsiz) {
+        for (i = 0; i < rsizw; i++)
+            for (k = 0; k < 4; k++)
+                st[i][k] ^= ((const uint64_t *) (in[k] + offset))[i];
+        keccakf_x4(st, KECCAK_ROUNDS);
+    }
+
+    // last block and padding
+    for (k = 0; k < 4; k++) {
+        memcpy(temp[k], in[k] + offset, inlen);
+        temp[k][inlen] = 1;
+        memset(temp[k] + inlen + 1, 0, rsiz - inlen - 1);
+        temp[k][rsiz - 1] |= 0x80;
+    }
+
+    for (i = 0; i < rsizw; i++)
+        for (k = 0; k < 4; k++)
+            st[i][k] ^= ((uint64_t *) temp[k])[i];
+
+    keccakf_x4(st, KECCAK_ROUNDS);
+
+    for (k = 0; k < 4; k++)
+        for (i = 0; i < mdlen; i += 8)
+            memcpy(md[k] + i, &st[i / 8][k], mdlen - i < 8 ? mdlen - i : 8);
+
+    return 0;
+}
@@ -23,4 +23,10 @@ void keccakf(uint64_t st[25], int norounds);
 
 void keccak1600(const uint8_t *in, int inlen, uint8_t *md);
 
+// update four independent states at once, st[i][k] is lane i of state k
+void keccakf_x4(uint64_t st[25][4], int norounds);
+
+// compute keccak hashes of four inputs of the same byte length
+int keccak_x4(const uint8_t *const in[4], int inlen, uint8_t *const md[4], int mdlen);
+
 #endif
@@ -11,6 +11,19 @@
 
 #include "hash-ops.h"
 
+// out[j] = H(in[2j] || in[2j + 1]) for j < count, four pairs per Keccak pass; out may alias in
+static void hash_pairs(const char (*in)[HASH_SIZE], size_t count, char (*out)[HASH_SIZE]) {
+  size_t j;
+  for (j = 0; j + 4 <= count; j += 4) {
+    const void *data[4] = { in[2 * j], in[2 * j + 2], in[2 * j + 4], in[2 * j + 6] };
+    char *hash[4] = { out[j], out[j + 1], out[j + 2], out[j + 3] };
+    cn_fast_hash_x4(data, 2 * HASH_SIZE, hash);
+  }
+  for (; j < count; ++j) {
+    cn_fast_hash(in[2 * j], 2 * HASH_SIZE, out[j]);
+  }
+}
+
 void tree_hash(const char (*hashes)[HASH_SIZE], size_t count, char *root_hash) {
   assert(count > 0);
   if (count == 1) {
@@ -18,7 +31,7 @@ void tree_hash(const char (*hashes)[HASH_SIZE], size_t count, char *root_hash) {
   } else if (count == 2) {
     cn_fast_hash(hashes, 2 * HASH_SIZE, root_hash);
   } else {
-    size_t i, j;
+    size_t i;
     size_t cnt = count - 1;
     char (*ints)[HASH_SIZE];
     for (i = 1; i < 8 * sizeof(size_t); i <<= 1) {
@@ -27,15 +40,10 @@ void tree_hash(const char (*hashes)[HASH_SIZE], size_t count, char *root_hash) {
     cnt &= ~(cnt >> 1);
     ints = alloca(cnt * HASH_SIZE);
     memcpy(ints, hashes, (2 * cnt - count) * HASH_SIZE);
-    for (i = 2 * cnt - count, j = 2 * cnt - count; j < cnt; i += 2, ++j) {
-      cn_fast_hash(hashes[i], 2 * HASH_SIZE, ints[j]);
-    }
-    assert(i == count);
+    hash_pairs(hashes + 2 * cnt - count, count - cnt, ints + 2 * cnt - count);
     while (cnt > 2) {
       cnt >>= 1;
-      for (i = 0, j = 0; j < cnt; i += 2, ++j) {
-        cn_fast_hash(ints[i], 2 * HASH_SIZE, ints[j]);
-      }
+      hash_pairs(ints, cnt, ints);
     }
     cn_fast_hash(ints[0], 2 * HASH_SIZE, root_hash);
   }
@@ -55,7 +63,7 @@ size_t tree_depth(size_t count) {
 }
 
 void tree_branch(const char (*hashes)[HASH_SIZE], size_t count, char (*branch)[HASH_SIZE]) {
-  size_t i, j;
+  size_t i;
   size_t cnt = 1;
   size_t depth = 0;
   char (*ints)[HASH_SIZE];
@@ -70,18 +78,13 @@ void tree_branch(const char (*hashes)[HASH_SIZE], size_t count, char (*branch)[H
   assert(depth == tree_depth(count));
   ints = alloca((cnt - 1) * HASH_SIZE);
   memcpy(ints, hashes + 1, (2 * cnt - count - 1) * HASH_SIZE);
-  for (i = 2 * cnt - count, j = 2 * cnt - count - 1; j < cnt - 1; i += 2, ++j) {
-    cn_fast_hash(hashes[i], 2 * HASH_SIZE, ints[j]);
-  }
-  assert(i == count);
+  hash_pairs(hashes + 2 * cnt - count, count - cnt, ints + 2 * cnt - count - 1);
   while (depth > 0) {
     assert(cnt == 1ULL << depth);
     cnt >>= 1;
     --depth;
     memcpy(branch[depth], ints[0], HASH_SIZE);
-    for (i = 1, j = 0; j < cnt - 1; i += 2, ++j) {
-      cn_fast_hash(ints[i], 2 * HASH_SIZE, ints[j]);
-    }
+    hash_pairs(ints + 1, cnt - 1, ints);
   }
 }
 
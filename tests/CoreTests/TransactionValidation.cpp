@@ -556,6 +556,41 @@ bool gen_tx_check_input_unlock_time::generate(std::vector<test_event_entry>& eve
   return true;
 }
 
+bool gen_tx_check_input_unlock_time_after_reorg::generate(std::vector<test_event_entry>& events) const
+{
+  uint64_t ts_start = 1338224400;
+
+  GENERATE_ACCOUNT(miner_account);
+  MAKE_GENESIS_BLOCK(events, blk_0, miner_account, ts_start);
+  REWIND_BLOCKS(events, blk_0r, blk_0, miner_account);
+  MAKE_ACCOUNT(events, alice_account);
+
+  // alice's output can only be spent in a block on top of blk_4
+  uint64_t unlock_height = get_block_height(blk_0r) + 4 + m_currency.lockedTxAllowedDeltaBlocks();
+  Transaction tx_0 = make_simple_tx_with_unlock_time(events, blk_0r, miner_account, alice_account,
+    MK_COINS(1) + m_currency.minimumFee(), m_currency.minimumFee(), unlock_height);
+  events.push_back(tx_0);
+  MAKE_NEXT_BLOCK_TX1(events, blk_1, blk_0r, miner_account, tx_0);
+  MAKE_NEXT_BLOCK(events, blk_2, blk_1, miner_account);
+  MAKE_NEXT_BLOCK(events, blk_3, blk_2, miner_account);
+  MAKE_NEXT_BLOCK(events, blk_4, blk_3, miner_account);
+
+  // verified against the main chain and kept in the pool
+  Transaction tx_1 = make_simple_tx_with_unlock_time(events, blk_4, alice_account, miner_account, MK_COINS(1),
+    m_currency.minimumFee(), 0);
+  events.push_back(tx_1);
+
+  // the alternative chain forks above the block of tx_0 and includes tx_1 while alice's output is still locked,
+  // so switching to it has to fail even though tx_1 was already verified before the main chain blocks were popped
+  MAKE_NEXT_BLOCK_TX1(events, blk_2a, blk_1, miner_account, tx_1);
+  MAKE_NEXT_BLOCK(events, blk_3a, blk_2a, miner_account);
+  MAKE_NEXT_BLOCK(events, blk_4a, blk_3a, miner_account);
+  DO_CALLBACK(events, "mark_invalid_block");
+  MAKE_NEXT_BLOCK(events, blk_5a, blk_4a, miner_account);
+
+  return true;
+}
+
 bool gen_tx_txout_to_key_has_invalid_key::generate(std::vector<test_event_entry>& events) const
 {
   uint64_t ts_start = 1338224400;
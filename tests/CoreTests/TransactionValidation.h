@@ -114,6 +114,11 @@ struct gen_tx_check_input_unlock_time : public get_tx_validation_base
   bool generate(std::vector<test_event_entry>& events) const;
 };
 
+struct gen_tx_check_input_unlock_time_after_reorg : public get_tx_validation_base
+{
+  bool generate(std::vector<test_event_entry>& events) const;
+};
+
 struct gen_tx_txout_to_key_has_invalid_key : public get_tx_validation_base
 {
   bool generate(std::vector<test_event_entry>& events) const;
@@ -3,7 +3,9 @@
 // Distributed under the MIT/X11 software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <chrono>
 #include <cstddef>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <ios>
@@ -32,13 +34,65 @@ extern "C" {
   static void slow_hash(const void *data, size_t length, char *hash) {
     cn_slow_hash_v0(*context, data, length, *reinterpret_cast<chash *>(hash));
   }
+
+  static void fast_hash_x4(const void *data, size_t length, char *hash) {
+    chash lanes[4];
+    const void *inputs[4] = {data, data, data, data};
+    char *outputs[4] = {(char *) &lanes[0], (char *) &lanes[1], (char *) &lanes[2], (char *) &lanes[3]};
+    Crypto::cn_fast_hash_x4(inputs, length, outputs);
+    if (lanes[1] != lanes[0] || lanes[2] != lanes[0] || lanes[3] != lanes[0]) {
+      throw ios_base::failure("cn_fast_hash_x4 lanes disagree");
+    }
+    memcpy(hash, &lanes[0], sizeof(chash));
+  }
+}
+
+template<typename F>
+static double throughput(size_t bytes_per_call, F f) {
+  const auto duration = chrono::milliseconds(500);
+  size_t calls = 0;
+  auto start = chrono::steady_clock::now();
+  auto elapsed = chrono::steady_clock::duration::zero();
+  do {
+    for (size_t i = 0; i < 64; ++i) {
+      f();
+    }
+    calls += 64;
+    elapsed = chrono::steady_clock::now() - start;
+  } while (elapsed < duration);
+  return double(bytes_per_call) * calls / chrono::duration<double>(elapsed).count() / (1024 * 1024);
+}
+
+// hash-tests bench: MB/s of the pairwise Keccak used by the Merkle tree, single and four-way, and of tree_hash
+static int run_benchmark() {
+  vector<chash> leaves(4096);
+  for (size_t i = 0; i < leaves.size(); ++i) {
+    Crypto::cn_fast_hash(&i, sizeof(i), leaves[i]);
+  }
+
+  chash out[4];
+  cout << fixed << setprecision(1);
+  cout << "cn_fast_hash, 64 bytes:    " << throughput(2 * sizeof(chash), [&] {
+    Crypto::cn_fast_hash(&leaves[0], 2 * sizeof(chash), out[0]);
+  }) << " MB/s" << endl;
+  cout << "cn_fast_hash_x4, 64 bytes: " << throughput(8 * sizeof(chash), [&] {
+    const void *inputs[4] = {&leaves[0], &leaves[2], &leaves[4], &leaves[6]};
+    char *outputs[4] = {(char *) &out[0], (char *) &out[1], (char *) &out[2], (char *) &out[3]};
+    Crypto::cn_fast_hash_x4(inputs, 2 * sizeof(chash), outputs);
+  }) << " MB/s" << endl;
+  for (size_t count : {3, 16, 255, 4096}) {
+    cout << "tree_hash, " << setw(4) << count << " leaves:   " << throughput(count * sizeof(chash), [&] {
+      Crypto::tree_hash(leaves.data(), count, out[0]);
+    }) << " MB/s" << endl;
+  }
+  return 0;
 }
 
 extern "C" typedef void hash_f(const void *, size_t, char *);
 struct hash_func {
   const string name;
   hash_f &f;
-} hashes[] = {{"fast", Crypto::cn_fast_hash}, {"slow", slow_hash}, {"tree", hash_tree},
+} hashes[] = {{"fast", Crypto::cn_fast_hash}, {"fast-x4", fast_hash_x4}, {"slow", slow_hash}, {"tree", hash_tree},
   {"extra-blake", Crypto::hash_extra_blake}, {"extra-groestl", Crypto::hash_extra_groestl},
   {"extra-jh", Crypto::hash_extra_jh}, {"extra-skein", Crypto::hash_extra_skein}};
 
@@ -50,6 +104,9 @@ int main(int argc, char *argv[]) {
   chash expected, actual;
   size_t test = 0;
   bool error = false;
+  if (argc == 2 && string(argv[1]) == "bench") {
+    return run_benchmark();
+  }
   if (argc != 3) {
     cerr << "Wrong number of arguments" << endl;
     return 1;
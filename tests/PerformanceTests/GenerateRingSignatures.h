@@ -0,0 +1,86 @@
+// Copyright (c) 2017-2022 Fuego Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <vector>
+
+#include "crypto/crypto.h"
+#include "CryptoNoteCore/CryptoNoteFormatUtils.h"
+
+// Ring signatures of an inputs_count-input transaction with mixin fake outputs per input.
+template<size_t inputs_count, size_t mixin>
+class ring_signatures_test_base
+{
+public:
+  static const size_t loop_count = 10;
+  static const size_t ring_size = mixin + 1;
+  static const size_t real_output = mixin / 2;
+
+  bool init()
+  {
+    m_ring_keys.resize(inputs_count * ring_size);
+    m_inputs.resize(inputs_count);
+
+    for (size_t i = 0; i < inputs_count; ++i)
+    {
+      CryptoNote::RingSignatureInput& input = m_inputs[i];
+      for (size_t j = 0; j < ring_size; ++j)
+      {
+        Crypto::PublicKey& key = m_ring_keys[i * ring_size + j];
+        Crypto::SecretKey sk;
+        Crypto::generate_keys(key, sk);
+        if (j == real_output)
+        {
+          input.secretKey = sk;
+          Crypto::generate_key_image(key, sk, input.keyImage);
+        }
+
+        input.keys.push_back(&key);
+      }
+
+      input.realOutput = real_output;
+    }
+
+    m_prefix_hash = Crypto::rand<Crypto::Hash>();
+    return true;
+  }
+
+protected:
+  Crypto::Hash m_prefix_hash;
+  std::vector<Crypto::PublicKey> m_ring_keys;
+  std::vector<CryptoNote::RingSignatureInput> m_inputs;
+  std::vector<std::vector<Crypto::Signature>> m_signatures;
+};
+
+// One generate_ring_signature call after another, as transactions were signed before.
+template<size_t inputs_count, size_t mixin>
+class test_generate_ring_signature : public ring_signatures_test_base<inputs_count, mixin>
+{
+public:
+  bool test()
+  {
+    this->m_signatures.resize(inputs_count);
+    for (size_t i = 0; i < inputs_count; ++i)
+    {
+      const CryptoNote::RingSignatureInput& input = this->m_inputs[i];
+      this->m_signatures[i].resize(input.keys.size());
+      Crypto::generate_ring_signature(this->m_prefix_hash, input.keyImage, input.keys, input.secretKey, input.realOutput, this->m_signatures[i].data());
+    }
+
+    return true;
+  }
+};
+
+// Same inputs signed through generateRingSignatures, spread over the available cores.
+template<size_t inputs_count, size_t mixin>
+class test_generate_ring_signatures : public ring_signatures_test_base<inputs_count, mixin>
+{
+public:
+  bool test()
+  {
+    CryptoNote::generateRingSignatures(this->m_prefix_hash, this->m_inputs, this->m_signatures);
+    return this->m_signatures.size() == inputs_count;
+  }
+};
@@ -0,0 +1,70 @@
+// Copyright (c) 2017-2022 Fuego Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include "Common/StringTools.h"
+#include "crypto/crypto.h"
+#include "Rpc/CoreRpcServerCommandsDefinitions.h"
+#include "Serialization/SerializationTools.h"
+
+// Renders the f_block_json response of a block with transactions_count transactions,
+// through a Common::JsonValue or straight into a string
+template<bool direct>
+class test_json_output
+{
+public:
+  static const size_t loop_count = 100;
+  static const size_t transactions_count = 2000;
+
+  bool init()
+  {
+    m_block.major_version = 8;
+    m_block.minor_version = 0;
+    m_block.timestamp = 1600000000;
+    m_block.prev_hash = Common::podToHex(Crypto::rand<Crypto::Hash>());
+    m_block.nonce = 12345;
+    m_block.orphan_status = false;
+    m_block.height = 800000;
+    m_block.depth = 0;
+    m_block.hash = Common::podToHex(Crypto::rand<Crypto::Hash>());
+    m_block.difficulty = 123456789;
+    m_block.reward = 8000000;
+    m_block.blockSize = 100000;
+    m_block.sizeMedian = 100000;
+    m_block.effectiveSizeMedian = 100000;
+    m_block.transactionsCumulativeSize = 100000;
+    m_block.alreadyGeneratedCoins = "7900000000000000";
+    m_block.alreadyGeneratedTransactions = 1000000;
+    m_block.baseReward = 8000000;
+    m_block.penalty = 0.0;
+    m_block.totalFeeAmount = 0;
+
+    for (size_t i = 0; i < transactions_count; ++i)
+    {
+      CryptoNote::f_transaction_short_response transaction;
+      transaction.hash = Common::podToHex(Crypto::rand<Crypto::Hash>());
+      transaction.fee = 800000;
+      transaction.amount_out = 1000000000 + i;
+      transaction.size = 2000 + i;
+      m_block.transactions.push_back(transaction);
+      m_block.totalFeeAmount += transaction.fee;
+    }
+
+    return true;
+  }
+
+  bool test()
+  {
+    return !render().empty();
+  }
+
+  std::string render()
+  {
+    return direct ? CryptoNote::storeToJson(m_block) : CryptoNote::storeToJsonValue(m_block).toString();
+  }
+
+private:
+  CryptoNote::f_block_details_response m_block;
+};
@@ -0,0 +1,49 @@
+// Copyright (c) 2017-2022 Fuego Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <sstream>
+
+#include "Common/JsonValue.h"
+#include "JsonOutput.h"
+
+// Parses the f_block_json response of test_json_output, through an std::istream or from the buffer
+template<bool buffer>
+class test_json_parse
+{
+public:
+  static const size_t loop_count = 100;
+
+  bool init()
+  {
+    test_json_output<true> output;
+    if (!output.init())
+    {
+      return false;
+    }
+
+    m_json = output.render();
+    return true;
+  }
+
+  bool test()
+  {
+    Common::JsonValue value;
+    if (buffer)
+    {
+      value = Common::JsonValue::fromString(m_json);
+    }
+    else
+    {
+      std::istringstream stream(m_json);
+      stream >> value;
+    }
+
+    return value.isObject();
+  }
+
+private:
+  std::string m_json;
+};
@@ -0,0 +1,52 @@
+// Copyright (c) 2017-2022 Fuego Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include "crypto/crypto.h"
+#include "CryptoNoteCore/CryptoNoteBasicImpl.h"
+#include "Logging/CommonLogger.h"
+#include "Logging/LoggerRef.h"
+
+// Formats the message with the default pattern and throws it away, as a logger without output would.
+class null_logger : public Logging::CommonLogger
+{
+public:
+  null_logger() : Logging::CommonLogger(Logging::INFO) {}
+};
+
+// A per-transaction message of the block processing path, written messages_count times at the given level
+// to a logger that keeps INFO and above.
+template<Logging::Level level>
+class test_logger_message
+{
+public:
+  static const size_t loop_count = 10;
+  static const size_t messages_count = 100000;
+
+  test_logger_message() : m_logger(m_sink, "protocol")
+  {
+  }
+
+  bool init()
+  {
+    m_hash = Crypto::rand<Crypto::Hash>();
+    return true;
+  }
+
+  bool test()
+  {
+    for (size_t i = 0; i < messages_count; ++i)
+    {
+      m_logger(level) << "transaction " << m_hash << " came in processObjects, index " << i;
+    }
+
+    return true;
+  }
+
+private:
+  null_logger m_sink;
+  Logging::LoggerRef m_logger;
+  Crypto::Hash m_hash;
+};
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <iostream>
+#include <thread>
 
 #include <boost/config.hpp>
 
@@ -35,6 +36,32 @@ void set_process_affinity(int core)
 #endif
 }
 
+// Lets the calling thread, and the threads it starts afterwards, run on every core again
+void set_process_affinity_all()
+{
+#if defined (__APPLE__)
+    return;
+#elif defined(BOOST_WINDOWS)
+  DWORD_PTR processMask = 0;
+  DWORD_PTR systemMask = 0;
+  if (::GetProcessAffinityMask(::GetCurrentProcess(), &processMask, &systemMask))
+  {
+    ::SetProcessAffinityMask(::GetCurrentProcess(), systemMask);
+  }
+#elif defined(BOOST_HAS_PTHREADS)
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  for (unsigned i = 0; i < std::thread::hardware_concurrency() && i < CPU_SETSIZE; ++i)
+  {
+    CPU_SET(i, &cpuset);
+  }
+  if (0 != ::pthread_setaffinity_np(::pthread_self(), sizeof(cpuset), &cpuset))
+  {
+    std::cout << "pthread_setaffinity_np - ERROR" << std::endl;
+  }
+#endif
+}
+
 void set_thread_high_priority()
 {
 #if defined(__APPLE__)
@@ -0,0 +1,91 @@
+// Copyright (c) 2017-2022 Fuego Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "crypto/crypto.h"
+#include "CryptoNoteCore/CryptoNoteBasic.h"
+
+#include "SingleTransactionTestBase.h"
+
+// Scans outputs_count outputs of one transaction the way TransfersConsumer did before batching:
+// one key derivation per transaction, then one underive_public_key per output.
+template<size_t outputs_count>
+class test_underive_public_key : public single_tx_test_base
+{
+public:
+  static const size_t loop_count = 100;
+
+  bool init()
+  {
+    if (!single_tx_test_base::init())
+      return false;
+
+    for (size_t i = 0; i < outputs_count; ++i)
+    {
+      Crypto::SecretKey sk;
+      Crypto::generate_keys(m_output_keys[i], sk);
+    }
+
+    return true;
+  }
+
+  bool test()
+  {
+    Crypto::KeyDerivation derivation;
+    if (!Crypto::generate_key_derivation(m_tx_pub_key, m_bob.getAccountKeys().viewSecretKey, derivation))
+      return false;
+
+    for (size_t i = 0; i < outputs_count; ++i)
+    {
+      if (!Crypto::underive_public_key(derivation, i, m_output_keys[i], m_spend_keys[i]))
+        return false;
+    }
+
+    return true;
+  }
+
+private:
+  Crypto::PublicKey m_output_keys[outputs_count];
+  Crypto::PublicKey m_spend_keys[outputs_count];
+};
+
+// Same work through the batched underive_public_keys API.
+template<size_t outputs_count>
+class test_underive_public_keys : public single_tx_test_base
+{
+public:
+  static const size_t loop_count = 100;
+
+  bool init()
+  {
+    if (!single_tx_test_base::init())
+      return false;
+
+    m_entries.resize(outputs_count);
+    for (size_t i = 0; i < outputs_count; ++i)
+    {
+      Crypto::SecretKey sk;
+      m_entries[i].transactionPublicKey = m_tx_pub_key;
+      Crypto::generate_keys(m_entries[i].outputKey, sk);
+      m_entries[i].outputIndex = i;
+    }
+
+    return true;
+  }
+
+  bool test()
+  {
+    Crypto::underive_public_keys(m_bob.getAccountKeys().viewSecretKey, m_entries.data(), outputs_count, m_spend_keys, m_valid);
+    return m_valid[outputs_count - 1];
+  }
+
+private:
+  std::vector<Crypto::OutputScanEntry> m_entries;
+  Crypto::PublicKey m_spend_keys[outputs_count];
+  bool m_valid[outputs_count];
+};
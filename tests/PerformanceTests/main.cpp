@@ -15,7 +15,12 @@
 #include "GenerateKeyDerivation.h"
 #include "GenerateKeyImage.h"
 #include "GenerateKeyImageHelper.h"
+#include "GenerateRingSignatures.h"
 #include "IsOutToAccount.h"
+#include "JsonOutput.h"
+#include "JsonParse.h"
+#include "LoggerMessage.h"
+#include "UnderivePublicKeys.h"
 
 int main(int argc, char** argv)
 {
@@ -58,8 +63,29 @@ int main(int argc, char** argv)
   TEST_PERFORMANCE0(test_derive_public_key);
   TEST_PERFORMANCE0(test_derive_secret_key);
 
+  TEST_PERFORMANCE1(test_underive_public_key, 2);
+  TEST_PERFORMANCE1(test_underive_public_keys, 2);
+  TEST_PERFORMANCE1(test_underive_public_key, 16);
+  TEST_PERFORMANCE1(test_underive_public_keys, 16);
+  TEST_PERFORMANCE1(test_underive_public_key, 100);
+  TEST_PERFORMANCE1(test_underive_public_keys, 100);
+
+  // parallel signing threads inherit the affinity of this thread, so both runs get every core
+  set_process_affinity_all();
+  TEST_PERFORMANCE2(test_generate_ring_signature, 100, 8);
+  TEST_PERFORMANCE2(test_generate_ring_signatures, 100, 8);
+  set_process_affinity(1);
+
   TEST_PERFORMANCE0(test_cn_slow_hash);
 
+  TEST_PERFORMANCE1(test_logger_message, Logging::INFO);
+  TEST_PERFORMANCE1(test_logger_message, Logging::TRACE);
+
+  TEST_PERFORMANCE1(test_json_output, false);
+  TEST_PERFORMANCE1(test_json_output, true);
+  TEST_PERFORMANCE1(test_json_parse, false);
+  TEST_PERFORMANCE1(test_json_parse, true);
+
   std::cout << "Tests finished. Elapsed time: " << timer.elapsed_ms() / 1000 << " sec" << std::endl;
 
   return 0;
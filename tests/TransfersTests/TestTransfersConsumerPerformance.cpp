@@ -0,0 +1,89 @@
+// Copyright (c) 2017-2022 Fuego Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "Globals.h"
+
+#include <chrono>
+#include <iostream>
+
+#include "Common/WorkerPool.h"
+#include "CryptoNoteCore/Account.h"
+#include "CryptoNoteCore/TransactionApi.h"
+#include "Logging/LoggerGroup.h"
+#include "Transfers/CommonTypes.h"
+#include "Transfers/TransfersConsumer.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+const uint32_t BENCHMARK_BLOCK_COUNT = 100;
+const size_t BENCHMARK_TRANSACTIONS_PER_BLOCK = 20;
+const size_t BENCHMARK_OUTPUTS_PER_TRANSACTION = 4;
+
+// Blocks full of transactions paying to foreign addresses: every output is derived
+// and checked, none of them pays the consumer, so the node is never asked for indices.
+std::vector<CompleteBlock> makeBenchmarkBlocks() {
+  std::vector<CompleteBlock> blocks(BENCHMARK_BLOCK_COUNT);
+  uint64_t timestamp = time(nullptr);
+
+  for (auto& block : blocks) {
+    block.block = CryptoNote::Block();
+    block.block->timestamp = timestamp++;
+
+    for (size_t i = 0; i < BENCHMARK_TRANSACTIONS_PER_BLOCK; ++i) {
+      auto tx = createTransaction();
+      for (size_t j = 0; j < BENCHMARK_OUTPUTS_PER_TRANSACTION; ++j) {
+        AccountBase receiver;
+        receiver.generate();
+        tx->addOutput(1000, receiver.getAccountKeys().address);
+      }
+
+      block.transactions.emplace_back(std::move(tx));
+    }
+  }
+
+  return blocks;
+}
+
+std::chrono::milliseconds scanBlocks(INode& node, Logging::ILogger& logger, Tools::WorkerPool& workerPool, const std::vector<CompleteBlock>& blocks) {
+  AccountBase account;
+  account.generate();
+
+  AccountSubscription subscription;
+  subscription.keys = account.getAccountKeys();
+  subscription.syncStart.height = 0;
+  subscription.syncStart.timestamp = 0;
+  subscription.transactionSpendableAge = 1;
+
+  TransfersConsumer consumer(currency, node, logger, subscription.keys.viewSecretKey, workerPool);
+  consumer.addSubscription(subscription);
+
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(consumer.onNewBlocks(blocks.data(), 1, static_cast<uint32_t>(blocks.size())));
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+}
+
+}
+
+TEST_F(TransfersTest, consumerBlockScanPerformance) {
+  launchTestnet(1);
+
+  std::unique_ptr<INode> node;
+  nodeDaemons[0]->makeINode(node);
+
+  Logging::LoggerGroup logger;
+  auto blocks = makeBenchmarkBlocks();
+
+  Tools::WorkerPool singleWorker(1);
+  Tools::WorkerPool allWorkers;
+
+  auto singleWorkerTime = scanBlocks(*node, logger, singleWorker, blocks);
+  auto allWorkersTime = scanBlocks(*node, logger, allWorkers, blocks);
+
+  std::cout << BENCHMARK_BLOCK_COUNT << " blocks, " << BENCHMARK_TRANSACTIONS_PER_BLOCK << " transactions per block, " <<
+    BENCHMARK_OUTPUTS_PER_TRANSACTION << " outputs per transaction" << std::endl;
+  std::cout << "1 worker: " << singleWorkerTime.count() << " ms" << std::endl;
+  std::cout << allWorkers.workerCount() << " workers: " << allWorkersTime.count() << " ms" << std::endl;
+}
@@ -50,6 +50,17 @@ bool INodeDummyStub::removeObserver(INodeObserver* observer) {
   return observerManager.remove(observer);
 }
 
+// dummy stubs answer synchronously, so a batch goes through the per-transaction method that tests override
+void INodeDummyStub::getTransactionsOutsGlobalIndices(const std::vector<Crypto::Hash>& transactionHashes, std::vector<std::vector<uint32_t>>& outsGlobalIndices, const Callback& callback) {
+  std::error_code result;
+  outsGlobalIndices.resize(transactionHashes.size());
+  for (size_t i = 0; i < transactionHashes.size() && !result; ++i) {
+    getTransactionOutsGlobalIndices(transactionHashes[i], outsGlobalIndices[i], [&result](std::error_code ec) { result = ec; });
+  }
+
+  callback(result);
+}
+
 void INodeTrivialRefreshStub::getNewBlocks(std::vector<Crypto::Hash>&& knownBlockIds, std::vector<block_complete_entry>& newBlocks, uint32_t& startHeight, const Callback& callback)
 {
   m_asyncCounter.addAsyncContext();
@@ -150,6 +161,43 @@ void INodeTrivialRefreshStub::doGetTransactionOutsGlobalIndices(const Crypto::Ha
   }
 }
 
+void INodeTrivialRefreshStub::getTransactionsOutsGlobalIndices(const std::vector<Crypto::Hash>& transactionHashes, std::vector<std::vector<uint32_t>>& outsGlobalIndices, const Callback& callback)
+{
+  m_asyncCounter.addAsyncContext();
+  std::unique_lock<std::mutex> lock(m_walletLock);
+  calls_getTransactionOutsGlobalIndices.insert(calls_getTransactionOutsGlobalIndices.end(), transactionHashes.begin(), transactionHashes.end());
+  std::thread task(&INodeTrivialRefreshStub::doGetTransactionsOutsGlobalIndices, this, transactionHashes, std::ref(outsGlobalIndices), callback);
+  task.detach();
+}
+
+void INodeTrivialRefreshStub::doGetTransactionsOutsGlobalIndices(const std::vector<Crypto::Hash>& transactionHashes, std::vector<std::vector<uint32_t>>& outsGlobalIndices, const Callback& callback) {
+  ContextCounterHolder counterHolder(m_asyncCounter);
+  std::unique_lock<std::mutex> lock(m_walletLock);
+
+  bool success = true;
+  outsGlobalIndices.resize(transactionHashes.size());
+  for (size_t i = 0; i < transactionHashes.size(); ++i) {
+    success = m_blockchainGenerator.getTransactionGlobalIndexesByHash(transactionHashes[i], outsGlobalIndices[i]) && success;
+  }
+
+  lock.unlock();
+
+  if (consumerTests) {
+    for (size_t i = 0; i < transactionHashes.size(); ++i) {
+      outsGlobalIndices[i].clear();
+      outsGlobalIndices[i].resize(20);
+      getGlobalOutsFunctor(transactionHashes[i], outsGlobalIndices[i]);
+    }
+    callback(std::error_code());
+  } else {
+    if (success) {
+      callback(std::error_code());
+    } else {
+      callback(std::make_error_code(std::errc::invalid_argument));
+    }
+  }
+}
+
 void INodeTrivialRefreshStub::relayTransaction(const Transaction& transaction, const Callback& callback)
 {
   m_asyncCounter.addAsyncContext();
@@ -0,0 +1,193 @@
+// Copyright (c) 2017-2022 Fuego Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "Logging/AsyncFileLogger.h"
+
+using namespace Logging;
+
+namespace {
+
+const size_t PRODUCERS = 4;
+const size_t MESSAGES_PER_PRODUCER = 20000;
+
+std::string message(size_t producer, size_t index) {
+  return std::to_string(producer) + " " + std::to_string(index);
+}
+
+std::vector<std::string> readLines(const std::string& fileName) {
+  std::vector<std::string> lines;
+  std::ifstream file(fileName);
+  std::string line;
+  while (std::getline(file, line)) {
+    lines.push_back(line);
+  }
+
+  return lines;
+}
+
+}
+
+class AsyncFileLoggerTest : public ::testing::Test {
+public:
+  AsyncFileLoggerTest() : fileName((boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string()) {
+  }
+
+  virtual void TearDown() override {
+    boost::filesystem::remove(fileName);
+    boost::filesystem::remove(fileName + ".1");
+  }
+
+  static void log(AsyncFileLogger& logger, const std::string& body) {
+    logger("test", INFO, boost::posix_time::ptime(), body + "\n");
+  }
+
+  // every producer logs its messages in order from its own thread
+  static void logConcurrently(AsyncFileLogger& logger) {
+    std::vector<std::thread> producers;
+    for (size_t producer = 0; producer < PRODUCERS; ++producer) {
+      producers.emplace_back([&logger, producer] {
+        for (size_t index = 0; index < MESSAGES_PER_PRODUCER; ++index) {
+          log(logger, message(producer, index));
+        }
+      });
+    }
+
+    for (auto& producer : producers) {
+      producer.join();
+    }
+  }
+
+  // messages of each producer, in the order they were written
+  static std::vector<std::vector<size_t>> parseMessages(const std::vector<std::string>& lines, uint64_t& dropped) {
+    std::vector<std::vector<size_t>> indexes(PRODUCERS);
+    dropped = 0;
+    for (const std::string& line : lines) {
+      size_t space = line.find(' ');
+      EXPECT_NE(std::string::npos, space) << line;
+      if (line.find("log messages dropped") != std::string::npos) {
+        dropped += std::stoull(line.substr(0, space));
+      } else {
+        indexes.at(std::stoul(line.substr(0, space))).push_back(std::stoul(line.substr(space + 1)));
+      }
+    }
+
+    return indexes;
+  }
+
+  std::string fileName;
+};
+
+TEST_F(AsyncFileLoggerTest, ringKeepsEveryMessageOfConcurrentProducers) {
+  {
+    AsyncFileLogger logger;
+    logger.setPattern("");
+    logger.init(fileName, 64);
+    logConcurrently(logger);
+  }
+
+  uint64_t dropped;
+  auto indexes = parseMessages(readLines(fileName), dropped);
+  ASSERT_EQ(0, dropped);
+  for (size_t producer = 0; producer < PRODUCERS; ++producer) {
+    ASSERT_EQ(MESSAGES_PER_PRODUCER, indexes[producer].size());
+    for (size_t index = 0; index < MESSAGES_PER_PRODUCER; ++index) {
+      ASSERT_EQ(index, indexes[producer][index]);
+    }
+  }
+}
+
+TEST_F(AsyncFileLoggerTest, blockPolicyWaitsForRoomInTinyBuffer) {
+  {
+    AsyncFileLogger logger;
+    logger.setPattern("");
+    logger.init(fileName, 2, std::chrono::milliseconds(1000), AsyncFileLogger::BLOCK);
+    logConcurrently(logger);
+  }
+
+  uint64_t dropped;
+  auto indexes = parseMessages(readLines(fileName), dropped);
+  ASSERT_EQ(0, dropped);
+  for (size_t producer = 0; producer < PRODUCERS; ++producer) {
+    ASSERT_EQ(MESSAGES_PER_PRODUCER, indexes[producer].size());
+  }
+}
+
+TEST_F(AsyncFileLoggerTest, dropPolicyReportsEveryDroppedMessage) {
+  {
+    AsyncFileLogger logger;
+    logger.setPattern("");
+    logger.init(fileName, 2, std::chrono::milliseconds(1000), AsyncFileLogger::DROP);
+    logConcurrently(logger);
+  }
+
+  uint64_t dropped;
+  auto indexes = parseMessages(readLines(fileName), dropped);
+  uint64_t written = 0;
+  for (size_t producer = 0; producer < PRODUCERS; ++producer) {
+    // whatever got through keeps its order
+    for (size_t i = 1; i < indexes[producer].size(); ++i) {
+      ASSERT_LT(indexes[producer][i - 1], indexes[producer][i]);
+    }
+
+    written += indexes[producer].size();
+  }
+
+  ASSERT_EQ(PRODUCERS * MESSAGES_PER_PRODUCER, written + dropped);
+}
+
+TEST_F(AsyncFileLoggerTest, sleepingWriterWakesForANewRecord) {
+  AsyncFileLogger logger;
+  logger.setPattern("");
+  logger.init(fileName, 64, std::chrono::milliseconds(0));
+
+  for (size_t index = 0; index < 3; ++index) {
+    // let the writer go to sleep on the empty ring
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    log(logger, message(0, index));
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (readLines(fileName).size() <= index && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    auto lines = readLines(fileName);
+    ASSERT_EQ(index + 1, lines.size());
+    ASSERT_EQ(message(0, index), lines.back());
+  }
+}
+
+TEST_F(AsyncFileLoggerTest, rotationKeepsTheTailOfTheLog) {
+  const uint64_t maxFileSize = 4096;
+  const size_t count = 5000;
+  {
+    AsyncFileLogger logger;
+    logger.setPattern("");
+    logger.init(fileName, 64, std::chrono::milliseconds(1000), AsyncFileLogger::BLOCK, maxFileSize);
+    for (size_t index = 0; index < count; ++index) {
+      log(logger, message(0, index));
+    }
+  }
+
+  ASSERT_TRUE(boost::filesystem::exists(fileName + ".1"));
+  ASSERT_LT(boost::filesystem::file_size(fileName), maxFileSize);
+  ASSERT_GE(boost::filesystem::file_size(fileName + ".1"), maxFileSize);
+
+  // the previous file followed by the current one is a run of messages ending with the last
+  auto lines = readLines(fileName + ".1");
+  auto current = readLines(fileName);
+  lines.insert(lines.end(), current.begin(), current.end());
+  ASSERT_FALSE(lines.empty());
+  for (size_t i = 0; i < lines.size(); ++i) {
+    ASSERT_EQ(message(0, count - lines.size() + i), lines[i]);
+  }
+}
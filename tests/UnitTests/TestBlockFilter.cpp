@@ -0,0 +1,135 @@
+// Copyright (c) 2017-2022 Fuego Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include <CryptoNoteCore/BlockFilter.h>
+#include <CryptoNoteCore/TransactionExtra.h>
+
+#include "crypto/random.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+std::vector<Crypto::Hash> randomTags(size_t count) {
+  std::vector<Crypto::Hash> tags;
+  for (size_t i = 0; i < count; ++i) {
+    tags.push_back(Crypto::rand<Crypto::Hash>());
+  }
+
+  return tags;
+}
+
+}
+
+class BlockFilterTest : public ::testing::Test {
+public:
+  BlockFilterTest() : blockHash(Crypto::rand<Crypto::Hash>()) {
+  }
+
+  Crypto::Hash blockHash;
+};
+
+TEST_F(BlockFilterTest, emptyFilterMatchesNothing) {
+  std::string filter = buildSpendFilter(blockHash, {});
+  ASSERT_FALSE(spendFilterMatchesAny(filter, blockHash, randomTags(10)));
+}
+
+TEST_F(BlockFilterTest, nothingMatchesNoTags) {
+  auto tags = randomTags(10);
+  ASSERT_FALSE(spendFilterMatchesAny(buildSpendFilter(blockHash, tags), blockHash, {}));
+}
+
+TEST_F(BlockFilterTest, everyItemMatches) {
+  auto tags = randomTags(500);
+  std::string filter = buildSpendFilter(blockHash, tags);
+
+  for (const auto& tag : tags) {
+    ASSERT_TRUE(spendFilterMatchesAny(filter, blockHash, { tag }));
+  }
+}
+
+TEST_F(BlockFilterTest, itemAmongOtherQueriesMatches) {
+  auto tags = randomTags(100);
+  std::string filter = buildSpendFilter(blockHash, tags);
+
+  auto queries = randomTags(1000);
+  ASSERT_FALSE(spendFilterMatchesAny(filter, blockHash, queries));
+
+  queries.push_back(tags[42]);
+  ASSERT_TRUE(spendFilterMatchesAny(filter, blockHash, queries));
+}
+
+TEST_F(BlockFilterTest, filterIsCompact) {
+  auto tags = randomTags(1000);
+  std::string filter = buildSpendFilter(blockHash, tags);
+
+  // P bits of remainder and about 2.5 bits of quotient per item
+  ASSERT_LT(filter.size(), tags.size() * (BLOCK_FILTER_P + 4) / 8);
+}
+
+TEST_F(BlockFilterTest, filterDependsOnBlockHash) {
+  auto tags = randomTags(10);
+  ASSERT_NE(buildSpendFilter(blockHash, tags), buildSpendFilter(Crypto::rand<Crypto::Hash>(), tags));
+}
+
+TEST_F(BlockFilterTest, truncatedFilterMatchesEverything) {
+  auto tags = randomTags(100);
+  std::string filter = buildSpendFilter(blockHash, tags);
+  filter.resize(filter.size() / 2);
+
+  ASSERT_TRUE(spendFilterMatchesAny(filter, blockHash, randomTags(1)));
+  ASSERT_TRUE(spendFilterMatchesAny(std::string(), blockHash, randomTags(1)));
+}
+
+TEST_F(BlockFilterTest, spendTagsOfTransactionInputs) {
+  TransactionPrefix tx;
+  KeyInput keyInput;
+  keyInput.amount = 10;
+  keyInput.keyImage = Crypto::rand<Crypto::KeyImage>();
+  tx.inputs.push_back(keyInput);
+
+  MultisignatureInput multisignatureInput;
+  multisignatureInput.amount = 20;
+  multisignatureInput.outputIndex = 7;
+  multisignatureInput.signatureCount = 1;
+  multisignatureInput.term = 0;
+  tx.inputs.push_back(multisignatureInput);
+
+  std::vector<Crypto::Hash> tags;
+  getTransactionSpendTags(tx, tags);
+
+  ASSERT_EQ(2, tags.size());
+  ASSERT_EQ(getSpendTag(keyInput.keyImage), tags[0]);
+  ASSERT_EQ(getSpendTag(20, 7), tags[1]);
+  ASSERT_NE(getSpendTag(20, 8), tags[1]);
+}
+
+TEST_F(BlockFilterTest, transactionFilterListsKeysInOutputOrder) {
+  TransactionPrefix tx;
+  tx.extra.clear();
+  Crypto::PublicKey txPublicKey = Crypto::rand<Crypto::PublicKey>();
+  addTransactionPublicKeyToExtra(tx.extra, txPublicKey);
+
+  KeyOutput keyOutput;
+  keyOutput.key = Crypto::rand<Crypto::PublicKey>();
+  MultisignatureOutput multisignatureOutput;
+  multisignatureOutput.keys = { Crypto::rand<Crypto::PublicKey>(), Crypto::rand<Crypto::PublicKey>() };
+  multisignatureOutput.requiredSignatureCount = 1;
+  multisignatureOutput.term = 0;
+
+  TransactionOutput output;
+  output.amount = 1;
+  output.target = multisignatureOutput;
+  tx.outputs.push_back(output);
+  output.target = keyOutput;
+  tx.outputs.push_back(output);
+
+  TransactionFilterInfo info = getTransactionFilterInfo(tx);
+  ASSERT_EQ(txPublicKey, info.txPublicKey);
+  ASSERT_EQ(std::vector<Crypto::PublicKey>({ multisignatureOutput.keys[0], multisignatureOutput.keys[1], keyOutput.key }), info.outputKeys);
+  ASSERT_EQ(std::vector<uint32_t>({ 0, 0, 1 }), info.outputIndexes);
+  ASSERT_EQ(std::vector<uint32_t>({ 0, 1 }), info.multisignatureKeys);
+}
@@ -0,0 +1,227 @@
+// Copyright (c) 2017-2022 Fuego Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include <boost/filesystem.hpp>
+
+#include <CryptoNoteCore/Account.h>
+#include <CryptoNoteCore/BlockShortInfoCache.h>
+#include <CryptoNoteCore/Core.h>
+#include <CryptoNoteCore/CoreConfig.h>
+#include <CryptoNoteCore/CryptoNoteTools.h>
+#include <CryptoNoteCore/Currency.h>
+#include <CryptoNoteCore/Miner.h>
+#include <CryptoNoteCore/MinerConfig.h>
+#include <Logging/LoggerGroup.h>
+
+using namespace CryptoNote;
+
+namespace {
+
+BlockShortInfo makeInfo(uint32_t height, size_t transactionCount) {
+  BlockShortInfo info;
+  info.blockId = Crypto::rand<Crypto::Hash>();
+  info.block = std::string(100 + height, static_cast<char>(height));
+  for (size_t i = 0; i < transactionCount; ++i) {
+    TransactionPrefixInfo prefixInfo;
+    prefixInfo.txHash = Crypto::rand<Crypto::Hash>();
+    prefixInfo.txPrefix.version = 1;
+    prefixInfo.txPrefix.unlockTime = height + i;
+
+    KeyInput input;
+    input.amount = 1000 * (i + 1);
+    input.outputIndexes = { 3, 1, 4 };
+    input.keyImage = Crypto::rand<Crypto::KeyImage>();
+    prefixInfo.txPrefix.inputs.push_back(input);
+
+    TransactionOutput output;
+    output.amount = 900 * (i + 1);
+    output.target = KeyOutput{ Crypto::rand<Crypto::PublicKey>() };
+    prefixInfo.txPrefix.outputs.push_back(output);
+    prefixInfo.txPrefix.extra = { 1, 2, 3 };
+    info.txPrefixes.push_back(std::move(prefixInfo));
+  }
+
+  return info;
+}
+
+void assertSameInfo(const BlockShortInfo& expected, const BlockShortInfo& actual) {
+  ASSERT_EQ(expected.blockId, actual.blockId);
+  ASSERT_EQ(expected.block, actual.block);
+  ASSERT_EQ(expected.txPrefixes.size(), actual.txPrefixes.size());
+  for (size_t i = 0; i < expected.txPrefixes.size(); ++i) {
+    ASSERT_EQ(expected.txPrefixes[i].txHash, actual.txPrefixes[i].txHash);
+    ASSERT_EQ(toBinaryArray(expected.txPrefixes[i].txPrefix), toBinaryArray(actual.txPrefixes[i].txPrefix));
+  }
+}
+
+}
+
+TEST(BlockShortInfoCache, hitReturnsTheStoredEntry) {
+  BlockShortInfoCache cache(1024 * 1024);
+  BlockShortInfo info = makeInfo(5, 3);
+  cache.put(5, 1000, info);
+
+  BlockShortInfo cached;
+  ASSERT_TRUE(cache.get(5, 1000, cached));
+  assertSameInfo(info, cached);
+
+  BlockShortInfo missed;
+  ASSERT_FALSE(cache.get(6, 0, missed));
+}
+
+TEST(BlockShortInfoCache, olderBlockGivesItsIdOnly) {
+  BlockShortInfoCache cache(1024 * 1024);
+  BlockShortInfo info = makeInfo(5, 2);
+  cache.put(5, 1000, info);
+
+  BlockShortInfo cached;
+  ASSERT_TRUE(cache.get(5, 1001, cached));
+  ASSERT_EQ(info.blockId, cached.blockId);
+  ASSERT_TRUE(cached.block.empty());
+  ASSERT_TRUE(cached.txPrefixes.empty());
+}
+
+TEST(BlockShortInfoCache, sizeBoundEvictsLowestHeights) {
+  BlockShortInfoCache probe(1024 * 1024);
+  probe.put(0, 0, makeInfo(0, 4));
+  size_t entrySize = probe.getSize();
+
+  BlockShortInfoCache cache(entrySize * 3 + entrySize / 2);
+  for (uint32_t height = 10; height < 20; ++height) {
+    cache.put(height, 0, makeInfo(0, 4));
+    ASSERT_LE(cache.getSize(), entrySize * 3 + entrySize / 2);
+  }
+
+  ASSERT_EQ(3, cache.getCount());
+  BlockShortInfo info;
+  ASSERT_FALSE(cache.get(16, 0, info));
+  ASSERT_TRUE(cache.get(17, 0, info));
+  ASSERT_TRUE(cache.get(19, 0, info));
+}
+
+TEST(BlockShortInfoCache, eraseAndClearRelease) {
+  BlockShortInfoCache cache(1024 * 1024);
+  cache.put(1, 0, makeInfo(1, 1));
+  cache.put(2, 0, makeInfo(2, 2));
+  size_t size = cache.getSize();
+
+  cache.put(2, 0, makeInfo(2, 2));
+  ASSERT_EQ(size, cache.getSize());
+
+  cache.erase(2);
+  BlockShortInfo info;
+  ASSERT_FALSE(cache.get(2, 0, info));
+  ASSERT_LT(cache.getSize(), size);
+
+  cache.clear();
+  ASSERT_EQ(0, cache.getSize());
+  ASSERT_EQ(0, cache.getCount());
+}
+
+class BlockShortInfoCacheCoreTest : public ::testing::Test {
+public:
+  BlockShortInfoCacheCoreTest() :
+    // version 1 blocks all along, they are mined without a parent block
+    currency(CurrencyBuilder(logger).upgradeHeightV2(1000).upgradeHeightV3(1000).upgradeHeightV4(1000)
+      .upgradeHeightV5(1000).upgradeHeightV6(1000).upgradeHeightV7(1000).upgradeHeightV8(1000).upgradeHeightV9(1000)
+      .upgradeHeightV10(1000).currency()),
+    node(currency, nullptr, logger, false, false),
+    dataDir(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()) {
+  }
+
+  virtual void SetUp() override {
+    boost::filesystem::create_directories(dataDir);
+    CoreConfig config;
+    config.configFolder = dataDir.string();
+    ASSERT_TRUE(node.init(config, MinerConfig(), false));
+  }
+
+  virtual void TearDown() override {
+    node.deinit();
+    boost::filesystem::remove_all(dataDir);
+  }
+
+  void mineBlock(const AccountBase& miner) {
+    Block block;
+    difficulty_type difficulty;
+    uint32_t height;
+    ASSERT_TRUE(node.get_block_template(block, miner.getAccountKeys().address, difficulty, height, BinaryArray()));
+    // blocks one target apart keep the difficulty low
+    Block previous;
+    ASSERT_TRUE(node.getBlockByHash(block.previousBlockHash, previous));
+    block.timestamp = previous.timestamp + currency.difficultyTarget();
+    ASSERT_TRUE(miner::find_nonce_for_given_block(context, block, difficulty));
+    ASSERT_TRUE(node.handle_block_found(block));
+  }
+
+  std::vector<BlockShortInfo> queryBlocks() {
+    uint32_t startHeight;
+    uint32_t currentHeight;
+    uint32_t fullOffset;
+    std::vector<BlockShortInfo> entries;
+    EXPECT_TRUE(node.queryBlocksLite({ node.getBlockIdByHeight(0) }, 0, startHeight, currentHeight, fullOffset, entries));
+    return entries;
+  }
+
+  void assertEntriesMatchChain(const std::vector<BlockShortInfo>& entries) {
+    ASSERT_EQ(node.get_current_blockchain_height(), entries.size());
+    for (uint32_t height = 0; height < entries.size(); ++height) {
+      Block block;
+      ASSERT_TRUE(node.getBlockByHash(node.getBlockIdByHeight(height), block));
+      ASSERT_EQ(node.getBlockIdByHeight(height), entries[height].blockId) << height;
+      ASSERT_EQ(Common::asString(toBinaryArray(block)), entries[height].block) << height;
+    }
+  }
+
+  Logging::LoggerGroup logger;
+  Currency currency;
+  core node;
+  boost::filesystem::path dataDir;
+  Crypto::cn_context context;
+};
+
+TEST_F(BlockShortInfoCacheCoreTest, cachedEntriesMatchTheChain) {
+  AccountBase miner;
+  miner.generate();
+  for (size_t i = 0; i < 5; ++i) {
+    mineBlock(miner);
+  }
+
+  auto first = queryBlocks();
+  assertEntriesMatchChain(first);
+
+  // the second query is answered from the cache
+  auto second = queryBlocks();
+  ASSERT_EQ(first.size(), second.size());
+  for (size_t i = 0; i < first.size(); ++i) {
+    assertSameInfo(first[i], second[i]);
+  }
+}
+
+TEST_F(BlockShortInfoCacheCoreTest, poppedBlocksLeaveTheCache) {
+  AccountBase miner;
+  miner.generate();
+  for (size_t i = 0; i < 5; ++i) {
+    mineBlock(miner);
+  }
+
+  auto before = queryBlocks();
+  ASSERT_TRUE(node.rollback_chain_to(3));
+
+  // blocks of another miner replace the popped ones at the same heights
+  AccountBase otherMiner;
+  otherMiner.generate();
+  for (size_t i = 0; i < 2; ++i) {
+    mineBlock(otherMiner);
+  }
+
+  auto after = queryBlocks();
+  assertEntriesMatchChain(after);
+  ASSERT_EQ(before.size(), after.size());
+  ASSERT_EQ(before[3].blockId, after[3].blockId);
+  ASSERT_NE(before[4].blockId, after[4].blockId);
+  ASSERT_NE(before[5].blockId, after[5].blockId);
+}
@@ -0,0 +1,154 @@
+// Copyright (c) 2017-2022 Fuego Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <system_error>
+
+#include <Common/StreamTools.h>
+#include <Common/StringOutputStream.h>
+#include <HTTP/HttpParser.h>
+
+using namespace CryptoNote;
+
+class HttpParserTest : public ::testing::Test {
+public:
+  HttpParser parser;
+};
+
+TEST_F(HttpParserTest, parsesRequestWithBody) {
+  std::string data = "POST /json_rpc HTTP/1.1\r\nHost: 127.0.0.1\r\nContent-Type:  application/json \r\nContent-Length: 4\r\n\r\nbody";
+
+  HttpRequest request;
+  ASSERT_EQ(data.size(), parser.parseRequest(data.data(), data.size(), request));
+  ASSERT_EQ("POST", request.getMethod());
+  ASSERT_EQ("/json_rpc", request.getUrl());
+  ASSERT_EQ("HTTP/1.1", request.getVersion());
+  ASSERT_EQ("application/json", request.getHeaders().at("content-type"));
+  ASSERT_EQ("body", request.getBody());
+}
+
+TEST_F(HttpParserTest, incompleteRequestNeedsMoreData) {
+  std::string data = "POST /getinfo HTTP/1.1\r\nContent-Length: 4\r\n\r\nbody";
+
+  for (size_t size = 0; size < data.size(); ++size) {
+    HttpRequest request;
+    ASSERT_EQ(0, parser.parseRequest(data.data(), size, request));
+  }
+}
+
+TEST_F(HttpParserTest, pipelinedRequestsAreParsedOneByOne) {
+  std::string first = "GET /getheight HTTP/1.1\r\n\r\n";
+  std::string second = "POST /getinfo HTTP/1.1\r\nContent-Length: 2\r\n\r\n{}";
+  std::string data = first + second;
+
+  HttpRequest request;
+  size_t size = parser.parseRequest(data.data(), data.size(), request);
+  ASSERT_EQ(first.size(), size);
+  ASSERT_EQ("/getheight", request.getUrl());
+
+  ASSERT_EQ(second.size(), parser.parseRequest(data.data() + size, data.size() - size, request));
+  ASSERT_EQ("/getinfo", request.getUrl());
+  ASSERT_EQ("{}", request.getBody());
+}
+
+TEST_F(HttpParserTest, malformedRequestThrows) {
+  std::string data = "GARBAGE\r\n\r\n";
+  HttpRequest request;
+  ASSERT_THROW(parser.parseRequest(data.data(), data.size(), request), std::system_error);
+
+  data = "GET / HTTP/1.1\r\nno colon here\r\n\r\n";
+  ASSERT_THROW(parser.parseRequest(data.data(), data.size(), request), std::system_error);
+}
+
+TEST_F(HttpParserTest, emptyLinesBeforeRequestAreSkipped) {
+  std::string data = "\r\n\r\nGET /getheight HTTP/1.1\r\n\r\n";
+
+  HttpRequest request;
+  ASSERT_EQ(data.size(), parser.parseRequest(data.data(), data.size(), request));
+  ASSERT_EQ("/getheight", request.getUrl());
+}
+
+TEST_F(HttpParserTest, longRunOfEmptyLinesIsRejected) {
+  std::string crlfs;
+  for (size_t i = 0; i < 4000; ++i) {
+    crlfs += "\r\n";
+  }
+
+  // a short run only waits for the request line
+  HttpRequest request;
+  ASSERT_EQ(0, parser.parseRequest(crlfs.data(), crlfs.size(), request));
+
+  for (size_t i = 0; i < 40000; ++i) {
+    crlfs += "\r\n";
+  }
+
+  ASSERT_THROW(parser.parseRequest(crlfs.data(), crlfs.size(), request), std::system_error);
+
+  std::string data = crlfs.substr(0, 64 * 1024) + "GET / HTTP/1.1\r\n\r\n";
+  ASSERT_THROW(parser.parseRequest(data.data(), data.size(), request), std::system_error);
+}
+
+TEST_F(HttpParserTest, keepAliveDependsOnVersion) {
+  std::string data = "GET / HTTP/1.1\r\n\r\nGET / HTTP/1.1\r\nConnection: close\r\n\r\nGET / HTTP/1.0\r\n\r\nGET / HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n";
+  std::vector<bool> expected = { true, false, false, true };
+
+  size_t offset = 0;
+  for (bool keepAlive : expected) {
+    HttpRequest request;
+    offset += parser.parseRequest(data.data() + offset, data.size() - offset, request);
+    ASSERT_EQ(keepAlive, request.isKeepAlive());
+  }
+}
+
+TEST_F(HttpParserTest, streamedBodyOfKnownSize) {
+  HttpResponse response;
+  response.setBodyWriter([](Common::IOutputStream& out) { Common::write(out, "streamed", 8); }, 8);
+
+  std::string message;
+  Common::StringOutputStream stream(message);
+  response.write(stream);
+
+  std::istringstream input(message);
+  HttpResponse parsed;
+  parser.receiveResponse(input, parsed);
+  ASSERT_EQ("8", parsed.getHeaders().at("content-length"));
+  ASSERT_EQ("streamed", parsed.getBody());
+}
+
+TEST_F(HttpParserTest, chunkedBodyRoundTrip) {
+  std::string body(100000, 'x');
+  for (size_t i = 0; i < body.size(); ++i) {
+    body[i] = static_cast<char>('a' + i % 26);
+  }
+
+  HttpResponse response;
+  response.setBodyWriter([&body](Common::IOutputStream& out) {
+    // small and large pieces, as a serializer would write them
+    Common::write(out, body.data(), 10);
+    Common::write(out, body.data() + 10, 50000);
+    Common::write(out, body.data() + 50010, body.size() - 50010);
+  });
+
+  std::string message;
+  Common::StringOutputStream stream(message);
+  response.write(stream);
+
+  std::istringstream input(message);
+  HttpResponse parsed;
+  parser.receiveResponse(input, parsed);
+  ASSERT_EQ(body, parsed.getBody());
+}
+
+TEST_F(HttpParserTest, bufferedChunkedBody) {
+  HttpResponse response;
+  response.setBodyWriter([](Common::IOutputStream& out) { Common::write(out, "buffered", 8); });
+  ASSERT_TRUE(response.hasChunkedBody());
+
+  response.bufferBody();
+  ASSERT_FALSE(response.hasChunkedBody());
+  ASSERT_EQ("buffered", response.getBody());
+  ASSERT_EQ(0, response.getHeaders().count("Transfer-Encoding"));
+}
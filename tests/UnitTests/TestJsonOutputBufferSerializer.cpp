@@ -0,0 +1,126 @@
+// Copyright (c) 2017-2022 Fuego Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include <Common/JsonValue.h>
+#include <CryptoNoteCore/CryptoNoteSerialization.h>
+#include <Serialization/SerializationOverloads.h>
+#include <Serialization/SerializationTools.h>
+
+#include "crypto/crypto.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+struct Item {
+  uint32_t height;
+  Crypto::Hash hash;
+  std::vector<uint64_t> amounts;
+
+  void serialize(ISerializer& s) {
+    KV_MEMBER(height)
+    KV_MEMBER(hash)
+    KV_MEMBER(amounts)
+  }
+};
+
+struct Response {
+  std::string status;
+  int64_t minimum;
+  uint64_t maximum;
+  uint8_t flag;
+  double ratio;
+  bool orphan;
+  Item item;
+  std::vector<Item> items;
+  std::vector<std::string> names;
+
+  void serialize(ISerializer& s) {
+    KV_MEMBER(status)
+    KV_MEMBER(minimum)
+    KV_MEMBER(maximum)
+    KV_MEMBER(flag)
+    KV_MEMBER(ratio)
+    KV_MEMBER(orphan)
+    KV_MEMBER(item)
+    KV_MEMBER(items)
+    KV_MEMBER(names)
+  }
+};
+
+}
+
+class JsonOutputBufferSerializerTest : public ::testing::Test {
+public:
+  JsonOutputBufferSerializerTest() {
+    response.status = "OK";
+    response.minimum = -5;
+    response.maximum = 18446744073709551615ULL;
+    response.flag = 255;
+    response.ratio = 1.25;
+    response.orphan = false;
+    response.item = makeItem(10);
+    for (uint32_t i = 0; i < 3; ++i) {
+      response.items.push_back(makeItem(i));
+    }
+
+    response.names = { "first", "second" };
+  }
+
+  static Item makeItem(uint32_t height) {
+    Item item;
+    item.height = height;
+    item.hash = Crypto::rand<Crypto::Hash>();
+    item.amounts = { 0, height, 1000000000000ULL * height };
+    return item;
+  }
+
+  Response response;
+};
+
+TEST_F(JsonOutputBufferSerializerTest, writesMembersInSerializationOrder) {
+  Item item;
+  item.height = 7;
+  item.hash = Crypto::Hash();
+  item.hash.data[0] = 0xab;
+  item.amounts = { 1, 20 };
+
+  ASSERT_EQ("{\"height\":7,\"hash\":\"ab" + std::string(62, '0') + "\",\"amounts\":[1,20]}", storeToJson(item));
+}
+
+TEST_F(JsonOutputBufferSerializerTest, readsTheSameAsJsonValueOutput) {
+  std::string json = storeToJson(response);
+  ASSERT_EQ(storeToJsonValue(response).toString(), Common::JsonValue::fromString(json).toString());
+}
+
+TEST_F(JsonOutputBufferSerializerTest, loadsBack) {
+  Item item = makeItem(3);
+  item.amounts.push_back(18446744073709551615ULL);
+
+  Item loaded;
+  ASSERT_TRUE(loadFromJson(loaded, storeToJson(item)));
+  ASSERT_EQ(item.height, loaded.height);
+  ASSERT_EQ(item.hash, loaded.hash);
+  ASSERT_EQ(item.amounts, loaded.amounts);
+}
+
+TEST_F(JsonOutputBufferSerializerTest, escapesStrings) {
+  std::string json;
+  JsonOutputBufferSerializer s(json);
+  std::string value = "quote \" backslash \\ line\n\x01";
+  s(value, "");
+
+  ASSERT_EQ("\"quote \\\" backslash \\\\ line\\n\\u0001\"", json);
+}
+
+TEST_F(JsonOutputBufferSerializerTest, emptyArray) {
+  Item item;
+  item.height = 0;
+  item.hash = Crypto::Hash();
+
+  std::string json = storeToJson(item);
+  ASSERT_NE(std::string::npos, json.find("\"amounts\":[]"));
+}
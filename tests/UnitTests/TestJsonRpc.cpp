@@ -0,0 +1,194 @@
+// Copyright (c) 2017-2022 Fuego Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include <future>
+#include <thread>
+#include <vector>
+
+#include <JsonRpcServer/JsonRpcServer.h>
+#include <Logging/LoggerGroup.h>
+#include <Rpc/HttpClient.h>
+#include <Rpc/JsonRpc.h>
+#include <System/Event.h>
+
+using namespace CryptoNote;
+using namespace CryptoNote::JsonRpc;
+
+namespace {
+
+const uint16_t SERVER_PORT = 39878;
+
+// Answers every method with its name and keeps the methods it ran
+class EchoServer : public JsonRpcServer {
+public:
+  EchoServer(System::Dispatcher& dispatcher, System::Event& stopEvent, Logging::ILogger& logger) :
+    JsonRpcServer(dispatcher, stopEvent, logger) {
+  }
+
+  std::vector<std::string> methods;
+
+protected:
+  virtual void processJsonRpcRequest(const Common::JsonValue& req, Common::JsonValue& resp) override {
+    if (!req.isObject() || !req.contains("method")) {
+      makeGenericErrorReponse(resp, "Invalid Request", -32600);
+      return;
+    }
+
+    prepareJsonResponse(req, resp);
+
+    methods.push_back(req("method").getString());
+    fillJsonResponse(req("method"), resp);
+  }
+};
+
+}
+
+class JsonRpcTest : public ::testing::Test {
+};
+
+TEST_F(JsonRpcTest, batchElementIsParsedOnItsOwn) {
+  Common::JsonValue batch = Common::JsonValue::fromString(
+    "[{\"jsonrpc\":\"2.0\",\"id\":0,\"method\":\"getblockheaderbyheight\",\"params\":{\"height\":10}},"
+    "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"getlastblockheader\"}]");
+
+  JsonRpcRequest first;
+  ASSERT_TRUE(first.parseRequest(batch[0]));
+  ASSERT_EQ("getblockheaderbyheight", first.getMethod());
+  ASSERT_EQ(0, first.getId().get().getInteger());
+  ASSERT_EQ("{\"height\":10}", first.getCanonicalParams());
+
+  JsonRpcRequest second;
+  ASSERT_TRUE(second.parseRequest(batch[1]));
+  ASSERT_EQ("getlastblockheader", second.getMethod());
+  ASSERT_EQ(1, second.getId().get().getInteger());
+}
+
+TEST_F(JsonRpcTest, invalidBatchElementIsInvalidRequest) {
+  const char* elements[] = { "1", "\"getinfo\"", "[]", "{}", "{\"method\":5}" };
+
+  for (const char* element : elements) {
+    JsonRpcRequest request;
+    try {
+      request.parseRequest(Common::JsonValue::fromString(element));
+      FAIL() << element;
+    } catch (const JsonRpcError& err) {
+      ASSERT_EQ(errInvalidRequest, err.code) << element;
+    }
+  }
+}
+
+TEST_F(JsonRpcTest, unparsableBodyIsParseError) {
+  JsonRpcRequest request;
+  try {
+    request.parseRequest(std::string("[{\"method\":"));
+    FAIL();
+  } catch (const JsonRpcError& err) {
+    ASSERT_EQ(errParseError, err.code);
+  }
+}
+
+TEST_F(JsonRpcTest, requestIdIsSent) {
+  JsonRpcRequest request;
+  request.setMethod("getblockcount");
+  request.setId(Common::JsonValue(static_cast<Common::JsonValue::Integer>(7)));
+
+  JsonRpcRequest parsed;
+  parsed.parseRequest(request.getBody());
+  ASSERT_EQ(7, parsed.getId().get().getInteger());
+}
+
+TEST_F(JsonRpcTest, batchResponseElementCarriesResultOrError) {
+  Common::JsonValue batch = Common::JsonValue::fromString(
+    "[{\"jsonrpc\":\"2.0\",\"id\":0,\"result\":{\"count\":12}},"
+    "{\"jsonrpc\":\"2.0\",\"id\":1,\"error\":{\"code\":-32601,\"message\":\"Method not found\"}}]");
+
+  JsonRpcResponse first;
+  first.parse(batch[0]);
+  JsonRpcError err;
+  ASSERT_FALSE(first.getError(err));
+
+  COMMAND_RPC_GETBLOCKCOUNT::response result;
+  ASSERT_TRUE(first.getResult(result));
+  ASSERT_EQ(12, result.count);
+
+  JsonRpcResponse second;
+  second.parse(batch[1]);
+  ASSERT_TRUE(second.getError(err));
+  ASSERT_EQ(errMethodNotFound, err.code);
+}
+
+class JsonRpcServerTest : public ::testing::Test {
+public:
+  virtual void SetUp() override {
+    std::promise<void> started;
+    serverThread = std::thread([this, &started] {
+      System::Dispatcher dispatcher;
+      System::Event stopEvent(dispatcher);
+      EchoServer echoServer(dispatcher, stopEvent, logger);
+      serverDispatcher = &dispatcher;
+      serverStopEvent = &stopEvent;
+      server = &echoServer;
+      dispatcher.remoteSpawn([&started] { started.set_value(); });
+      echoServer.start("127.0.0.1", SERVER_PORT);
+    });
+
+    started.get_future().wait();
+  }
+
+  virtual void TearDown() override {
+    serverDispatcher->remoteSpawn([this] { serverStopEvent->set(); });
+    serverThread.join();
+  }
+
+  std::string post(const std::string& body) {
+    HttpClient client(dispatcher, "127.0.0.1", SERVER_PORT);
+    HttpRequest request;
+    request.setUrl("/json_rpc");
+    request.setBody(body);
+    HttpResponse response;
+    client.request(request, response);
+    return response.getBody();
+  }
+
+  std::vector<std::string> serverMethods() {
+    std::promise<std::vector<std::string>> methods;
+    serverDispatcher->remoteSpawn([this, &methods] { methods.set_value(server->methods); });
+    return methods.get_future().get();
+  }
+
+  Logging::LoggerGroup logger;
+  System::Dispatcher dispatcher;
+  std::thread serverThread;
+  System::Dispatcher* serverDispatcher;
+  System::Event* serverStopEvent;
+  EchoServer* server;
+};
+
+TEST_F(JsonRpcServerTest, batchLeavesNotificationsOut) {
+  Common::JsonValue response = Common::JsonValue::fromString(post(
+    "[{\"jsonrpc\":\"2.0\",\"id\":0,\"method\":\"first\"},"
+    "{\"jsonrpc\":\"2.0\",\"method\":\"notified\"},"
+    "5,"
+    "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"second\"}]"));
+
+  ASSERT_TRUE(response.isArray());
+  ASSERT_EQ(3, response.size());
+  ASSERT_EQ(0, response[0]("id").getInteger());
+  ASSERT_EQ("first", response[0]("result").getString());
+  ASSERT_TRUE(response[1].contains("error"));
+  ASSERT_EQ(1, response[2]("id").getInteger());
+  ASSERT_EQ("second", response[2]("result").getString());
+
+  std::vector<std::string> expected = { "first", "notified", "second" };
+  ASSERT_EQ(expected, serverMethods());
+}
+
+TEST_F(JsonRpcServerTest, batchOfNotificationsGetsAnEmptyBody) {
+  ASSERT_EQ("", post("[{\"jsonrpc\":\"2.0\",\"method\":\"one\"},{\"jsonrpc\":\"2.0\",\"method\":\"two\"}]"));
+
+  std::vector<std::string> expected = { "one", "two" };
+  ASSERT_EQ(expected, serverMethods());
+}
@@ -6,6 +6,8 @@
 #include "gtest/gtest.h"
 #include <Common/JsonValue.h>
 
+#include <sstream>
+
 using Common::JsonValue;
 
 namespace {
@@ -53,3 +55,38 @@ TEST(JsonValue, testBadPatterns) {
   }
 }
 
+
+TEST(JsonValue, bufferParserReadsLikeStreamParser) {
+  std::vector<std::string> patterns(goodPatterns);
+  patterns.insert(patterns.end(), {
+    "-42",
+    "0",
+    "12.5e-3",
+    "9223372036854775807",
+    "-9223372036854775808",
+    "99999999999999999999",
+    "true",
+    "null",
+    "\"escaped \\\" quote and \\\\ backslash\"",
+    "{\"b\": [1, -2.25, \"x\", false, null, {}], \"a\": {\"c\": [[]]}, \"a\": 3}",
+    "[1, 2] trailing"
+  });
+
+  for (const auto& p : patterns) {
+    JsonValue streamValue;
+    std::istringstream stream(p);
+    stream >> streamValue;
+
+    ASSERT_EQ(streamValue.toString(), JsonValue::fromString(p).toString()) << p;
+  }
+}
+
+TEST(JsonValue, integerLimits) {
+  ASSERT_EQ(INT64_MIN, JsonValue::fromString("-9223372036854775808").getInteger());
+  ASSERT_EQ(INT64_MAX, JsonValue::fromString("9223372036854775808").getInteger());
+}
+
+TEST(JsonValue, deepNestingThrows) {
+  ASSERT_ANY_THROW(JsonValue::fromString(std::string(100000, '[')));
+  ASSERT_NO_THROW(JsonValue::fromString(std::string(100, '[') + std::string(100, ']')));
+}
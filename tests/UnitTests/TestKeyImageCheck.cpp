@@ -0,0 +1,125 @@
+// Copyright (c) 2017-2022 Fuego Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include <Common/StringTools.h>
+#include <crypto/crypto.h>
+
+extern "C" {
+#include <crypto/crypto-ops.h>
+}
+
+using namespace Crypto;
+
+namespace {
+
+const KeyImage IDENTITY = { { 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } };
+const KeyImage L = { { 0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10 } };
+
+// Encodings of the points of order 2, 4 and 8
+const char* SMALL_ORDER_POINTS[] = {
+  "ecffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff7f",
+  "0000000000000000000000000000000000000000000000000000000000000000",
+  "0000000000000000000000000000000000000000000000000000000000000080",
+  "26e8958fc2b227b045c3f489f2ef98f0d5dfac05d3c63339b13802886d53fc05",
+  "26e8958fc2b227b045c3f489f2ef98f0d5dfac05d3c63339b13802886d53fc85",
+  "c7176a703d4dd84fba3c0b760d10670f2a2053fa2c39ccc64ec7fd7792ac037a",
+  "c7176a703d4dd84fba3c0b760d10670f2a2053fa2c39ccc64ec7fd7792ac03fa"
+};
+
+// The check the key image cache replaced
+bool referenceCheck(const KeyImage& image) {
+  return scalarmultKey(image, L) == IDENTITY;
+}
+
+KeyImage fromHex(const char* hex) {
+  KeyImage image;
+  EXPECT_TRUE(Common::podFromHex(hex, image));
+  return image;
+}
+
+KeyImage generateKeyImage() {
+  PublicKey pub;
+  SecretKey sec;
+  generate_keys(pub, sec);
+
+  KeyImage image;
+  generate_key_image(pub, sec, image);
+  return image;
+}
+
+KeyImage addPoints(const KeyImage& a, const KeyImage& b) {
+  ge_p3 pa;
+  ge_p3 pb;
+  EXPECT_EQ(0, ge_frombytes_vartime(&pa, reinterpret_cast<const unsigned char*>(&a)));
+  EXPECT_EQ(0, ge_frombytes_vartime(&pb, reinterpret_cast<const unsigned char*>(&b)));
+
+  ge_cached cached;
+  ge_p1p1 sum;
+  ge_p3 result;
+  ge_p3_to_cached(&cached, &pb);
+  ge_add(&sum, &pa, &cached);
+  ge_p1p1_to_p3(&result, &sum);
+
+  KeyImage image;
+  ge_p3_tobytes(reinterpret_cast<unsigned char*>(&image), &result);
+  return image;
+}
+
+}
+
+TEST(KeyImageCheck, validKeyImagesAreAccepted) {
+  for (size_t i = 0; i < 64; ++i) {
+    KeyImage image = generateKeyImage();
+    ASSERT_TRUE(referenceCheck(image));
+    ASSERT_TRUE(check_key_image(image));
+  }
+}
+
+TEST(KeyImageCheck, identityIsInSubgroup) {
+  ASSERT_TRUE(referenceCheck(IDENTITY));
+  ASSERT_TRUE(check_key_image(IDENTITY));
+}
+
+TEST(KeyImageCheck, smallOrderPointsAreRejected) {
+  for (const char* hex : SMALL_ORDER_POINTS) {
+    KeyImage image = fromHex(hex);
+    ASSERT_FALSE(referenceCheck(image)) << hex;
+    ASSERT_FALSE(check_key_image(image)) << hex;
+  }
+}
+
+TEST(KeyImageCheck, torsionMixedPointsAreRejected) {
+  for (const char* hex : SMALL_ORDER_POINTS) {
+    KeyImage image = addPoints(generateKeyImage(), fromHex(hex));
+    ASSERT_FALSE(referenceCheck(image)) << hex;
+    ASSERT_FALSE(check_key_image(image)) << hex;
+  }
+}
+
+TEST(KeyImageCheck, undecodablePointIsRejected) {
+  // y with no matching x on the curve
+  KeyImage image = fromHex("0200000000000000000000000000000000000000000000000000000000000000");
+  ge_p3 point;
+  ASSERT_NE(0, ge_frombytes_vartime(&point, reinterpret_cast<const unsigned char*>(&image)));
+  ASSERT_FALSE(check_key_image(image));
+}
+
+TEST(KeyImageCheck, matchesReferenceOnRandomPoints) {
+  size_t decoded = 0;
+  for (size_t i = 0; decoded < 256 && i < 4096; ++i) {
+    KeyImage image = rand<KeyImage>();
+
+    ge_p3 point;
+    if (ge_frombytes_vartime(&point, reinterpret_cast<const unsigned char*>(&image)) != 0) {
+      continue;
+    }
+
+    ++decoded;
+    ASSERT_EQ(referenceCheck(image), check_key_image(image)) << Common::podToHex(image);
+  }
+
+  ASSERT_EQ(256, decoded);
+}
@@ -0,0 +1,87 @@
+// Copyright (c) 2017-2022 Fuego Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include "Common/JsonValue.h"
+#include "Logging/LoggerGroup.h"
+#include "Logging/LoggerManager.h"
+#include "Logging/LoggerRef.h"
+
+using namespace Logging;
+
+namespace {
+
+class CountingLogger : public CommonLogger {
+public:
+  explicit CountingLogger(Level level) : CommonLogger(level), count(0) {
+  }
+
+  size_t count;
+
+protected:
+  virtual void doLogString(const std::string& message) override {
+    ++count;
+  }
+};
+
+}
+
+TEST(LoggerGroup, emptyGroupFormatsNothing) {
+  LoggerGroup group(TRACE);
+  ASSERT_FALSE(group.isEnabled(FATAL));
+}
+
+TEST(LoggerGroup, takesTheHighestLevelOfItsLoggers) {
+  LoggerGroup group(TRACE);
+  CountingLogger info(INFO);
+  CountingLogger warning(WARNING);
+
+  group.addLogger(warning);
+  ASSERT_TRUE(group.isEnabled(WARNING));
+  ASSERT_FALSE(group.isEnabled(INFO));
+
+  group.addLogger(info);
+  ASSERT_TRUE(group.isEnabled(INFO));
+  ASSERT_FALSE(group.isEnabled(DEBUGGING));
+
+  group.removeLogger(info);
+  ASSERT_FALSE(group.isEnabled(INFO));
+
+  // a disabled message isn't formatted, so no logger sees it
+  LoggerRef(group, "test")(INFO) << "skipped";
+  LoggerRef(group, "test")(WARNING) << "logged";
+  ASSERT_EQ(1, warning.count);
+}
+
+TEST(LoggerGroup, groupLevelCapsItsLoggers) {
+  LoggerGroup group(TRACE);
+  CountingLogger debug(DEBUGGING);
+  group.addLogger(debug);
+  ASSERT_TRUE(group.isEnabled(DEBUGGING));
+
+  group.setMaxLevel(WARNING);
+  ASSERT_TRUE(group.isEnabled(WARNING));
+  ASSERT_FALSE(group.isEnabled(INFO));
+
+  group.setMaxLevel(TRACE);
+  ASSERT_TRUE(group.isEnabled(DEBUGGING));
+  ASSERT_FALSE(group.isEnabled(TRACE));
+}
+
+TEST(LoggerGroup, managerWithoutGlobalLevelFollowsItsLoggers) {
+  Common::JsonValue logger(Common::JsonValue::OBJECT);
+  logger.insert("type", "console");
+  logger.insert("level", static_cast<int64_t>(INFO));
+  Common::JsonValue loggers(Common::JsonValue::ARRAY);
+  loggers.pushBack(logger);
+  Common::JsonValue config(Common::JsonValue::OBJECT);
+  config.insert("loggers", loggers);
+
+  LoggerManager manager;
+  manager.configure(config);
+  ASSERT_TRUE(manager.isEnabled(INFO));
+  ASSERT_FALSE(manager.isEnabled(DEBUGGING));
+  ASSERT_FALSE(manager.isEnabled(TRACE));
+}
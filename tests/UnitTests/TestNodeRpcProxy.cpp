@@ -0,0 +1,262 @@
+// Copyright (c) 2017-2022 Fuego Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <Logging/LoggerGroup.h>
+#include <NodeRpcProxy/NodeRpcProxy.h>
+#include <Rpc/CoreRpcServerCommandsDefinitions.h>
+#include <Rpc/HttpServer.h>
+#include <Rpc/JsonRpc.h>
+#include <Serialization/SerializationTools.h>
+#include <System/Event.h>
+#include <System/Timer.h>
+
+using namespace CryptoNote;
+
+namespace {
+
+const uint16_t NODE_PORT = 39877;
+
+// Answers the requests the proxy polls with and counts them
+class FakeNode : public HttpServer {
+public:
+  FakeNode(System::Dispatcher& dispatcher, Logging::ILogger& logger) : HttpServer(dispatcher, logger) {
+  }
+
+  virtual void processRequest(const HttpRequest& request, HttpResponse& response) override {
+    size_t inFlight = ++requestsInFlight;
+    size_t max = maxRequestsInFlight.load();
+    while (inFlight > max && !maxRequestsInFlight.compare_exchange_weak(max, inFlight)) {
+    }
+
+    const std::string& url = request.getUrl();
+    if (url == "/json_rpc") {
+      COMMAND_RPC_GET_LAST_BLOCK_HEADER::response rsp{};
+      rsp.status = CORE_RPC_STATUS_OK;
+      rsp.block_header.hash = tailBlockHash();
+      rsp.block_header.height = 10;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        polls.push_back(std::chrono::steady_clock::now());
+      }
+
+      JsonRpc::JsonRpcResponse jsRes;
+      jsRes.setResult(rsp);
+      response.setBody(jsRes.getBody());
+    } else if (url == "/getinfo") {
+      COMMAND_RPC_GET_INFO::response rsp{};
+      rsp.status = CORE_RPC_STATUS_OK;
+      response.setBody(storeToJson(rsp));
+    } else if (url == "/get_pool_changes_lite.bin") {
+      COMMAND_RPC_GET_POOL_CHANGES_LITE::response rsp{};
+      rsp.isTailBlockActual = true;
+      rsp.status = CORE_RPC_STATUS_OK;
+      response.setBody(storeToBinaryKeyValue(rsp));
+    } else if (url == "/get_o_indexes.bin") {
+      System::Timer(m_dispatcher).sleep(std::chrono::milliseconds(100));
+      COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES::response rsp{};
+      rsp.status = CORE_RPC_STATUS_OK;
+      response.setBody(storeToBinaryKeyValue(rsp));
+    } else if (url == "/sendrawtransaction") {
+      COMMAND_RPC_SEND_RAW_TX::response rsp{};
+      rsp.status = CORE_RPC_STATUS_OK;
+      response.setBody(storeToJson(rsp));
+    } else if (url == "/waitforchange") {
+      ++waitRequests;
+      response.setStatus(waitStatus);
+    } else {
+      response.setStatus(HttpResponse::STATUS_404);
+    }
+
+    --requestsInFlight;
+  }
+
+  std::string tailBlockHash() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hash;
+  }
+
+  void setTailBlockHash(const std::string& value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    hash = value;
+  }
+
+  std::vector<std::chrono::steady_clock::time_point> getPolls() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return polls;
+  }
+
+  std::atomic<size_t> requestsInFlight{0};
+  std::atomic<size_t> maxRequestsInFlight{0};
+  std::atomic<size_t> waitRequests{0};
+  // an older node without /waitforchange by default
+  std::atomic<HttpResponse::HTTP_STATUS> waitStatus{HttpResponse::STATUS_404};
+
+private:
+  std::mutex mutex;
+  std::string hash = std::string(63, '0') + "1";
+  std::vector<std::chrono::steady_clock::time_point> polls;
+};
+
+class NodeRpcProxyTest : public ::testing::Test {
+public:
+  NodeRpcProxyTest() : proxy("127.0.0.1", NODE_PORT) {
+  }
+
+  virtual void SetUp() override {
+    std::promise<void> started;
+    nodeThread = std::thread([this, &started] {
+      System::Dispatcher dispatcher;
+      System::Event stopEvent(dispatcher);
+      FakeNode fakeNode(dispatcher, logger);
+      fakeNode.start("127.0.0.1", NODE_PORT);
+      nodeDispatcher = &dispatcher;
+      nodeStopEvent = &stopEvent;
+      node = &fakeNode;
+      started.set_value();
+
+      stopEvent.wait();
+      fakeNode.stop();
+    });
+
+    started.get_future().wait();
+  }
+
+  virtual void TearDown() override {
+    proxy.shutdown();
+    nodeDispatcher->remoteSpawn([this] { nodeStopEvent->set(); });
+    nodeThread.join();
+  }
+
+  void initProxy() {
+    std::promise<std::error_code> initialized;
+    proxy.init([&initialized](std::error_code ec) { initialized.set_value(ec); });
+    ASSERT_FALSE(initialized.get_future().get());
+  }
+
+  bool waitForPolls(size_t count, std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (node->getPolls().size() < count) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        return false;
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    return true;
+  }
+
+  Logging::LoggerGroup logger;
+  std::thread nodeThread;
+  System::Dispatcher* nodeDispatcher = nullptr;
+  System::Event* nodeStopEvent = nullptr;
+  FakeNode* node = nullptr;
+  NodeRpcProxy proxy;
+};
+
+}
+
+TEST_F(NodeRpcProxyTest, requestsShareTheConnectionPool) {
+  proxy.httpConnections(2);
+  proxy.pullInterval(5000, 5000);
+  initProxy();
+  ASSERT_TRUE(waitForPolls(1, std::chrono::seconds(5)));
+
+  const size_t REQUESTS = 6;
+  std::vector<std::vector<uint32_t>> indices(REQUESTS);
+  std::vector<std::promise<std::error_code>> done(REQUESTS);
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < REQUESTS; ++i) {
+    proxy.getTransactionOutsGlobalIndices(Crypto::Hash(), indices[i], [&done, i](std::error_code ec) { done[i].set_value(ec); });
+  }
+
+  for (auto& result : done) {
+    ASSERT_FALSE(result.get_future().get());
+  }
+
+  // two connections serve six requests of 100 ms in three rounds
+  ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(300));
+  ASSERT_EQ(2, node->maxRequestsInFlight.load());
+
+  auto stats = proxy.getRequestStats();
+  ASSERT_EQ(REQUESTS, stats["/get_o_indexes.bin"].calls);
+  ASSERT_EQ(0, stats["/get_o_indexes.bin"].errors);
+}
+
+TEST_F(NodeRpcProxyTest, pollIntervalGrowsUntilTheNodeChanges) {
+  proxy.pullInterval(50, 400);
+  initProxy();
+
+  // the first poll finds a new tail, the next ones 50, 100, 200, 400 and 400 ms apart find nothing
+  ASSERT_TRUE(waitForPolls(6, std::chrono::seconds(5)));
+  auto polls = node->getPolls();
+  for (size_t i = 2; i < polls.size(); ++i) {
+    ASSERT_GE(polls[i] - polls[i - 1], polls[i - 1] - polls[i - 2] - std::chrono::milliseconds(20)) << i;
+  }
+
+  ASSERT_LT(polls[1] - polls[0], std::chrono::milliseconds(300));
+  ASSERT_GE(polls[5] - polls[4], std::chrono::milliseconds(350));
+
+  node->setTailBlockHash(std::string(63, '0') + "2");
+  size_t count = polls.size();
+  ASSERT_TRUE(waitForPolls(count + 2, std::chrono::seconds(5)));
+
+  // the poll after the change comes m_minPullInterval later again
+  polls = node->getPolls();
+  ASSERT_LT(polls[count + 1] - polls[count], std::chrono::milliseconds(300));
+}
+
+TEST_F(NodeRpcProxyTest, nodeWithoutLongPollIsPolledOnTheInterval) {
+  proxy.pullInterval(20, 20);
+  initProxy();
+  ASSERT_TRUE(waitForPolls(5, std::chrono::seconds(5)));
+  ASSERT_EQ(1, node->waitRequests.load());
+}
+
+TEST_F(NodeRpcProxyTest, failedLongPollIsTriedAgain) {
+  node->waitStatus = HttpResponse::STATUS_500;
+  proxy.pullInterval(20, 20);
+  initProxy();
+  ASSERT_TRUE(waitForPolls(5, std::chrono::seconds(5)));
+  ASSERT_GE(node->waitRequests.load(), 3);
+}
+
+TEST_F(NodeRpcProxyTest, relayedTransactionPollsRightAway) {
+  proxy.pullInterval(10000, 10000);
+  initProxy();
+  ASSERT_TRUE(waitForPolls(1, std::chrono::seconds(5)));
+  // the proxy sleeps until the next poll
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  ASSERT_EQ(1, node->getPolls().size());
+
+  std::promise<std::error_code> relayed;
+  proxy.relayTransaction(Transaction(), [&relayed](std::error_code ec) { relayed.set_value(ec); });
+  ASSERT_FALSE(relayed.get_future().get());
+
+  ASSERT_TRUE(waitForPolls(2, std::chrono::seconds(2)));
+}
+
+TEST_F(NodeRpcProxyTest, shutdownAndInitAgain) {
+  initProxy();
+  ASSERT_TRUE(proxy.shutdown());
+  ASSERT_TRUE(proxy.shutdown());
+
+  std::promise<std::error_code> failed;
+  std::vector<uint32_t> indices;
+  proxy.getTransactionOutsGlobalIndices(Crypto::Hash(), indices, [&failed](std::error_code ec) { failed.set_value(ec); });
+  ASSERT_TRUE(static_cast<bool>(failed.get_future().get()));
+
+  initProxy();
+  size_t count = node->getPolls().size();
+  ASSERT_TRUE(waitForPolls(count + 1, std::chrono::seconds(5)));
+}
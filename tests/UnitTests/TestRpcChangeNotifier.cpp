@@ -0,0 +1,116 @@
+// Copyright (c) 2017-2022 Fuego Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include <Rpc/RpcChangeNotifier.h>
+#include <System/Context.h>
+#include <System/Dispatcher.h>
+#include <System/InterruptedException.h>
+#include <System/Timer.h>
+
+using namespace CryptoNote;
+
+class RpcChangeNotifierTest : public ::testing::Test {
+public:
+  RpcChangeNotifierTest() : notifier(dispatcher, 4) {
+  }
+
+  System::Dispatcher dispatcher;
+  RpcChangeNotifier notifier;
+};
+
+TEST_F(RpcChangeNotifierTest, waitTimesOut) {
+  auto start = std::chrono::steady_clock::now();
+  notifier.wait(std::chrono::milliseconds(50));
+  ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(50));
+}
+
+TEST_F(RpcChangeNotifierTest, changeFromAnotherThreadWakesWaiters) {
+  uint64_t version = notifier.getPoolVersion();
+
+  std::vector<std::unique_ptr<System::Context<>>> waiters;
+  for (size_t i = 0; i < 2; ++i) {
+    waiters.emplace_back(new System::Context<>(dispatcher, [&] { notifier.wait(std::chrono::seconds(10)); }));
+  }
+
+  std::thread core([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    notifier.blockchainUpdated();
+  });
+
+  auto start = std::chrono::steady_clock::now();
+  for (auto& waiter : waiters) {
+    waiter->get();
+  }
+
+  core.join();
+  ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+  ASSERT_GT(notifier.getPoolVersion(), version);
+}
+
+TEST_F(RpcChangeNotifierTest, poolUpdateChangesVersion) {
+  uint64_t version = notifier.getPoolVersion();
+  ASSERT_NE(0, version);
+
+  notifier.poolUpdated();
+  ASSERT_EQ(version + 1, notifier.getPoolVersion());
+  // let the posted wake-up run before the notifier goes away
+  System::Timer(dispatcher).sleep(std::chrono::milliseconds(1));
+}
+
+TEST_F(RpcChangeNotifierTest, interruptedWaitThrows) {
+  System::Context<> waiter(dispatcher, [&] { notifier.wait(std::chrono::seconds(10)); });
+  waiter.interrupt();
+  ASSERT_THROW(waiter.get(), System::InterruptedException);
+}
+
+TEST_F(RpcChangeNotifierTest, waitersBeyondTheLimitReturnRightAway) {
+  std::vector<std::unique_ptr<System::Context<>>> waiters;
+  for (size_t i = 0; i < 4; ++i) {
+    waiters.emplace_back(new System::Context<>(dispatcher, [&] { ASSERT_TRUE(notifier.wait(std::chrono::seconds(10))); }));
+  }
+
+  // let the waiters start waiting
+  System::Timer(dispatcher).sleep(std::chrono::milliseconds(1));
+
+  auto start = std::chrono::steady_clock::now();
+  ASSERT_FALSE(notifier.wait(std::chrono::seconds(10)));
+  ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+
+  notifier.poolUpdated();
+  for (auto& waiter : waiters) {
+    waiter->get();
+  }
+
+  ASSERT_TRUE(notifier.wait(std::chrono::milliseconds(1)));
+}
+
+TEST_F(RpcChangeNotifierTest, earlierDeadlineIsNotHeldBackByALaterOne) {
+  System::Context<> longWaiter(dispatcher, [&] { notifier.wait(std::chrono::seconds(10)); });
+  System::Timer(dispatcher).sleep(std::chrono::milliseconds(1));
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::unique_ptr<System::Context<>>> waiters;
+  for (size_t i = 1; i <= 3; ++i) {
+    waiters.emplace_back(new System::Context<>(dispatcher, [&, i] {
+      notifier.wait(std::chrono::milliseconds(100 * i));
+      auto elapsed = std::chrono::steady_clock::now() - start;
+      ASSERT_GE(elapsed, std::chrono::milliseconds(100 * i));
+      ASSERT_LT(elapsed, std::chrono::milliseconds(100 * i + 80));
+    }));
+  }
+
+  for (auto& waiter : waiters) {
+    waiter->get();
+  }
+
+  ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+  longWaiter.interrupt();
+  ASSERT_THROW(longWaiter.get(), System::InterruptedException);
+}
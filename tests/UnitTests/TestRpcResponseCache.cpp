@@ -0,0 +1,112 @@
+// Copyright (c) 2017-2022 Fuego Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include <thread>
+
+#include <Rpc/RpcResponseCache.h>
+
+using namespace CryptoNote;
+
+namespace {
+
+const RpcResponseCache::Policy BLOCKCHAIN_POLICY = { false, std::chrono::milliseconds(0) };
+const RpcResponseCache::Policy POOL_POLICY = { true, std::chrono::milliseconds(0) };
+
+}
+
+class RpcResponseCacheTest : public ::testing::Test {
+public:
+  RpcResponseCacheTest() : cache(1024) {
+  }
+
+  RpcResponseCache cache;
+};
+
+TEST_F(RpcResponseCacheTest, storedResponseIsReturned) {
+  std::string response;
+  ASSERT_FALSE(cache.get("getlastblockheader\n", response));
+
+  cache.put("getlastblockheader\n", BLOCKCHAIN_POLICY, cache.getVersion(), "header");
+  ASSERT_TRUE(cache.get("getlastblockheader\n", response));
+  ASSERT_EQ("header", response);
+
+  RpcResponseCache::Stats stats = cache.getStats();
+  ASSERT_EQ(1, stats.hits);
+  ASSERT_EQ(1, stats.misses);
+  ASSERT_EQ(1, stats.entries);
+}
+
+TEST_F(RpcResponseCacheTest, blockchainUpdateDropsEverything) {
+  cache.put("a", BLOCKCHAIN_POLICY, cache.getVersion(), "1");
+  cache.put("b", POOL_POLICY, cache.getVersion(), "2");
+  cache.blockchainUpdated();
+
+  std::string response;
+  ASSERT_FALSE(cache.get("a", response));
+  ASSERT_FALSE(cache.get("b", response));
+  ASSERT_EQ(0, cache.getStats().size);
+}
+
+TEST_F(RpcResponseCacheTest, poolUpdateDropsPoolDependentResponses) {
+  cache.put("a", BLOCKCHAIN_POLICY, cache.getVersion(), "1");
+  cache.put("b", POOL_POLICY, cache.getVersion(), "2");
+  cache.poolUpdated();
+
+  std::string response;
+  ASSERT_TRUE(cache.get("a", response));
+  ASSERT_FALSE(cache.get("b", response));
+}
+
+TEST_F(RpcResponseCacheTest, responseOfOldVersionIsNotStored) {
+  RpcResponseCache::Version version = cache.getVersion();
+  cache.blockchainUpdated();
+  cache.put("a", BLOCKCHAIN_POLICY, version, "1");
+
+  version = cache.getVersion();
+  cache.poolUpdated();
+  cache.put("b", BLOCKCHAIN_POLICY, version, "2");
+  cache.put("c", POOL_POLICY, version, "3");
+
+  std::string response;
+  ASSERT_FALSE(cache.get("a", response));
+  ASSERT_TRUE(cache.get("b", response));
+  ASSERT_FALSE(cache.get("c", response));
+}
+
+TEST_F(RpcResponseCacheTest, leastRecentlyUsedIsEvicted) {
+  cache.put("a", BLOCKCHAIN_POLICY, cache.getVersion(), std::string(400, 'a'));
+  cache.put("b", BLOCKCHAIN_POLICY, cache.getVersion(), std::string(400, 'b'));
+
+  std::string response;
+  ASSERT_TRUE(cache.get("a", response));
+  cache.put("c", BLOCKCHAIN_POLICY, cache.getVersion(), std::string(400, 'c'));
+
+  ASSERT_TRUE(cache.get("a", response));
+  ASSERT_FALSE(cache.get("b", response));
+  ASSERT_TRUE(cache.get("c", response));
+  ASSERT_LE(cache.getStats().size, 1024);
+
+  cache.put("d", BLOCKCHAIN_POLICY, cache.getVersion(), std::string(2000, 'd'));
+  ASSERT_FALSE(cache.get("d", response));
+}
+
+TEST_F(RpcResponseCacheTest, responseExpires) {
+  cache.put("/getinfo\n", { true, std::chrono::milliseconds(20) }, cache.getVersion(), "info");
+
+  std::string response;
+  ASSERT_TRUE(cache.get("/getinfo\n", response));
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  ASSERT_FALSE(cache.get("/getinfo\n", response));
+}
+
+TEST_F(RpcResponseCacheTest, zeroSizeDisablesCache) {
+  cache.setMaxSize(0);
+  ASSERT_FALSE(cache.isEnabled());
+
+  cache.put("a", BLOCKCHAIN_POLICY, cache.getVersion(), "1");
+  std::string response;
+  ASSERT_FALSE(cache.get("a", response));
+}
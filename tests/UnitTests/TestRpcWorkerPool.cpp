@@ -0,0 +1,108 @@
+// Copyright (c) 2017-2022 Fuego Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include <Rpc/RpcWorkerPool.h>
+#include <System/Context.h>
+#include <System/Dispatcher.h>
+
+using namespace CryptoNote;
+
+class RpcWorkerPoolTest : public ::testing::Test {
+public:
+  RpcWorkerPoolTest() : pool(dispatcher) {
+  }
+
+  System::Dispatcher dispatcher;
+  RpcWorkerPool pool;
+};
+
+TEST_F(RpcWorkerPoolTest, runsInlineWithoutThreads) {
+  pool.start(0);
+
+  std::thread::id id;
+  pool.run("/getheight", [&] { id = std::this_thread::get_id(); });
+  ASSERT_EQ(std::this_thread::get_id(), id);
+}
+
+TEST_F(RpcWorkerPoolTest, runsOnWorkerThread) {
+  pool.start(2);
+
+  std::thread::id id;
+  pool.run("/getblocks.bin", [&] { id = std::this_thread::get_id(); });
+  ASSERT_NE(std::this_thread::get_id(), id);
+  ASSERT_EQ(1, pool.getStats().at("/getblocks.bin").calls);
+}
+
+TEST_F(RpcWorkerPoolTest, exceptionIsRethrownInRequestContext) {
+  pool.start(1);
+  ASSERT_THROW(pool.run("/getblocks.bin", [] { throw std::runtime_error("failed"); }), std::runtime_error);
+  ASSERT_EQ(0, pool.getStats().at("/getblocks.bin").running);
+}
+
+TEST_F(RpcWorkerPoolTest, requestsRunConcurrently) {
+  pool.start(4);
+
+  std::atomic<size_t> running(0);
+  std::atomic<size_t> maxRunning(0);
+  auto task = [&] {
+    size_t current = ++running;
+    size_t max = maxRunning;
+    while (current > max && !maxRunning.compare_exchange_weak(max, current)) {
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    --running;
+  };
+
+  std::vector<std::unique_ptr<System::Context<>>> requests;
+  for (size_t i = 0; i < 4; ++i) {
+    requests.emplace_back(new System::Context<>(dispatcher, [&] { pool.run("/getblocks.bin", task); }));
+  }
+
+  for (auto& request : requests) {
+    request->get();
+  }
+
+  ASSERT_GT(maxRunning.load(), 1);
+}
+
+TEST_F(RpcWorkerPoolTest, endpointLimitIsRespected) {
+  pool.setEndpointLimit("/getrandom_outs.bin", 1);
+  pool.start(4);
+
+  std::atomic<size_t> running(0);
+  std::atomic<bool> overlapped(false);
+  auto task = [&] {
+    if (++running > 1) {
+      overlapped = true;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    --running;
+  };
+
+  std::vector<std::unique_ptr<System::Context<>>> requests;
+  for (size_t i = 0; i < 3; ++i) {
+    requests.emplace_back(new System::Context<>(dispatcher, [&] { pool.run("/getrandom_outs.bin", task); }));
+  }
+
+  for (auto& request : requests) {
+    request->get();
+  }
+
+  ASSERT_FALSE(overlapped);
+
+  auto stats = pool.getStats().at("/getrandom_outs.bin");
+  ASSERT_EQ(3, stats.calls);
+  ASSERT_EQ(0, stats.running);
+  ASSERT_EQ(0, stats.waiting);
+}
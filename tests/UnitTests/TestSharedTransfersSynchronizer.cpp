@@ -0,0 +1,242 @@
+// Copyright (c) 2017-2022 Fuego Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+
+#include "CryptoNoteCore/Account.h"
+#include "CryptoNoteCore/Currency.h"
+#include "Logging/LoggerGroup.h"
+#include "Transfers/SharedTransfersSynchronizer.h"
+
+#include "INodeStubs.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+// A chain of bare block hashes, enough for consumers to follow it
+class ChainNode : public INodeDummyStub {
+public:
+  explicit ChainNode(const Crypto::Hash& genesisBlockHash) {
+    m_chain.push_back(genesisBlockHash);
+  }
+
+  virtual uint32_t getLastLocalBlockHeight() const override { return getLocalBlockCount() - 1; }
+  virtual uint32_t getLastKnownBlockHeight() const override { return getLocalBlockCount() - 1; }
+  virtual uint32_t getKnownBlockCount() const override { return getLocalBlockCount(); }
+
+  virtual uint32_t getLocalBlockCount() const override {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<uint32_t>(m_chain.size());
+  }
+
+  virtual void queryBlocks(std::vector<Crypto::Hash>&& knownBlockIds, uint64_t timestamp, std::vector<BlockShortEntry>& newBlocks,
+    uint32_t& startHeight, const Callback& callback) override {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      startHeight = 0;
+      for (const auto& id : knownBlockIds) {
+        auto it = std::find(m_chain.begin(), m_chain.end(), id);
+        if (it != m_chain.end()) {
+          startHeight = static_cast<uint32_t>(it - m_chain.begin());
+          break;
+        }
+      }
+
+      for (uint32_t height = startHeight; height < m_chain.size(); ++height) {
+        BlockShortEntry entry;
+        entry.blockHash = m_chain[height];
+        entry.hasBlock = false;
+        newBlocks.push_back(entry);
+      }
+    }
+
+    callback(std::error_code());
+  }
+
+  void addBlocks(size_t count) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      while (count--) {
+        m_chain.push_back(Crypto::rand<Crypto::Hash>());
+      }
+    }
+
+    updateObservers();
+  }
+
+private:
+  mutable std::mutex m_mutex;
+  std::vector<Crypto::Hash> m_chain;
+};
+
+class CompletionCounter : public IBlockchainSynchronizerObserver {
+public:
+  virtual void synchronizationCompleted(std::error_code result) override {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_completions;
+    m_completed.notify_all();
+  }
+
+  bool waitFor(size_t completions) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_completed.wait_for(lock, std::chrono::seconds(10), [this, completions] { return m_completions >= completions; });
+  }
+
+private:
+  std::mutex m_mutex;
+  std::condition_variable m_completed;
+  size_t m_completions = 0;
+};
+
+}
+
+class SharedTransfersSynchronizerTest : public ::testing::Test {
+public:
+  SharedTransfersSynchronizerTest() :
+    currency(CurrencyBuilder(logger).currency()),
+    node(currency.genesisBlockHash()),
+    synchronizer(currency, logger, node) {
+    first.generate();
+    second.generate();
+    subscribe(synchronizer, first);
+    subscribe(synchronizer, second);
+    synchronizer.getBlockchainSynchronizer().addObserver(&completions);
+  }
+
+  ~SharedTransfersSynchronizerTest() {
+    synchronizer.pause();
+    synchronizer.getBlockchainSynchronizer().removeObserver(&completions);
+  }
+
+  static void subscribe(SharedTransfersSynchronizer& shared, const AccountBase& account) {
+    AccountSubscription subscription;
+    subscription.keys = account.getAccountKeys();
+    subscription.syncStart.timestamp = 0;
+    subscription.syncStart.height = 0;
+    subscription.transactionSpendableAge = 1;
+    shared.getTransfersSynchronizer().addSubscription(subscription);
+  }
+
+  static const Crypto::PublicKey& viewKey(const AccountBase& account) {
+    return account.getAccountKeys().address.viewPublicKey;
+  }
+
+  size_t knownBlocks(SharedTransfersSynchronizer& shared, const AccountBase& account) {
+    return shared.getTransfersSynchronizer().getViewKeyKnownBlocks(viewKey(account)).size();
+  }
+
+  Logging::LoggerGroup logger;
+  Currency currency;
+  ChainNode node;
+  SharedTransfersSynchronizer synchronizer;
+  CompletionCounter completions;
+  AccountBase first;
+  AccountBase second;
+};
+
+TEST_F(SharedTransfersSynchronizerTest, runsOnceEveryContainerResumed) {
+  node.addBlocks(5);
+
+  synchronizer.pause();
+  synchronizer.pause();
+  synchronizer.resume();
+
+  // still stopped, so the states can be read and nothing was fetched
+  ASSERT_EQ(1, knownBlocks(synchronizer, first));
+  ASSERT_EQ(1, knownBlocks(synchronizer, second));
+
+  synchronizer.resume();
+  ASSERT_TRUE(completions.waitFor(1));
+
+  synchronizer.pause();
+  ASSERT_EQ(6, knownBlocks(synchronizer, first));
+  ASSERT_EQ(6, knownBlocks(synchronizer, second));
+  synchronizer.resume();
+}
+
+TEST_F(SharedTransfersSynchronizerTest, pausedViewKeyMissesBlocksUntilEveryPauseIsResumed) {
+  node.addBlocks(2);
+  synchronizer.pause();
+  synchronizer.resume();
+  ASSERT_TRUE(completions.waitFor(1));
+
+  synchronizer.pause(viewKey(first));
+  synchronizer.pause(viewKey(first));
+
+  // a paused consumer can be read while the synchronizer runs
+  ASSERT_EQ(3, knownBlocks(synchronizer, first));
+
+  node.addBlocks(3);
+  ASSERT_TRUE(completions.waitFor(2));
+  synchronizer.resume(viewKey(first));
+
+  synchronizer.pause();
+  ASSERT_EQ(3, knownBlocks(synchronizer, first));
+  ASSERT_EQ(6, knownBlocks(synchronizer, second));
+  synchronizer.resume();
+  ASSERT_TRUE(completions.waitFor(3));
+
+  // the last resume lets it catch up
+  synchronizer.resume(viewKey(first));
+  ASSERT_TRUE(completions.waitFor(4));
+
+  synchronizer.pause();
+  ASSERT_EQ(6, knownBlocks(synchronizer, first));
+  ASSERT_EQ(6, knownBlocks(synchronizer, second));
+  synchronizer.resume();
+}
+
+TEST_F(SharedTransfersSynchronizerTest, viewKeyStateIsSavedWhileOthersRunAndLoadsAlone) {
+  node.addBlocks(4);
+  synchronizer.pause();
+  synchronizer.resume();
+  ASSERT_TRUE(completions.waitFor(1));
+
+  std::stringstream state;
+  synchronizer.pause(viewKey(first));
+  synchronizer.getTransfersSynchronizer().save(state, viewKey(first));
+  synchronizer.resume(viewKey(first));
+
+  SharedTransfersSynchronizer restored(currency, logger, node);
+  subscribe(restored, first);
+  subscribe(restored, second);
+  restored.getTransfersSynchronizer().load(state, viewKey(first));
+
+  ASSERT_EQ(5, knownBlocks(restored, first));
+  ASSERT_EQ(1, knownBlocks(restored, second));
+
+  // state of the other view key is left out of the stream, loading it changes nothing
+  state.clear();
+  state.seekg(0);
+  restored.getTransfersSynchronizer().load(state, viewKey(second));
+  ASSERT_EQ(1, knownBlocks(restored, second));
+}
+
+TEST_F(SharedTransfersSynchronizerTest, snapshotWritesTheStateItWasTakenAt) {
+  node.addBlocks(2);
+  synchronizer.pause();
+  synchronizer.resume();
+  ASSERT_TRUE(completions.waitFor(1));
+
+  std::stringstream state;
+  synchronizer.pause(viewKey(first));
+  synchronizer.getTransfersSynchronizer().save(state, viewKey(first));
+  auto snapshot = synchronizer.getTransfersSynchronizer().getSnapshot(viewKey(first));
+  synchronizer.resume(viewKey(first));
+
+  node.addBlocks(3);
+  ASSERT_TRUE(completions.waitFor(2));
+
+  // the blocks taken after the snapshot are left out
+  std::stringstream snapshotState;
+  snapshot->save(snapshotState);
+  ASSERT_EQ(state.str(), snapshotState.str());
+}
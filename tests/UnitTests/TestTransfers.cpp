@@ -381,6 +381,45 @@ TEST_F(TransfersApi, state) {
   ASSERT_TRUE(compareStates(m_transfersSync, sync2));
 }
 
+TEST_F(TransfersApi, stateChangesFollowSavedState) {
+  addMinerAccount();
+  subscribeAccounts();
+
+  generator.generateEmptyBlocks(20);
+  startSync();
+
+  const auto& viewKey = m_accounts[0].address.viewPublicKey;
+  m_sync.stop();
+  std::stringstream state;
+  m_transfersSync.save(state);
+  m_transfersSync.clearChanges(viewKey);
+  uint32_t savedHeight = static_cast<uint32_t>(m_transfersSync.getViewKeyKnownBlocks(viewKey).size());
+  m_sync.start();
+
+  generator.getBlockRewardForAddress(m_accounts[0].address);
+  generator.generateEmptyBlocks(10);
+  refreshSync();
+
+  m_sync.stop();
+  std::stringstream changes;
+  uint32_t height = m_transfersSync.saveChanges(changes, viewKey, savedHeight);
+  m_sync.start();
+  ASSERT_EQ(m_transfersSync.getViewKeyKnownBlocks(viewKey).size(), height);
+
+  BlockchainSynchronizer bsync2(m_node, m_currency.genesisBlockHash());
+  TransfersSyncronizer sync2(m_currency, m_logger, bsync2, m_node);
+  for (size_t i = 0; i < m_accounts.size(); ++i) {
+    sync2.addSubscription(createSubscription(i));
+  }
+
+  sync2.load(state);
+  ASSERT_FALSE(compareStates(m_transfersSync, sync2));
+
+  sync2.loadChanges(changes, viewKey);
+  ASSERT_TRUE(compareStates(m_transfersSync, sync2));
+  ASSERT_EQ(m_transfersSync.getViewKeyKnownBlocks(viewKey), sync2.getViewKeyKnownBlocks(viewKey));
+}
+
 TEST_F(TransfersApi, sameTrackingKey) {
 
   size_t offset = 2; // miner account + ordinary account
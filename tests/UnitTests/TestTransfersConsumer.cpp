@@ -552,6 +552,112 @@ TEST_F(TransfersConsumerTest, onNewBlocks_getTransactionOutsGlobalIndicesIsPrope
   ASSERT_EQ(expectedHash, node.hash);
 }
 
+TEST_F(TransfersConsumerTest, onNewBlocks_getTransactionsOutsGlobalIndicesIsCalledOncePerBatch) {
+  class INodeGlobalIndicesStub: public INodeDummyStub {
+  public:
+    virtual void getTransactionsOutsGlobalIndices(const std::vector<Crypto::Hash>& transactionHashes,
+      std::vector<std::vector<uint32_t>>& outsGlobalIndices, const Callback& callback) override {
+      outsGlobalIndices.assign(transactionHashes.size(), std::vector<uint32_t>(3, 7));
+      hashes.push_back(transactionHashes);
+      callback(std::error_code());
+    };
+
+    std::vector<std::vector<Crypto::Hash>> hashes;
+  };
+
+  INodeGlobalIndicesStub node;
+  TransfersConsumer consumer(m_currency, node, m_accountKeys.viewSecretKey);
+
+  AccountSubscription subscription = getAccountSubscription(m_accountKeys);
+  subscription.syncStart.height = 0;
+  subscription.syncStart.timestamp = 0;
+  auto& container = consumer.addSubscription(subscription).getContainer();
+
+  std::shared_ptr<ITransaction> tx1(createTransaction());
+  addTestInput(*tx1, 10000);
+  addTestKeyOutput(*tx1, 900, 2, m_accountKeys);
+
+  std::shared_ptr<ITransaction> tx2(createTransaction());
+  addTestInput(*tx2, 10000);
+  addTestKeyOutput(*tx2, 800, 2, m_accountKeys);
+
+  CompleteBlock blocks[2];
+  blocks[0].block = CryptoNote::Block();
+  blocks[0].block->timestamp = 0;
+  blocks[0].transactions.push_back(tx1);
+  blocks[1].block = CryptoNote::Block();
+  blocks[1].block->timestamp = 0;
+  blocks[1].transactions.push_back(tx2);
+
+  ASSERT_TRUE(consumer.onNewBlocks(&blocks[0], 1, 2));
+  ASSERT_EQ(1, node.hashes.size());
+  ASSERT_EQ(2, node.hashes[0].size());
+
+  auto outs = container.getTransactionOutputs(tx2->getTransactionHash(), ITransfersContainer::IncludeAll);
+  ASSERT_EQ(1, outs.size());
+  ASSERT_EQ(7, outs[0].globalOutputIndex);
+}
+
+TEST_F(TransfersConsumerTest, onNewBlocks_fallsBackToSingleRequestsIfBatchIsNotSupported) {
+  class INodeGlobalIndicesStub: public INodeDummyStub {
+  public:
+    INodeGlobalIndicesStub() : batchCalls(0) {};
+
+    virtual void getTransactionsOutsGlobalIndices(const std::vector<Crypto::Hash>& transactionHashes,
+      std::vector<std::vector<uint32_t>>& outsGlobalIndices, const Callback& callback) override {
+      ++batchCalls;
+      callback(std::make_error_code(std::errc::function_not_supported));
+    };
+
+    virtual void getTransactionOutsGlobalIndices(const Crypto::Hash& transactionHash,
+      std::vector<uint32_t>& outsGlobalIndices, const Callback& callback) override {
+      outsGlobalIndices.assign(3, 7);
+      hashes.push_back(transactionHash);
+      callback(std::error_code());
+    };
+
+    size_t batchCalls;
+    std::vector<Crypto::Hash> hashes;
+  };
+
+  INodeGlobalIndicesStub node;
+  TransfersConsumer consumer(m_currency, node, m_accountKeys.viewSecretKey);
+
+  AccountSubscription subscription = getAccountSubscription(m_accountKeys);
+  subscription.syncStart.height = 0;
+  subscription.syncStart.timestamp = 0;
+  auto& container = consumer.addSubscription(subscription).getContainer();
+
+  std::shared_ptr<ITransaction> tx1(createTransaction());
+  addTestInput(*tx1, 10000);
+  addTestKeyOutput(*tx1, 900, 2, m_accountKeys);
+
+  std::shared_ptr<ITransaction> tx2(createTransaction());
+  addTestInput(*tx2, 10000);
+  addTestKeyOutput(*tx2, 800, 2, m_accountKeys);
+
+  CompleteBlock blocks[2];
+  blocks[0].block = CryptoNote::Block();
+  blocks[0].block->timestamp = 0;
+  blocks[0].transactions.push_back(tx1);
+  blocks[1].block = CryptoNote::Block();
+  blocks[1].block->timestamp = 0;
+  blocks[1].transactions.push_back(tx2);
+
+  ASSERT_TRUE(consumer.onNewBlocks(&blocks[0], 1, 1));
+  ASSERT_TRUE(consumer.onNewBlocks(&blocks[1], 2, 1));
+
+  // the batch request isn't tried again once the node turned it down
+  ASSERT_EQ(1, node.batchCalls);
+  ASSERT_EQ(2, node.hashes.size());
+  ASSERT_EQ(tx1->getTransactionHash(), node.hashes[0]);
+  ASSERT_EQ(tx2->getTransactionHash(), node.hashes[1]);
+
+  auto outs = container.getTransactionOutputs(tx2->getTransactionHash(), ITransfersContainer::IncludeAll);
+  ASSERT_EQ(1, outs.size());
+  ASSERT_EQ(7, outs[0].globalOutputIndex);
+}
+
 TEST_F(TransfersConsumerTest, onNewBlocks_getTransactionOutsGlobalIndicesIsNotCalled) {
   class INodeGlobalIndicesStub: public INodeDummyStub {
   public:
@@ -1553,3 +1553,95 @@ TEST_F(TransfersContainer_depositBalance, transactionUnlockTimeGreaterThenDeposi
   EXPECT_EQ(0, container.balance(ITransfersContainer::IncludeAllUnlocked));
   EXPECT_EQ(TEST_OUTPUT_AMOUNT, container.balance(ITransfersContainer::IncludeTypeAll | ITransfersContainer::IncludeStateLocked));
 }
+
+//--------------------------------------------------------------------------- 
+// TransfersContainer_changes
+//--------------------------------------------------------------------------- 
+class TransfersContainer_changes : public TransfersContainerTest {
+protected:
+  static void expectSameState(const TransfersContainer& expected, const TransfersContainer& actual, const std::vector<Hash>& hashes) {
+    EXPECT_EQ(expected.transactionsCount(), actual.transactionsCount());
+    EXPECT_EQ(expected.transfersCount(), actual.transfersCount());
+    EXPECT_EQ(expected.balance(ITransfersContainer::IncludeAllUnlocked), actual.balance(ITransfersContainer::IncludeAllUnlocked));
+    EXPECT_EQ(expected.balance(ITransfersContainer::IncludeAllLocked), actual.balance(ITransfersContainer::IncludeAllLocked));
+    EXPECT_EQ(expected.getSpentOutputs().size(), actual.getSpentOutputs().size());
+
+    for (const auto& hash : hashes) {
+      TransactionInformation expectedInfo;
+      TransactionInformation actualInfo;
+      EXPECT_EQ(expected.getTransactionInformation(hash, expectedInfo), actual.getTransactionInformation(hash, actualInfo));
+      EXPECT_EQ(expectedInfo.blockHeight, actualInfo.blockHeight);
+    }
+  }
+};
+
+TEST_F(TransfersContainer_changes, changesBringSavedStateUpToDate) {
+  auto tx = addTransaction(TEST_BLOCK_HEIGHT);
+  container.advanceHeight(TEST_BLOCK_HEIGHT);
+
+  std::stringstream state;
+  container.save(state);
+  container.clearChanges();
+
+  auto spendingTx = addSpendingTransaction(tx->getTransactionHash(), TEST_BLOCK_HEIGHT + 1, 0, TEST_OUTPUT_AMOUNT / 2);
+  auto unconfirmedTx = addTransaction();
+  container.advanceHeight(TEST_BLOCK_HEIGHT + 1);
+
+  std::stringstream changes;
+  container.saveChanges(changes);
+
+  TransfersContainer container2(currency, TEST_TRANSACTION_SPENDABLE_AGE);
+  container2.load(state);
+  std::stringstream previous;
+  container2.loadChanges(changes, previous);
+
+  expectSameState(container, container2,
+    { tx->getTransactionHash(), spendingTx->getTransactionHash(), unconfirmedTx->getTransactionHash() });
+}
+
+TEST_F(TransfersContainer_changes, changesHoldOnlyTouchedTransactions) {
+  addTransaction(TEST_BLOCK_HEIGHT);
+  addTransaction(TEST_BLOCK_HEIGHT);
+  container.clearChanges();
+
+  addTransaction(TEST_BLOCK_HEIGHT + 1);
+
+  std::stringstream changes;
+  container.saveChanges(changes);
+
+  TransfersContainer container2(currency, TEST_TRANSACTION_SPENDABLE_AGE);
+  std::stringstream previous;
+  container2.loadChanges(changes, previous);
+  EXPECT_EQ(1, container2.transactionsCount());
+}
+
+TEST_F(TransfersContainer_changes, loadingPreviousUndoesChanges) {
+  auto tx = addTransaction(TEST_BLOCK_HEIGHT);
+  container.advanceHeight(TEST_BLOCK_HEIGHT);
+
+  std::stringstream state;
+  container.save(state);
+  container.clearChanges();
+
+  auto spendingTx = addSpendingTransaction(tx->getTransactionHash(), TEST_BLOCK_HEIGHT + 1, 0, TEST_OUTPUT_AMOUNT / 2);
+  container.advanceHeight(TEST_BLOCK_HEIGHT + 1);
+  std::vector<Hash> hashes = { tx->getTransactionHash(), spendingTx->getTransactionHash() };
+
+  std::stringstream changes;
+  container.saveChanges(changes);
+
+  TransfersContainer original(currency, TEST_TRANSACTION_SPENDABLE_AGE);
+  state.seekg(0);
+  original.load(state);
+  state.seekg(0);
+  TransfersContainer container2(currency, TEST_TRANSACTION_SPENDABLE_AGE);
+  container2.load(state);
+
+  std::stringstream previous;
+  container2.loadChanges(changes, previous);
+  expectSameState(container, container2, hashes);
+
+  std::stringstream unused;
+  container2.loadChanges(previous, unused);
+  expectSameState(original, container2, hashes);
+}
@@ -0,0 +1,164 @@
+// Copyright (c) 2017-2022 Fuego Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <vector>
+
+#include <Common/StringTools.h>
+#include <crypto/crypto.h>
+
+using namespace Crypto;
+
+namespace {
+
+const PublicKey IDENTITY = { { 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } };
+
+// y = 2 is not the y coordinate of any curve point
+const PublicKey INVALID_POINT = { { 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } };
+
+class UnderivePublicKeysTest : public ::testing::Test {
+public:
+  UnderivePublicKeysTest() {
+    generate_keys(viewPublicKey, viewSecretKey);
+    generate_keys(spendPublicKey, spendSecretKey);
+  }
+
+  // An output of a transaction with the given secret key, paid to the test spend key
+  OutputScanEntry makeEntry(const PublicKey& txPublicKey, const SecretKey& txSecretKey, size_t outputIndex, const PublicKey& base) {
+    KeyDerivation derivation;
+    EXPECT_TRUE(generate_key_derivation(viewPublicKey, txSecretKey, derivation));
+
+    OutputScanEntry entry;
+    entry.transactionPublicKey = txPublicKey;
+    entry.outputIndex = outputIndex;
+    EXPECT_TRUE(derive_public_key(derivation, outputIndex, base, entry.outputKey));
+    return entry;
+  }
+
+  void addTransaction(size_t outputCount) {
+    PublicKey txPublicKey;
+    SecretKey txSecretKey;
+    generate_keys(txPublicKey, txSecretKey);
+    for (size_t i = 0; i < outputCount; ++i) {
+      PublicKey base = spendPublicKey;
+      if (i % 2 == 1) {
+        SecretKey otherSecretKey;
+        generate_keys(base, otherSecretKey);
+      }
+
+      entries.push_back(makeEntry(txPublicKey, txSecretKey, i, base));
+    }
+  }
+
+  // The batch must agree with calling underive_public_key for every output on its own
+  void checkBatch() {
+    std::unique_ptr<PublicKey[]> bases(new PublicKey[entries.size()]);
+    std::unique_ptr<bool[]> valid(new bool[entries.size()]);
+    underive_public_keys(viewSecretKey, entries.data(), entries.size(), bases.get(), valid.get());
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+      KeyDerivation derivation;
+      PublicKey expected;
+      bool expectedValid = generate_key_derivation(entries[i].transactionPublicKey, viewSecretKey, derivation) &&
+        underive_public_key(derivation, entries[i].outputIndex, entries[i].outputKey, expected);
+
+      ASSERT_EQ(expectedValid, valid[i]) << i;
+      if (expectedValid) {
+        ASSERT_EQ(expected, bases[i]) << i << " " << Common::podToHex(bases[i]);
+      }
+    }
+  }
+
+  PublicKey viewPublicKey;
+  SecretKey viewSecretKey;
+  PublicKey spendPublicKey;
+  SecretKey spendSecretKey;
+  std::vector<OutputScanEntry> entries;
+};
+
+}
+
+TEST_F(UnderivePublicKeysTest, batchMatchesSingleUnderive) {
+  for (size_t i = 1; i <= 8; ++i) {
+    addTransaction(i);
+  }
+
+  checkBatch();
+}
+
+TEST_F(UnderivePublicKeysTest, singleKeyBatch) {
+  addTransaction(1);
+  checkBatch();
+}
+
+TEST_F(UnderivePublicKeysTest, emptyBatch) {
+  underive_public_keys(viewSecretKey, nullptr, 0, nullptr, nullptr);
+}
+
+TEST_F(UnderivePublicKeysTest, spendKeyIsFound) {
+  addTransaction(4);
+
+  std::vector<PublicKey> bases(entries.size());
+  std::unique_ptr<bool[]> valid(new bool[entries.size()]);
+  underive_public_keys(viewSecretKey, entries.data(), entries.size(), bases.data(), valid.get());
+
+  for (size_t i = 0; i < entries.size(); ++i) {
+    ASSERT_TRUE(valid[i]);
+    ASSERT_EQ(i % 2 == 0, bases[i] == spendPublicKey) << i;
+  }
+}
+
+TEST_F(UnderivePublicKeysTest, invalidOutputKeyIsReportedAlone) {
+  addTransaction(3);
+  entries[1].outputKey = INVALID_POINT;
+  addTransaction(2);
+
+  checkBatch();
+  std::unique_ptr<PublicKey[]> bases(new PublicKey[entries.size()]);
+  std::unique_ptr<bool[]> valid(new bool[entries.size()]);
+  underive_public_keys(viewSecretKey, entries.data(), entries.size(), bases.get(), valid.get());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    ASSERT_EQ(i != 1, valid[i]) << i;
+  }
+}
+
+TEST_F(UnderivePublicKeysTest, invalidTransactionKeyInvalidatesItsOutputs) {
+  addTransaction(2);
+  addTransaction(3);
+  entries[2].transactionPublicKey = INVALID_POINT;
+  entries[3].transactionPublicKey = INVALID_POINT;
+  entries[4].transactionPublicKey = INVALID_POINT;
+  addTransaction(1);
+
+  checkBatch();
+  std::unique_ptr<PublicKey[]> bases(new PublicKey[entries.size()]);
+  std::unique_ptr<bool[]> valid(new bool[entries.size()]);
+  underive_public_keys(viewSecretKey, entries.data(), entries.size(), bases.get(), valid.get());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    ASSERT_EQ(i < 2 || i > 4, valid[i]) << i;
+  }
+}
+
+TEST_F(UnderivePublicKeysTest, identityBaseIsEncoded) {
+  PublicKey txPublicKey;
+  SecretKey txSecretKey;
+  generate_keys(txPublicKey, txSecretKey);
+  entries.push_back(makeEntry(txPublicKey, txSecretKey, 0, spendPublicKey));
+  entries.push_back(makeEntry(txPublicKey, txSecretKey, 1, IDENTITY));
+
+  checkBatch();
+}
+
+TEST_F(UnderivePublicKeysTest, repeatedTransactionKeyOutOfOrder) {
+  PublicKey txPublicKey;
+  SecretKey txSecretKey;
+  generate_keys(txPublicKey, txSecretKey);
+  entries.push_back(makeEntry(txPublicKey, txSecretKey, 0, spendPublicKey));
+  addTransaction(2);
+  entries.push_back(makeEntry(txPublicKey, txSecretKey, 1, spendPublicKey));
+
+  checkBatch();
+}
@@ -9,6 +9,7 @@
 #include <chrono>
 #include <numeric>
 #include <tuple>
+#include <unordered_set>
 
 #include "Common/StringTools.h"
 #include "CryptoNoteCore/Currency.h"
@@ -707,6 +708,82 @@ TEST_F(WalletApi, transferNegativeAmount) {
   ASSERT_ANY_THROW(sendMoney(RANDOM_ADDRESS, -static_cast<int64_t>(SENT), FEE));
 }
 
+TEST_F(WalletApi, transferBatchSendsEveryTransaction) {
+  generateBlockReward();
+  generateBlockReward();
+  unlockMoney();
+
+  CryptoNote::WalletOrder order;
+  order.address = RANDOM_ADDRESS;
+  order.amount = SENT;
+
+  CryptoNote::TransactionParameters params;
+  params.destinations = {order};
+  params.fee = FEE;
+  params.changeDestination = aliceAddress;
+
+  auto alicePrev = alice.getActualBalance();
+  std::vector<Crypto::SecretKey> transactionSKs;
+  std::vector<size_t> ids = static_cast<CryptoNote::IWallet&>(alice).transfer({params, params, params}, transactionSKs);
+  node.updateObservers();
+  waitActualBalanceUpdated(alicePrev);
+
+  ASSERT_EQ(3, ids.size());
+  ASSERT_EQ(3, transactionSKs.size());
+
+  std::unordered_set<Crypto::Hash> hashes;
+  for (size_t id : ids) {
+    CryptoNote::WalletTransaction tx = alice.getTransaction(id);
+    ASSERT_EQ(CryptoNote::WalletTransactionState::SUCCEEDED, tx.state);
+    hashes.insert(tx.hash);
+  }
+
+  ASSERT_EQ(3, hashes.size());
+  ASSERT_EQ(alicePrev - 3 * (SENT + FEE), alice.getActualBalance() + alice.getPendingBalance());
+}
+
+TEST_F(WalletApi, transferBatchThrowsIfEmpty) {
+  generateAndUnlockMoney();
+
+  std::vector<Crypto::SecretKey> transactionSKs;
+  try {
+    static_cast<CryptoNote::IWallet&>(alice).transfer(std::vector<CryptoNote::TransactionParameters>(), transactionSKs);
+    FAIL();
+  } catch (const std::system_error& e) {
+    ASSERT_EQ(make_error_code(CryptoNote::error::WRONG_PARAMETERS), e.code());
+  }
+
+  ASSERT_EQ(0, alice.getTransactionCount());
+}
+
+TEST_F(WalletApi, transferBatchReleasesReservedOutputsOnFailure) {
+  generateAndUnlockMoney();
+
+  CryptoNote::WalletOrder order;
+  order.address = RANDOM_ADDRESS;
+  order.amount = SENT;
+
+  CryptoNote::TransactionParameters params;
+  params.destinations = {order};
+  params.fee = FEE;
+  params.changeDestination = aliceAddress;
+
+  CryptoNote::TransactionParameters tooBig = params;
+  tooBig.destinations[0].amount = alice.getActualBalance();
+
+  std::vector<Crypto::SecretKey> transactionSKs;
+  ASSERT_ANY_THROW(static_cast<CryptoNote::IWallet&>(alice).transfer({params, tooBig}, transactionSKs));
+  ASSERT_EQ(0, alice.getTransactionCount());
+
+  // the outputs selected for the first transaction are available again
+  auto alicePrev = alice.getActualBalance();
+  ASSERT_NO_THROW(sendMoney(RANDOM_ADDRESS, alicePrev - FEE, FEE));
+  node.updateObservers();
+  waitActualBalanceUpdated(alicePrev);
+
+  ASSERT_EQ(0, alice.getActualBalance() + alice.getPendingBalance());
+}
+
 TEST_F(WalletApi, transferFromTwoAddresses) {
   generateBlockReward();
   generateBlockReward(alice.createAddress());
@@ -0,0 +1,136 @@
+// Copyright (c) 2017-2022 Fuego Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+
+#include "gtest/gtest.h"
+
+#include "Wallet/WalletJournal.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+class WalletJournalTest : public ::testing::Test {
+public:
+  WalletJournalTest() : snapshotIv(Crypto::randomChachaIV()) {
+    memset(key.data, 0x5a, sizeof(key.data));
+  }
+
+  virtual void SetUp() override {
+    path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("journal_%%%%%%%%%%%%")).string();
+  }
+
+  virtual void TearDown() override {
+    WalletJournal::remove(path);
+  }
+
+protected:
+  std::string path;
+  Crypto::chacha8_key key;
+  Crypto::chacha8_iv snapshotIv;
+};
+
+}
+
+TEST_F(WalletJournalTest, recordsAreReadBackInOrder) {
+  WalletJournal journal;
+  journal.reset(path, snapshotIv);
+  journal.append(key, "first");
+  journal.append(key, std::string(4096, 'x'));
+
+  std::vector<std::string> records;
+  WalletJournal reopened;
+  ASSERT_TRUE(reopened.open(path, key, snapshotIv, records));
+  ASSERT_EQ(2, records.size());
+  ASSERT_EQ("first", records[0]);
+  ASSERT_EQ(std::string(4096, 'x'), records[1]);
+  ASSERT_EQ(journal.size(), reopened.size());
+  ASSERT_EQ(2, reopened.recordCount());
+}
+
+TEST_F(WalletJournalTest, journalOfAnotherSnapshotIsIgnored) {
+  WalletJournal journal;
+  journal.reset(path, snapshotIv);
+  journal.append(key, "record");
+
+  std::vector<std::string> records;
+  ASSERT_FALSE(journal.open(path, key, Crypto::randomChachaIV(), records));
+  ASSERT_TRUE(records.empty());
+  ASSERT_FALSE(journal.isOpened());
+}
+
+TEST_F(WalletJournalTest, tornTailIsCutOff) {
+  WalletJournal journal;
+  journal.reset(path, snapshotIv);
+  journal.append(key, "record");
+
+  {
+    std::ofstream file(path, std::ios_base::binary | std::ios_base::app);
+    file << "partially written record";
+  }
+
+  std::vector<std::string> records;
+  ASSERT_TRUE(journal.open(path, key, snapshotIv, records));
+  ASSERT_EQ(1, records.size());
+  ASSERT_EQ(journal.size(), boost::filesystem::file_size(path));
+
+  journal.append(key, "next");
+  records.clear();
+  ASSERT_TRUE(journal.open(path, key, snapshotIv, records));
+  ASSERT_EQ(2, records.size());
+  ASSERT_EQ("next", records[1]);
+}
+
+TEST_F(WalletJournalTest, rebaseKeepsLaterRecords) {
+  WalletJournal journal;
+  journal.reset(path, snapshotIv);
+  journal.append(key, "folded");
+  journal.append(key, "kept");
+  journal.append(key, "also kept");
+
+  Crypto::chacha8_iv newSnapshotIv = Crypto::randomChachaIV();
+  journal.rebase(newSnapshotIv, 1);
+  ASSERT_EQ(2, journal.recordCount());
+  ASSERT_EQ(journal.size(), boost::filesystem::file_size(path));
+
+  std::vector<std::string> records;
+  WalletJournal reopened;
+  ASSERT_FALSE(reopened.open(path, key, snapshotIv, records));
+  ASSERT_TRUE(reopened.open(path, key, newSnapshotIv, records));
+  ASSERT_EQ(2, records.size());
+  ASSERT_EQ("kept", records[0]);
+  ASSERT_EQ("also kept", records[1]);
+}
+
+TEST_F(WalletJournalTest, appendAfterRebaseFollowsKeptRecords) {
+  WalletJournal journal;
+  journal.reset(path, snapshotIv);
+  journal.append(key, "folded");
+
+  Crypto::chacha8_iv newSnapshotIv = Crypto::randomChachaIV();
+  journal.rebase(newSnapshotIv, 1);
+  ASSERT_EQ(0, journal.recordCount());
+  journal.append(key, "next");
+
+  std::vector<std::string> records;
+  ASSERT_TRUE(journal.open(path, key, newSnapshotIv, records));
+  ASSERT_EQ(1, records.size());
+  ASSERT_EQ("next", records[0]);
+  ASSERT_FALSE(boost::filesystem::exists(path + ".tmp"));
+}
+
+TEST_F(WalletJournalTest, rebaseBeyondRecordsThrows) {
+  WalletJournal journal;
+  journal.reset(path, snapshotIv);
+  journal.append(key, "record");
+
+  ASSERT_ANY_THROW(journal.rebase(Crypto::randomChachaIV(), 2));
+
+  std::vector<std::string> records;
+  ASSERT_TRUE(journal.open(path, key, snapshotIv, records));
+  ASSERT_EQ(1, records.size());
+}
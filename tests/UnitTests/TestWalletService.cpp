@@ -12,6 +12,7 @@
 #include <IWallet.h>
 
 #include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/TransactionExtra.h"
 #include "Logging/LoggerGroup.h"
 #include "Logging/ConsoleLogger.h"
 #include <System/Event.h>
@@ -70,12 +71,15 @@ struct IWalletBaseStub : public CryptoNote::IWallet {
   virtual WalletTransactionWithTransfers getTransaction(const Crypto::Hash& transactionHash) const override { return WalletTransactionWithTransfers(); }
   virtual std::vector<TransactionsInBlockInfo> getTransactions(const Crypto::Hash& blockHash, size_t count) const override { return {}; }
   virtual std::vector<TransactionsInBlockInfo> getTransactions(uint32_t blockIndex, size_t count) const override { return {}; }
+  virtual std::vector<TransactionsInBlockInfo> getTransactionsByPaymentId(const Crypto::Hash& paymentId, const Crypto::Hash& blockHash, size_t count) const override { return {}; }
+  virtual std::vector<TransactionsInBlockInfo> getTransactionsByPaymentId(const Crypto::Hash& paymentId, uint32_t blockIndex, size_t count) const override { return {}; }
   virtual std::vector<Crypto::Hash> getBlockHashes(uint32_t blockIndex, size_t count) const override { return {}; }
   virtual uint32_t getBlockCount() const override { return 0; }
   virtual std::vector<WalletTransactionWithTransfers> getUnconfirmedTransactions() const override { return {}; }
   virtual std::vector<size_t> getDelayedTransactionIds() const override { return {}; }
 
   virtual size_t transfer(const TransactionParameters& sendingTransaction) override { return 0; }
+  virtual std::vector<size_t> transfer(const std::vector<TransactionParameters>& sendingTransactions, std::vector<Crypto::SecretKey>& transactionSKs) override { return {}; }
 
   virtual size_t makeTransaction(const TransactionParameters& sendingTransaction) override { return 0; }
   virtual void commitTransaction(size_t transactionId) override { }
@@ -530,7 +534,40 @@ public:
     return transactions;
   }
 
+  virtual std::vector<TransactionsInBlockInfo> getTransactionsByPaymentId(const Crypto::Hash& paymentId, const Crypto::Hash& blockHash, size_t count) const override {
+    return transactionsByPaymentId(paymentId);
+  }
+
+  virtual std::vector<TransactionsInBlockInfo> getTransactionsByPaymentId(const Crypto::Hash& paymentId, uint32_t blockIndex, size_t count) const override {
+    return transactionsByPaymentId(paymentId);
+  }
+
+  virtual uint32_t getBlockCount() const override {
+    return static_cast<uint32_t>(transactions.size());
+  }
+
   std::vector<TransactionsInBlockInfo> transactions;
+
+private:
+  std::vector<TransactionsInBlockInfo> transactionsByPaymentId(const Crypto::Hash& paymentId) const {
+    std::vector<TransactionsInBlockInfo> result;
+    for (const auto& block : transactions) {
+      TransactionsInBlockInfo item;
+      item.blockHash = block.blockHash;
+      for (const auto& transaction : block.transactions) {
+        Crypto::Hash transactionPaymentId;
+        if (getPaymentIdFromTxExtra(Common::asBinaryArray(transaction.transaction.extra), transactionPaymentId) && transactionPaymentId == paymentId) {
+          item.transactions.push_back(transaction);
+        }
+      }
+
+      if (!block.transactions.empty()) {
+        result.push_back(std::move(item));
+      }
+    }
+
+    return result;
+  }
 };
 
 TEST_F(WalletServiceTest_getTransactions, addressesFilter_emptyReturnsTransaction) {
@@ -624,6 +661,38 @@ TEST_F(WalletServiceTest_getTransactions, paymentIdFilter_nonExistentReturnsNoTr
   ASSERT_TRUE(transactions[0].transactions.empty());
 }
 
+TEST_F(WalletServiceTest_getTransactions, paymentIdFilter_deletedTransactionIsNotReturned) {
+  WalletGetTransactionsStub wallet(dispatcher);
+  wallet.transactions = testTransactions;
+  wallet.transactions[0].transactions.push_back(
+    WalletTransactionWithTransfersBuilder().addTransfer(RANDOM_ADDRESS1, 111).transaction(
+      WalletTransactionBuilder().hash(generateRandomHash()).extra(TRANSACTION_EXTRA).state(WalletTransactionState::DELETED).build()
+    ).build()
+  );
+
+  auto service = createWalletService(wallet);
+
+  std::vector<TransactionsInBlockRpcInfo> transactions;
+  auto ec = service->getTransactions({}, 0, 1, PAYMENT_ID, transactions);
+
+  ASSERT_FALSE(ec);
+
+  ASSERT_EQ(1, transactions.size());
+  ASSERT_EQ(1, transactions[0].transactions.size());
+  ASSERT_EQ(Common::podToHex(testTransactions[0].transactions[0].transaction.hash), transactions[0].transactions[0].transactionHash);
+}
+
+TEST_F(WalletServiceTest_getTransactions, paymentIdFilter_unknownBlockReturnsNotFound) {
+  WalletGetTransactionsStub wallet(dispatcher);
+  wallet.transactions = testTransactions;
+
+  auto service = createWalletService(wallet);
+
+  std::vector<TransactionsInBlockRpcInfo> transactions;
+  auto ec = service->getTransactions({}, 1, 1, PAYMENT_ID, transactions);
+  ASSERT_EQ(make_error_code(CryptoNote::error::WalletServiceErrorCode::OBJECT_NOT_FOUND), ec);
+}
+
 TEST_F(WalletServiceTest_getTransactions, invalidAddress) {
   WalletGetTransactionsStub wallet(dispatcher);
   wallet.transactions = testTransactions;
@@ -817,6 +886,20 @@ TEST_F(WalletServiceTest_sendTransaction, incorrectTransferAddress) {
   ASSERT_EQ(make_error_code(CryptoNote::error::BAD_ADDRESS), ec);
 }
 
+class WalletServiceTest_sendTransactions : public WalletServiceTest {
+};
+
+TEST_F(WalletServiceTest_sendTransactions, emptyRequestIsRejected) {
+  auto service = createWalletService();
+
+  SendTransactions::Request request;
+  std::vector<SentTransaction> transactions;
+  auto ec = service->sendTransactions(request, transactions);
+
+  ASSERT_EQ(make_error_code(CryptoNote::error::WRONG_PARAMETERS), ec);
+  ASSERT_TRUE(transactions.empty());
+}
+
 class WalletServiceTest_createDelayedTransaction : public WalletServiceTest_getTransactions {
   virtual void SetUp() override;
 protected:
@@ -0,0 +1,190 @@
+// Copyright (c) 2017-2022 Fuego Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include <Wallet/WalletUnlockedOutputs.h>
+
+using namespace CryptoNote;
+
+namespace {
+
+TransactionOutputInformation makeOutput(uint64_t amount, uint8_t tx, uint32_t index = 0) {
+  TransactionOutputInformation output;
+  output.type = TransactionTypes::OutputType::Key;
+  output.amount = amount;
+  output.globalOutputIndex = 0;
+  output.outputInTransaction = index;
+  output.transactionHash = Crypto::Hash();
+  output.transactionHash.data[0] = tx;
+  output.transactionPublicKey = Crypto::PublicKey();
+  output.outputKey = Crypto::PublicKey();
+  output.outputKey.data[0] = tx;
+  output.outputKey.data[1] = static_cast<uint8_t>(index);
+  return output;
+}
+
+std::vector<uint64_t> selectAmounts(uint64_t neededMoney, uint64_t dustThreshold, const std::vector<const UnlockedOutputs*>& sources,
+  const std::unordered_set<Crypto::PublicKey>& reserved = {}) {
+  std::vector<std::pair<size_t, TransactionOutputInformation>> selected;
+  selectUnlockedOutputs(neededMoney, dustThreshold, sources, reserved, selected);
+
+  std::vector<uint64_t> amounts;
+  for (const auto& output : selected) {
+    amounts.push_back(output.second.amount);
+  }
+
+  return amounts;
+}
+
+}
+
+class WalletUnlockedOutputsTest : public ::testing::Test {
+};
+
+TEST_F(WalletUnlockedOutputsTest, keepsOutputsOrderedByAmount) {
+  UnlockedOutputs outputs;
+  ASSERT_TRUE(outputs.add(makeOutput(300, 1)));
+  ASSERT_TRUE(outputs.add(makeOutput(100, 2)));
+  ASSERT_TRUE(outputs.add(makeOutput(200, 3)));
+
+  std::vector<uint64_t> amounts;
+  for (const auto& output : outputs) {
+    amounts.push_back(output.first);
+  }
+
+  ASSERT_EQ(std::vector<uint64_t>({100, 200, 300}), amounts);
+}
+
+TEST_F(WalletUnlockedOutputsTest, addingOutputTwiceKeepsOneCopy) {
+  UnlockedOutputs outputs;
+  ASSERT_TRUE(outputs.add(makeOutput(100, 1)));
+  ASSERT_FALSE(outputs.add(makeOutput(100, 1)));
+  ASSERT_EQ(1, outputs.size());
+}
+
+TEST_F(WalletUnlockedOutputsTest, outputsWithSameAmountAreDistinguished) {
+  UnlockedOutputs outputs;
+  ASSERT_TRUE(outputs.add(makeOutput(100, 1, 0)));
+  ASSERT_TRUE(outputs.add(makeOutput(100, 1, 1)));
+  ASSERT_TRUE(outputs.add(makeOutput(100, 2, 0)));
+  ASSERT_EQ(3, outputs.size());
+
+  ASSERT_TRUE(outputs.remove(makeOutput(100, 1, 1)));
+  ASSERT_EQ(2, outputs.size());
+  ASSERT_FALSE(outputs.remove(makeOutput(100, 1, 1)));
+
+  for (const auto& output : outputs) {
+    ASSERT_FALSE(output.second.transactionHash.data[0] == 1 && output.second.outputInTransaction == 1);
+  }
+}
+
+TEST_F(WalletUnlockedOutputsTest, removingMissingOutputIsNoop) {
+  UnlockedOutputs outputs;
+  outputs.add(makeOutput(100, 1));
+  ASSERT_FALSE(outputs.remove(makeOutput(200, 1)));
+  ASSERT_FALSE(outputs.remove(makeOutput(100, 2)));
+  ASSERT_EQ(1, outputs.size());
+}
+
+TEST_F(WalletUnlockedOutputsTest, unlockAndLockEventsReplayedOverRebuiltIndexConverge) {
+  // index rebuilt after the output was unlocked and spent, then both events arrive
+  UnlockedOutputs outputs;
+  outputs.add(makeOutput(500, 1));
+
+  outputs.add(makeOutput(100, 2));
+  outputs.remove(makeOutput(100, 2));
+
+  ASSERT_EQ(1, outputs.size());
+  ASSERT_EQ(500, outputs.begin()->first);
+}
+
+TEST_F(WalletUnlockedOutputsTest, selectionTakesOneOutputPerBucketSmallestBucketFirst) {
+  UnlockedOutputs outputs;
+  outputs.add(makeOutput(5, 1));
+  outputs.add(makeOutput(50, 2));
+  outputs.add(makeOutput(500, 3));
+  outputs.add(makeOutput(7, 4));
+
+  ASSERT_EQ(std::vector<uint64_t>({7, 50, 500}), selectAmounts(60, 0, {&outputs}));
+}
+
+TEST_F(WalletUnlockedOutputsTest, selectionTakesLargestOutputOfBucketFirst) {
+  UnlockedOutputs outputs;
+  outputs.add(makeOutput(100, 1));
+  outputs.add(makeOutput(300, 2));
+  outputs.add(makeOutput(200, 3));
+
+  ASSERT_EQ(std::vector<uint64_t>({300}), selectAmounts(250, 0, {&outputs}));
+  ASSERT_EQ(std::vector<uint64_t>({300, 200}), selectAmounts(400, 0, {&outputs}));
+  ASSERT_EQ(std::vector<uint64_t>({300, 200, 100}), selectAmounts(550, 0, {&outputs}));
+}
+
+TEST_F(WalletUnlockedOutputsTest, selectionStopsAsSoonAsEnoughIsFound) {
+  UnlockedOutputs outputs;
+  outputs.add(makeOutput(9, 1));
+  outputs.add(makeOutput(90, 2));
+  outputs.add(makeOutput(900, 3));
+
+  ASSERT_EQ(std::vector<uint64_t>({9}), selectAmounts(5, 0, {&outputs}));
+  ASSERT_EQ(std::vector<uint64_t>({9, 90}), selectAmounts(50, 0, {&outputs}));
+}
+
+TEST_F(WalletUnlockedOutputsTest, selectionSkipsDust) {
+  UnlockedOutputs outputs;
+  outputs.add(makeOutput(10, 1));
+  outputs.add(makeOutput(11, 2));
+  outputs.add(makeOutput(1000, 3));
+
+  std::vector<std::pair<size_t, TransactionOutputInformation>> selected;
+  uint64_t found = selectUnlockedOutputs(2000, 10, {&outputs}, {}, selected);
+  ASSERT_EQ(1011, found);
+  ASSERT_EQ(2, selected.size());
+}
+
+TEST_F(WalletUnlockedOutputsTest, selectionSkipsReservedOutputs) {
+  UnlockedOutputs outputs;
+  outputs.add(makeOutput(300, 1));
+  outputs.add(makeOutput(200, 2));
+
+  ASSERT_EQ(std::vector<uint64_t>({200}), selectAmounts(150, 0, {&outputs}, {makeOutput(300, 1).outputKey}));
+}
+
+TEST_F(WalletUnlockedOutputsTest, selectionReportsSourceOfEachOutput) {
+  UnlockedOutputs first;
+  first.add(makeOutput(100, 1));
+  UnlockedOutputs second;
+  second.add(makeOutput(300, 2));
+  second.add(makeOutput(5, 3));
+
+  std::vector<std::pair<size_t, TransactionOutputInformation>> selected;
+  uint64_t found = selectUnlockedOutputs(400, 0, {&first, &second}, {}, selected);
+
+  ASSERT_EQ(405, found);
+  ASSERT_EQ(3, selected.size());
+  ASSERT_EQ(1, selected[0].first);
+  ASSERT_EQ(5, selected[0].second.amount);
+  ASSERT_EQ(1, selected[1].first);
+  ASSERT_EQ(300, selected[1].second.amount);
+  ASSERT_EQ(0, selected[2].first);
+  ASSERT_EQ(100, selected[2].second.amount);
+}
+
+TEST_F(WalletUnlockedOutputsTest, selectionReturnsLessIfNotEnoughMoney) {
+  UnlockedOutputs outputs;
+  outputs.add(makeOutput(100, 1));
+  outputs.add(makeOutput(20, 2));
+
+  std::vector<std::pair<size_t, TransactionOutputInformation>> selected;
+  ASSERT_EQ(120, selectUnlockedOutputs(1000, 0, {&outputs}, {}, selected));
+  ASSERT_EQ(2, selected.size());
+}
+
+TEST_F(WalletUnlockedOutputsTest, selectionHandlesLargestAmounts) {
+  UnlockedOutputs outputs;
+  outputs.add(makeOutput(std::numeric_limits<uint64_t>::max(), 1));
+  outputs.add(makeOutput(10000000000000000000ULL, 2));
+
+  ASSERT_EQ(std::vector<uint64_t>({std::numeric_limits<uint64_t>::max()}), selectAmounts(1, 0, {&outputs}));
+}